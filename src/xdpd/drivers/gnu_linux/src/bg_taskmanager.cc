@@ -24,10 +24,10 @@
 #include "processing/ls_internal_state.h"
 #include "io/bufferpool.h"
 #include "io/datapacket_storage.h"
-#include "io/pktin_dispatcher.h"
 #include "io/iomanager.h"
 #include "io/iface_utils.h"
 #include "util/time_utils.h"
+#include "telemetry.h"
 
 using namespace xdpd::gnu_linux;
 
@@ -167,7 +167,6 @@ static rofl_result_t read_netlink_message(int fd){
  */
 int process_timeouts()
 {
-	datapacket_t* pkt;
 	unsigned int i, max_switches;
 	struct timeval now;
 	of_switch_t** logical_switches;
@@ -207,6 +206,7 @@ int process_timeouts()
 	if(get_time_difference_ms(&now, &last_time_pool_checked)>=LSW_TIMER_BUFFER_POOL_MS){
 		uint32_t buffer_id;
 		datapacket_storage* dps=NULL;
+		pktin_spill_t* spill;
 		
 		for(i=0; i<max_switches; i++){
 
@@ -219,12 +219,12 @@ int process_timeouts()
 
 					ROFL_DEBUG_VERBOSE(DRIVER_NAME" [bg] Trying to erase a datapacket from storage: %u\n", buffer_id);
 
-					if( (pkt = dps->get_packet(buffer_id) ) == NULL ){
+					if( (spill = dps->get_spill(buffer_id) ) == NULL ){
 						ROFL_DEBUG_VERBOSE(DRIVER_NAME" [bg] Error in get_packet_wrapper %u\n", buffer_id);
 					}else{
 						ROFL_DEBUG_VERBOSE(DRIVER_NAME" [bg] Datapacket expired correctly %u\n", buffer_id);
-						//Return buffer to bufferpool
-						bufferpool::release_buffer(pkt);
+						//Return the spill to the arena
+						( (switch_platform_state_t*) logical_switches[i]->platform_state)->arena->release(spill);
 					}
 				}
 			}
@@ -274,17 +274,6 @@ void* x86_background_tasks_routine(void* param)
 		return NULL;
 	}
 
-	//Add PKT_IN
-	init_packetin_pipe();
-
-	epe_port.data.fd = get_packet_in_read_fd();
-	epe_port.events = EPOLLIN; //| EPOLLET
-	
-	if(epoll_ctl(efd,EPOLL_CTL_ADD, epe_port.data.fd, &epe_port)==-1){
-		ROFL_ERR(DRIVER_NAME" [bg] Error in epoll_ctl, errno(%d): %s\n", errno, strerror(errno));
-		return NULL;
-	}
-
 	while(bg_continue_execution){
 		
 		//Throttle
@@ -305,33 +294,18 @@ void* x86_background_tasks_routine(void* param)
 				close(event_list[i].data.fd); //fd gets removed automatically from efd's
 				continue;
 			}else{
-				//Is netlink or packet-in subsystem
-				if(get_packet_in_read_fd() == event_list[i].data.fd){
-					//PKT_IN
-					process_packet_ins();	
-				}else{
-					//Netlink message
-					read_netlink_message(event_list[i].data.fd);
-				}
+				//Netlink message
+				read_netlink_message(event_list[i].data.fd);
 			}
 		}
 	
-		//If it is a timeout event drain packet_ins. 
-		//This draining is necessary since PKT_IN pipe
-		//is non-blocking (in order to not block processing threads)
-		//so if a PKT_IN was enqueued but write() to the pipe failed
-		//Those packets would never be drained otherwise 
-		if(nfds == 0)
-			process_packet_ins();	
-			
-	
 		//check timers expiration 
 		process_timeouts();
+
+		//Publish counters
+		telemetry_publish();
 	}
 
-	//Cleanup packet-in
-	destroy_packetin_pipe();
-	
 	//Cleanup epoll fd
 	close(efd);
 	
@@ -350,6 +324,9 @@ rofl_result_t launch_background_tasks_manager()
 	//Set flag
 	bg_continue_execution = true;
 
+	//Telemetry is optional; just complain if the segment cannot be created
+	telemetry_init();
+
 	if(pthread_create(&bg_thread, NULL, x86_background_tasks_routine,NULL)<0){
 		ROFL_ERR(DRIVER_NAME" [bg] pthread_create failed, errno(%d): %s\n", errno, strerror(errno));
 		return ROFL_FAILURE;
@@ -361,5 +338,6 @@ rofl_result_t stop_background_tasks_manager()
 {
 	bg_continue_execution = false;
 	pthread_join(bg_thread,NULL);
+	telemetry_destroy();
 	return ROFL_SUCCESS;
 }
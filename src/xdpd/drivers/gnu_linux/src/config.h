@@ -83,6 +83,13 @@
 #define IO_PKT_IN_STORAGE_MAX_BUF 512
 //Buffer storage(PKT_IN) expiration time (seconds)
 #define IO_PKT_IN_STORAGE_EXPIRATION_S 10
+//Buffered PKT_INs are copied to a per LSI arena (bytes), releasing
+//the I/O buffer right away
+#define IO_PKT_IN_ARENA_BYTES (IO_PKT_IN_STORAGE_MAX_BUF*IO_IFACE_MMAP_FRAME_SIZE)
+
+//Max. number of threads setting up the ports (rings) in parallel
+//when a set of ports is brought up at once
+#define IO_PORT_BRINGUP_WORKERS 8
 
 //Kernel scheduling policy for I/O threads. Possible values SCHED_FIFO, SCHED_RR or SCHED_OTHER
 //Warning: change it only if you know what you are doing 
@@ -111,6 +118,49 @@
 //WARNING: do not over-size it or congestion can be created
 #define PROCESSING_PKT_IN_QUEUE_SLOTS 64
 
+//Max. number of PKT_INs handed to the CMM by the (per LSI) PKT_IN
+//dispatcher before checking again whether there is more work
+#define IO_PKT_IN_DISPATCHER_BURST 32
+
+//Max. time the PKT_IN dispatcher sleeps without being notified (ms)
+#define IO_PKT_IN_DISPATCHER_TIMEOUT_MS 100
+
+//Serve the pipeline memory hooks (platform_malloc) with the size-class slab
+//allocator (pipeline-imp/slab.h), with per-thread caches and per NUMA node
+//arenas. Set to 0 to use malloc() instead (e.g. to run under valgrind)
+#ifndef PIPELINE_SLAB_ALLOCATOR
+#define PIPELINE_SLAB_ALLOCATOR 1
+#endif
+
+//Index the flow entries by cookie, to answer aggregate stats requests
+//filtered by cookie without going through all the entries of the table.
+//Set to 0 to save memory on LSIs with many entries
+#define PROCESSING_FLOW_STATS_COOKIE_INDEX 1
+
+//Per RX thread exact-match (microflow) cache in front of the OpenFlow
+//pipeline (processing/microflow_cache.h). Whether it is enabled on new LSIs
+//(see hal_driver_set_microflow_cache()), entries per RX thread (power of 2)
+//and max. number of flow entries of a cached path
+#define PROCESSING_MICROFLOW_CACHE 1
+#define PROCESSING_MICROFLOW_CACHE_ENTRIES 8192
+#define PROCESSING_MICROFLOW_CACHE_MAX_STEPS 8
+
+/*
+* Telemetry
+*/
+
+//Shared-memory segment where the port, queue, LSI, table and bufferpool
+//counters are published (see telemetry_shm.h)
+#define TELEMETRY_SHM_NAME "/xdpd-gnu-linux-telemetry"
+
+//Publishing period (ms); counters are sampled by the background thread
+#define TELEMETRY_PERIOD_MS 200
+
+//Capacity of the segment. Queues are TELEMETRY_MAX_PORTS*IO_IFACE_NUM_QUEUES
+#define TELEMETRY_MAX_PORTS 512
+#define TELEMETRY_MAX_LSIS 64
+#define TELEMETRY_MAX_TABLES 1024
+
 /* 
 * Other
 */
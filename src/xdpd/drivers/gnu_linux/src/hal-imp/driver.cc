@@ -16,6 +16,7 @@
 
 
 #include <stdio.h>
+#include <inttypes.h>
 #include <rofl/datapath/hal/driver.h>
 #include <rofl/common/utils/c_logger.h>
 #include <rofl/datapath/hal/cmm.h>
@@ -27,9 +28,13 @@
 #include "../io/iomanager.h"
 #include "../bg_taskmanager.h"
 
+#include "driver_ext.h"
 #include "../io/iface_utils.h"
 #include "../io/pktin_dispatcher.h"
+#include "../io/pktin_meter.h"
 #include "../processing/ls_internal_state.h"
+#include "../processing/microflow_cache.h"
+#include "../pipeline-imp/slab.h"
 
 //only for Test
 #include <stdlib.h>
@@ -45,8 +50,16 @@ using namespace xdpd::gnu_linux;
 #define GNU_LINUX_DESC \
 "GNU/Linux user-space driver.\n\nThe GNU/Linux driver is a user-space driver and serves as a reference implementation. It contains all the necessary bits and pieces to process packets in software, including a complete I/O subsystem written in C/C++. Access to network interfaces (NICs) is done via PACKET_MMAP.\n\nAlthough this driver does not provide cutting-edge performance, still provides a reasonable level of throughput\n\nFeatures:\n - Supports the following OpenFlow versions: v1.0, v1.2, v1.3.X\n - Supports multiple Logical Switch Instances (LSIs)\n - Supports virtual links between LSIs\n - Supports vast majority of network protocols defined by OpenFlow + extensions (GTP, PPP/PPPoE).\n\nMore details here:\n\nhttp://www.xdpd.org"
 
-#define GNU_LINUX_USAGE  "" //We don't support extra params
-#define GNU_LINUX_EXTRA_PARAMS "" //We don't support extra params
+#define GNU_LINUX_USAGE  \
+"Extra params (key1=value1;key2=value2):\n\n"\
+" pktin-rate=<pps>          Max. PKT_IN rate per LSI (0: unlimited)\n"\
+" pktin-table-rate=<pps>    Max. PKT_IN rate per table of an LSI (0: unlimited)\n"\
+" pktin-nomatch-rate=<pps>  Max. PKT_IN rate (reason NO_MATCH) per LSI (0: unlimited)\n"\
+" pktin-action-rate=<pps>   Max. PKT_IN rate (reason ACTION) per LSI (0: unlimited)\n"\
+" pktin-burst=<pkts>        Burst of the PKT_IN meters (0: one second worth of PKT_INs)\n"
+
+//Extra params in use
+static char gnu_linux_extra_params[DRIVER_EXTRA_PARAMS_MAX_LEN] = "";
 
 /*
 * @name    hal_driver_init
@@ -56,6 +69,12 @@ using namespace xdpd::gnu_linux;
 hal_result_t hal_driver_init(const char* extra_params){
 
 	ROFL_INFO(DRIVER_NAME" Initializing driver...\n");
+
+	//PKT_IN meters
+	if(pktin_meter::parse_params(extra_params, &pktin_meter::defaults) != ROFL_SUCCESS)
+		return HAL_FAILURE;
+	if(extra_params)
+		strncpy(gnu_linux_extra_params, extra_params, DRIVER_EXTRA_PARAMS_MAX_LEN-1);
 	
 	//Init the ROFL-PIPELINE phyisical switch
 	if(physical_switch_init() != ROFL_SUCCESS)
@@ -90,7 +109,7 @@ void hal_driver_get_info(driver_info_t* info){
 	strncpy(info->version, GNU_LINUX_VERSION, DRIVER_VERSION_MAX_LEN);
 	strncpy(info->description, GNU_LINUX_DESC, DRIVER_DESCRIPTION_MAX_LEN);
 	strncpy(info->usage, GNU_LINUX_USAGE, DRIVER_USAGE_MAX_LEN);
-	strncpy(info->extra_params, GNU_LINUX_EXTRA_PARAMS, DRIVER_EXTRA_PARAMS_MAX_LEN);
+	strncpy(info->extra_params, gnu_linux_extra_params, DRIVER_EXTRA_PARAMS_MAX_LEN);
 }
 
 
@@ -181,6 +200,12 @@ hal_result_t hal_driver_create_switch(char* name, uint64_t dpid, of_version_t of
 	if(unlikely(!sw))
 		return HAL_FAILURE;
 
+	//Launch the PKT_IN dispatcher
+	if(start_pktin_dispatcher(sw) != ROFL_SUCCESS){
+		of1x_destroy_switch((of1x_switch_t*)sw);
+		return HAL_FAILURE;
+	}
+
 	//Create RX ports
 	processingmanager::create_rx_pgs(sw);
 
@@ -220,7 +245,8 @@ hal_result_t hal_driver_destroy_switch_by_dpid(const uint64_t dpid){
 	//Create RX ports
 	processingmanager::destroy_rx_pgs(sw);	 
 
-	//Drain existing packet ins
+	//Stop the PKT_IN dispatcher and drain existing packet ins
+	stop_pktin_dispatcher(sw);
 	drain_packet_ins(sw);
 
 	//Detach ports from switch. Do not feed more packets to the switch
@@ -287,6 +313,242 @@ switch_port_snapshot_t* hal_driver_get_port_snapshot_by_num(uint64_t dpid, unsig
 	return physical_switch_get_port_snapshot(lsw->logical_ports[port_num].port->name); 
 }
 
+/**
+ * @name hal_driver_get_port_stats
+ * @brief Copies the counters of the port attached at port_num of the LSI with dpid, without taking snapshots.
+ * @ingroup port_management
+ */
+hal_result_t hal_driver_get_port_stats(uint64_t dpid, unsigned int port_num, port_stats_t* stats){
+
+	of_switch_t* lsw;
+	switch_port_t* port;
+
+	lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+	if(!lsw || !stats)
+		return HAL_FAILURE;
+
+	if(!port_num || port_num >= LOGICAL_SWITCH_MAX_LOG_PORTS)
+		return HAL_FAILURE;
+
+	port = lsw->logical_ports[port_num].port;
+	if(!port || lsw->logical_ports[port_num].attachment_state != LOGICAL_PORT_STATE_ATTACHED)
+		return HAL_FAILURE;
+
+	//Counters are updated by the I/O threads; each one is read atomically,
+	//but not the set as a whole (as in the snapshots)
+	stats->rx_packets = port->stats.rx_packets;
+	stats->tx_packets = port->stats.tx_packets;
+	stats->rx_bytes = port->stats.rx_bytes;
+	stats->tx_bytes = port->stats.tx_bytes;
+	stats->rx_dropped = port->stats.rx_dropped;
+	stats->tx_dropped = port->stats.tx_dropped;
+	stats->rx_errors = port->stats.rx_errors;
+	stats->tx_errors = port->stats.tx_errors;
+	stats->rx_frame_err = port->stats.rx_frame_err;
+	stats->rx_over_err = port->stats.rx_over_err;
+	stats->rx_crc_err = port->stats.rx_crc_err;
+	stats->collisions = port->stats.collisions;
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_bufferpool_stats
+ * @brief Retrieves the number of packet buffers of the driver and the number of buffers in use.
+ * @ingroup port_management
+ */
+hal_result_t hal_driver_get_bufferpool_stats(uint64_t* capacity, uint64_t* in_use){
+
+	if(!capacity || !in_use)
+		return HAL_FAILURE;
+
+	*capacity = bufferpool::get_capacity();
+	*in_use = bufferpool::get_num_of_buffers_in_use();
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_allocator_stats
+ * @brief Retrieves the counters of the size class class_id of the pipeline memory allocator.
+ * @ingroup port_management
+ */
+hal_result_t hal_driver_get_allocator_stats(unsigned int class_id, uint64_t* obj_size, uint64_t* capacity, uint64_t* in_use, uint64_t* cached, uint64_t* remote_frees){
+
+	slab_stats_t stats;
+	slab_class_stats_t* cs;
+
+	if(class_id >= SLAB_NUM_OF_CLASSES || !obj_size || !capacity || !in_use || !cached || !remote_frees)
+		return HAL_FAILURE;
+
+	slab_get_stats(&stats);
+	cs = &stats.classes[class_id];
+
+	*obj_size = cs->obj_size;
+	*capacity = cs->capacity;
+	*in_use = cs->in_use;
+	*cached = cs->cached;
+	*remote_frees = cs->remote_frees;
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_allocator_large_stats
+ * @brief Retrieves the number of large allocations of the pipeline memory allocator and their size in bytes.
+ * @ingroup port_management
+ */
+hal_result_t hal_driver_get_allocator_large_stats(uint64_t* in_use, uint64_t* bytes){
+
+	slab_stats_t stats;
+
+	if(!in_use || !bytes)
+		return HAL_FAILURE;
+
+	slab_get_stats(&stats);
+
+	*in_use = stats.large_in_use;
+	*bytes = stats.large_bytes;
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_set_microflow_cache
+ * @brief Enables or disables the microflow (exact-match) cache of the RX threads for the LSI with dpid.
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_set_microflow_cache(uint64_t dpid, bool enabled){
+
+	of_switch_t* lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+
+	if(!lsw || !lsw->platform_state)
+		return HAL_FAILURE;
+
+	((switch_platform_state_t*)lsw->platform_state)->mfc_enabled = enabled;
+
+	ROFL_INFO(DRIVER_NAME" Microflow cache of switch %s %s\n", lsw->name, (enabled)? "enabled" : "disabled");
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_microflow_cache_stats
+ * @brief Retrieves whether the microflow cache is enabled for the LSI with dpid, and its hit and miss counters (all RX threads).
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_get_microflow_cache_stats(uint64_t dpid, bool* enabled, uint64_t* hits, uint64_t* misses){
+
+	of_switch_t* lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+	switch_platform_state_t* ls_int;
+
+	if(!lsw || !lsw->platform_state || !enabled || !hits || !misses)
+		return HAL_FAILURE;
+
+	ls_int = (switch_platform_state_t*)lsw->platform_state;
+
+	*enabled = ls_int->mfc_enabled;
+	microflow_cache::get_stats(ls_int, hits, misses);
+
+	return HAL_SUCCESS;
+}
+
+static pktin_meter* get_pktin_meter(uint64_t dpid){
+
+	of_switch_t* lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+
+	if(!lsw || !lsw->platform_state)
+		return NULL;
+
+	return ((switch_platform_state_t*)lsw->platform_state)->meter;
+}
+
+/**
+ * @name hal_driver_set_pktin_meter
+ * @brief Replaces the PKT_IN limits of the LSI with dpid.
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_set_pktin_meter(uint64_t dpid, uint32_t rate, uint32_t table_rate, uint32_t nomatch_rate, uint32_t action_rate, uint32_t burst){
+
+	pktin_meter* meter = get_pktin_meter(dpid);
+	pktin_meter_config_t conf;
+
+	if(!meter)
+		return HAL_FAILURE;
+
+	conf.rate = rate;
+	conf.table_rate = table_rate;
+	conf.reason_rate[PKTIN_METER_REASON_NO_MATCH] = nomatch_rate;
+	conf.reason_rate[PKTIN_METER_REASON_ACTION] = action_rate;
+	conf.burst = burst;
+
+	meter->configure(&conf);
+
+	ROFL_INFO(DRIVER_NAME" PKT_IN meter of switch 0x%" PRIx64 " set to rate %u, table rate %u, no match rate %u, action rate %u, burst %u\n", dpid, rate, table_rate, nomatch_rate, action_rate, burst);
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_pktin_meter_stats
+ * @brief Retrieves the PKT_INs of the LSI with dpid accepted and dropped by its meters.
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_get_pktin_meter_stats(uint64_t dpid, uint64_t* accepted, uint64_t* dropped, uint64_t* lsi_dropped){
+
+	pktin_meter* meter = get_pktin_meter(dpid);
+	pktin_meter_stats_t stats;
+
+	if(!meter || !accepted || !dropped || !lsi_dropped)
+		return HAL_FAILURE;
+
+	meter->get_stats(&stats);
+	*accepted = stats.accepted;
+	*dropped = stats.dropped;
+
+	meter->get_lsi_stats(&stats);
+	*lsi_dropped = stats.dropped;
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_pktin_meter_reason_stats
+ * @brief Retrieves the counters of the PKT_IN meter of a reason of the LSI with dpid.
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_get_pktin_meter_reason_stats(uint64_t dpid, unsigned int reason, uint64_t* accepted, uint64_t* dropped){
+
+	pktin_meter* meter = get_pktin_meter(dpid);
+	pktin_meter_stats_t stats;
+
+	if(!meter || !accepted || !dropped || meter->get_reason_stats(reason, &stats) != ROFL_SUCCESS)
+		return HAL_FAILURE;
+
+	*accepted = stats.accepted;
+	*dropped = stats.dropped;
+
+	return HAL_SUCCESS;
+}
+
+/**
+ * @name hal_driver_get_pktin_meter_table_stats
+ * @brief Retrieves the counters of the PKT_IN meter of a table of the LSI with dpid.
+ * @ingroup logical_switch_management
+ */
+hal_result_t hal_driver_get_pktin_meter_table_stats(uint64_t dpid, unsigned int table_id, uint64_t* accepted, uint64_t* dropped){
+
+	pktin_meter* meter = get_pktin_meter(dpid);
+	pktin_meter_stats_t stats;
+
+	if(!meter || !accepted || !dropped || table_id > 0xFF || meter->get_table_stats(table_id, &stats) != ROFL_SUCCESS)
+		return HAL_FAILURE;
+
+	*accepted = stats.accepted;
+	*dropped = stats.dropped;
+
+	return HAL_SUCCESS;
+}
 
 /*
 * @name    hal_driver_attach_physical_port_to_switch
@@ -585,6 +847,61 @@ hal_result_t hal_driver_bring_port_up(const char* name){
 	return HAL_SUCCESS;
 }
 
+/*
+* @name    hal_driver_bring_ports_up
+* @brief   Brings up a set of system ports (see hal_driver_bring_port_up)
+* @ingroup port_management
+*/
+hal_result_t hal_driver_bring_ports_up(const char** names, unsigned int num, hal_result_t* results){
+
+	unsigned int i;
+	switch_port_t* port;
+	switch_port_snapshot_t* port_snapshot;
+	std::vector<ioport*> ports;
+	std::vector<unsigned int> index;
+	hal_result_t result = HAL_SUCCESS;
+
+	//Resolve the ports
+	for(i=0;i<num;++i){
+		port = physical_switch_get_port_by_name(names[i]);
+
+		if(!port || !port->platform_port_state){
+			results[i] = HAL_FAILURE;
+			result = HAL_FAILURE;
+			continue;
+		}
+
+		ports.push_back((ioport*)port->platform_port_state);
+		index.push_back(i);
+	}
+
+	if(ports.empty())
+		return result;
+
+	//Ports that are not attached are not in any portgroup; I/O manager only brings them up
+	std::vector<rofl_result_t> io_results(ports.size());
+	iomanager::bring_ports_up(ports, &io_results[0]);
+
+	for(i=0;i<ports.size();++i){
+		port = ports[i]->of_port_state;
+
+		if(io_results[i] != ROFL_SUCCESS){
+			results[index[i]] = HAL_FAILURE;
+			result = HAL_FAILURE;
+			continue;
+		}
+		results[index[i]] = HAL_SUCCESS;
+
+		//Notify only if its virtual; otherwise bg will do it for us
+		if(port->type == PORT_TYPE_VIRTUAL){
+			port_snapshot = physical_switch_get_port_snapshot(port->name); 
+			hal_cmm_notify_port_status_changed(port_snapshot);
+		}
+	}
+
+	return result;
+}
+
 /*
 * @name    hal_driver_bring_port_down
 * @brief   Shutdowns (brings down) a system port. If the port is attached to an OF logical switch, this also de-schedules port and triggers PORTMOD message. 
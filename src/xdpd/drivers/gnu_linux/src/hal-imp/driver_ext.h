@@ -0,0 +1,106 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef GNU_LINUX_DRIVER_EXT_H
+#define GNU_LINUX_DRIVER_EXT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rofl/datapath/hal/driver.h>
+
+/**
+* @file driver_ext.h
+*
+* @brief Version agnostic calls exposed by the GNU/Linux driver in addition
+* to the HAL API.
+*/
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @name hal_driver_get_port_stats
+* @brief Copies the counters of the port attached at port_num of the LSI with dpid, without taking snapshots.
+* @ingroup port_management
+*/
+hal_result_t hal_driver_get_port_stats(uint64_t dpid, unsigned int port_num, port_stats_t* stats);
+
+/**
+* @name hal_driver_get_bufferpool_stats
+* @brief Retrieves the number of packet buffers of the driver and the number of buffers in use.
+* @ingroup port_management
+*/
+hal_result_t hal_driver_get_bufferpool_stats(uint64_t* capacity, uint64_t* in_use);
+
+/**
+* @name hal_driver_get_allocator_stats
+* @brief Retrieves the counters of the size class class_id of the pipeline memory allocator (slab.h). Fails if class_id is not a valid class, so that classes can be iterated from 0.
+* @ingroup port_management
+*/
+hal_result_t hal_driver_get_allocator_stats(unsigned int class_id, uint64_t* obj_size, uint64_t* capacity, uint64_t* in_use, uint64_t* cached, uint64_t* remote_frees);
+
+/**
+* @name hal_driver_get_allocator_large_stats
+* @brief Retrieves the number of allocations of the pipeline memory allocator bigger than its biggest size class, and their size in bytes.
+* @ingroup port_management
+*/
+hal_result_t hal_driver_get_allocator_large_stats(uint64_t* in_use, uint64_t* bytes);
+
+/**
+* @name hal_driver_bring_ports_up
+* @brief Brings up a set of system ports; equivalent to calling hal_driver_bring_port_up() for each of them, but the ports are set up in parallel and the I/O threads are resynchronized once.
+* @ingroup port_management
+*
+* @param names Port system names
+* @param num Number of ports
+* @param results Result for each of the ports (num entries)
+*/
+hal_result_t hal_driver_bring_ports_up(const char** names, unsigned int num, hal_result_t* results);
+
+/**
+* @name hal_driver_set_microflow_cache
+* @brief Enables or disables the microflow (exact-match) cache of the RX threads for the LSI with dpid. New LSIs take the default of PROCESSING_MICROFLOW_CACHE (config.h).
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_set_microflow_cache(uint64_t dpid, bool enabled);
+
+/**
+* @name hal_driver_get_microflow_cache_stats
+* @brief Retrieves whether the microflow cache is enabled for the LSI with dpid, and its hit and miss counters (all RX threads). Packets processed with the cache disabled are not counted.
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_get_microflow_cache_stats(uint64_t dpid, bool* enabled, uint64_t* hits, uint64_t* misses);
+
+/**
+* @name hal_driver_set_pktin_meter
+* @brief Replaces the PKT_IN limits of the LSI with dpid (packets per second, 0: unlimited; burst in packets, 0: one second worth of PKT_INs). New LSIs take the limits of the driver extra params.
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_set_pktin_meter(uint64_t dpid, uint32_t rate, uint32_t table_rate, uint32_t nomatch_rate, uint32_t action_rate, uint32_t burst);
+
+/**
+* @name hal_driver_get_pktin_meter_stats
+* @brief Retrieves the PKT_INs of the LSI with dpid accepted and dropped by its meters, and how many of the drops were due to the LSI (aggregated) limit.
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_get_pktin_meter_stats(uint64_t dpid, uint64_t* accepted, uint64_t* dropped, uint64_t* lsi_dropped);
+
+/**
+* @name hal_driver_get_pktin_meter_reason_stats
+* @brief Retrieves the counters of the PKT_IN meter of the reason (0: no match, 1: action) of the LSI with dpid. Fails if reason is not valid, so that reasons can be iterated from 0.
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_get_pktin_meter_reason_stats(uint64_t dpid, unsigned int reason, uint64_t* accepted, uint64_t* dropped);
+
+/**
+* @name hal_driver_get_pktin_meter_table_stats
+* @brief Retrieves the counters of the PKT_IN meter of table table_id of the LSI with dpid.
+* @ingroup logical_switch_management
+*/
+hal_result_t hal_driver_get_pktin_meter_table_stats(uint64_t dpid, unsigned int table_id, uint64_t* accepted, uint64_t* dropped);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //GNU_LINUX_DRIVER_EXT_H
@@ -1,15 +1,19 @@
+#include <string.h>
 #include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
 #include <rofl/common/utils/c_logger.h>
 #include <rofl/datapath/pipeline/physical_switch.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_statistics.h>
 #include <rofl/datapath/pipeline/platform/timing.h>
+#include <rofl/datapath/pipeline/platform/memory.h>
 #include "../../../io/bufferpool.h"
 #include "../../../io/datapacket_storage.h"
 #include "../../../io/datapacketx86.h"
+#include "../../../io/pktin_dispatcher.h"
 #include "../../../io/ports/ioport.h"
 #include "../../../processing/ls_internal_state.h"
 #include "../../../util/time_measurements.h"
+#include "of1x_driver_batch.h"
 
 //Make sure pipeline-imp are BEFORE _pp.h
 //so that functions can be inlined
@@ -237,42 +241,20 @@ hal_result_t hal_driver_of1x_set_table_config(uint64_t dpid, unsigned int table_
 	return HAL_SUCCESS;
 }
 
-/**
- * @name    hal_driver_of1x_process_packet_out
- * @brief   Instructs driver to process a PACKET_OUT event
- * @ingroup of1x_driver_async_event_processing
- *
- * @param dpid 		Datapath ID of the switch to process PACKET_OUT
- * @param buffer_id	Buffer ID
- * @param in_port 	Port IN
- * @param action_group 	Action group to apply
- * @param buffer		Pointer to the buffer
- * @param buffer_size	Buffer size
- */
-hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, uint8_t* buffer, uint32_t buffer_size)
-{
-	of_switch_t* lsw;
-	datapacket_t* pkt;
-	datapacketx86* pktx86;
+/*
+* Process a PACKET_OUT for an already resolved LSI. The packet is classified
+* exactly once; either while rehydrating the stored PKT_IN or while copying
+* the controller payload into the bufferpool buffer.
+*/
+static inline hal_result_t of1x_process_packet_out(of_switch_t* lsw, uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, uint8_t* buffer, uint32_t buffer_size){
 
-	//Recover port	
-	lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+	datapacket_t* pkt;
 
-	//Check switch and port
-	if(!lsw || ((lsw->of_ver != OF_VERSION_10) && (lsw->of_ver != OF_VERSION_12) && (lsw->of_ver != OF_VERSION_13))) {
-		//TODO: log this... should never happen
-		assert(0);
-		return HAL_FAILURE;
-	}	
-	
 	//Avoid DoS. Check whether the action list contains an action ouput, otherwise drop, since the packet will never be freed
 	if(!action_group_of1x_packet_in_contains_output(action_group)){
 
 		if (OF1XP_NO_BUFFER != buffer_id) {
-			pkt = ((switch_platform_state_t*)lsw->platform_state)->storage->get_packet(buffer_id);
-			if (NULL != pkt) {
-				bufferpool::release_buffer(pkt);
-			}
+			discard_packet_in(lsw, buffer_id);
 		}
 
 		//FIXME: free action_group??
@@ -282,16 +264,14 @@ hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_i
 	//Recover pkt buffer if is stored. Otherwise pick a free buffer
 	if( buffer_id && buffer_id != OF1XP_NO_BUFFER){
 	
-		//Retrieve the packet
-		pkt = ((switch_platform_state_t*)lsw->platform_state)->storage->get_packet(buffer_id);
+		//Retrieve the packet. The frame is the one sent in the PKT_IN
+		//(unmodified), so the classification done here is final
+		pkt = retrieve_packet_in(lsw, buffer_id, true);
 
-		//Buffer has expired
+		//Buffer has expired (or no free buffers)
 		if(!pkt){
 			return HAL_FAILURE; /* TODO: add specific error */
 		}
-		
-		//Mark as pkt out (ignore counters, slow path)	
-		TM_STAMP_PKT_OUT(pkt);
 	}else{
 		//Retrieve a free buffer	
 		pkt = bufferpool::get_free_buffer_nonblocking();
@@ -301,18 +281,19 @@ hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_i
 			return HAL_FAILURE; /* TODO: add specific error */
 		}	
 
-		//Mark as pkt out (ignore counters, slow path)	
-		TM_STAMP_PKT_OUT(pkt);
-
-		//Initialize the packet and copy
-		((datapacketx86*)pkt->platform_state)->init(buffer, buffer_size, lsw, in_port, 0, true);
+		//Initialize the packet, copy and classify. The payload cannot be
+		//adopted; it belongs to the CMM and the packet may be sent (TX
+		//queues) after this call returns
+		if(((datapacketx86*)pkt->platform_state)->init(buffer, buffer_size, lsw, in_port, 0, true) != ROFL_SUCCESS){
+			bufferpool::release_buffer(pkt);
+			return HAL_FAILURE;
+		}
 		pkt->sw = lsw;
 	}
-	
-	//Reclassify the packet
-	pktx86 = (datapacketx86*)pkt->platform_state;
-	classify_packet(pktx86->headers, pktx86->get_buffer(), pktx86->get_buffer_length(), pktx86->in_port, 0);
 
+	//Mark as pkt out (ignore counters, slow path)	
+	TM_STAMP_PKT_OUT(pkt);
+	
 	ROFL_DEBUG_VERBOSE(DRIVER_NAME" Getting packet out [%p]\n",pkt);	
 	
 	//Instruct pipeline to process actions. This may reinject the packet	
@@ -321,6 +302,75 @@ hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_i
 	return HAL_SUCCESS;
 }
 
+/**
+ * @name    hal_driver_of1x_process_packet_out
+ * @brief   Instructs driver to process a PACKET_OUT event
+ * @ingroup of1x_driver_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch to process PACKET_OUT
+ * @param buffer_id	Buffer ID
+ * @param in_port 	Port IN
+ * @param action_group 	Action group to apply
+ * @param buffer		Pointer to the buffer
+ * @param buffer_size	Buffer size
+ */
+hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, uint8_t* buffer, uint32_t buffer_size)
+{
+	of_switch_t* lsw;
+
+	//Recover port	
+	lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+
+	//Check switch and port
+	if(!lsw || ((lsw->of_ver != OF_VERSION_10) && (lsw->of_ver != OF_VERSION_12) && (lsw->of_ver != OF_VERSION_13))) {
+		//TODO: log this... should never happen
+		assert(0);
+		return HAL_FAILURE;
+	}	
+	
+	return of1x_process_packet_out(lsw, buffer_id, in_port, action_group, buffer, buffer_size);
+}
+
+/**
+ * @name    hal_driver_of1x_process_packet_out_batch
+ * @brief   Instructs driver to process a batch of PACKET_OUT events of the same LSI
+ * @ingroup of1x_driver_async_event_processing
+ *
+ * The LSI is resolved once for the whole batch, and the PACKET_OUTs are
+ * processed in order. The result of every PACKET_OUT is stored in
+ * pkt_outs[i].result.
+ *
+ * @param dpid 		Datapath ID of the switch to process the PACKET_OUTs
+ * @param pkt_outs	Array of PACKET_OUTs
+ * @param num		Number of PACKET_OUTs in pkt_outs
+ * @retval HAL_SUCCESS if all the PACKET_OUTs have been processed successfully
+ */
+hal_result_t hal_driver_of1x_process_packet_out_batch(uint64_t dpid, of1x_packet_out_t* pkt_outs, unsigned int num)
+{
+	of_switch_t* lsw;
+	unsigned int i;
+	hal_result_t res = HAL_SUCCESS;
+
+	//Recover switch
+	lsw = physical_switch_get_logical_switch_by_dpid(dpid);
+
+	//Check switch
+	if(!lsw || ((lsw->of_ver != OF_VERSION_10) && (lsw->of_ver != OF_VERSION_12) && (lsw->of_ver != OF_VERSION_13))) {
+		assert(0);
+		for(i=0;i<num;i++)
+			pkt_outs[i].result = HAL_FAILURE;
+		return HAL_FAILURE;
+	}
+
+	for(i=0;i<num;i++){
+		pkt_outs[i].result = of1x_process_packet_out(lsw, pkt_outs[i].buffer_id, pkt_outs[i].in_port, pkt_outs[i].action_group, pkt_outs[i].buffer, pkt_outs[i].buffer_size);
+		if(pkt_outs[i].result != HAL_SUCCESS)
+			res = HAL_FAILURE;
+	}
+
+	return res;
+}
+
 /**
  * @name    driver_of1x_process_flow_mod
  * @brief   Instructs driver to process a FLOW_MOD event
@@ -362,7 +412,7 @@ hal_result_t hal_driver_of1x_process_flow_mod_add(uint64_t dpid, uint8_t table_i
 
 	if(buffer_id && buffer_id != OF1XP_NO_BUFFER){
 	
-		datapacket_t* pkt = ((switch_platform_state_t*)lsw->platform_state)->storage->get_packet(buffer_id);
+		datapacket_t* pkt = retrieve_packet_in((of_switch_t*)lsw, buffer_id, true);
 		
 		if(!pkt){
 			//assert(0);
@@ -380,6 +430,69 @@ hal_result_t hal_driver_of1x_process_flow_mod_add(uint64_t dpid, uint8_t table_i
 	return HAL_SUCCESS;
 }
 
+/**
+ * @name    hal_driver_of1x_process_flow_mod_add_batch
+ * @brief   Instructs driver to process a batch of FLOW_MOD ADDs of the same table
+ * @ingroup of1x_driver_async_event_processing
+ *
+ * The LSI and the table are resolved once for the whole batch, and entries
+ * are installed in order. Batched entries have no buffer_id. On failure
+ * the caller keeps the ownership of entries[i].
+ *
+ * This is NOT applied under a single table lock: rofl-pipeline only
+ * exposes of1x_add_flow_entry_table(), which takes the table write lock
+ * and runs the add entry hook (microflow cache invalidation, stats index)
+ * for every entry. The hooks must stay per entry anyway, since the
+ * microflow cache relies on being invalidated with the table locked. The
+ * saving is in the caller (one HAL call and one LSI lookup per batch).
+ *
+ * There is no MODIFY/DELETE counterpart: the endpoints install queued ADDs
+ * before any other FLOW_MOD, whose result depends on them.
+ *
+ * @param dpid 		Datapath ID of the switch to install the FLOW_MODs
+ * @param table_id	Table id to install the flowmods
+ * @param entries	Flow entries to be installed
+ * @param num		Number of entries
+ * @param check_overlap	Check if the entries overlap with existing ones
+ * @param reset_counts	Reset counts of existing (matching) entries
+ * @param results	Result of every entry (num elements)
+ * @retval HAL_SUCCESS if all the entries have been installed
+ */
+hal_result_t hal_driver_of1x_process_flow_mod_add_batch(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** entries, unsigned int num, bool check_overlap, bool reset_counts, hal_result_t* results){
+
+	of1x_switch_t* lsw;
+	rofl_of1x_fm_result_t result;
+	hal_result_t res = HAL_SUCCESS;
+	unsigned int i;
+
+	//Recover port	
+	lsw = (of1x_switch_t*)physical_switch_get_logical_switch_by_dpid(dpid);
+
+	if(!lsw || table_id >= lsw->pipeline.num_of_tables){
+		for(i=0;i<num;i++)
+			results[i] = HAL_FAILURE;
+		return HAL_FAILURE;
+	}
+
+	for(i=0;i<num;i++){
+		result = of1x_add_flow_entry_table(&lsw->pipeline, table_id, &entries[i], check_overlap, reset_counts);
+
+		if(result == ROFL_OF1X_FM_SUCCESS){
+			results[i] = HAL_SUCCESS;
+			continue;
+		}
+
+		results[i] = (result == ROFL_OF1X_FM_OVERLAP)? HAL_FM_OVERLAP_FAILURE : HAL_FAILURE;
+		res = HAL_FAILURE;
+	}
+
+#ifdef DEBUG
+	of1x_full_dump_switch(lsw, false);
+#endif
+	
+	return res;
+}
+
 /**
  * @name    hal_driver_of1x_process_flow_mod_modify
  * @brief   Instructs driver to process a FLOW_MOD modify event
@@ -412,7 +525,7 @@ hal_result_t hal_driver_of1x_process_flow_mod_modify(uint64_t dpid, uint8_t tabl
 	
 	if(buffer_id && buffer_id != OF1XP_NO_BUFFER){
 	
-		datapacket_t* pkt = ((switch_platform_state_t*)lsw->platform_state)->storage->get_packet(buffer_id);
+		datapacket_t* pkt = retrieve_packet_in((of_switch_t*)lsw, buffer_id, true);
 		
 		if(!pkt){
 			assert(0);
@@ -515,6 +628,117 @@ of1x_stats_flow_msg_t* hal_driver_of1x_get_flow_stats(uint64_t dpid, uint8_t tab
 	return of1x_get_flow_stats(&lsw->pipeline, table_id, cookie, cookie_mask, out_port, out_group, matches);
 }
 
+/*
+* Flow stats cursors hold the table being walked in the upper bits and the
+* last entry returned (the resume point in the stats index) in the lower ones
+*/
+#define OF1X_FLOW_STATS_CURSOR_TABLE_SHIFT 56
+#define OF1X_FLOW_STATS_CURSOR_ENTRY_MASK ((1ULL<<OF1X_FLOW_STATS_CURSOR_TABLE_SHIFT)-1)
+
+/**
+ * @name    hal_driver_of1x_get_flow_stats_chunk
+ * @brief   Recovers the flow stats given a set of matches, at most max_flows per call
+ * @ingroup of1x_driver_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch to install the FLOW_MOD
+ * @param table_id 	Table id to get the flows of 
+ * @param cookie	Cookie to be applied 
+ * @param cookie_mask	Mask for the cookie
+ * @param out_port 	Out port that entry must include
+ * @param out_group 	Out group that entry must include	
+ * @param matchs	Matches
+ * @param max_flows	Maximum number of entries returned
+ * @param cursor	Resume point; 0 on the first call, 0 when done
+ */
+of1x_stats_flow_msg_t* hal_driver_of1x_get_flow_stats_chunk(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, unsigned int max_flows, uint64_t* cursor){
+
+	of1x_switch_t* lsw;
+	switch_platform_state_t* ls_int;
+	of1x_stats_flow_msg_t* msg;
+	of1x_stats_single_flow_msg_t* flow_stats;
+	of1x_flow_entry_t check_entry;
+	of1x_flow_entry_t* entry;
+	of1x_flow_table_t* table;
+	unsigned int i, first_table, last_table, num_of_flows = 0;
+
+	//Recover port	
+	lsw = (of1x_switch_t*)physical_switch_get_logical_switch_by_dpid(dpid);
+
+	if(!lsw){
+		assert(0);
+		return NULL;
+	}
+
+	if(table_id >= lsw->pipeline.num_of_tables && table_id != OF1X_FLOW_TABLE_ALL)
+		return NULL; 
+
+	if(!max_flows)
+		return NULL;
+
+	ls_int = (switch_platform_state_t*)lsw->platform_state;
+
+	first_table = (table_id == OF1X_FLOW_TABLE_ALL)? 0 : table_id;
+	last_table = (table_id == OF1X_FLOW_TABLE_ALL)? lsw->pipeline.num_of_tables-1 : table_id;
+
+	//Resume point
+	i = (*cursor)? (unsigned int)((*cursor) >> OF1X_FLOW_STATS_CURSOR_TABLE_SHIFT) : first_table;
+	entry = (of1x_flow_entry_t*)(uintptr_t)((*cursor) & OF1X_FLOW_STATS_CURSOR_ENTRY_MASK);
+
+	if(i < first_table || i > last_table)
+		return NULL;
+
+	msg = __of1x_init_stats_flow_msg();
+
+	if(!msg)
+		return NULL;
+
+	//Entries are filtered as in of1x_get_flow_stats()
+	memset(&check_entry, 0, sizeof(of1x_flow_entry_t));
+	if(matches)
+		check_entry.matches = *matches;
+	check_entry.cookie = cookie;
+	check_entry.cookie_mask = cookie_mask;
+
+	for(; i <= last_table; i++, entry = NULL){
+
+		table = &lsw->pipeline.tables[i];
+
+		//Entries cannot be removed while the table is read-locked
+		platform_rwlock_rdlock(table->rwlock);
+
+		while(num_of_flows < max_flows && (entry = ls_int->stats_index->next(i, entry)) != NULL){
+
+			if(!__of1x_flow_entry_check_contained(entry, &check_entry, false, true, out_port, out_group, false))
+				continue;
+
+			flow_stats = __of1x_init_stats_single_flow_msg(entry);
+
+			if(!flow_stats){
+				platform_rwlock_rdunlock(table->rwlock);
+				of1x_destroy_stats_flow_msg(msg);
+				return NULL;
+			}
+
+			__of1x_push_single_flow_stats_to_msg(msg, flow_stats);
+			num_of_flows++;
+		}
+
+		platform_rwlock_rdunlock(table->rwlock);
+
+		//Full; resume after the last entry returned
+		if(num_of_flows == max_flows && entry){
+			assert(((uintptr_t)entry & ~OF1X_FLOW_STATS_CURSOR_ENTRY_MASK) == 0);
+			*cursor = ((uint64_t)i << OF1X_FLOW_STATS_CURSOR_TABLE_SHIFT) | (uintptr_t)entry;
+			return msg;
+		}
+	}
+
+	//Done
+	*cursor = 0;
+
+	return msg;
+}
+
  
 /**
  * @name    hal_driver_of1x_get_flow_aggregate_stats
@@ -544,6 +768,27 @@ of1x_stats_flow_aggregate_msg_t* hal_driver_of1x_get_flow_aggregate_stats(uint64
 	if(table_id >= lsw->pipeline.num_of_tables && table_id != OF1X_FLOW_TABLE_ALL)
 		return NULL; 
 
+	//Requests filtered only by table and cookie are answered from the index
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)lsw->platform_state;
+
+	if(ls_int->stats_index && (!matches || !matches->head) && out_port == OF1X_PORT_ANY && out_group == OF1X_GROUP_ANY){
+		uint64_t packet_count, byte_count;
+		uint32_t flow_count;
+		of1x_stats_flow_aggregate_msg_t* msg = (of1x_stats_flow_aggregate_msg_t*)platform_malloc_shared(sizeof(of1x_stats_flow_aggregate_msg_t));
+
+		if(!msg)
+			return NULL;
+
+		ls_int->stats_index->get_aggregate(table_id, cookie, cookie_mask, &packet_count, &byte_count, &flow_count);
+
+		memset(msg, 0, sizeof(*msg));
+		msg->packet_count = packet_count;
+		msg->byte_count = byte_count;
+		msg->flow_count = flow_count;
+
+		return msg;
+	}
+
 	return of1x_get_flow_aggregate_stats(&lsw->pipeline, table_id, cookie, cookie_mask, out_port, out_group, matches);
 } 
 /**
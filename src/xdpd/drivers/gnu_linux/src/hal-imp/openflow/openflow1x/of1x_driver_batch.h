@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef GNU_LINUX_OF1X_DRIVER_BATCH_H
+#define GNU_LINUX_OF1X_DRIVER_BATCH_H
+
+#include <stdint.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+
+/**
+* @file of1x_driver_batch.h
+*
+* @brief Batched (and chunked) variants of the OF1.x driver calls, exposed
+* by the GNU/Linux driver in addition to the HAL API.
+*/
+
+/**
+* PACKET_OUT descriptor for hal_driver_of1x_process_packet_out_batch().
+* Same semantics as the arguments of hal_driver_of1x_process_packet_out().
+* Also declared in the HAL extensions of xDPd (hal_ext.h).
+*/
+#ifndef OF1X_PACKET_OUT_T_DEFINED
+#define OF1X_PACKET_OUT_T_DEFINED
+typedef struct of1x_packet_out{
+	uint32_t buffer_id;
+	uint32_t in_port;
+	of1x_action_group_t* action_group;
+	uint8_t* buffer;
+	uint32_t buffer_size;
+
+	//Filled in by the driver
+	hal_result_t result;
+}of1x_packet_out_t;
+#endif
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* PACKET_OUTs of the same LSI, processed in order with one call
+*/
+hal_result_t hal_driver_of1x_process_packet_out_batch(uint64_t dpid, of1x_packet_out_t* pkt_outs, unsigned int num);
+
+/**
+* FLOW_MOD ADDs of the same table and flags, installed in order with one
+* call (see of1x_driver.cc; the table is still locked once per entry)
+*/
+hal_result_t hal_driver_of1x_process_flow_mod_add_batch(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** entries, unsigned int num, bool check_overlap, bool reset_counts, hal_result_t* results);
+
+/**
+* Same as hal_driver_of1x_get_flow_stats(), but returning at most max_flows
+* entries per call. *cursor must be 0 on the first call; it is updated to
+* resume the walk on the next one, and set back to 0 once all the entries
+* have been returned. The tables are only locked while each call runs.
+*/
+of1x_stats_flow_msg_t* hal_driver_of1x_get_flow_stats_chunk(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, unsigned int max_flows, uint64_t* cursor);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //GNU_LINUX_OF1X_DRIVER_BATCH_H
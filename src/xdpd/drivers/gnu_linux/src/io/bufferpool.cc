@@ -121,6 +121,18 @@ void bufferpool::destroy(){
 	instance = NULL;	
 }
 
+long long unsigned int bufferpool::get_num_of_buffers_in_use(void){
+
+	bufferpool* bp = get_instance();
+	long long unsigned int i, in_use = 0;
+
+	for(i=0;i<capacity;++i){
+		if(bp->pool_status[i] == BUFFERPOOL_SLOT_IN_USE)
+			in_use++;
+	}
+
+	return in_use;
+}
 
 void
 bufferpool::dump_state(void)
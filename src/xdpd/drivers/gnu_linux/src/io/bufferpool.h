@@ -53,6 +53,13 @@ public:
 	
 	static void destroy();
 
+	/**
+	* Number of buffers of the pool and number of buffers in use. The
+	* latter is computed by going through the slots (not atomically).
+	*/
+	static long long unsigned int get_capacity(void){ return capacity; }
+	static long long unsigned int get_num_of_buffers_in_use(void);
+
 	//Only used in debug	
 	friend std::ostream&
 	operator<< (std::ostream& os, bufferpool const& bp) {
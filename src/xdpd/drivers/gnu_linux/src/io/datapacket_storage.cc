@@ -1,92 +1,149 @@
 #include "datapacket_storage.h"
 #include <assert.h>
+#include <stdlib.h>
+#include <new>
 #include <rofl/common/thread_helper.h>
 #include "../util/likely.h"
 
 using namespace xdpd::gnu_linux;
 
-datapacket_storage::datapacket_storage(uint16_t size, uint16_t expiration) :
-		next_id(1),
+datapacket_storage::datapacket_storage(uint32_t size, uint16_t expiration) :
 		max_size(size),
+		num_slots(2),
+		slot_bits(1),
+		head(0),
+		exp_cursor(0),
+		used(0),
 		expiration_time_sec(expiration)
 {
-	pthread_mutex_init(&lock, NULL);
+	//Twice as many slots as packets, so that a packet which is held for
+	//long does not prevent the ring from being reused
+	while(num_slots < 2*(uint64_t)max_size){
+		num_slots <<= 1;
+		slot_bits++;
+	}
+	slot_mask = num_slots - 1;
+
+	//Generations go from 1 to max_generation-1 so that neither 0 nor ERROR are valid ids
+	max_generation = (1U << (32 - slot_bits)) - 1;
+
+	slots = (store_slot*)calloc(num_slots, sizeof(store_slot));
+	if(!slots)
+		throw std::bad_alloc();
 }
 
 datapacket_storage::~datapacket_storage()
 {
-	pthread_mutex_destroy(&lock);
+	free(slots);
 }
 
 storeid
-datapacket_storage::store_packet(datapacket_t* pkt)
-{	
-	store_mapping map;
-	map.pkt = pkt;
-	
-	pthread_mutex_lock(&lock);
-		
-	if (store.size() >= max_size) {
-		pthread_mutex_unlock(&lock);
+datapacket_storage::store(void* obj)
+{
+	uint32_t i, pos, generation;
+	store_slot* slot;
+	storeid id;
+
+	//Reserve
+	if(unlikely(__sync_add_and_fetch(&used, 1) > max_size)){
+		__sync_sub_and_fetch(&used, 1);
+		return this->ERROR;
+	}
+
+	//Claim the next free slot of the ring. There are at least
+	//num_slots-max_size free slots, so this is bounded
+	for(i=0;i<num_slots;i++){
+		pos = __sync_fetch_and_add(&head, 1);
+		slot = &slots[pos & slot_mask];
+		if(likely(__sync_bool_compare_and_swap(&slot->id, SLOT_FREE, SLOT_BUSY)))
+			break;
+	}
+
+	if(unlikely(i == num_slots)){
+		__sync_sub_and_fetch(&used, 1);
 		return this->ERROR;
 	}
 
-	map.input_timestamp = time(NULL);
+	generation = slot->generation + 1;
+	if(unlikely(generation >= max_generation))
+		generation = 1;
 
-	if(unlikely(next_id+1 == 0xffffffff))
-		map.id = next_id = 1; //Skip error and 0
-	else
-		map.id = ++next_id;
-	store.push_back(map);
+	slot->generation = generation;
+	slot->obj = obj;
+	slot->input_timestamp = time(NULL);
+	id = (generation << slot_bits) | (pos & slot_mask);
 
-	pthread_mutex_unlock(&lock);
+	//Publish (full barrier; the slot is owned, it cannot fail)
+	__sync_bool_compare_and_swap(&slot->id, SLOT_BUSY, id);
 
-	return map.id;
+	return id;
 }
 
-datapacket_t*
-datapacket_storage::get_packet(storeid id)
+void*
+datapacket_storage::get(storeid id)
 {
-	std::list<store_mapping>::iterator iter;
-	store_mapping map = { 0, NULL };
+	store_slot* slot;
+	void* obj;
 
-	pthread_mutex_lock(&lock);
+	if(unlikely(id == SLOT_FREE || id == SLOT_BUSY))
+		return NULL;
 
-	// search the packet
-	for (iter = store.begin(); iter != store.end(); ++iter) {
-		if ( id == (*iter).id ) {
-			map = *iter;
-			store.erase(iter);
-			break;
-		}
-	}
-	
-	pthread_mutex_unlock(&lock);
+	slot = &slots[id & slot_mask];
+
+	//Only succeeds if the slot holds this very same id (generation)
+	if(!__sync_bool_compare_and_swap(&slot->id, id, SLOT_BUSY))
+		return NULL;
 
-	return map.pkt;
+	obj = slot->obj;
+	slot->obj = NULL;
+
+	//Release (full barrier; the slot is owned, it cannot fail)
+	__sync_bool_compare_and_swap(&slot->id, SLOT_BUSY, SLOT_FREE);
+	__sync_sub_and_fetch(&used, 1);
+
+	return obj;
 }
 
-bool 
+bool
 datapacket_storage::oldest_packet_needs_expiration(storeid *id)
 {
-	double buffer_life_time;
-	if(store.empty())
-		return false;
-	
-	buffer_life_time = difftime(time(NULL),store.front().input_timestamp);
-	
-	if(buffer_life_time>expiration_time_sec){
-		*id = store.front().id;
-		return true;
-	}else{
+	store_slot* slot;
+	storeid slot_id;
+	uint32_t curr_head = head;
+
+	//Positions older than one lap have been reused (or skipped)
+	if(unlikely(curr_head - exp_cursor > num_slots))
+		exp_cursor = curr_head - num_slots;
+
+	//Skip released slots
+	while(exp_cursor != curr_head){
+		slot = &slots[exp_cursor & slot_mask];
+		slot_id = slot->id;
+
+		if(slot_id == SLOT_FREE){
+			exp_cursor++;
+			continue;
+		}
+
+		if(slot_id == SLOT_BUSY)
+			return false; //Being stored/retrieved; check on the next round
+
+		__sync_synchronize();
+		if(difftime(time(NULL), slot->input_timestamp) > expiration_time_sec){
+			*id = slot_id;
+			return true;
+		}
 		return false;
 	}
+
+	return false;
 }
 
-uint16_t
+uint32_t
 datapacket_storage::get_storage_size() const
 {
-	return store.size();
+	//used may be transiently over max_size while a store is being rejected
+	return (used > max_size)? max_size : used;
 }
 
 #ifdef DEBUG
@@ -108,13 +165,15 @@ datapacket_storage::dump_state()
 void
 datapacket_storage::dump_slots()
 {
-	for (std::list<store_mapping>::const_iterator
-			it = store.begin(); it != store.end(); ++it) {
-		store_mapping const& map = (*it);
+	for (uint32_t i = 0; i < num_slots; ++i) {
+		store_slot const& slot = slots[i];
+		if(slot.id == SLOT_FREE)
+			continue;
 		std::cerr << "  ";
-		std::cerr << "id:" << (int)map.id << " ";
-		std::cerr << "input-timestamp:" << (int)map.input_timestamp << " ";
-		std::cerr << "pkt:" << (int*)map.pkt << " ";
+		std::cerr << "slot:" << i << " ";
+		std::cerr << "id:" << slot.id << " ";
+		std::cerr << "input-timestamp:" << (int)slot.input_timestamp << " ";
+		std::cerr << "obj:" << slot.obj << " ";
 		std::cerr << std::endl;
 	}
 }
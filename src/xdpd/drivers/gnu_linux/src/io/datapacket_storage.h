@@ -5,17 +5,14 @@
 #ifndef DATAPACKET_STORAGE_H_
 #define DATAPACKET_STORAGE_H_
 
-#include <vector>
-#include <list>
-#include <queue>
 #include <cstddef>
 #include <ctime>
 #include <iostream>
 
 #include <stdint.h>
-#include <pthread.h>
 
 #include <rofl/datapath/pipeline/common/datapacket.h>
+#include "pktin_arena.h"
 
 /**
 * @file datapacket_storage.h
@@ -34,6 +31,15 @@ typedef uint32_t storeid;
 /**
 * @brief Temporal storage for datapackets (PKT_IN events). 
 *
+* Buffered PKT_INs are stored as spills (copies in the pktin_arena of the
+* LSI), so that the bufferpool buffer can be released right away.
+*
+* Packets are kept in a ring of slots (power of 2). The storeid (OF buffer_id)
+* encodes the slot index in the lower bits and the generation of the slot in
+* the upper bits, so that store, lookup and expiration are O(1) and stale ids
+* are detected. Slots are claimed/released with CAS on the per-slot id; there
+* is no lock. Expiration follows the ring (insertion) order.
+*
 * @ingroup driver_gnu_linux_io
 */
 class datapacket_storage
@@ -41,9 +47,9 @@ class datapacket_storage
 public:
 	/**
 	 * constructor
-	 * @param size
+	 * @param size maximum number of packets stored
 	 */
-	datapacket_storage(uint16_t size, uint16_t expiration_time_sec);
+	datapacket_storage(uint32_t size, uint16_t expiration_time_sec);
 
 	/**
 	 * destructor
@@ -53,29 +59,45 @@ public:
 	/**
 	 * store a datapacket
 	 * @param pkt
-	 * @return id of the stored packet, -1 if the packet could not be stored
+	 * @return id of the stored packet, ERROR if the packet could not be stored
 	 */
 	storeid
-	store_packet(datapacket_t *pkt);
+	store_packet(datapacket_t *pkt){ return store(pkt); }
 
 	/**
-	 * get the stored packet by id
+	 * get (and remove) the stored packet by id
 	 * @param id
-	 * @return
+	 * @return the packet or NULL if id is not (or no longer) stored
 	 */
 	datapacket_t*
-	get_packet(storeid id);
+	get_packet(storeid id){ return (datapacket_t*)get(id); }
+
+	/**
+	 * store a PKT_IN spilled to a pktin_arena
+	 * @return id of the stored spill, ERROR if it could not be stored
+	 */
+	storeid
+	store_spill(pktin_spill_t* spill){ return store(spill); }
+
+	/**
+	 * get (and remove) the stored spill by id
+	 * @return the spill or NULL if id is not (or no longer) stored
+	 */
+	pktin_spill_t*
+	get_spill(storeid id){ return (pktin_spill_t*)get(id); }
 
 	/**
 	 * get the size of the storage
 	 * @return
 	 */
-	uint16_t
+	uint32_t
 	get_storage_size() const;
 	
 	/**
 	 * returns true if the first element needs to be
 	 * expired, and sets it's ID in the parameter.
+	 *
+	 * @warning must be called from a single thread (expiration thread)
 	 */
 	bool
 	oldest_packet_needs_expiration(storeid *id);
@@ -91,9 +113,12 @@ public:
 	friend std::ostream&
 	operator<< (std::ostream& os, datapacket_storage const& ds) {
 		os << "<datapacket_storage: ";
-			os << "max-size:" << (int)ds.max_size << " ";
+			os << "max-size:" << ds.max_size << " ";
+			os << "num-slots:" << ds.num_slots << " ";
 			os << "expiration-time-sec:" << (int)ds.expiration_time_sec << " ";
-			os << "store.size():" << (int)ds.store.size() << " ";
+			os << "used:" << ds.used << " ";
+			os << "head:" << ds.head << " ";
+			os << "expiration-cursor:" << ds.exp_cursor << " ";
 			os << "now:" << time(NULL) << " ";
 		os << ">";
 		return os;
@@ -103,17 +128,38 @@ public:
 	static const storeid ERROR = 0xFFFFFFFF;
 
 private:
-	
-	storeid next_id;
-	uint16_t max_size;
+
+	//Slot is free
+	static const storeid SLOT_FREE = 0x0;
+	//Slot is being written/read (ERROR is never a valid id)
+	static const storeid SLOT_BUSY = ERROR;
+
 	typedef struct {
-		storeid id;
-		datapacket_t* pkt;
+		//Id of the packet stored or SLOT_FREE/SLOT_BUSY
+		volatile storeid id;
+		//Generation of the last packet stored
+		uint32_t generation;
+		void* obj;
 		time_t input_timestamp;
-	} store_mapping;
+	} store_slot;
+
+	uint32_t max_size;
+	uint32_t num_slots;
+	uint32_t slot_mask;
+	unsigned int slot_bits;
+	uint32_t max_generation;
+
+	store_slot* slots;
+
+	storeid store(void* obj);
+	void* get(storeid id);
+
+	//Ring positions: next position to be used and next to be checked for expiration
+	volatile uint32_t head;
+	uint32_t exp_cursor;
 
-	std::list<store_mapping> store;
-	pthread_mutex_t lock;
+	//Number of packets stored
+	volatile uint32_t used;
 	uint16_t expiration_time_sec;
 
 	// this class is noncopyable
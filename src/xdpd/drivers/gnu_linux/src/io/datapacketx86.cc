@@ -125,6 +125,8 @@ rofl_result_t datapacketx86::transfer_to_user_space(){
 	switch (get_buffering_status()){
 
 		case X86_DATAPACKET_BUFFERED_IN_NIC: {
+			uint8_t* nic_buffer = (uint8_t*)buffer.iov_base;
+
 			slot.iov_base 	= user_space_buffer;
 			slot.iov_len	= sizeof(user_space_buffer);
 #ifndef NDEBUG
@@ -140,9 +142,8 @@ rofl_result_t datapacketx86::transfer_to_user_space(){
 			// set buffering flag
 			buffering_status = X86_DATAPACKET_BUFFERED_IN_USER_SPACE;
 			
-			//Re-classify 
-			//TODO: use offsets instead of fixed pointers for frames to avoid re-classification here
-			classify_packet(headers, get_buffer(), get_buffer_length(), in_port, 0);
+			//Relocate the classified headers; their offsets within the frame did not change
+			shift_classifier(headers, (uint8_t*)buffer.iov_base - nic_buffer);
 			
 			//Copy done
 		} return ROFL_SUCCESS;
@@ -189,7 +190,10 @@ rofl_result_t datapacketx86::push(unsigned int offset, unsigned int num_of_bytes
 		return ROFL_FAILURE;
 	}
 
-	// move header num_of_bytes backward
+	/*
+	 * Only the first offset bytes (L2 header) are moved; the rest of the frame
+	 * stays in place and the buffer start is moved into the headroom
+	 */
 	platform_memmove((uint8_t*)buffer.iov_base - num_of_bytes, buffer.iov_base, offset);
 #ifndef NDEBUG
 	// initialize new pushed memory area with 0x00
@@ -225,7 +229,7 @@ rofl_result_t datapacketx86::pop(unsigned int offset, unsigned int num_of_bytes)
 		return ROFL_FAILURE;
 	}
 
-	// move first bytes backward
+	// move first bytes (L2 header) forward, the start of the buffer follows them
 	platform_memmove((uint8_t*)buffer.iov_base + num_of_bytes, buffer.iov_base, offset);
 
 #ifndef NDEBUG
@@ -236,8 +240,6 @@ rofl_result_t datapacketx86::pop(unsigned int offset, unsigned int num_of_bytes)
 	buffer.iov_base = (uint8_t*)buffer.iov_base + num_of_bytes;
 	buffer.iov_len -= num_of_bytes;
 
-	// re-parse_ether() here? yes, we have to, but what about the costs?
-
 	return ROFL_SUCCESS;
 }
 
@@ -246,11 +248,7 @@ rofl_result_t datapacketx86::pop(unsigned int offset, unsigned int num_of_bytes)
 //Push&pop operations
 rofl_result_t datapacketx86::push(uint8_t* push_point, unsigned int num_of_bytes){
 
-	//If not already transfer to user space
-	if(X86_DATAPACKET_BUFFERED_IN_NIC == buffering_status){
-		transfer_to_user_space();
-	}
-	
+	//NOTE: offset must be calculated before the (eventual) transfer to user space
 	if (push_point < buffer.iov_base){
 		return ROFL_FAILURE;
 	}
@@ -259,7 +257,6 @@ rofl_result_t datapacketx86::push(uint8_t* push_point, unsigned int num_of_bytes
 		return ROFL_FAILURE;
 	}
 
-	//size_t offset = ((uint8_t*)buffer.iov_base - push_point);
 	size_t offset = (push_point - (uint8_t*)buffer.iov_base);
 
 	return push(offset, num_of_bytes);
@@ -277,8 +274,7 @@ rofl_result_t datapacketx86::pop(uint8_t* pop_point, unsigned int num_of_bytes){
 		return ROFL_FAILURE;
 	}
 
-	//size_t offset = ((uint8_t*)buffer.iov_base - pop_point);
-	size_t offset = ((uint8_t*)buffer.iov_base - pop_point);
+	size_t offset = (pop_point - (uint8_t*)buffer.iov_base);
 
 	return pop(offset, num_of_bytes);
 }
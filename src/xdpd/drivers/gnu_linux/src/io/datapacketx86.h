@@ -110,6 +110,10 @@ public: // methods
 
 	/*
 	* Push&pop raw operations. To be used ONLY by classifiers
+	*
+	* Only the first offset bytes are moved; the start of the buffer is displaced
+	* within the headroom (PRE_GUARD_BYTES), so the cost does not depend on the
+	* packet size. Headers beyond offset keep their address.
 	*/
 	rofl_result_t push(unsigned int offset, unsigned int num_of_bytes);
 	rofl_result_t pop(unsigned int offset, unsigned int num_of_bytes);
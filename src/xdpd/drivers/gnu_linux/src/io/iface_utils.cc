@@ -1,6 +1,5 @@
 #include <linux/ethtool.h>
 #include <sys/ioctl.h>
-#include <ifaddrs.h>
 #include <sys/socket.h>
 #include <linux/sockios.h>
 //#include <netpacket/packet.h>
@@ -9,6 +8,11 @@
 #include <stdio.h>
 #include <map>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_ether.h>
 
 //Prototypes
 #include <rofl/common/utils/c_logger.h>
@@ -23,6 +27,7 @@
 #include "ports/ioport.h" 
 #include "ports/mmap/ioport_mmap.h" 
 #include "ports/vlink/ioport_vlink.h" 
+#include "../util/time_utils.h"
 
 using namespace xdpd::gnu_linux;
 
@@ -64,6 +69,7 @@ rofl_result_t update_port_status(char * name){
 	strcpy(ifr.ifr_name, port->name);
 
 	if ((rc = ioctl(sd, SIOCGIFINDEX, &ifr)) < 0){
+		close(sd);
 		assert(0);
 		return ROFL_FAILURE;
 	}
@@ -81,6 +87,7 @@ rofl_result_t update_port_status(char * name){
 	
 	//Release mutex
 	pthread_rwlock_unlock(&io_port->rwlock);
+	close(sd);
 	
 	ROFL_DEBUG(DRIVER_NAME"[ports] Interface %s is %s, and link is %s\n", name,( ((IFF_UP & ifr.ifr_flags) > 0) ? "up" : "down"), ( ((IFF_RUNNING & ifr.ifr_flags) > 0) ? "detected" : "not detected"));
 
@@ -117,37 +124,105 @@ static void fill_port_queues(switch_port_t* port, ioport* io_port){
 /*
 * Physical port disovery
 */
-static rofl_result_t fill_port_admin_and_link_state(switch_port_t* port){
 
-	struct ifreq ifr;
-	int sd, rc;
+//Interface information retrieved via the RTM_GETLINK dump
+typedef struct link_info{
+	unsigned int flags;
+	uint8_t hwaddr[ETH_ALEN];
+}link_info_t;
 
-	if ((sd = socket(AF_PACKET, SOCK_RAW, 0)) < 0) {
+/*
+* Retrieves the name, index, flags and MAC address of all the interfaces of
+* the system with a single netlink dump (instead of getifaddrs() plus a
+* couple of ioctls per interface)
+*/
+static rofl_result_t dump_links(std::map<std::string, link_info_t>& links){
+
+	int sock, len;
+	bool done = false;
+	unsigned int seq = time(NULL);
+	char buf[16384] __attribute__((aligned(NLMSG_ALIGNTO)));
+	struct sockaddr_nl addr;
+	struct nlmsghdr* nlh;
+	struct ifinfomsg* ifi;
+	struct rtattr* rta;
+	int rta_len;
+	const char* name;
+	link_info_t link;
+	struct {
+		struct nlmsghdr nlh;
+		struct ifinfomsg ifi;
+	}req;
+
+	if((sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE)) < 0){
+		ROFL_ERR(DRIVER_NAME"[ports] Unable to open NETLINK_ROUTE socket, errno(%d): %s\n", errno, strerror(errno));
 		return ROFL_FAILURE;
 	}
 
-	memset(&ifr, 0, sizeof(struct ifreq));
-	strcpy(ifr.ifr_name, port->name);
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
 
-	if ((rc = ioctl(sd, SIOCGIFINDEX, &ifr)) < 0) {
-		return ROFL_FAILURE;
-	}
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	req.nlh.nlmsg_type = RTM_GETLINK;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.nlh.nlmsg_seq = seq;
+	req.ifi.ifi_family = AF_UNSPEC;
 
-	if ((rc = ioctl(sd, SIOCGIFFLAGS, &ifr)) < 0) {
-		close(sd);
+	if(sendto(sock, &req, req.nlh.nlmsg_len, 0, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+		ROFL_ERR(DRIVER_NAME"[ports] Unable to send RTM_GETLINK request, errno(%d): %s\n", errno, strerror(errno));
+		close(sock);
 		return ROFL_FAILURE;
 	}
 
-	//Fill values
-	port->up = (IFF_UP & ifr.ifr_flags) > 0;
+	while(!done){
 
-	if( (IFF_RUNNING & ifr.ifr_flags) > 0){
-	}else{
-		port->state = PORT_STATE_LINK_DOWN;
+		if((len = recv(sock, buf, sizeof(buf), 0)) < 0){
+			if(errno == EINTR)
+				continue;
+			ROFL_ERR(DRIVER_NAME"[ports] Error reading RTM_GETLINK dump, errno(%d): %s\n", errno, strerror(errno));
+			close(sock);
+			return ROFL_FAILURE;
+		}
+
+		for(nlh = (struct nlmsghdr*)buf; NLMSG_OK(nlh, (unsigned int)len); nlh = NLMSG_NEXT(nlh, len)){
+
+			if(nlh->nlmsg_seq != seq)
+				continue;
+
+			if(nlh->nlmsg_type == NLMSG_DONE){
+				done = true;
+				break;
+			}
+
+			if(nlh->nlmsg_type == NLMSG_ERROR){
+				ROFL_ERR(DRIVER_NAME"[ports] RTM_GETLINK dump failed\n");
+				close(sock);
+				return ROFL_FAILURE;
+			}
+
+			if(nlh->nlmsg_type != RTM_NEWLINK)
+				continue;
+
+			ifi = (struct ifinfomsg*)NLMSG_DATA(nlh);
+			memset(&link, 0, sizeof(link));
+			link.flags = ifi->ifi_flags;
+			name = NULL;
+
+			rta_len = IFLA_PAYLOAD(nlh);
+			for(rta = IFLA_RTA(ifi); RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)){
+				if(rta->rta_type == IFLA_IFNAME)
+					name = (const char*)RTA_DATA(rta);
+				else if(rta->rta_type == IFLA_ADDRESS && RTA_PAYLOAD(rta) == ETH_ALEN)
+					memcpy(link.hwaddr, RTA_DATA(rta), ETH_ALEN);
+			}
+
+			if(name)
+				links[std::string(name)] = link;
+		}
 	}
 
-	//Close socket	
-	close(sd);
+	close(sock);
 	return ROFL_SUCCESS;
 }
 
@@ -200,48 +275,43 @@ static void fill_port_speeds_capabilities(switch_port_t* port, struct ethtool_cm
 	switch_port_set_current_max_speed(port, current_speed); //TODO: this is not right
 }
 
-static switch_port_t* fill_port(int sock, struct ifaddrs* ifa){
+static switch_port_t* fill_port(int sock, const std::string& name, const link_info_t& link){
 	
 	int j;
 	struct ethtool_cmd edata;
 	struct ifreq ifr;
-	struct sockaddr_ll *socll;
 	switch_port_t* port;	
 
 	//fetch interface info with ethtool
-	strcpy(ifr.ifr_name, ifa->ifa_name);
+	strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ-1);
+	ifr.ifr_name[IFNAMSIZ-1] = '\0';
 	memset(&edata,0,sizeof(edata));
 	edata.cmd = ETHTOOL_GSET;
 	ifr.ifr_data = (char *) &edata;
 
 	if (ioctl(sock, SIOCETHTOOL, &ifr)==-1){
 		//FIXME change this messages into warnings "Unable to discover mac address of interface %s"
-		if(strncmp("lo",ifa->ifa_name,2) != 0)
+		if(strncmp("lo",name.c_str(),2) != 0)
 			ROFL_WARN(DRIVER_NAME"[ports] WARNING: unable to retrieve MAC address from iface %s via ioctl SIOCETHTOOL. Information will not be filled\n",ifr.ifr_name);
 	}
 	
 	//Init the port
-	port = switch_port_init(ifa->ifa_name, true/*will be overriden afterwards*/, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	port = switch_port_init((char*)name.c_str(), true/*will be overriden afterwards*/, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
 	if(!port)
 		return NULL;
 
-	//get the MAC addr.
-	socll = (struct sockaddr_ll *)ifa->ifa_addr;
+	//MAC addr.
 	ROFL_INFO(DRIVER_NAME"[ports] Discovered interface %s mac_addr %02X:%02X:%02X:%02X:%02X:%02X \n",
-		ifa->ifa_name,socll->sll_addr[0],socll->sll_addr[1],socll->sll_addr[2],socll->sll_addr[3],
-		socll->sll_addr[4],socll->sll_addr[5]);
+		name.c_str(),link.hwaddr[0],link.hwaddr[1],link.hwaddr[2],link.hwaddr[3],
+		link.hwaddr[4],link.hwaddr[5]);
 
 	for(j=0;j<6;j++)
-		port->hwaddr[j] = socll->sll_addr[j];
+		port->hwaddr[j] = link.hwaddr[j];
 
 	//Fill port admin/link state
-	if( fill_port_admin_and_link_state(port) == ROFL_FAILURE){
-		if(strcmp(port->name,"lo") == 0) //Skip loopback but return success
-			return port; 
-			
-		switch_port_destroy(port);
-		return NULL;
-	}
+	port->up = (IFF_UP & link.flags) > 0;
+	if( (IFF_RUNNING & link.flags) == 0)
+		port->state = PORT_STATE_LINK_DOWN;
 	
 	//Fill speeds and capabilities	
 	fill_port_speeds_capabilities(port, &edata);
@@ -265,59 +335,52 @@ static switch_port_t* fill_port(int sock, struct ifaddrs* ifa){
  */
 rofl_result_t discover_physical_ports(){
 	
-	unsigned int i, max_ports;
-	switch_port_t* port, **array;
+	unsigned int num_of_ports = 0;
+	switch_port_t* port;
+	switch_port_snapshot_t* port_snapshot;
 	int sock;
-	
-	struct ifaddrs *ifaddr, *ifa;
-	
-	/*real way to find interfaces*/
-	//getifaddrs(&ifap); -> there are examples on how to get the ip addresses
-	if (getifaddrs(&ifaddr) == -1){
-		perror("getifaddrs");
-		exit(EXIT_FAILURE);
-	}
-	
+	struct timeval start, end;
+	std::map<std::string, link_info_t> links;
+
+	gettimeofday(&start, NULL);
+
+	if(dump_links(links) != ROFL_SUCCESS)
+		return ROFL_FAILURE;
+
+	//Only used for ethtool
 	if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0){
-	        perror("socket");
-			freeifaddrs(ifaddr);
-        	exit(EXIT_FAILURE);
-    	}
+		ROFL_ERR(DRIVER_NAME"[ports] Unable to open socket, errno(%d): %s\n", errno, strerror(errno));
+		return ROFL_FAILURE;
+	}
 	
-	for(ifa = ifaddr; ifa != NULL; ifa=ifa->ifa_next){
+	for(std::map<std::string, link_info_t>::iterator it = links.begin(); it != links.end(); ++it){
 		
-		if(ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_PACKET)
-			continue;
-
 		//Fill port
-		port = fill_port(sock, ifa);
+		port = fill_port(sock, it->first, it->second);
+		if(!port){
+			ROFL_ERR(DRIVER_NAME"[ports] Unable to initialize interface %s\n", it->first.c_str());
+			continue;
+		}
 
 		//Adding the 
 		if( physical_switch_add_port(port) != ROFL_SUCCESS ){
 			ROFL_ERR(DRIVER_NAME"[ports] All physical port slots are occupied\n");
-			freeifaddrs(ifaddr);
+			close(sock);
 			assert(0);
 			return ROFL_FAILURE;
 		}
 
-	}
+		//Admin and link state come from the dump; no need to query them again
+		port_snapshot = physical_switch_get_port_snapshot(port->name); 
+		hal_cmm_notify_port_status_changed(port_snapshot);
 
-	//This MUST be here and NOT in the previous loop, or the ports will be discovered (duplicated)
-	//via update_physical_ports. FIXME: this needs to be implemented properly	
-	array = physical_switch_get_physical_ports(&max_ports);
-	for(i=0; i<max_ports ; i++){
-		if(array[i] != NULL){
-			//Update status
-			if(update_port_status(array[i]->name) != ROFL_SUCCESS){
-				ROFL_ERR(DRIVER_NAME"[ports] Unable to retrieve link and/or admin status of the interface\n");
-				freeifaddrs(ifaddr);
-				assert(0);
-				return ROFL_FAILURE;
-			}
-		}
+		num_of_ports++;
 	}
 
-	freeifaddrs(ifaddr);
+	close(sock);
+
+	gettimeofday(&end, NULL);
+	ROFL_INFO(DRIVER_NAME"[ports] Discovered %u interfaces in %llu ms\n", num_of_ports, (long long unsigned int)get_time_difference_ms(&end, &start));
 	
 	return ROFL_SUCCESS;
 }
@@ -344,7 +407,7 @@ rofl_result_t create_virtual_port_pair(of_switch_t* lsw1, ioport** vport1, of_sw
 	port2 = switch_port_init(port_name, false, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
 
 	if(!port1 || !port2){
-		free(port1);
+		platform_free_shared(port1);
 		assert(0);
 		ROFL_ERR(DRIVER_NAME"[ports] Not enough memory\n");
 		return ROFL_FAILURE;
@@ -354,8 +417,8 @@ rofl_result_t create_virtual_port_pair(of_switch_t* lsw1, ioport** vport1, of_sw
 	*vport1 = new ioport_vlink(port1);
 	
 	if(!*vport1){
-		free(port1);
-		free(port2);
+		platform_free_shared(port1);
+		platform_free_shared(port2);
 		ROFL_ERR(DRIVER_NAME"[ports] Not enough memory\n");
 		assert(0);
 		return ROFL_FAILURE;
@@ -364,8 +427,8 @@ rofl_result_t create_virtual_port_pair(of_switch_t* lsw1, ioport** vport1, of_sw
 	*vport2 = new ioport_vlink(port2);
 
 	if(!*vport2){
-		free(port1);
-		free(port2);
+		platform_free_shared(port1);
+		platform_free_shared(port2);
 		delete *vport1;
 		ROFL_ERR(DRIVER_NAME"[ports] Not enough memory\n");
 		assert(0);
@@ -430,8 +493,8 @@ rofl_result_t create_virtual_port_pair(of_switch_t* lsw1, ioport** vport1, of_sw
 
 	//Add them to the platform
 	if( physical_switch_add_port(port1) != ROFL_SUCCESS ){
-		free(port1);
-		free(port2);
+		platform_free_shared(port1);
+		platform_free_shared(port2);
 		delete *vport1;
 		delete *vport2;
 		ROFL_ERR(DRIVER_NAME"[ports] Unable to add vlink port1 to the physical switch; out of slots?\n");
@@ -439,8 +502,8 @@ rofl_result_t create_virtual_port_pair(of_switch_t* lsw1, ioport** vport1, of_sw
 		return ROFL_FAILURE;
 	}
 	if( physical_switch_add_port(port2) != ROFL_SUCCESS ){
-		free(port1);
-		free(port2);
+		platform_free_shared(port1);
+		platform_free_shared(port2);
 		delete *vport1;
 		delete *vport2;
 		ROFL_ERR(DRIVER_NAME"[ports] Unable to add vlink port2 to the physical switch; out of slots?\n");
@@ -523,16 +586,13 @@ rofl_result_t update_physical_ports(){
 	switch_port_t *port, **ports;
 	switch_port_snapshot_t *port_snapshot;
 	int sock;
-	struct ifaddrs *ifaddr, *ifa;
 	unsigned int i, max_ports;
-	std::map<std::string, struct ifaddrs*> system_ifaces;
+	std::map<std::string, link_info_t> system_ifaces;
 	std::map<std::string, switch_port_t*> pipeline_ifaces;
 	
 	ROFL_DEBUG_VERBOSE(DRIVER_NAME"[ports] Trying to update the list of physical interfaces...\n");	
 	
-	/*real way to find interfaces*/
-	//getifaddrs(&ifap); -> there are examples on how to get the ip addresses
-	if (getifaddrs(&ifaddr) == -1){
+	if(dump_links(system_ifaces) != ROFL_SUCCESS){
 		return ROFL_FAILURE;	
 	}
 	
@@ -554,12 +614,6 @@ rofl_result_t update_physical_ports(){
 			pipeline_ifaces[std::string(ports[i]->name)] = ports[i];	
 			
 	}
-	for(ifa = ifaddr; ifa != NULL; ifa=ifa->ifa_next){
-		if(ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_PACKET)
-			continue;
-			
-		system_ifaces[std::string(ifa->ifa_name)] = ifa;	
-	}
 
 	//Validate the existance of the ports in the pipeline and remove
 	//the ones that are no longer there. If they still exist remove them from ifaces
@@ -588,9 +642,9 @@ rofl_result_t update_physical_ports(){
 	}
 	
 	//Add remaining "new" interfaces (remaining interfaces in system_ifaces map 
-	for (std::map<std::string, struct ifaddrs*>::iterator it = system_ifaces.begin(); it != system_ifaces.end(); ++it){
+	for (std::map<std::string, link_info_t>::iterator it = system_ifaces.begin(); it != system_ifaces.end(); ++it){
 		//Fill port
-		port = fill_port(sock,  it->second);
+		port = fill_port(sock, it->first, it->second);
 		if(!port){
 			ROFL_ERR(DRIVER_NAME"[ports] Unable to initialize newly discovered interface %s\n", it->first.c_str());
 			continue;
@@ -599,7 +653,6 @@ rofl_result_t update_physical_ports(){
 		//Adding the 
 		if( physical_switch_add_port(port) != ROFL_SUCCESS ){
 			ROFL_ERR(DRIVER_NAME"[ports] Unable to add port %s to physical switch. Not enough slots?\n", it->first.c_str());
-			freeifaddrs(ifaddr);
 			continue;	
 		}
 
@@ -611,7 +664,6 @@ rofl_result_t update_physical_ports(){
 	
 	ROFL_DEBUG_VERBOSE(DRIVER_NAME"[ports] Update of interfaces done.\n");	
 
-	freeifaddrs(ifaddr);
 	close(sock);
 	
 	return ROFL_SUCCESS;
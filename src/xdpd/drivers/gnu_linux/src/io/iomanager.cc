@@ -1,9 +1,11 @@
 #include <stdio.h>
 #include <assert.h>
+#include <sys/time.h>
 #include <sstream>
 #include <rofl/common/utils/c_logger.h>
 #include "iomanager.h"
 #include "bufferpool.h"
+#include "../util/time_utils.h"
 #include "../processing/processingmanager.h"
 
 //Add it here if you want to use another scheduler...
@@ -287,6 +289,147 @@ rofl_result_t iomanager::bring_port_up(ioport* port){
 }
 
 
+/*
+* Work shared by the port bring-up workers
+*/
+typedef struct bring_up_work{
+	std::vector<ioport*>* ports;
+	rofl_result_t* results;		//ROFL_SUCCESS on entry if the port has to be brought up
+	unsigned int next;		//Next port to be claimed
+}bring_up_work_t;
+
+void* iomanager::bring_up_worker(void* param){
+
+	unsigned int i;
+	bring_up_work_t* work = (bring_up_work_t*)param;
+
+	while( (i = __sync_fetch_and_add(&work->next, 1)) < work->ports->size() ){
+		if(work->results[i] == ROFL_SUCCESS)
+			work->results[i] = (*work->ports)[i]->up();
+	}
+
+	return NULL;
+}
+
+/*
+* Start a set of ports. Same semantics as bring_port_up(), but the port set up (ring creation)
+* is done in parallel and every portgroup is resynchronized only once. Ports not contained in
+* any portgroup are only brought up.
+*/
+rofl_result_t iomanager::bring_ports_up(std::vector<ioport*>& ports, rofl_result_t* results){
+
+	unsigned int i, j, num_of_workers, num_of_scheduled = 0;
+	rofl_result_t result = ROFL_SUCCESS;
+	pthread_t workers[IO_PORT_BRINGUP_WORKERS];
+	bring_up_work_t work;
+	struct timeval start, rings_done, end;
+
+	if(ports.empty())
+		return ROFL_SUCCESS;
+
+	gettimeofday(&start, NULL);
+
+	pthread_mutex_lock(&mutex);
+
+	std::vector<bool> dirty(portgroups.size(), false), was_idle(portgroups.size(), false);
+
+	//Skip the ports that are already running
+	for(i=0;i<ports.size();++i){
+		results[i] = ROFL_SUCCESS;
+		for(j=0;j<portgroups.size();++j){
+			if(portgroups[j]->running_ports->contains(ports[i])){
+				results[i] = ROFL_FAILURE;
+				break;
+			}
+		}
+	}
+
+	//Phase 1: set up the ports in parallel; the calling thread is also a worker
+	work.ports = &ports;
+	work.results = results;
+	work.next = 0;
+
+	num_of_workers = (ports.size() < IO_PORT_BRINGUP_WORKERS)? ports.size() : IO_PORT_BRINGUP_WORKERS;
+	for(i=1;i<num_of_workers;++i){
+		if(pthread_create(&workers[i], NULL, bring_up_worker, &work) != 0){
+			ROFL_WARN(DRIVER_NAME"[iomanager] Unable to launch port bring-up worker %u; continuing with %u workers\n", i, i);
+			num_of_workers = i;
+			break;
+		}
+	}
+	bring_up_worker(&work);
+	for(i=1;i<num_of_workers;++i)
+		pthread_join(workers[i], NULL);
+
+	gettimeofday(&rings_done, NULL);
+
+	//Phase 2: add the ports to the running set of their portgroups
+	try{
+		for(i=0;i<ports.size();++i){
+
+			if(results[i] != ROFL_SUCCESS)
+				continue;
+
+			for(j=0;j<portgroups.size();++j){
+				portgroup_state* pg = portgroups[j];
+
+				if(!pg->ports->contains(ports[i]))
+					continue;
+
+				if(!dirty[j]){
+					dirty[j] = true;
+					was_idle[j] = (pg->running_ports->size() == 0);
+				}
+
+				pg->running_ports->push_back(ports[i]);
+			}
+		}
+
+		//Resynchronize each portgroup once
+		for(j=0;j<portgroups.size();++j){
+			portgroup_state* pg = portgroups[j];
+
+			if(!dirty[j])
+				continue;
+
+			if(was_idle[j]){
+				start_portgroup_threads(pg);
+			}else{
+				//Refresh hash
+				pg->running_hash++;
+			}
+
+			//Wait for all I/O threads to be synchronized with the new state
+			for(i=0;i<pg->num_of_threads;++i)
+				sem_wait(&pg->sync_sem);
+
+			num_of_scheduled++;
+		}
+	}catch(...){
+		//Do nothing; should never jump here
+		ROFL_ERR(DRIVER_NAME"[iomanager] Exception thrown while trying to bring a set of ports up\n");
+		assert(0);
+	}
+
+	pthread_mutex_unlock(&mutex);
+
+	gettimeofday(&end, NULL);
+
+	for(i=0;i<ports.size();++i){
+		if(results[i] != ROFL_SUCCESS){
+			ROFL_ERR(DRIVER_NAME"[iomanager] Unable to bring port %s up\n", ports[i]->of_port_state->name);
+			result = ROFL_FAILURE;
+		}
+	}
+
+	ROFL_INFO(DRIVER_NAME"[iomanager] Brought up %u ports: port set up %llu ms (%u workers), scheduling %llu ms (%u portgroups)\n", (unsigned int)ports.size(), (unsigned long long)get_time_difference_ms(&rings_done, &start), num_of_workers, (unsigned long long)get_time_difference_ms(&end, &rings_done), num_of_scheduled);
+
+	dump_state(false);
+
+	return result;
+}
+
+
 
 
 
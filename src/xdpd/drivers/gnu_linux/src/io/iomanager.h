@@ -102,6 +102,12 @@ public:
 	*/
 	static rofl_result_t bring_port_up(ioport* port);
 	static rofl_result_t bring_port_down(ioport* port, bool mutex_locked=false);
+
+	/*
+	* Bring up a set of ports. Port set up runs in parallel on up to IO_PORT_BRINGUP_WORKERS
+	* threads and each portgroup is resynchronized once. results[i] is the result for ports[i]
+	*/
+	static rofl_result_t bring_ports_up(std::vector<ioport*>& ports, rofl_result_t* results);
 	
 	/*
 	* Checkpoint for I/O threads to keep on working. Called by schedulers
@@ -154,6 +160,9 @@ protected:
 	/* Start/Stop portgroup threads */
 	static void start_portgroup_threads(portgroup_state* pg);
 	static void stop_portgroup_threads(portgroup_state* pg);
+
+	/* Port bring-up worker (bring_ports_up) */
+	static void* bring_up_worker(void* param);
 	
 };
 
@@ -58,13 +58,29 @@ void reset_classifier(classify_state_t* clas_state){
 		memset(clas_state->matches,0,sizeof(packet_matches_t));
 }
 
+void shift_classifier(classify_state_t* clas_state, ssize_t bytes){
+
+	unsigned int i;
+
+	if(!clas_state->is_classified || bytes == 0)
+		return;
+
+	//Header offsets within the frame are kept, only the base changes
+	for(i=0;i<MAX_HEADERS;i++){
+		if(clas_state->headers[i].present)
+			clas_state->headers[i].frame = (uint8_t*)(clas_state->headers[i].frame) + bytes;
+	}
+}
+
 void parse_ethernet(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_eth_hdr_t))){return;}
+	if (unlikely(datalen < sizeof(cpc_eth_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_ETHER] == MAX_ETHER_FRAMES)){return;}
 
 	//Data pointer	
 	cpc_eth_hdr_t* ether = (cpc_eth_hdr_t *)data;
 
+	if (unlikely(is_llc_frame(ether) && datalen < sizeof(cpc_eth_llc_hdr_t))){return;}
+
 	//Set frame
 	unsigned int num_of_ether = clas_state->num_of_headers[HEADER_TYPE_ETHER];
 	clas_state->headers[FIRST_ETHER_FRAME_POS + num_of_ether].frame = ether;
@@ -135,7 +151,7 @@ void parse_ethernet(classify_state_t* clas_state, uint8_t *data, size_t datalen)
 
 void parse_vlan(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_vlan_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_vlan_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_VLAN] == MAX_VLAN_FRAMES)) { return; }
 
 	//Data pointer	
 	cpc_vlan_hdr_t* vlan = (cpc_vlan_hdr_t *)data;
@@ -205,7 +221,7 @@ void parse_vlan(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_mpls(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 	
-	if (unlikely(datalen < sizeof(cpc_mpls_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_mpls_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_MPLS] == MAX_MPLS_FRAMES)) { return; }
 
 	cpc_mpls_hdr_t* mpls = (cpc_mpls_hdr_t*)data;
 	
@@ -236,7 +252,7 @@ void parse_mpls(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 }
 void parse_pppoe(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_pppoe_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_pppoe_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_PPPOE] == MAX_PPPOE_FRAMES)) { return; }
 
 	cpc_pppoe_hdr_t* pppoe = (cpc_pppoe_hdr_t*)data;
 
@@ -295,7 +311,7 @@ void parse_pppoe(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_ppp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 	
-	if (unlikely(datalen < sizeof(cpc_ppp_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_ppp_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_PPP] == MAX_PPP_FRAMES)) { return; }
 
 	cpc_ppp_hdr_t* ppp = (cpc_ppp_hdr_t*)data;
 	
@@ -330,7 +346,7 @@ void parse_ppp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_arpv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 	
-	if (unlikely(datalen < sizeof(cpc_arpv4_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_arpv4_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_ARPV4] == MAX_ARPV4_FRAMES)) { return; }
 	
 	cpc_arpv4_hdr_t* arpv4 = (cpc_arpv4_hdr_t*)data;
 
@@ -358,7 +374,7 @@ void parse_arpv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 }
 
 void parse_ipv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
-	if (unlikely(datalen < sizeof(cpc_ipv4_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_ipv4_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_IPV4] == MAX_IPV4_FRAMES)) { return; }
 	
 	//Set reference
 	cpc_ipv4_hdr_t *ipv4 = (cpc_ipv4_hdr_t*)data; 
@@ -428,7 +444,7 @@ void parse_ipv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_icmpv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_icmpv4_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_icmpv4_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_ICMPV4] == MAX_ICMPV4_FRAMES)) { return; }
 
 	//Set reference
 	cpc_icmpv4_hdr_t *icmpv4 = (cpc_icmpv4_hdr_t*)data; 
@@ -458,7 +474,7 @@ void parse_icmpv4(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_ipv6(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 	
-	if(unlikely(datalen < sizeof(cpc_ipv6_hdr_t))) { return; }
+	if(unlikely(datalen < sizeof(cpc_ipv6_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_IPV6] == MAX_IPV6_FRAMES)) { return; }
 	
 	//Set reference
 	cpc_ipv6_hdr_t *ipv6 = (cpc_ipv6_hdr_t*)data; 
@@ -531,7 +547,7 @@ void parse_ipv6(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 }
 
 void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datalen){
-	if (unlikely(datalen < sizeof(cpc_icmpv6_option_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_icmpv6_option_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_ICMPV6_OPT] == MAX_ICMPV6_OPT_FRAMES)) { return; }
 	/*So far we only parse optionsICMPV6_OPT_LLADDR_TARGET, ICMPV6_OPT_LLADDR_SOURCE and ICMPV6_OPT_PREFIX_INFO*/
 	cpc_icmpv6_option_hdr_t* icmpv6_opt = (cpc_icmpv6_option_hdr_t*)data;
 	
@@ -541,6 +557,7 @@ void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datal
 	//we asume here that there is only one option for each type
 	switch(icmpv6_opt->type){
 		case ICMPV6_OPT_LLADDR_SOURCE:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_lla_option))) { return; }
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_SOURCE].frame = icmpv6_opt;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_SOURCE].present = true;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_SOURCE].length = datalen;
@@ -552,6 +569,7 @@ void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datal
 
 			break;
 		case ICMPV6_OPT_LLADDR_TARGET:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_lla_option))) { return; }
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_TARGET].frame = icmpv6_opt;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_TARGET].present = true;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_LLADDR_TARGET].length = datalen;
@@ -563,6 +581,7 @@ void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datal
 
 			break;
 		case ICMPV6_OPT_PREFIX_INFO:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_prefix_info))) { return; }
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_PREFIX_INFO].frame = icmpv6_opt;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_PREFIX_INFO].present = true;
 			clas_state->headers[FIRST_ICMPV6_OPT_FRAME_POS + OFFSET_ICMPV6_OPT_PREFIX_INFO].length = datalen;
@@ -574,6 +593,9 @@ void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datal
 			get_icmpv6_pfx_aac_flag( (struct cpc_icmpv6_prefix_info *)icmpv6_opt );
 
 			break;
+		default:
+			//Options not parsed
+			return;
 	}
 	clas_state->num_of_headers[HEADER_TYPE_ICMPV6_OPT] = num_of_icmpv6_opt+1;
 
@@ -584,7 +606,7 @@ void parse_icmpv6_opts(classify_state_t* clas_state, uint8_t *data, size_t datal
 
 void parse_icmpv6(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_icmpv6_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_icmpv6_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_ICMPV6] == MAX_ICMPV6_FRAMES)) { return; }
 
 	cpc_icmpv6_hdr_t* icmpv6 = (cpc_icmpv6_hdr_t*)data;
 	
@@ -598,27 +620,33 @@ void parse_icmpv6(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 	//Initialize icmpv6 packet matches
 	clas_state->matches->__icmpv6_code = get_icmpv6_code(icmpv6);
 	clas_state->matches->__icmpv6_type = get_icmpv6_type(icmpv6);
-	clas_state->matches->__ipv6_nd_target = get_icmpv6_neighbor_taddr(icmpv6);
 	
 	//Increment pointers and decrement remaining payload size (depending on type)
 	switch(clas_state->matches->__icmpv6_type){
 		case ICMPV6_TYPE_ROUTER_SOLICATION:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_router_solicitation_hdr))) { return; }
 			data += sizeof(struct cpc_icmpv6_router_solicitation_hdr);
 			datalen -= sizeof(struct cpc_icmpv6_router_solicitation_hdr);
 			break;
 		case ICMPV6_TYPE_ROUTER_ADVERTISEMENT:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_router_advertisement_hdr))) { return; }
 			data += sizeof(struct cpc_icmpv6_router_advertisement_hdr);
 			datalen -= sizeof(struct cpc_icmpv6_router_advertisement_hdr);
 			break;
 		case ICMPV6_TYPE_NEIGHBOR_SOLICITATION:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_neighbor_solicitation_hdr))) { return; }
+			clas_state->matches->__ipv6_nd_target = get_icmpv6_neighbor_taddr(icmpv6);
 			data += sizeof(struct cpc_icmpv6_neighbor_solicitation_hdr);
 			datalen -= sizeof(struct cpc_icmpv6_neighbor_solicitation_hdr);
 			break;
 		case ICMPV6_TYPE_NEIGHBOR_ADVERTISEMENT:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_neighbor_advertisement_hdr))) { return; }
+			clas_state->matches->__ipv6_nd_target = get_icmpv6_neighbor_taddr(icmpv6);
 			data += sizeof(struct cpc_icmpv6_neighbor_advertisement_hdr);
 			datalen -= sizeof(struct cpc_icmpv6_neighbor_advertisement_hdr);
 			break;
 		case ICMPV6_TYPE_REDIRECT_MESSAGE:
+			if (unlikely(datalen < sizeof(struct cpc_icmpv6_redirect_hdr))) { return; }
 			data += sizeof(struct cpc_icmpv6_redirect_hdr);
 			datalen -= sizeof(struct cpc_icmpv6_redirect_hdr);
 			break;
@@ -637,7 +665,7 @@ void parse_icmpv6(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 }
 
 void parse_tcp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
-	if (unlikely(datalen < sizeof(cpc_tcp_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_tcp_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_TCP] == MAX_TCP_FRAMES)) { return; }
 
 	cpc_tcp_hdr_t* tcp = (cpc_tcp_hdr_t*)data;
 	
@@ -663,7 +691,7 @@ void parse_tcp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_udp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_udp_hdr_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_udp_hdr_t) || clas_state->num_of_headers[HEADER_TYPE_UDP] == MAX_UDP_FRAMES)) { return; }
 
 	cpc_udp_hdr_t *udp = (cpc_udp_hdr_t*)data; 
 	
@@ -698,7 +726,7 @@ void parse_udp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
 void parse_gtp(classify_state_t* clas_state, uint8_t *data, size_t datalen){
 
-	if (unlikely(datalen < sizeof(cpc_gtphu_t))) { return; }
+	if (unlikely(datalen < sizeof(cpc_gtphu_t) || clas_state->num_of_headers[HEADER_TYPE_GTP] == MAX_GTP_FRAMES)) { return; }
 
 	cpc_gtphu_t *gtp = (cpc_gtphu_t*)data; 
 		
@@ -770,8 +798,10 @@ void pop_vlan(datapacket_t* pkt, classify_state_t* clas_state){
 
 	uint16_t ether_type = get_vlan_type(vlan);
 	
-	//Take header out from packet
-	pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_vlan_hdr_t));
+	//Take header out from packet (only ether(0) is moved)
+	if(pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_vlan_hdr_t)) == ROFL_FAILURE)
+		return;
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 
 	//Take header out from classifier state
 	pop_header(clas_state, HEADER_TYPE_VLAN, FIRST_VLAN_FRAME_POS, FIRST_VLAN_FRAME_POS+MAX_VLAN_FRAMES);
@@ -800,7 +830,9 @@ void pop_mpls(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_ty
 	//Recover the ether(0)
 	//ether_header = (cpc_eth_hdr_t*) ether(clas_state,0);
 	
-	pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_mpls_hdr_t));
+	if(pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_mpls_hdr_t)) == ROFL_FAILURE)
+		return;
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 
 	//Take header out
 	pop_header(clas_state, HEADER_TYPE_MPLS, FIRST_MPLS_FRAME_POS, FIRST_MPLS_FRAME_POS+MAX_MPLS_FRAMES);
@@ -822,12 +854,11 @@ void pop_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_t
 	switch (get_ether_type(ether_header)) {
 		case ETH_TYPE_PPPOE_DISCOVERY:
 		{
-			pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_pppoe_hdr_t));
+			if(pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t), sizeof(cpc_pppoe_hdr_t)) == ROFL_FAILURE)
+				return;
 			if (get_pppoe_hdr(clas_state, 0)) {
 				//Take header out
 				pop_header(clas_state, HEADER_TYPE_PPPOE, FIRST_PPPOE_FRAME_POS, FIRST_PPPOE_FRAME_POS+MAX_PPPOE_FRAMES);
-
-				pop_header(clas_state, HEADER_TYPE_PPP, FIRST_PPP_FRAME_POS, FIRST_PPP_FRAME_POS+MAX_PPP_FRAMES);
 			}
 			shift_ether(clas_state, 0, sizeof(cpc_pppoe_hdr_t));// shift right
 		}
@@ -835,7 +866,8 @@ void pop_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_t
 
 		case ETH_TYPE_PPPOE_SESSION:
 		{
-			pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t),sizeof(cpc_pppoe_hdr_t) + sizeof(cpc_ppp_hdr_t));
+			if(pkt_pop(pkt, NULL,/*offset=*/sizeof(cpc_eth_hdr_t),sizeof(cpc_pppoe_hdr_t) + sizeof(cpc_ppp_hdr_t)) == ROFL_FAILURE)
+				return;
 			if (get_pppoe_hdr(clas_state, 0)) {
 				pop_header(clas_state, HEADER_TYPE_PPPOE, FIRST_PPPOE_FRAME_POS, FIRST_PPPOE_FRAME_POS+MAX_PPPOE_FRAMES);
 			}
@@ -847,52 +879,133 @@ void pop_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_t
 		break;
 	}
 
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 	set_ether_type(get_ether_hdr(clas_state,0), ether_type);
 	//ether_header->reset(ether_header->soframe(), ether_header->framelen() - sizeof(struct rofl::fpppoeframe::pppoe_hdr_t));
 }
 
+//Shift the headers in front of l3 (the L2 headers), used when bytes are pushed/popped right before l3
+static void shift_l2_headers(classify_state_t* clas_state, uint8_t* l3, ssize_t bytes){
+	unsigned int i;
+
+	for(i=0;i<MAX_HEADERS;i++){
+		if(clas_state->headers[i].present && (uint8_t*)clas_state->headers[i].frame < l3){
+			clas_state->headers[i].frame = (uint8_t*)(clas_state->headers[i].frame) + bytes;
+			clas_state->headers[i].length -= bytes;
+		}
+	}
+}
+
+//Drop the classification state of L3 and upper layers
+static void reset_l3_headers(classify_state_t* clas_state){
+	unsigned int i;
+
+	for(i=FIRST_ARPV4_FRAME_POS;i<FIRST_PPPOE_FRAME_POS;i++)
+		clas_state->headers[i].present = false;
+	for(i=FIRST_GTP_FRAME_POS;i<FIRST_GTP_FRAME_POS+MAX_GTP_FRAMES;i++)
+		clas_state->headers[i].present = false;
+
+	for(i=HEADER_TYPE_ARPV4;i<=HEADER_TYPE_SCTP;i++)
+		clas_state->num_of_headers[i] = 0;
+	clas_state->num_of_headers[HEADER_TYPE_GTP] = 0;
+}
+
+//Clear the L3/L4 (and GTP) matches, before parsing another L3 header
+static void reset_l3_matches(classify_state_t* clas_state){
+	packet_matches_t* matches = clas_state->matches;
+
+	matches->__arp_opcode = 0;
+	matches->__arp_sha = matches->__arp_tha = 0;
+	matches->__arp_spa = matches->__arp_tpa = 0;
+
+	matches->__ip_proto = matches->__ip_dscp = matches->__ip_ecn = 0;
+	matches->__ipv4_src = matches->__ipv4_dst = 0;
+	matches->__icmpv4_type = matches->__icmpv4_code = 0;
+
+	memset(&matches->__ipv6_src, 0, sizeof(matches->__ipv6_src));
+	memset(&matches->__ipv6_dst, 0, sizeof(matches->__ipv6_dst));
+	memset(&matches->__ipv6_nd_target, 0, sizeof(matches->__ipv6_nd_target));
+	matches->__ipv6_flabel = 0;
+	matches->__ipv6_nd_sll = matches->__ipv6_nd_tll = 0;
+	matches->__icmpv6_type = matches->__icmpv6_code = 0;
+
+	matches->__tcp_src = matches->__tcp_dst = 0;
+	matches->__udp_src = matches->__udp_dst = 0;
+
+	matches->__gtp_msg_type = 0;
+	matches->__gtp_teid = 0;
+}
+
+//Set the ether type of the innermost L2 header
+static void set_l2_ether_type(classify_state_t* clas_state, uint16_t ether_type){
+	void* vlan = get_vlan_hdr(clas_state, -1);
+
+	if(vlan){
+		set_vlan_type(vlan, ether_type);
+	}else{
+		set_ether_type(get_ether_hdr(clas_state, 0), ether_type);
+		clas_state->matches->__eth_type = ether_type;
+	}
+	clas_state->eth_type = ether_type;
+}
+
+/*
+* Removes the outer IPv4/UDP/GTP-U headers. If ether_type is 0 it is derived
+* from the version of the inner IP packet. Only the L2 headers are moved and
+* only the inner packet (T-PDU) is parsed.
+*/
 void pop_gtp(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_type){
-	// assumption: UDP -> GTP
+	uint8_t *ether, *ipv4, *gtp, *inner;
+	size_t offset, pop_length, inner_len;
 
-	// an ip header must be present
-	if((clas_state->num_of_headers[HEADER_TYPE_IPV4] == 0) || (!clas_state->headers[FIRST_IPV4_FRAME_POS].present) || (clas_state->num_of_headers[HEADER_TYPE_IPV4] > 1))
+	// assumption: IPv4 -> UDP -> GTP
+	ether = (uint8_t*)get_ether_hdr(clas_state, 0);
+	ipv4 = (uint8_t*)get_ipv4_hdr(clas_state, 0);
+	gtp = (uint8_t*)get_gtpu_hdr(clas_state, 0);
+
+	if(!ether || !ipv4 || !get_udp_hdr(clas_state, 0) || !gtp)
 		return;
 
-	// a udp header must be present
-	if((clas_state->num_of_headers[HEADER_TYPE_UDP] == 0) || (!clas_state->headers[FIRST_UDP_FRAME_POS].present) || (clas_state->num_of_headers[HEADER_TYPE_UDP] > 1))
+	// determine effective length of the outer headers (GTP optional fields and extensions included)
+	offset = ipv4 - ether;
+	pop_length = (gtp - ipv4) + get_gtpu_hdr_length(gtp, clas_state->headers[FIRST_GTP_FRAME_POS].length);
+
+	if(unlikely(offset + pop_length >= get_buffer_length(pkt)))
 		return;
 
-	// a gtp header must be present
-	if(clas_state->num_of_headers[HEADER_TYPE_GTP] == 0 || !clas_state->headers[FIRST_GTP_FRAME_POS].present)
+	inner_len = get_buffer_length(pkt) - offset - pop_length;
+
+	//Remove bytes from packet (the L2 headers are moved forward)
+	if(pkt_pop(pkt, NULL, offset, pop_length) == ROFL_FAILURE)
 		return;
 
+	//The buffer may have been moved to user space; recover the reference
+	ipv4 = (uint8_t*)get_ipv4_hdr(clas_state, 0);
+	inner = ipv4 + pop_length;
 
-	// determine effective length of GTP header
-	size_t pop_length = sizeof(cpc_ipv4_hdr_t) + sizeof(cpc_udp_hdr_t);
-	//gtp(0)->get_hdr_length(); // based on flags set to 1 in GTP header
+	shift_l2_headers(clas_state, ipv4, pop_length); //shift right
+	reset_l3_headers(clas_state);
 
-	//Remove bytes from packet
-	pkt_pop(pkt, get_ipv4_hdr(clas_state, 0), 0, pop_length);
+	if(ether_type == 0)
+		ether_type = ((inner[0] >> 4) == 6)? ETH_TYPE_IPV6 : ETH_TYPE_IPV4;
 
-	//Take headers out
-	pop_header(clas_state, HEADER_TYPE_GTP, FIRST_GTP_FRAME_POS, FIRST_GTP_FRAME_POS+MAX_GTP_FRAMES);
-	pop_header(clas_state, HEADER_TYPE_UDP, FIRST_UDP_FRAME_POS, FIRST_UDP_FRAME_POS+MAX_UDP_FRAMES);
-	pop_header(clas_state, HEADER_TYPE_IPV4, FIRST_IPV4_FRAME_POS, FIRST_IPV4_FRAME_POS+MAX_IPV4_FRAMES);
+	set_l2_ether_type(clas_state, ether_type);
 
-	int i;
-	for ( i = MAX_VLAN_FRAMES-1; i >= 0; ++i) {
-		shift_vlan(clas_state, i, pop_length); //shift_right
-		//vlan(i)->reset(vlan(i)->soframe(), vlan(i)->framelen() - pop_length);
-	}
-	for ( i = MAX_ETHER_FRAMES-1; i >= 0; ++i) {
-		shift_ether(clas_state, i, pop_length);//shift_right
-		//ether(i)->reset(ether(i)->soframe(), ether(i)->framelen() - pop_length);
-	}
+	//Outer L3/L4/GTP matches are no longer valid (the inner packet may
+	//not be of the same IP version)
+	reset_l3_matches(clas_state);
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 
-	if (get_vlan_hdr(clas_state, -1)) {
-		set_vlan_type(get_vlan_hdr(clas_state, -1), ether_type);
-	} else {
-		set_ether_type(get_ether_hdr(clas_state, -1), ether_type);
+	//Parse the inner packet only
+	switch(ether_type){
+		case ETH_TYPE_IPV4:
+			parse_ipv4(clas_state, inner, inner_len);
+			break;
+		case ETH_TYPE_IPV6:
+			parse_ipv6(clas_state, inner, inner_len);
+			break;
+		default:
+			break;
 	}
 }
 
@@ -903,9 +1016,9 @@ void push_header(classify_state_t* clas_state, enum header_type type, unsigned i
 	if(clas_state->headers[start].present){
 		header_container_t copy = clas_state->headers[end-1];
 		
-		//Rotate frames (push them)
-		for(i=start;i<end-1;i++){
-			clas_state->headers[i] = clas_state->headers[i+1];
+		//Rotate frames (push them); the outermost becomes start+1
+		for(i=end-1;i>start;i--){
+			clas_state->headers[i] = clas_state->headers[i-1];
 		}
 
 		clas_state->headers[start] = copy;
@@ -945,7 +1058,7 @@ void* push_vlan(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 	 * adjust ether(0): move one vlan tag to the left
 	 */
 	shift_ether(clas_state, 0, 0-sizeof(cpc_vlan_hdr_t)); // shift left
-	ether_header-=sizeof(cpc_vlan_hdr_t); //We change also the local pointer
+	ether_header = get_ether_hdr(clas_state, 0); //Recover it, the buffer may have been moved to user space
 	
 	/*
 	 * append the new fvlanframe 
@@ -954,7 +1067,8 @@ void* push_vlan(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 	
 	//Now reset frame 
 	clas_state->headers[FIRST_VLAN_FRAME_POS].frame = ether_header + sizeof(cpc_eth_hdr_t);
-	clas_state->headers[FIRST_VLAN_FRAME_POS].length =  get_buffer_length(pkt) + sizeof(cpc_vlan_hdr_t) - sizeof(cpc_eth_hdr_t);
+	clas_state->headers[FIRST_VLAN_FRAME_POS].length = get_buffer_length(pkt) - sizeof(cpc_eth_hdr_t);
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 	//ether_header->reset(ether_header->soframe(), current_length + sizeof(struct rofl::fvlanframe::vlan_hdr_t));
 	//headers[FIRST_VLAN_FRAME_POS].frame->reset(ether_header->soframe() + sizeof(struct rofl::fetherframe::eth_hdr_t), current_length + sizeof(struct rofl::fvlanframe::vlan_hdr_t) - sizeof(struct rofl::fetherframe::eth_hdr_t));
 
@@ -987,6 +1101,8 @@ void* push_mpls(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 		assert(0);	//classify(clas_state);
 		return NULL;
 	}
+	if(clas_state->num_of_headers[HEADER_TYPE_MPLS] == MAX_MPLS_FRAMES)
+		return NULL;
 	//Recover the ether(0)
 	ether_header = get_ether_hdr(clas_state, 0);
 	//current_length = ether_header->framelen(); 
@@ -994,7 +1110,7 @@ void* push_mpls(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 	/*
 	 * this invalidates ether(0), as it shifts ether(0) to the left
 	 */
-	if (pkt_push(pkt, (void*)(ether_header + sizeof(cpc_eth_hdr_t)),0 , sizeof(cpc_mpls_hdr_t)) == ROFL_FAILURE){
+	if (pkt_push(pkt, NULL, sizeof(cpc_eth_hdr_t), sizeof(cpc_mpls_hdr_t)) == ROFL_FAILURE){
 		// TODO: log error
 		return 0;
 	}
@@ -1003,7 +1119,7 @@ void* push_mpls(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 	 * adjust ether(0): move one mpls tag to the left
 	 */
 	shift_ether(clas_state, 0, 0-sizeof(cpc_mpls_hdr_t));//shift left
-	ether_header-=sizeof(cpc_mpls_hdr_t); //We change also the local pointer
+	ether_header = get_ether_hdr(clas_state, 0); //Recover it, the buffer may have been moved to user space
 
 	/*
 	 * append the new fmplsframe instance to ether(0)
@@ -1014,7 +1130,8 @@ void* push_mpls(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_
 	clas_state->headers[FIRST_MPLS_FRAME_POS].frame = ether_header + sizeof(cpc_eth_hdr_t);
 	//Size of ethernet needs to be extended with + MPLS size 
 	//MPLS size needs to be ether_header->size + MPLS - ether_header
-	clas_state->headers[FIRST_MPLS_FRAME_POS].length = get_buffer_length(pkt) + sizeof(cpc_mpls_hdr_t) - sizeof(cpc_eth_hdr_t);
+	clas_state->headers[FIRST_MPLS_FRAME_POS].length = get_buffer_length(pkt) - sizeof(cpc_eth_hdr_t);
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
 	//ether_header->reset(ether_header->soframe(), current_length + sizeof(struct rofl::fmplsframe::mpls_hdr_t));
 	//headers[FIRST_MPLS_FRAME_POS].frame->reset(ether_header->soframe() + sizeof(struct rofl::fetherframe::eth_hdr_t), current_length + sizeof(struct rofl::fmplsframe::mpls_hdr_t) - sizeof(struct rofl::fetherframe::eth_hdr_t));
 
@@ -1085,8 +1202,8 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 			/*
 			 * adjust ether(0): move one pppoe tag to the left
 			 */
-			shift_ether(clas_state, 0, 0-bytes_to_insert); // shift left
-			ether_header-=bytes_to_insert; //We change also the local pointer
+			shift_ether(clas_state, 0, -(ssize_t)bytes_to_insert); // shift left
+			ether_header = get_ether_hdr(clas_state, 0); //Recover it, the buffer may have been moved to user space
 			set_ether_type(ether_header, ETH_TYPE_PPPOE_SESSION);
 
 			/*
@@ -1097,9 +1214,9 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 	
 			//Now reset frames
 			clas_state->headers[FIRST_PPPOE_FRAME_POS].frame = ether_header + sizeof(cpc_eth_hdr_t);
-			clas_state->headers[FIRST_PPPOE_FRAME_POS].length = get_buffer_length(pkt) + sizeof(cpc_pppoe_hdr_t) - sizeof(cpc_eth_hdr_t);
+			clas_state->headers[FIRST_PPPOE_FRAME_POS].length = get_buffer_length(pkt) - sizeof(cpc_eth_hdr_t);
 			clas_state->headers[FIRST_PPP_FRAME_POS].frame = ether_header + sizeof(cpc_eth_hdr_t) + sizeof(cpc_pppoe_hdr_t);
-			clas_state->headers[FIRST_PPP_FRAME_POS].length = get_buffer_length(pkt) + sizeof(cpc_ppp_hdr_t) - sizeof(cpc_eth_hdr_t) - sizeof(cpc_pppoe_hdr_t);
+			clas_state->headers[FIRST_PPP_FRAME_POS].length = get_buffer_length(pkt) - sizeof(cpc_eth_hdr_t) - sizeof(cpc_pppoe_hdr_t);
 			//ether_header->reset(ether_header->soframe(), current_length + bytes_to_insert);
 			//n_pppoe->reset(ether_header->soframe() + sizeof(struct rofl::fetherframe::eth_hdr_t), ether_header->framelen() - sizeof(struct rofl::fetherframe::eth_hdr_t) );
 			//n_ppp->reset(n_pppoe->soframe() + sizeof(struct rofl::fpppoeframe::pppoe_hdr_t), n_pppoe->framelen() - sizeof(struct rofl::fpppoeframe::pppoe_hdr_t));
@@ -1121,7 +1238,7 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 			/*
 			 * this invalidates ether(0), as it shifts ether(0) to the left
 			 */
-			if (pkt_push(pkt, (void*)(ether_header+sizeof(cpc_eth_hdr_t)),0, bytes_to_insert) == ROFL_FAILURE){
+			if (pkt_push(pkt, NULL, sizeof(cpc_eth_hdr_t), bytes_to_insert) == ROFL_FAILURE){
 				// TODO: log error
 				return NULL;
 			}
@@ -1129,8 +1246,8 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 			/*
 			 * adjust ether(0): move one pppoe tag to the left
 			 */
-			shift_ether(clas_state, 0, 0-bytes_to_insert);//shift left
-			ether_header-=bytes_to_insert; //We change also the local pointer
+			shift_ether(clas_state, 0, -(ssize_t)bytes_to_insert);//shift left
+			ether_header = get_ether_hdr(clas_state, 0); //Recover it, the buffer may have been moved to user space
 			set_ether_type(get_ether_hdr(clas_state, 0), ETH_TYPE_PPPOE_DISCOVERY);
 
 			/*
@@ -1141,7 +1258,7 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 			clas_state->headers[FIRST_PPPOE_FRAME_POS].frame = ether_header + sizeof(cpc_eth_hdr_t);
 			//Size of ethernet needs to be extended with +PPPOE size 
 			//PPPOE size needs to be ether_header->size + PPPOE - ether_header
-			clas_state->headers[FIRST_PPPOE_FRAME_POS].length = get_buffer_length(pkt) + sizeof(cpc_pppoe_hdr_t) - sizeof(cpc_eth_hdr_t);
+			clas_state->headers[FIRST_PPPOE_FRAME_POS].length = get_buffer_length(pkt) - sizeof(cpc_eth_hdr_t);
 			//ether_header->reset(ether_header->soframe(), current_length + sizeof(struct rofl::fpppoeframe::pppoe_hdr_t));
 			//headers[FIRST_PPPOE_FRAME_POS].frame->reset(ether_header->soframe() + sizeof(struct rofl::fetherframe::eth_hdr_t), current_length + sizeof(struct rofl::fpppoeframe::pppoe_hdr_t) - sizeof(struct rofl::fetherframe::eth_hdr_t));
 
@@ -1152,6 +1269,11 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 			break;
 	}
 
+	if(!n_pppoe)
+		return NULL;
+
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
+
 	/*
 	 * set default values in pppoe tag
 	 */
@@ -1163,8 +1285,134 @@ void* push_pppoe(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether
 	return NULL;
 }
 
+//Default GTP-U template: 0.0.0.0 -> 0.0.0.0, DF, TTL 64, UDP 2152 -> 2152, G-PDU, TEID 0
+static const gtpu_tunnel_tmpl_t gtpu_default_tmpl = {
+	.hdr = {
+		//IPv4
+		0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00,
+		0x40, UDP_IP_PROTO, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		//UDP
+		0x08, 0x68, 0x08, 0x68, 0x00, 0x00, 0x00, 0x00,
+		//GTP-U (version 1, PT=1, G-PDU)
+		0x30, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	.ipv4_partial_csum = 0x4500 + 0x4000 + ((0x40 << 8) | UDP_IP_PROTO),
+};
+
+void init_gtpu_tunnel_tmpl(gtpu_tunnel_tmpl_t* tmpl, uint32_t ipv4_src, uint32_t ipv4_dst, uint16_t udp_sport, uint32_t teid, uint8_t ttl, uint8_t dscp){
+	unsigned int i;
+	uint16_t* word16;
+	void *ipv4, *udp, *gtp;
+
+	memcpy(tmpl, &gtpu_default_tmpl, sizeof(gtpu_tunnel_tmpl_t));
+
+	ipv4 = tmpl->hdr;
+	udp = tmpl->hdr + sizeof(cpc_ipv4_hdr_t);
+	gtp = tmpl->hdr + sizeof(cpc_ipv4_hdr_t) + sizeof(cpc_udp_hdr_t);
+
+	set_ipv4_src(ipv4, ipv4_src);
+	set_ipv4_dst(ipv4, ipv4_dst);
+	set_ipv4_ttl(ipv4, ttl);
+	set_ipv4_dscp(ipv4, dscp);
+	set_udp_sport(udp, udp_sport);
+	set_gtpu_teid(gtp, teid);
+
+	//Partial checksum (length and checksum are 0 in the template)
+	word16 = (uint16_t*)ipv4;
+	tmpl->ipv4_partial_csum = 0;
+	for(i=0;i<sizeof(cpc_ipv4_hdr_t)/sizeof(uint16_t);i++)
+		tmpl->ipv4_partial_csum += NTOHB16(word16[i]);
+}
+
+/*
+* Encapsulates the L3 packet in a GTP-U tunnel using the outer headers of
+* tmpl. The outer headers are written into the headroom (only the L2 headers
+* are moved) and the IPv4 checksum is completed from the template partial sum.
+*/
+void* push_gtp_tmpl(datapacket_t* pkt, classify_state_t* clas_state, const gtpu_tunnel_tmpl_t* tmpl, uint16_t ether_type){
+	uint8_t *ether, *l3, *outer;
+	size_t offset, ip_len;
+	uint32_t sum;
+	header_container_t* header;
+
+	if(!clas_state->is_classified || get_gtpu_hdr(clas_state, 0))
+		return NULL;
+
+	if(clas_state->num_of_headers[HEADER_TYPE_IPV4] == MAX_IPV4_FRAMES || clas_state->num_of_headers[HEADER_TYPE_UDP] == MAX_UDP_FRAMES)
+		return NULL;
+
+	//T-PDU must be an IP packet
+	ether = (uint8_t*)get_ether_hdr(clas_state, 0);
+	l3 = (uint8_t*)get_ipv4_hdr(clas_state, 0);
+	if(!l3)
+		l3 = (uint8_t*)get_ipv6_hdr(clas_state, 0);
+	if(!ether || !l3)
+		return NULL;
+
+	offset = l3 - ether;
+
+	if(pkt_push(pkt, NULL, offset, GTPU_TUNNEL_HDR_LEN) == ROFL_FAILURE)
+		return NULL;
+
+	//The buffer may have been moved to user space; recover the reference
+	l3 = (uint8_t*)get_ipv4_hdr(clas_state, 0);
+	if(!l3)
+		l3 = (uint8_t*)get_ipv6_hdr(clas_state, 0);
+
+	shift_l2_headers(clas_state, l3, -(ssize_t)GTPU_TUNNEL_HDR_LEN); //shift left
+
+	//Outer headers
+	outer = l3 - GTPU_TUNNEL_HDR_LEN;
+	memcpy(outer, tmpl->hdr, GTPU_TUNNEL_HDR_LEN);
+
+	ip_len = get_buffer_length(pkt) - offset;
+
+	set_ipv4_length(outer, HTONB16(ip_len));
+	sum = tmpl->ipv4_partial_csum + ip_len;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	((cpc_ipv4_hdr_t*)outer)->checksum = HTONB16((uint16_t)~sum);
+
+	set_udp_length(outer + sizeof(cpc_ipv4_hdr_t), HTONB16(ip_len - sizeof(cpc_ipv4_hdr_t)));
+	set_gtpu_length(outer + sizeof(cpc_ipv4_hdr_t) + sizeof(cpc_udp_hdr_t), HTONB16(ip_len - GTPU_TUNNEL_HDR_LEN));
+
+	//Classifier state; previous IPv4/UDP headers become the inner ones
+	push_header(clas_state, HEADER_TYPE_IPV4, FIRST_IPV4_FRAME_POS, FIRST_IPV4_FRAME_POS+MAX_IPV4_FRAMES);
+	header = &clas_state->headers[FIRST_IPV4_FRAME_POS];
+	header->frame = outer;
+	header->length = ip_len;
+
+	push_header(clas_state, HEADER_TYPE_UDP, FIRST_UDP_FRAME_POS, FIRST_UDP_FRAME_POS+MAX_UDP_FRAMES);
+	header = &clas_state->headers[FIRST_UDP_FRAME_POS];
+	header->frame = outer + sizeof(cpc_ipv4_hdr_t);
+	header->length = ip_len - sizeof(cpc_ipv4_hdr_t);
+
+	push_header(clas_state, HEADER_TYPE_GTP, FIRST_GTP_FRAME_POS, FIRST_GTP_FRAME_POS+MAX_GTP_FRAMES);
+	header = &clas_state->headers[FIRST_GTP_FRAME_POS];
+	header->frame = outer + sizeof(cpc_ipv4_hdr_t) + sizeof(cpc_udp_hdr_t);
+	header->length = ip_len - sizeof(cpc_ipv4_hdr_t) - sizeof(cpc_udp_hdr_t);
+
+	set_l2_ether_type(clas_state, ether_type);
+
+	//Matches now refer to the outer headers
+	clas_state->matches->__ip_proto = UDP_IP_PROTO;
+	clas_state->matches->__ip_dscp = get_ipv4_dscp(outer);
+	clas_state->matches->__ip_ecn = get_ipv4_ecn(outer);
+	clas_state->matches->__ipv4_src = get_ipv4_src(outer);
+	clas_state->matches->__ipv4_dst = get_ipv4_dst(outer);
+	clas_state->matches->__udp_src = get_udp_sport(outer + sizeof(cpc_ipv4_hdr_t));
+	clas_state->matches->__udp_dst = get_udp_dport(outer + sizeof(cpc_ipv4_hdr_t));
+	clas_state->matches->__gtp_msg_type = get_gtpu_msg_type(clas_state->headers[FIRST_GTP_FRAME_POS].frame);
+	clas_state->matches->__gtp_teid = get_gtpu_teid(clas_state->headers[FIRST_GTP_FRAME_POS].frame);
+	clas_state->matches->__pkt_size_bytes = get_buffer_length(pkt);
+
+	return clas_state->headers[FIRST_GTP_FRAME_POS].frame;
+}
+
 void* push_gtp(datapacket_t* pkt, classify_state_t* clas_state, uint16_t ether_type){
-	return NULL;
+	return push_gtp_tmpl(pkt, clas_state, &gtpu_default_tmpl, ether_type);
 }
 
 void dump_pkt_classifier(classify_state_t* clas_state){
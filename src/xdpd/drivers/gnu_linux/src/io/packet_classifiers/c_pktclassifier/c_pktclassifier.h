@@ -153,6 +153,26 @@ typedef struct classify_state{
 	packet_matches_t* matches; 
 }classify_state_t;
 
+//GTP-U tunnel encapsulation (outer IPv4, UDP and GTP-U headers, no optional fields)
+#define GTPU_TUNNEL_HDR_LEN (sizeof(cpc_ipv4_hdr_t) + sizeof(cpc_udp_hdr_t) + sizeof(struct cpc_gtpu_base_hdr_t))
+
+/**
+* @brief Precomputed outer headers of a GTP-U tunnel endpoint
+*
+* The headers are copied as-is in front of the payload; only the length
+* fields and the IPv4 checksum are fixed up per packet. ipv4_partial_csum
+* holds the (unfolded, host byte order) sum of the IPv4 header words with
+* the length and checksum fields set to 0.
+*/
+typedef struct gtpu_tunnel_tmpl{
+	uint8_t hdr[GTPU_TUNNEL_HDR_LEN];
+	uint32_t ipv4_partial_csum;
+}gtpu_tunnel_tmpl_t;
+
+//Addresses, port and teid in network byte order
+void init_gtpu_tunnel_tmpl(gtpu_tunnel_tmpl_t* tmpl, uint32_t ipv4_src, uint32_t ipv4_dst, uint16_t udp_sport, uint32_t teid, uint8_t ttl, uint8_t dscp);
+void* push_gtp_tmpl(datapacket_t* pkt, classify_state_t* clas_state, const gtpu_tunnel_tmpl_t* tmpl, uint16_t ether_type);
+
 
 //inline function implementations
 inline static 
@@ -458,7 +478,7 @@ void shift_ether(classify_state_t* clas_state, int idx, ssize_t bytes){
 	//Return the index
 	if(clas_state->headers[pos].present){
 		clas_state->headers[pos].frame = (uint8_t*)(clas_state->headers[pos].frame) + bytes;
-		clas_state->headers[pos].length += bytes;
+		clas_state->headers[pos].length -= bytes;
 	}
 }
 
@@ -478,7 +498,7 @@ void shift_vlan(classify_state_t* clas_state, int idx, ssize_t bytes){
 	//Return the index
 	if(clas_state->headers[pos].present){
 		clas_state->headers[pos].frame = (uint8_t*)(clas_state->headers[pos].frame) + bytes;
-		clas_state->headers[pos].length += bytes;
+		clas_state->headers[pos].length -= bytes;
 	}
 }
 
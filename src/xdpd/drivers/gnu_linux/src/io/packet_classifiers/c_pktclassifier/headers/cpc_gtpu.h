@@ -221,4 +221,34 @@ void set_gtpu_ext_type(void *hdr, uint8_t exthdr){
 	((cpc_gtphu_t *)hdr)->cpc_gtpu_e_hdr.exthdr = exthdr;
 };
 
+//Length of the GTP-U header, including the optional fields and the extension headers
+inline static
+size_t get_gtpu_hdr_length(void *hdr, size_t datalen){
+	uint8_t* ptr = (uint8_t*)hdr;
+	size_t len = sizeof(struct cpc_gtpu_base_hdr_t);
+	size_t ext_len;
+	uint8_t next;
+
+	if(!(ptr[0] & (GTPU_E_FLAG | GTPU_S_FLAG | GTPU_PN_FLAG)))
+		return len;
+
+	//seqno, N-PDU number and next extension header type are present if any of the flags is set
+	len += sizeof(uint16_t) + 2*sizeof(uint8_t);
+
+	if(!(ptr[0] & GTPU_E_FLAG))
+		return len;
+
+	//Extension headers; length is expressed in 4 byte units
+	next = ((cpc_gtphu_t *)hdr)->cpc_gtpu_e_hdr.exthdr;
+	while(next && len < datalen){
+		ext_len = ptr[len]*4;
+		if(unlikely(ext_len == 0 || (len + ext_len) > datalen))
+			break;
+		len += ext_len;
+		next = ptr[len-1];
+	}
+
+	return len;
+};
+
 #endif //_CPC_GTPU_H_
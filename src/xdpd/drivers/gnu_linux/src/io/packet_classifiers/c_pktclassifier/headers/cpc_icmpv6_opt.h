@@ -5,6 +5,8 @@
 #ifndef _CPC_ICMPV6_OPT_H_
 #define _CPC_ICMPV6_OPT_H_
 
+#include <string.h>
+
 /**
 * @file cpc_icmpv6_opt.h
 * @author Victor Alvarez<victor.alvarez (at) bisdn.de>
@@ -110,26 +112,28 @@ void set_icmpv6_opt_type(void *hdr, uint8_t type){
 
 inline static
 uint64_t get_icmpv6_ll_taddr(void *hdr){
-	uint64_t *ret = (uint64_t*) &((cpc_icmpv6_lla_option_t*)hdr)->addr;
-	return (*ret) & OF1X_6_BYTE_MASK;
+	//The option may be the last bytes of the packet; do not read beyond addr
+	uint64_t ret = 0;
+	memcpy(&ret, ((cpc_icmpv6_lla_option_t*)hdr)->addr, ETHER_ADDR_LEN);
+	return ret;
 };
 
 inline static
 void set_icmpv6_ll_taddr(void *hdr, uint64_t taddr){
-	uint64_t *ptr = (uint64_t *) &((cpc_icmpv6_lla_option_t*)hdr)->addr;
-	*ptr = (taddr & OF1X_6_BYTE_MASK) | (*ptr & ~OF1X_6_BYTE_MASK);
+	memcpy(((cpc_icmpv6_lla_option_t*)hdr)->addr, &taddr, ETHER_ADDR_LEN);
 };
 
 inline static
 uint64_t get_icmpv6_ll_saddr(void *hdr){
-	uint64_t *ret = (uint64_t*) &((cpc_icmpv6_lla_option_t*)hdr)->addr;
-	return (*ret) & OF1X_6_BYTE_MASK;
+	//The option may be the last bytes of the packet; do not read beyond addr
+	uint64_t ret = 0;
+	memcpy(&ret, ((cpc_icmpv6_lla_option_t*)hdr)->addr, ETHER_ADDR_LEN);
+	return ret;
 };
 
 inline static
 void set_icmpv6_ll_saddr(void *hdr, uint64_t saddr){
-	uint64_t *ptr = (uint64_t *) &((cpc_icmpv6_lla_option_t*)hdr)->addr;
-	*ptr = (saddr & OF1X_6_BYTE_MASK) | (*ptr & ~OF1X_6_BYTE_MASK);
+	memcpy(((cpc_icmpv6_lla_option_t*)hdr)->addr, &saddr, ETHER_ADDR_LEN);
 };
 
 inline static
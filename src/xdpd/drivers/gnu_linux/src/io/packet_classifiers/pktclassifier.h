@@ -12,6 +12,9 @@ void destroy_classifier(struct classify_state* clas_state);
 void classify_packet(struct classify_state* clas_state, uint8_t* pkt, size_t len, uint32_t port_in, uint32_t phy_port_in);
 void reset_classifier(struct classify_state* clas_state);
 
+//Relocate all the classified headers (e.g. when the buffer has been moved)
+void shift_classifier(struct classify_state* clas_state, ssize_t bytes);
+
 //push & pop
 void pop_vlan(datapacket_t* pkt, struct classify_state* clas_state);
 void pop_mpls(datapacket_t* pkt, struct classify_state* clas_state, uint16_t ether_type);
@@ -0,0 +1,121 @@
+#include "pktin_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <new>
+#include "../util/likely.h"
+
+using namespace xdpd::gnu_linux;
+
+pktin_arena::pktin_arena(uint32_t size) :
+		head(0),
+		tail(0),
+		used(0),
+		failures(0)
+{
+	this->size = (size + PKTIN_ARENA_GRANULE - 1) & ~(PKTIN_ARENA_GRANULE - 1);
+
+	if(posix_memalign((void**)&base, PKTIN_ARENA_GRANULE, this->size) != 0)
+		throw std::bad_alloc();
+
+	pthread_mutex_init(&mutex, NULL);
+}
+
+pktin_arena::~pktin_arena(){
+	pthread_mutex_destroy(&mutex);
+	free(base);
+}
+
+//Must be called with the mutex held
+pktin_spill_t* pktin_arena::alloc(uint32_t chunk_size){
+
+	pktin_spill_t* pad;
+	uint32_t offset;
+
+	if(used == size)
+		return NULL;
+
+	if(head >= tail){
+		//Free space: [head, size) and [0, tail)
+		if(size - head >= chunk_size){
+			offset = head;
+		}else if(tail >= chunk_size){
+			//Pad the end of the ring; reclaimed with the chunk before it
+			pad = chunk(head);
+			pad->chunk_size = size - head;
+			pad->in_use = 0;
+			used += pad->chunk_size;
+			offset = 0;
+		}else{
+			return NULL;
+		}
+	}else{
+		//Free space: [head, tail)
+		if(tail - head < chunk_size)
+			return NULL;
+		offset = head;
+	}
+
+	head = offset + chunk_size;
+	if(head == size)
+		head = 0;
+	used += chunk_size;
+
+	return chunk(offset);
+}
+
+pktin_spill_t* pktin_arena::spill(const uint8_t* frame, uint32_t len, uint32_t in_port, uint32_t in_phy_port){
+
+	pktin_spill_t* spill;
+	uint32_t chunk_size = (sizeof(pktin_spill_t) + len + PKTIN_ARENA_GRANULE - 1) & ~(PKTIN_ARENA_GRANULE - 1);
+
+	pthread_mutex_lock(&mutex);
+	spill = alloc(chunk_size);
+	if(unlikely(!spill)){
+		failures++;
+		pthread_mutex_unlock(&mutex);
+		return NULL;
+	}
+	spill->chunk_size = chunk_size;
+	spill->in_use = 1;
+	pthread_mutex_unlock(&mutex);
+
+	//Copy outside of the lock
+	spill->in_port = in_port;
+	spill->in_phy_port = in_phy_port;
+	spill->len = len;
+	memcpy(spill->data, frame, len);
+
+	return spill;
+}
+
+void pktin_arena::release(pktin_spill_t* spill){
+
+	pktin_spill_t* oldest;
+
+	pthread_mutex_lock(&mutex);
+
+	assert(spill->in_use);
+	spill->in_use = 0;
+
+	//Reclaim from the tail
+	while(used){
+		oldest = chunk(tail);
+		if(oldest->in_use)
+			break;
+		used -= oldest->chunk_size;
+		tail += oldest->chunk_size;
+		if(tail == size)
+			tail = 0;
+	}
+
+	//Empty; start over at the beginning of the arena
+	if(!used)
+		head = tail = 0;
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void pktin_arena::dump_state(){
+	std::cerr << *this << std::endl;
+}
@@ -0,0 +1,119 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PKTIN_ARENA_H_
+#define PKTIN_ARENA_H_
+
+#include <iostream>
+#include <stdint.h>
+#include <pthread.h>
+#include <rofl.h>
+
+/**
+* @file pktin_arena.h
+*
+* @brief Compact (per LSI) memory for buffered PKT_INs.
+*
+*/
+
+namespace xdpd {
+namespace gnu_linux {
+
+/**
+* Copy of a buffered PKT_IN frame (spill). Everything that is needed to
+* rehydrate the packet into a bufferpool buffer on PACKET_OUT/FLOW_MOD.
+*/
+typedef struct pktin_spill{
+	//Arena internal; size of the chunk (bytes) and whether it is in use
+	uint32_t chunk_size;
+	uint32_t in_use;
+
+	//Packet
+	uint32_t in_port;
+	uint32_t in_phy_port;
+	uint32_t len;
+	uint8_t data[0];
+}pktin_spill_t;
+
+/**
+* @brief Arena where buffered PKT_INs are copied (spilled) to, so that the
+* RX buffer can be returned to the bufferpool right away, instead of being
+* pinned until the controller answers or the buffer expires.
+*
+* Chunks are sized to the frame (PKTIN_ARENA_GRANULE multiples) and carved
+* out of a ring: allocation happens at the head, and space is reclaimed
+* from the tail as soon as the oldest chunks are released. Since buffered
+* PKT_INs are released roughly in FIFO order (and expire in FIFO order),
+* fragmentation is bounded by the storage expiration time.
+*
+* @ingroup driver_gnu_linux_io
+*/
+class pktin_arena{
+
+public:
+	static const uint32_t PKTIN_ARENA_GRANULE = 64;
+
+	/**
+	* @param size Size in bytes (rounded up to PKTIN_ARENA_GRANULE)
+	*/
+	pktin_arena(uint32_t size);
+	~pktin_arena();
+
+	/**
+	* Copy a frame into the arena. Returns NULL if there is no room
+	*/
+	pktin_spill_t* spill(const uint8_t* frame, uint32_t len, uint32_t in_port, uint32_t in_phy_port);
+
+	/**
+	* Release a spill (after being rehydrated or expired)
+	*/
+	void release(pktin_spill_t* spill);
+
+	//Stats
+	uint32_t get_used() const { return used; }
+	uint32_t get_size() const { return size; }
+	uint64_t get_num_of_failures() const { return failures; }
+
+	//Used only for debugging purposes
+	void dump_state();
+
+	friend std::ostream&
+	operator<< (std::ostream& os, pktin_arena const& a) {
+		os << "<pktin_arena: ";
+			os << "size:" << a.size << " ";
+			os << "used:" << a.used << " ";
+			os << "head:" << a.head << " ";
+			os << "tail:" << a.tail << " ";
+			os << "failures:" << a.failures << " ";
+		os << ">";
+		return os;
+	};
+
+private:
+	uint8_t* base;
+	uint32_t size;
+
+	//Next chunk to allocate and oldest chunk (offsets)
+	uint32_t head;
+	uint32_t tail;
+
+	//Bytes in use (including padding at the end of the ring)
+	uint32_t used;
+
+	uint64_t failures;
+
+	pthread_mutex_t mutex;
+
+	inline pktin_spill_t* chunk(uint32_t offset){ return (pktin_spill_t*)(base + offset); }
+	pktin_spill_t* alloc(uint32_t chunk_size);
+
+	// this class is noncopyable
+	pktin_arena(const pktin_arena&);
+	pktin_arena& operator=(const pktin_arena&);
+};
+
+}// namespace xdpd::gnu_linux
+}// namespace xdpd
+
+#endif /* PKTIN_ARENA_H_ */
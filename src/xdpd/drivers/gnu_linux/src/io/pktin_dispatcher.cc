@@ -1,8 +1,10 @@
 #include "pktin_dispatcher.h"
 
 #include <unistd.h>
-#include <fcntl.h>
-#include <rofl/datapath/pipeline/physical_switch.h>
+#include <errno.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/of1x_async_events_hooks.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h>
@@ -15,32 +17,22 @@
 #include "../io/datapacketx86.h"
 #include "../io/datapacket_storage.h"
 #include "../processing/ls_internal_state.h"
+#include "../util/likely.h"
 
 using namespace xdpd::gnu_linux;
 
-#define BUCKETS_PER_LS 16
-#define DUMMY_BUF_SIZE 128
-#define ITERATIONS_PER_ROUND 2
+//Processes up to IO_PKT_IN_DISPATCHER_BURST pkt-ins; returns the number of pkt-ins dequeued
+static inline unsigned int process_sw_of1x_packet_ins(of1x_switch_t* sw, switch_platform_state_t* ls_int){
 
-int pktin_not_pipe[2];
-
-//Processes the pkt_ins up to BUCKETS_PER_LS 
-static inline void process_sw_of1x_packet_ins(of1x_switch_t* sw){
-
-	int ret;
 	unsigned int i;
 	datapacket_t* pkt;
 	datapacketx86* pkt_x86;
 	hal_result_t rv;
 	storeid id;
-	static char null_buf[DUMMY_BUF_SIZE];
-	static unsigned int pending_to_read=0;
+	pktin_spill_t* spill;
 	
-	//Recover platform state
-	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
-
-	//Try to process up to BUCKETS_PER_LS packet-ins
-	for(i=0;i<BUCKETS_PER_LS;++i){
+	//Try to process up to IO_PKT_IN_DISPATCHER_BURST packet-ins
+	for(i=0;i<IO_PKT_IN_DISPATCHER_BURST;++i){
 	
 		//Recover packet	
 		pkt = ls_int->pkt_in_queue->non_blocking_read();
@@ -51,13 +43,25 @@ static inline void process_sw_of1x_packet_ins(of1x_switch_t* sw){
 		//Recover platform state
 		pkt_x86 = (datapacketx86*)pkt->platform_state;
 		
-		//Store packet in the storage system. Packet is NOT returned to the bufferpool
-		id = ls_int->storage->store_packet(pkt);
+		//Copy the frame to the arena and store it; the buffer is returned to the bufferpool
+		//once the PKT_IN has been sent
+		spill = ls_int->arena->spill(pkt_x86->get_buffer(), pkt_x86->get_buffer_length(), pkt_x86->in_port, pkt_x86->in_phy_port);
+
+		if(unlikely(!spill)){
+			ROFL_DEBUG(DRIVER_NAME"[pkt-in-dispatcher] PKT_IN for packet(%p) could not be buffered (arena full). Dropping..\n",pkt);
+	
+			//Return to the bufferpool
+			bufferpool::release_buffer(pkt);
+			continue;
+		}
+
+		id = ls_int->storage->store_spill(spill);
 
 		if(id == datapacket_storage::ERROR){
 			ROFL_DEBUG(DRIVER_NAME"[pkt-in-dispatcher] PKT_IN for packet(%p) could not be stored in the storage. Dropping..\n",pkt);
 	
-			//Return to the bufferpool
+			//Return to the arena and bufferpool
+			ls_int->arena->release(spill);
 			bufferpool::release_buffer(pkt);
 			continue;
 		}
@@ -76,84 +80,135 @@ static inline void process_sw_of1x_packet_ins(of1x_switch_t* sw){
 
 		if( unlikely(rv != HAL_SUCCESS) ){
 			ROFL_DEBUG(DRIVER_NAME"[pkt-in-dispatcher] PKT_IN for packet(%p) could not be sent to sw:%s controller. Dropping..\n",pkt,sw->name);
-			//Take packet out from the storage
-			if( unlikely(ls_int->storage->get_packet(id) != pkt) ){
-				ROFL_ERR(DRIVER_NAME"[pkt-in-dispatcher] Storage corruption. get_packet(%u) returned a different pkt pointer (should have been %p)\n", id, pkt);
+			//Take the spill out from the storage (unless it has already expired)
+			discard_packet_in((of_switch_t*)sw, id);
+		}
 
-				assert(0);
-			}
+		//Return to the bufferpool
+		bufferpool::release_buffer(pkt);
+	}
 
-			//Return to datapacket_storage
-			ls_int->storage->get_packet(id);
+	return i;
+}
 
-			//Return to the bufferpool
-			bufferpool::release_buffer(pkt);
-		}
-		
-	}
+/*
+* Dispatcher thread of an LSI
+*/
+static void* pktin_dispatcher_routine(void* param){
 
-	//Empty pipe
-	pending_to_read += i;
+	int ret;
+	uint64_t events;
+	of1x_switch_t* sw = (of1x_switch_t*)param;
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
+	struct pollfd pfd;
 
-	if( pending_to_read > 0 ){
+	pfd.fd = ls_int->pktin_efd;
+	pfd.events = POLLIN;
 
-		if(pending_to_read > DUMMY_BUF_SIZE){
-			ret = read(pktin_not_pipe[PKT_IN_PIPE_READ], &null_buf, DUMMY_BUF_SIZE);
-		}else{
-			ret = read(pktin_not_pipe[PKT_IN_PIPE_READ], &null_buf, pending_to_read);
+	while(likely(ls_int->pktin_keep_on)){
+
+		//Drain in bursts
+		if(process_sw_of1x_packet_ins(sw, ls_int) == IO_PKT_IN_DISPATCHER_BURST)
+			continue;
+
+		//Going to sleep; from now on writers will notify. Recheck
+		//the queue, something may have been enqueued meanwhile
+		ls_int->pktin_sleeping = 1;
+		__sync_synchronize();
+		if(!ls_int->pkt_in_queue->is_empty() || !ls_int->pktin_keep_on){
+			ls_int->pktin_sleeping = 0;
+			continue;
 		}
 
-		if(ret > 0)
-			pending_to_read -= ret; 
+		//The timeout is just a safety net
+		pfd.revents = 0;
+		if(poll(&pfd, 1, IO_PKT_IN_DISPATCHER_TIMEOUT_MS) > 0){
+			ret = read(ls_int->pktin_efd, &events, sizeof(events));
+			(void)ret;
+		}
+		ls_int->pktin_sleeping = 0;
 	}
+
+	ROFL_DEBUG(DRIVER_NAME"[pkt-in-dispatcher] Finishing dispatcher of sw: %s\n", sw->name);
+
+	pthread_exit(NULL);
 }
 
-//Initialize pkt in notification pipe
+rofl_result_t start_pktin_dispatcher(of_switch_t* sw){
 
-int init_packetin_pipe(){
-	
-	//Open pipe for output signaling on enqueue	
-	int rc = pipe(pktin_not_pipe);
-	(void)rc; // todo use the value
-
-	//Set non-blocking read/write in the pipe
-	for(unsigned int i=0;i<2;i++){
-		int flags = fcntl(pktin_not_pipe[i], F_GETFL, 0);	///get current file status flags
-		flags |= O_NONBLOCK;					//turn off blocking flag
-		fcntl(pktin_not_pipe[i], F_SETFL, flags);		//set up non-blocking read
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
+
+	ls_int->pktin_efd = eventfd(0, EFD_NONBLOCK);
+	if(ls_int->pktin_efd == -1){
+		ROFL_ERR(DRIVER_NAME"[pkt-in-dispatcher] Unable to create eventfd for sw: %s, errno(%d): %s\n", sw->name, errno, strerror(errno));
+		return ROFL_FAILURE;
 	}
-	
-	return pktin_not_pipe[PKT_IN_PIPE_READ];
+
+	ls_int->pktin_sleeping = 0;
+	ls_int->pktin_keep_on = true;
+
+	if(pthread_create(&ls_int->pktin_thread, NULL, pktin_dispatcher_routine, sw) != 0){
+		ROFL_ERR(DRIVER_NAME"[pkt-in-dispatcher] pthread_create failed for sw: %s\n", sw->name);
+		close(ls_int->pktin_efd);
+		return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
 }
 
-void destroy_packetin_pipe(){
-	close(pktin_not_pipe[PKT_IN_PIPE_WRITE]);
-	close(pktin_not_pipe[PKT_IN_PIPE_READ]);
+void stop_pktin_dispatcher(of_switch_t* sw){
+
+	int ret;
+	uint64_t c=1;
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
+
+	ls_int->pktin_keep_on = false;
+	__sync_synchronize();
+
+	//Wake it up
+	ret = write(ls_int->pktin_efd, &c, sizeof(c));
+	(void)ret;
+
+	pthread_join(ls_int->pktin_thread, NULL);
+	close(ls_int->pktin_efd);
 }
 
-/*
-* Attempt to process packet ins for all the switches
-*/
-void process_packet_ins(){
+datapacket_t* retrieve_packet_in(of_switch_t* sw, uint32_t buffer_id, bool classify){
 
-	unsigned int i, j, r, max_switches;
-	of_switch_t** logical_switches;
-	
-	//Retrieve the logical switches list
-	logical_switches = physical_switch_get_logical_switches(&max_switches);
-	
-	for(i=0;i<ITERATIONS_PER_ROUND;++i){
-		for(j=0;j<ITERATIONS_PER_ROUND;++j){
-			for(r=0; r<max_switches; ++r){
-				if(logical_switches[r] != NULL){
-					//if( logical_switches[r]->of_ver == OF_VERSION_12 )
-					process_sw_of1x_packet_ins((of1x_switch_t*)logical_switches[r]);
-				}
-			}
+	datapacket_t* pkt;
+	pktin_spill_t* spill;
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
+
+	spill = ls_int->storage->get_spill(buffer_id);
+	if(!spill)
+		return NULL;
+
+	//Rehydrate
+	pkt = bufferpool::get_free_buffer_nonblocking();
+
+	if(likely(pkt != NULL)){
+		if(unlikely(((datapacketx86*)pkt->platform_state)->init(spill->data, spill->len, sw, spill->in_port, spill->in_phy_port, classify) != ROFL_SUCCESS)){
+			bufferpool::release_buffer(pkt);
+			pkt = NULL;
+		}else{
+			pkt->sw = sw;
 		}
 	}
+
+	ls_int->arena->release(spill);
+
+	return pkt;
 }
 
+void discard_packet_in(of_switch_t* sw, uint32_t buffer_id){
+
+	pktin_spill_t* spill;
+	switch_platform_state_t* ls_int = (switch_platform_state_t*)sw->platform_state;
+
+	spill = ls_int->storage->get_spill(buffer_id);
+	if(spill)
+		ls_int->arena->release(spill);
+}
 
 void drain_packet_ins(of_switch_t* sw){
 	
@@ -3,74 +3,75 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #ifndef CTL_PACKETS_H
-#define CTL_PACKETS_H 
+#define CTL_PACKETS_H
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <vector>
 #include <rofl/datapath/pipeline/common/datapacket.h>
 #include <rofl/datapath/pipeline/openflow/of_switch.h>
+#include "../processing/ls_internal_state.h"
 
 /**
 * @file pktin_dispatcher.h
 * @author Marc Sune<marc.sune (at) bisdn.de>
 *
 * @brief Functions to dispatch pkt_ins from the processing subsystem
-* to another thread (bg currently). 
+* to the CMM. Every LSI has its own dispatcher thread, woken up via
+* an eventfd, so that the PKT_IN load of an LSI does not delay the
+* PKT_INs of other LSIs nor the bg tasks (e.g. flow expiration).
 *
 */
 
-#define PKT_IN_PIPE_READ 0
-#define PKT_IN_PIPE_WRITE 1
-
-//Notification pipe
-extern int pktin_not_pipe[];
-
 //C++ extern C
 ROFL_BEGIN_DECLS
 
 /**
-* Get notification fd (write edge of the pipe)
+* Wake the dispatcher of the LSI, if it is sleeping. Must be called
+* after the PKT_IN has been enqueued in the pkt_in_queue.
 */
-inline int get_packet_in_notify_fd(void){ return pktin_not_pipe[PKT_IN_PIPE_WRITE]; }
+inline void notify_packet_in(xdpd::gnu_linux::switch_platform_state_t* ls_int){
+	int ret;
+	uint64_t c=1;
 
-/**
-* Get read fd (read edge of the pipe)
-*/
-inline int get_packet_in_read_fd(void){ return pktin_not_pipe[PKT_IN_PIPE_READ]; }
+	//Enqueue (CAS) is a full barrier; only one of the writers wakes the dispatcher
+	if(ls_int->pktin_sleeping && __sync_bool_compare_and_swap(&ls_int->pktin_sleeping, 1, 0)){
+		ret = write(ls_int->pktin_efd, &c, sizeof(c));
+		(void)ret;
+	}
+}
 
 /**
-* Send a single byte to wake thread attending pkt_ins 
+* Launch the PKT_IN dispatcher of an LSI. Must be called before
+* any packet is processed by the LSI
 */
-inline void notify_packet_in(void){ 
-	int ret;
-	char c='a';
-	ret = write(pktin_not_pipe[PKT_IN_PIPE_WRITE], &c, 1);
-	(void)ret;
-}
+rofl_result_t start_pktin_dispatcher(of_switch_t* sw);
 
 /**
-* Process packet_ins for all LSI 
+* Stop the PKT_IN dispatcher of an LSI. Pending PKT_INs are NOT
+* processed (see drain_packet_ins())
 */
-void process_packet_ins(void);
+void stop_pktin_dispatcher(of_switch_t* sw);
 
 /**
-* Drain packet_ins for an LSI
+* Recover a buffered PKT_IN (buffer_id) into a bufferpool buffer. Returns
+* NULL if buffer_id is not (or no longer) stored, or if there are no free buffers;
+* in any case the PKT_IN is no longer buffered after the call.
 */
-void drain_packet_ins(of_switch_t* sw);
-
+datapacket_t* retrieve_packet_in(of_switch_t* sw, uint32_t buffer_id, bool classify);
 
 /**
-* Initialize notification pipe
+* Discard a buffered PKT_IN (buffer_id), if stored
 */
-int init_packetin_pipe(void);
+void discard_packet_in(of_switch_t* sw, uint32_t buffer_id);
 
 /**
-* Destroy or release notification pipe resources 
+* Drain packet_ins for an LSI
 */
-void destroy_packetin_pipe(void);
+void drain_packet_ins(of_switch_t* sw);
 
 //C++ extern C
 ROFL_END_DECLS
@@ -0,0 +1,301 @@
+#include "pktin_meter.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <new>
+#include <rofl/common/utils/c_logger.h>
+#include "../config.h"
+#include "../util/likely.h"
+
+using namespace xdpd::gnu_linux;
+
+#define NSEC_PER_SEC 1000000000ULL
+
+//Extra params keys
+#define PKTIN_METER_RATE_KEY "pktin-rate"
+#define PKTIN_METER_TABLE_RATE_KEY "pktin-table-rate"
+#define PKTIN_METER_NOMATCH_RATE_KEY "pktin-nomatch-rate"
+#define PKTIN_METER_ACTION_RATE_KEY "pktin-action-rate"
+#define PKTIN_METER_BURST_KEY "pktin-burst"
+
+//Unlimited by default
+pktin_meter_config_t pktin_meter::defaults = { 0, 0, { 0, 0 }, 0 };
+
+static inline uint64_t now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static rofl_result_t parse_value(const char* key, const char* value, size_t len, uint32_t* out){
+	char buf[16];
+	char* end;
+	unsigned long val;
+
+	if(len == 0 || len >= sizeof(buf))
+		goto PARSE_ERROR;
+
+	memcpy(buf, value, len);
+	buf[len] = '\0';
+
+	errno = 0;
+	val = strtoul(buf, &end, 10);
+	if(errno != 0 || *end != '\0' || buf[0] == '-' || val > 0xFFFFFFFFUL)
+		goto PARSE_ERROR;
+
+	*out = (uint32_t)val;
+	return ROFL_SUCCESS;
+
+PARSE_ERROR:
+	ROFL_ERR(DRIVER_NAME" Invalid value for extra param '%s' (expected packets per second or packets)\n", key);
+	return ROFL_FAILURE;
+}
+
+rofl_result_t pktin_meter::parse_params(const char* extra_params, pktin_meter_config_t* conf){
+
+	const char *p, *end, *eq;
+	size_t key_len;
+	const char* key;
+	uint32_t* field;
+
+	if(!extra_params)
+		return ROFL_SUCCESS;
+
+	for(p = extra_params; *p != '\0'; p = (*end == '\0')? end : end+1){
+		end = strchr(p, ';');
+		if(!end)
+			end = p + strlen(p);
+
+		//Trim spaces
+		while(p < end && *p == ' ')
+			p++;
+
+		eq = (const char*)memchr(p, '=', end-p);
+		if(!eq)
+			continue;
+		key_len = eq - p;
+		while(key_len > 0 && p[key_len-1] == ' ')
+			key_len--;
+
+#define PKTIN_METER_KEY_MATCH(k) (key_len == sizeof(k)-1 && strncmp(p, k, key_len) == 0)
+		if(PKTIN_METER_KEY_MATCH(PKTIN_METER_RATE_KEY)){
+			key = PKTIN_METER_RATE_KEY;
+			field = &conf->rate;
+		}else if(PKTIN_METER_KEY_MATCH(PKTIN_METER_TABLE_RATE_KEY)){
+			key = PKTIN_METER_TABLE_RATE_KEY;
+			field = &conf->table_rate;
+		}else if(PKTIN_METER_KEY_MATCH(PKTIN_METER_NOMATCH_RATE_KEY)){
+			key = PKTIN_METER_NOMATCH_RATE_KEY;
+			field = &conf->reason_rate[PKTIN_METER_REASON_NO_MATCH];
+		}else if(PKTIN_METER_KEY_MATCH(PKTIN_METER_ACTION_RATE_KEY)){
+			key = PKTIN_METER_ACTION_RATE_KEY;
+			field = &conf->reason_rate[PKTIN_METER_REASON_ACTION];
+		}else if(PKTIN_METER_KEY_MATCH(PKTIN_METER_BURST_KEY)){
+			key = PKTIN_METER_BURST_KEY;
+			field = &conf->burst;
+		}else
+			continue; //Not for us
+#undef PKTIN_METER_KEY_MATCH
+
+		eq++;
+		while(eq < end && *eq == ' ')
+			eq++;
+		key_len = end - eq;
+		while(key_len > 0 && eq[key_len-1] == ' ')
+			key_len--;
+
+		if(parse_value(key, eq, key_len, field) != ROFL_SUCCESS)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+pktin_meter::pktin_meter(unsigned int num_of_tables, const pktin_meter_config_t* config) :
+		conf(*config),
+		num_of_tables(num_of_tables),
+		accepted(0),
+		dropped(0)
+{
+	unsigned int i;
+
+	init_bucket(&lsi, conf.rate, conf.burst);
+	for(i=0;i<PKTIN_METER_NUM_REASONS;i++)
+		init_bucket(&reasons[i], conf.reason_rate[i], conf.burst);
+
+	tables = (bucket_t*)calloc(num_of_tables, sizeof(bucket_t));
+	if(num_of_tables && !tables)
+		throw std::bad_alloc();
+	for(i=0;i<num_of_tables;i++)
+		init_bucket(&tables[i], conf.table_rate, conf.burst);
+
+	enabled = is_limited(&conf);
+}
+
+pktin_meter::~pktin_meter(){
+	free(tables);
+}
+
+void pktin_meter::configure(const pktin_meter_config_t* config){
+
+	unsigned int i;
+
+	//Stop metering before the buckets are changed, if no limit is left
+	if(!is_limited(config))
+		enabled = false;
+
+	conf = *config;
+
+	set_bucket_limits(&lsi, conf.rate, conf.burst);
+	for(i=0;i<PKTIN_METER_NUM_REASONS;i++)
+		set_bucket_limits(&reasons[i], conf.reason_rate[i], conf.burst);
+	for(i=0;i<num_of_tables;i++)
+		set_bucket_limits(&tables[i], conf.table_rate, conf.burst);
+
+	__sync_synchronize();
+	enabled = is_limited(&conf);
+}
+
+bool pktin_meter::is_limited(const pktin_meter_config_t* config){
+
+	unsigned int i;
+
+	if(config->rate || config->table_rate)
+		return true;
+	for(i=0;i<PKTIN_METER_NUM_REASONS;i++){
+		if(config->reason_rate[i])
+			return true;
+	}
+	return false;
+}
+
+void pktin_meter::init_bucket(bucket_t* b, uint32_t rate, uint32_t burst){
+
+	memset((void*)b, 0, sizeof(*b));
+	set_bucket_limits(b, rate, burst);
+}
+
+//Counters are not touched
+void pktin_meter::set_bucket_limits(bucket_t* b, uint32_t rate, uint32_t burst){
+
+	b->tat = 0;
+
+	if(rate == 0){
+		b->interval = b->tolerance = 0;
+		return;
+	}
+
+	if(burst == 0)
+		burst = rate;
+
+	b->interval = NSEC_PER_SEC/rate;
+	if(b->interval == 0)
+		b->interval = 1;
+	b->tolerance = (uint64_t)(burst-1)*b->interval;
+}
+
+/*
+* GCRA: the PKT_IN conforms if it does not arrive earlier than the
+* theoretical arrival time minus the burst tolerance.
+*/
+inline bool pktin_meter::conform(bucket_t* b, uint64_t now){
+	uint64_t tat, base;
+
+	if(!b->interval)
+		return true;
+
+	do{
+		tat = b->tat;
+		base = (tat > now)? tat : now;
+		if(base - now > b->tolerance)
+			return false;
+	}while(unlikely(!__sync_bool_compare_and_swap(&b->tat, tat, base + b->interval)));
+
+	return true;
+}
+
+//Give back the emission interval taken by a PKT_IN refused by another bucket
+inline void pktin_meter::refund(bucket_t* b){
+	if(b->interval)
+		__sync_fetch_and_sub(&b->tat, b->interval);
+}
+
+bool pktin_meter::admit(uint8_t table_id, of_packet_in_reason_t reason){
+
+	bucket_t *table, *rsn;
+	uint64_t now;
+
+	if(likely(!enabled)){
+		__sync_fetch_and_add(&accepted, 1);
+		return true;
+	}
+
+	table = (table_id < num_of_tables)? &tables[table_id] : NULL;
+	rsn = &reasons[(reason == PKTIN_METER_REASON_NO_MATCH)? PKTIN_METER_REASON_NO_MATCH : PKTIN_METER_REASON_ACTION];
+	now = now_ns();
+
+	//Most specific first, so that a noisy table or reason does not starve the rest
+	if(table && !conform(table, now)){
+		__sync_fetch_and_add(&table->dropped, 1);
+		goto DROP;
+	}
+
+	if(!conform(rsn, now)){
+		__sync_fetch_and_add(&rsn->dropped, 1);
+		if(table)
+			refund(table);
+		goto DROP;
+	}
+
+	if(!conform(&lsi, now)){
+		__sync_fetch_and_add(&lsi.dropped, 1);
+		refund(rsn);
+		if(table)
+			refund(table);
+		goto DROP;
+	}
+
+	if(table)
+		__sync_fetch_and_add(&table->accepted, 1);
+	__sync_fetch_and_add(&rsn->accepted, 1);
+	__sync_fetch_and_add(&lsi.accepted, 1);
+	__sync_fetch_and_add(&accepted, 1);
+	return true;
+
+DROP:
+	__sync_fetch_and_add(&dropped, 1);
+	return false;
+}
+
+void pktin_meter::read_bucket(const bucket_t* b, pktin_meter_stats_t* stats){
+	stats->accepted = b->accepted;
+	stats->dropped = b->dropped;
+}
+
+void pktin_meter::get_stats(pktin_meter_stats_t* stats) const{
+	stats->accepted = accepted;
+	stats->dropped = dropped;
+}
+
+void pktin_meter::get_lsi_stats(pktin_meter_stats_t* stats) const{
+	read_bucket(&lsi, stats);
+}
+
+rofl_result_t pktin_meter::get_table_stats(uint8_t table_id, pktin_meter_stats_t* stats) const{
+	if(table_id >= num_of_tables)
+		return ROFL_FAILURE;
+	read_bucket(&tables[table_id], stats);
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t pktin_meter::get_reason_stats(unsigned int reason, pktin_meter_stats_t* stats) const{
+	if(reason >= PKTIN_METER_NUM_REASONS)
+		return ROFL_FAILURE;
+	read_bucket(&reasons[reason], stats);
+	return ROFL_SUCCESS;
+}
+
+void pktin_meter::dump_state(){
+	std::cerr << *this << std::endl;
+}
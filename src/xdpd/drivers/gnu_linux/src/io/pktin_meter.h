@@ -0,0 +1,172 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PKTIN_METER_H_
+#define PKTIN_METER_H_
+
+#include <iostream>
+#include <stdint.h>
+#include <rofl.h>
+#include <rofl/datapath/pipeline/openflow/of_switch.h>
+
+/**
+* @file pktin_meter.h
+*
+* @brief PKT_IN rate limiting (control-plane protection).
+*
+*/
+
+namespace xdpd {
+namespace gnu_linux {
+
+/**
+* PKT_IN reasons metered separately. of_packet_in_reason_t follows the
+* OpenFlow numbering (OFPR_NO_MATCH, OFPR_ACTION...); any other reason is
+* accounted as ACTION.
+*/
+#define PKTIN_METER_REASON_NO_MATCH 0
+#define PKTIN_METER_REASON_ACTION 1
+#define PKTIN_METER_NUM_REASONS 2
+
+/**
+* Limits in packets per second (0: unlimited) and burst in packets
+* (0: one second worth of packets). They apply to every LSI independently,
+* and can be reconfigured per LSI (pktin_meter::configure()).
+*/
+typedef struct pktin_meter_config{
+	//Aggregated PKT_IN rate of the LSI
+	uint32_t rate;
+	//Per table rate
+	uint32_t table_rate;
+	//Per reason rate
+	uint32_t reason_rate[PKTIN_METER_NUM_REASONS];
+	//Bucket depth
+	uint32_t burst;
+}pktin_meter_config_t;
+
+/**
+* Counters of a meter (bucket)
+*/
+typedef struct pktin_meter_stats{
+	uint64_t accepted;
+	uint64_t dropped;
+}pktin_meter_stats_t;
+
+/**
+* @brief Token bucket meters applied to the PKT_INs of an LSI, before
+* the packet is buffered (stored) or enqueued towards the controller.
+*
+* There is one bucket for the LSI, one per table and one per reason; a PKT_IN
+* is accepted only if all of them conform. Buckets are implemented as a GCRA
+* (virtual scheduling): the state is a single 64 bit theoretical arrival time,
+* updated with CAS, so that the RX threads of the LSI can meter concurrently
+* without locks.
+*
+* @ingroup driver_gnu_linux_io
+*/
+class pktin_meter{
+
+public:
+	/**
+	* Default configuration for new LSIs (set from the driver extra params)
+	*/
+	static pktin_meter_config_t defaults;
+
+	/**
+	* Parse the meter configuration out of the driver extra params
+	* ("key1=value1;key2=value2"). Keys:
+	*
+	*   pktin-rate, pktin-table-rate, pktin-nomatch-rate,
+	*   pktin-action-rate, pktin-burst
+	*
+	* Unknown keys are ignored.
+	*/
+	static rofl_result_t parse_params(const char* extra_params, pktin_meter_config_t* conf);
+
+	pktin_meter(unsigned int num_of_tables, const pktin_meter_config_t* config);
+	~pktin_meter();
+
+	/**
+	* Replace the limits of the meter, while PKT_INs are being metered. The
+	* buckets start full; counters are kept. PKT_INs metered concurrently
+	* may still be checked against the previous limits.
+	*/
+	void configure(const pktin_meter_config_t* config);
+
+	/**
+	* Meter a PKT_IN. Returns true if the PKT_IN shall be sent to the controller.
+	*/
+	bool admit(uint8_t table_id, of_packet_in_reason_t reason);
+
+	/*
+	* Counters. A PKT_IN is accounted as dropped only by the meter that
+	* refused it. While no limit is set, only the totals are counted.
+	*/
+	void get_stats(pktin_meter_stats_t* stats) const;
+	void get_lsi_stats(pktin_meter_stats_t* stats) const;
+	rofl_result_t get_table_stats(uint8_t table_id, pktin_meter_stats_t* stats) const;
+	rofl_result_t get_reason_stats(unsigned int reason, pktin_meter_stats_t* stats) const;
+
+	//Used only for debugging purposes
+	void dump_state();
+
+	friend std::ostream&
+	operator<< (std::ostream& os, pktin_meter const& m) {
+		pktin_meter_stats_t stats;
+		m.get_stats(&stats);
+		os << "<pktin_meter: ";
+			os << "rate:" << m.conf.rate << " ";
+			os << "table-rate:" << m.conf.table_rate << " ";
+			os << "nomatch-rate:" << m.conf.reason_rate[PKTIN_METER_REASON_NO_MATCH] << " ";
+			os << "action-rate:" << m.conf.reason_rate[PKTIN_METER_REASON_ACTION] << " ";
+			os << "burst:" << m.conf.burst << " ";
+			os << "accepted:" << stats.accepted << " ";
+			os << "dropped:" << stats.dropped << " ";
+		os << ">";
+		return os;
+	};
+
+private:
+
+	typedef struct {
+		//Emission interval (ns); 0 means unlimited
+		uint64_t interval;
+		//Burst tolerance (ns)
+		uint64_t tolerance;
+		//Theoretical arrival time (ns)
+		volatile uint64_t tat;
+		volatile uint64_t accepted;
+		volatile uint64_t dropped;
+	}__attribute__((aligned(64))) bucket_t;
+
+	pktin_meter_config_t conf;
+	unsigned int num_of_tables;
+
+	//Whether any bucket is limited at all
+	volatile bool enabled;
+
+	bucket_t lsi;
+	bucket_t reasons[PKTIN_METER_NUM_REASONS];
+	bucket_t* tables;
+
+	//Totals
+	volatile uint64_t accepted;
+	volatile uint64_t dropped;
+
+	static void init_bucket(bucket_t* b, uint32_t rate, uint32_t burst);
+	static void set_bucket_limits(bucket_t* b, uint32_t rate, uint32_t burst);
+	static bool is_limited(const pktin_meter_config_t* config);
+	static bool conform(bucket_t* b, uint64_t now);
+	static void refund(bucket_t* b);
+	static void read_bucket(const bucket_t* b, pktin_meter_stats_t* stats);
+
+	// this class is noncopyable
+	pktin_meter(const pktin_meter&);
+	pktin_meter& operator=(const pktin_meter&);
+};
+
+}// namespace xdpd::gnu_linux
+}// namespace xdpd
+
+#endif /* PKTIN_METER_H_ */
@@ -26,6 +26,7 @@
 #include "../../pipeline-imp/packet.h"
 
 #include <rofl/datapath/pipeline/openflow/of_switch_pp.h>
+#include "../../processing/microflow_cache_pp.h"
 
 //Profiling
 #include "../../util/time_measurements.h"
@@ -86,7 +87,7 @@ protected:
 
 	/* Methods */
 	//WRR
-	static inline bool process_port_rx(ioport* port);
+	static inline bool process_port_rx(ioport* port, microflow_cache* mfc);
 	static inline int process_port_tx(ioport* port);
 
 	//EPOLL related	
@@ -115,7 +116,7 @@ private:
 /*
 * Call port based on scheduling algorithm 
 */
-inline bool epoll_ioscheduler::process_port_rx(ioport* port){
+inline bool epoll_ioscheduler::process_port_rx(ioport* port, microflow_cache* mfc){
 
 	unsigned int i;
 	datapacket_t* pkt;
@@ -146,9 +147,13 @@ inline bool epoll_ioscheduler::process_port_rx(ioport* port){
 				/*
 				* Process packets
 				*/
-				//Process it through the pipeline
+				//Process it through the pipeline (through the
+				//microflow cache of the thread, if any)
 				TM_STAMP_STAGE(pkt, TM_S3);
-				of_process_packet_pipeline(sw, pkt);
+				if(likely(mfc != NULL))
+					mfc->process_packet(sw, pkt);
+				else
+					of_process_packet_pipeline(sw, pkt);
 					
 #ifdef DEBUG
 			}
@@ -200,6 +205,7 @@ void* epoll_ioscheduler::process_io(void* grp){
 	portgroup_state* pg = (portgroup_state*)grp;
 	ioport* port;
 	safevector<ioport*> ports;	//Ports of the group currently performing I/O operations
+	microflow_cache* mfc = NULL;	//Microflow cache of the RX thread
 	
 	//Init epoll fd set
 	epfd = -1;
@@ -213,6 +219,14 @@ void* epoll_ioscheduler::process_io(void* grp){
 	//Set scheduling and priority
 	set_kernel_scheduling();
 
+	if(is_rx){
+		try{
+			mfc = new microflow_cache();
+		}catch(...){
+			ROFL_ERR(DRIVER_NAME"[epoll_ioscheduler] Unable to allocate the microflow cache of the RX thread for group %u; packets will go through the pipeline lookups\n", pg->id);
+		}
+	}
+
 	/*
 	* Infinite loop unless group is stopped. e.g. all ports detached
 	*/
@@ -234,7 +248,7 @@ void* epoll_ioscheduler::process_io(void* grp){
 					port = ((epoll_event_data_t*)events[i].data.ptr)->port;
 					
 					if(is_rx)
-						epoll_ioscheduler::process_port_rx(port);
+						epoll_ioscheduler::process_port_rx(port, mfc);
 					else
 						epoll_ioscheduler::process_port_tx(port);
 				}
@@ -248,6 +262,7 @@ void* epoll_ioscheduler::process_io(void* grp){
 
 	//Release resources
 	release_resources(epfd, ev, events, current_num_of_ports);
+	delete mfc;
 
 	ROFL_DEBUG(DRIVER_NAME"[epoll_ioscheduler] Finishing execution of the %s I/O thread: #%u\n", is_rx? "RX":"TX", pthread_self());
 
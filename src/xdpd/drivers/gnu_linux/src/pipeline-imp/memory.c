@@ -2,26 +2,46 @@
 #include <string.h>
 #include <rofl/datapath/pipeline/platform/memory.h>
 
+#include "../config.h"
+#include "slab.h"
 
 /*
- * malloc and free should be replaced if necessary by platform specific memory allocators
+ * Flow entries, matches, actions, instructions and stats messages are
+ * allocated through these hooks; they are served by the size-class slab
+ * allocator (see slab.h) unless PIPELINE_SLAB_ALLOCATOR is 0
  */
 
 //Per core memory allocators
 void* platform_malloc( size_t length ){
+#if PIPELINE_SLAB_ALLOCATOR
+	return slab_alloc( length );
+#else
 	return malloc( length );
+#endif
 }
 void platform_free( void *data ){
+#if PIPELINE_SLAB_ALLOCATOR
+	slab_free( data );
+#else
 	free( data );
+#endif
 }
 
 //Shared memory allocators
 void* platform_malloc_shared( size_t length ){
+#if PIPELINE_SLAB_ALLOCATOR
+	return slab_alloc( length );
+#else
 	return malloc( length );
+#endif
 }
 
 void platform_free_shared( void *data ){
+#if PIPELINE_SLAB_ALLOCATOR
+	slab_free( data );
+#else
 	free( data );
+#endif
 }
 
 void* platform_memcpy( void *dst, const void *src, size_t length ){
@@ -999,12 +999,18 @@ void platform_packet_set_gtp_teid(datapacket_t* pkt, uint32_t teid)
 STATIC_PACKET_INLINE__
 void platform_packet_pop_gtp(datapacket_t* pkt)
 {
-	//TODO: implement
+	datapacketx86 *pack = (datapacketx86*)pkt->platform_state;
+	if (NULL == pack) return;
+	//Ether type is derived from the inner (T-PDU) IP version
+	pop_gtp(pkt, pack->headers, 0);
 }
 STATIC_PACKET_INLINE__
 void platform_packet_push_gtp(datapacket_t* pkt)
 {
-	//TODO: implement
+	datapacketx86 *pack = (datapacketx86*)pkt->platform_state;
+	if (NULL == pack) return;
+	//Default endpoint; addresses, ports and teid are set by the subsequent set-field actions
+	push_gtp(pkt, pack->headers, ETH_TYPE_IPV4);
 }
 
 
@@ -1113,6 +1119,13 @@ void platform_packet_output(datapacket_t* pkt, switch_port_t* output_port){
 
 	//Outer most IPv4 frame
 	void *fipv4 = get_ipv4_hdr(pack->headers, 0);
+	int udp_idx = 0;
+
+	//GTP-U tunnel: the outer UDP checksum is left to 0 and L4 checksums refer to the inner IPv4 packet
+	if(unlikely(get_gtpu_hdr(pack->headers, 0) != NULL)){
+		fipv4 = get_ipv4_hdr(pack->headers, 1);
+		udp_idx = 1;
+	}
 
 	if ((pack->tcp_recalc_checksum) && get_tcp_hdr(pack->headers, 0) && fipv4) {
 		
@@ -1124,14 +1137,14 @@ void platform_packet_output(datapacket_t* pkt, switch_port_t* output_port){
 			get_ipv4_proto(fipv4),
 			get_pkt_len(pkt, pack->headers, get_tcp_hdr(pack->headers,0), NULL) ); // start at innermost IPv4 up to and including last frame
 
-	} else if ((pack->udp_recalc_checksum) && (get_udp_hdr(pack->headers, 0)) && fipv4) {
+	} else if ((pack->udp_recalc_checksum) && (get_udp_hdr(pack->headers, udp_idx)) && fipv4) {
 
 		udp_calc_checksum(
-				get_udp_hdr(pack->headers, 0),
+				get_udp_hdr(pack->headers, udp_idx),
 				get_ipv4_src(fipv4),
 				get_ipv4_dst(fipv4),
 				get_ipv4_proto(fipv4),
-				get_pkt_len(pkt, pack->headers, get_udp_hdr(pack->headers, 0), NULL) ); // start at innermost IPv4 up to and including last frame
+				get_pkt_len(pkt, pack->headers, get_udp_hdr(pack->headers, udp_idx), NULL) ); // start at innermost IPv4 up to and including last frame
 
 	} else if ((pack->icmpv4_recalc_checksum) && (get_icmpv4_hdr(pack->headers,0))) {
 
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <unistd.h>
+#include <inttypes.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/of1x_async_events_hooks.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h>
@@ -10,8 +11,10 @@
 #include "../io/bufferpool.h"
 #include "../io/datapacketx86.h"
 #include "../io/datapacket_storage.h"
-#include "/ls_internal_state.h"
+#include "../processing/ls_internal_state.h"
 #include "../io/pktin_dispatcher.h"
+#include "../processing/microflow_cache.h"
+#include "../util/likely.h"
 
 //Time measurements
 #include "../util/time_measurements.h"
@@ -34,6 +37,10 @@ rofl_result_t platform_post_init_of1x_switch(of1x_switch_t* sw){
 
 	ls_int->pkt_in_queue = new circular_queue<datapacket_t>(PROCESSING_PKT_IN_QUEUE_SLOTS);
 	ls_int->storage = new datapacket_storage( IO_PKT_IN_STORAGE_MAX_BUF, IO_PKT_IN_STORAGE_EXPIRATION_S); // todo make this value configurable
+	ls_int->arena = new pktin_arena(IO_PKT_IN_ARENA_BYTES);
+	ls_int->meter = new pktin_meter(sw->pipeline.num_of_tables, &pktin_meter::defaults);
+	ls_int->stats_index = new flow_stats_index(sw->pipeline.num_of_tables, PROCESSING_FLOW_STATS_COOKIE_INDEX);
+	microflow_cache::init_lsi(ls_int);
 
 	sw->platform_state = (of_switch_platform_state_t*)ls_int;
 
@@ -68,6 +75,7 @@ rofl_result_t platform_pre_destroy_of1x_switch(of1x_switch_t* sw){
 	unsigned int i;
 
 	switch_platform_state_t* ls_int =  (switch_platform_state_t*)sw->platform_state;
+	pktin_meter_stats_t stats;
 
 	//There should NOT be any PKT_INs pending
 	if(ls_int->pkt_in_queue->size() != 0)
@@ -79,6 +87,13 @@ rofl_result_t platform_pre_destroy_of1x_switch(of1x_switch_t* sw){
 	}
 	delete ls_int->pkt_in_queue;
 	delete ls_int->storage;
+	delete ls_int->arena;
+
+	ls_int->meter->get_stats(&stats);
+	if(stats.dropped)
+		ROFL_INFO(DRIVER_NAME" PKT_IN meter of switch %s: %" PRIu64 " accepted, %" PRIu64 " dropped (rate limited)\n", sw->name, stats.accepted, stats.dropped);
+	delete ls_int->meter;
+	delete ls_int->stats_index;
 	free(sw->platform_state);
 	
 	return ROFL_SUCCESS;
@@ -96,6 +111,13 @@ void platform_of1x_packet_in(const of1x_switch_t* sw, uint8_t table_id, datapack
 	datapacketx86* pkt_x86;
 	switch_platform_state_t* ls_state = (switch_platform_state_t*)sw->platform_state;
 
+	//Rate limit before the packet is buffered or enqueued
+	if(unlikely(!ls_state->meter->admit(table_id, reason))){
+		ROFL_DEBUG(DRIVER_NAME" PKT_IN for packet(%p) exceeds the PKT_IN rate of sw:%s (table: %u, reason: %u). Dropping..\n",pkt,sw->name,table_id,(unsigned int)reason);
+		bufferpool::release_buffer(pkt);
+		return;
+	}
+
 	ROFL_DEBUG(DRIVER_NAME" Enqueuing PKT_IN event for packet(%p) in switch: %s\n",pkt,sw->name);
 	
 	//Recover platform state and fill it so that state can be recovered afterwards
@@ -110,7 +132,7 @@ void platform_of1x_packet_in(const of1x_switch_t* sw, uint8_t table_id, datapack
 	//Enqueue
 	if( ls_state->pkt_in_queue->non_blocking_write(pkt) == ROFL_SUCCESS ){
 		//Notify
-		notify_packet_in();
+		notify_packet_in(ls_state);
 			
 		//Timestamp SB6_SUCCESS	
 		TM_STAMP_STAGE(pkt, TM_SB5_SUCCESS);
@@ -134,16 +156,39 @@ void platform_of1x_notify_flow_removed(const of1x_switch_t* sw,
 }
 
 
+//Called with the table locked
+static inline switch_platform_state_t* get_ls_state(of1x_flow_entry_t* entry){
+	if(unlikely(!entry->table || !entry->table->pipeline || !entry->table->pipeline->sw))
+		return NULL;
+	return (switch_platform_state_t*)entry->table->pipeline->sw->platform_state;
+}
+
 void plaftorm_of1x_add_entry_hook(of1x_flow_entry_t* new_entry){
+	switch_platform_state_t* ls_int = get_ls_state(new_entry);
 
+	if(unlikely(ls_int == NULL))
+		return;
+
+	microflow_cache::invalidate(ls_int);
+	ls_int->stats_index->add(new_entry->table->number, new_entry);
 }
 
 void platform_of1x_modify_entry_hook(of1x_flow_entry_t* old_entry, of1x_flow_entry_t* mod, int reset_count){
+	switch_platform_state_t* ls_int = get_ls_state(old_entry);
 
+	//Instructions may have changed; cookie and table are not modified
+	if(likely(ls_int != NULL))
+		microflow_cache::invalidate(ls_int);
 }
 
 void platform_of1x_remove_entry_hook(of1x_flow_entry_t* entry){
+	switch_platform_state_t* ls_int = get_ls_state(entry);
+
+	if(unlikely(ls_int == NULL))
+		return;
 
+	microflow_cache::invalidate(ls_int);
+	ls_int->stats_index->remove(entry->table->number, entry);
 }
 
 void
@@ -0,0 +1,525 @@
+#include "slab.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "../util/likely.h"
+
+#define SLAB_MAGIC 0x534c4142 //"SLAB"
+#define SLAB_HDR_SIZE 64
+#define SLAB_CLASS_LARGE 0xFFFF
+
+//Free objects are linked through their first word
+typedef struct slab_obj{
+	struct slab_obj* next;
+}slab_obj_t;
+
+//Header at the beginning of every slab (and of every large allocation)
+typedef struct slab{
+	uint32_t magic;
+	uint16_t class_id;
+	uint16_t node;
+	uint32_t num_of_objs;
+	uint32_t in_use;		//Objects out of the slab (incl. thread caches)
+	slab_obj_t* free_list;
+	struct slab* prev;
+	struct slab* next;
+	size_t map_len;			//Length of the mapping (allocation if large)
+}slab_t;
+
+//Slabs of a size class in the arena of a node
+typedef struct slab_arena_class{
+	pthread_mutex_t mutex;
+	slab_t* partial;		//Slabs with free objects
+	unsigned int num_of_empty;	//Fully free slabs in partial
+	uint64_t slabs;
+	uint64_t remote_frees;
+}__attribute__((aligned(64))) slab_arena_class_t;
+
+//Per-thread cache of a size class
+typedef struct slab_cache_class{
+	unsigned int count;
+	void* objs[SLAB_CACHE_SIZE];
+	uint64_t allocs;
+	uint64_t frees;
+
+	//Objects of another node (remote_node) to be returned to its arena
+	unsigned int remote_count;
+	unsigned int remote_node;
+	void* remote[SLAB_REMOTE_BATCH];
+}slab_cache_class_t;
+
+typedef struct slab_cache{
+	unsigned int node;
+	slab_cache_class_t classes[SLAB_NUM_OF_CLASSES];
+	struct slab_cache* prev;
+	struct slab_cache* next;
+}slab_cache_t;
+
+static const size_t slab_class_size[SLAB_NUM_OF_CLASSES] = {
+	16, 32, 48, 64, 96, 128, 192, 256,
+	384, 512, 768, 1024, 1536, 2048, 3072, 4096
+};
+
+//Size class of (length+15)/16
+static uint8_t slab_size_to_class[(SLAB_MAX_OBJ_SIZE/16)+1];
+
+static slab_arena_class_t slab_arenas[SLAB_MAX_NUMA_NODES][SLAB_NUM_OF_CLASSES];
+static unsigned int slab_num_of_arenas = 1;
+
+//Thread caches
+static __thread slab_cache_t* slab_cache = NULL;
+static pthread_key_t slab_cache_key;
+static pthread_once_t slab_once = PTHREAD_ONCE_INIT;
+
+//Registry of the thread caches (stats) and counters of the exited threads
+static pthread_mutex_t slab_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static slab_cache_t* slab_registry = NULL;
+static uint64_t slab_retired_allocs[SLAB_NUM_OF_CLASSES];
+static uint64_t slab_retired_frees[SLAB_NUM_OF_CLASSES];
+
+//Large allocations
+static uint64_t slab_large_in_use = 0;
+static uint64_t slab_large_bytes = 0;
+
+static void slab_cache_destroy(void* param);
+
+static void slab_init(void){
+
+	unsigned int i, j, cls = 0;
+
+	for(i=0; i<SLAB_MAX_NUMA_NODES; ++i){
+		for(j=0; j<SLAB_NUM_OF_CLASSES; ++j){
+			memset(&slab_arenas[i][j], 0, sizeof(slab_arena_class_t));
+			pthread_mutex_init(&slab_arenas[i][j].mutex, NULL);
+		}
+	}
+
+	for(i=0; i<=SLAB_MAX_OBJ_SIZE/16; ++i){
+		while(slab_class_size[cls] < i*16)
+			cls++;
+		slab_size_to_class[i] = cls;
+	}
+
+	pthread_key_create(&slab_cache_key, slab_cache_destroy);
+}
+
+/*
+* Memory
+*/
+
+//Map len bytes (multiple of SLAB_SIZE) aligned to SLAB_SIZE
+static void* slab_map(size_t len){
+
+	size_t map_len = len + SLAB_SIZE;
+	size_t head, tail;
+	uintptr_t aligned;
+	uint8_t* mem;
+
+	mem = (uint8_t*)mmap(NULL, map_len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if(unlikely(mem == MAP_FAILED))
+		return NULL;
+
+	aligned = ((uintptr_t)mem + SLAB_SIZE - 1) & ~((uintptr_t)SLAB_SIZE - 1);
+	head = aligned - (uintptr_t)mem;
+	tail = map_len - head - len;
+
+	if(head)
+		munmap(mem, head);
+	if(tail)
+		munmap((uint8_t*)aligned + len, tail);
+
+	return (void*)aligned;
+}
+
+static inline slab_t* slab_of(void* data){
+	slab_t* slab = (slab_t*)((uintptr_t)data & ~((uintptr_t)SLAB_SIZE - 1));
+	assert(slab->magic == SLAB_MAGIC);
+	return slab;
+}
+
+//The free list is built by the thread that creates the slab, which runs
+//on the node of the arena, so that the pages are allocated on that node
+static slab_t* slab_create(unsigned int node, unsigned int cls){
+
+	slab_t* slab = (slab_t*)slab_map(SLAB_SIZE);
+	size_t obj_size = slab_class_size[cls];
+	uint8_t* obj;
+	int i;
+
+	if(unlikely(!slab))
+		return NULL;
+
+	slab->magic = SLAB_MAGIC;
+	slab->class_id = cls;
+	slab->node = node;
+	slab->num_of_objs = (SLAB_SIZE - SLAB_HDR_SIZE) / obj_size;
+	slab->in_use = 0;
+	slab->free_list = NULL;
+	slab->prev = slab->next = NULL;
+	slab->map_len = SLAB_SIZE;
+
+	for(i=slab->num_of_objs-1; i>=0; --i){
+		obj = (uint8_t*)slab + SLAB_HDR_SIZE + i*obj_size;
+		((slab_obj_t*)obj)->next = slab->free_list;
+		slab->free_list = (slab_obj_t*)obj;
+	}
+
+	return slab;
+}
+
+/*
+* Arenas
+*/
+
+static inline void slab_link(slab_arena_class_t* ac, slab_t* slab){
+	slab->prev = NULL;
+	slab->next = ac->partial;
+	if(ac->partial)
+		ac->partial->prev = slab;
+	ac->partial = slab;
+}
+
+static inline void slab_unlink(slab_arena_class_t* ac, slab_t* slab){
+	if(slab->prev)
+		slab->prev->next = slab->next;
+	else
+		ac->partial = slab->next;
+	if(slab->next)
+		slab->next->prev = slab->prev;
+	slab->prev = slab->next = NULL;
+}
+
+//Take up to num objects from the arena
+static unsigned int slab_arena_alloc(unsigned int node, unsigned int cls, void** objs, unsigned int num){
+
+	slab_arena_class_t* ac = &slab_arenas[node][cls];
+	unsigned int got = 0;
+	slab_t* slab;
+
+	pthread_mutex_lock(&ac->mutex);
+
+	while(got < num){
+		slab = ac->partial;
+
+		if(!slab){
+			slab = slab_create(node, cls);
+			if(unlikely(!slab))
+				break;
+			slab_link(ac, slab);
+			ac->slabs++;
+			ac->num_of_empty++;
+		}
+
+		if(slab->in_use == 0)
+			ac->num_of_empty--;
+
+		while(got < num && slab->free_list){
+			objs[got++] = slab->free_list;
+			slab->free_list = slab->free_list->next;
+			slab->in_use++;
+		}
+
+		if(!slab->free_list)
+			slab_unlink(ac, slab);
+	}
+
+	pthread_mutex_unlock(&ac->mutex);
+
+	return got;
+}
+
+//Return num objects of the arena of node
+static void slab_arena_free(unsigned int node, unsigned int cls, void** objs, unsigned int num, bool remote){
+
+	slab_arena_class_t* ac = &slab_arenas[node][cls];
+	slab_t* release = NULL;
+	slab_t* slab;
+	unsigned int i;
+
+	pthread_mutex_lock(&ac->mutex);
+
+	for(i=0; i<num; ++i){
+		slab = slab_of(objs[i]);
+
+		//Was full
+		if(!slab->free_list)
+			slab_link(ac, slab);
+
+		((slab_obj_t*)objs[i])->next = slab->free_list;
+		slab->free_list = (slab_obj_t*)objs[i];
+		slab->in_use--;
+
+		if(slab->in_use == 0){
+			if(ac->num_of_empty < SLAB_MAX_EMPTY_SLABS){
+				ac->num_of_empty++;
+			}else{
+				slab_unlink(ac, slab);
+				ac->slabs--;
+				slab->next = release;
+				release = slab;
+			}
+		}
+	}
+
+	if(remote)
+		ac->remote_frees += num;
+
+	pthread_mutex_unlock(&ac->mutex);
+
+	//Unmap outside the lock
+	while(release){
+		slab = release;
+		release = release->next;
+		munmap(slab, slab->map_len);
+	}
+}
+
+/*
+* Thread caches
+*/
+
+static unsigned int slab_get_node(void){
+
+	unsigned int cpu, node;
+
+	if(syscall(SYS_getcpu, &cpu, &node, NULL) < 0)
+		return 0;
+
+	return node % SLAB_MAX_NUMA_NODES;
+}
+
+static slab_cache_t* slab_cache_create(void){
+
+	slab_cache_t* cache;
+	unsigned int num, cur;
+
+	pthread_once(&slab_once, slab_init);
+
+	//Not from the slabs themselves
+	cache = (slab_cache_t*)calloc(1, sizeof(slab_cache_t));
+	if(unlikely(!cache))
+		return NULL;
+
+	//The node is sampled once; threads are expected to be pinned (or at
+	//least not to migrate across nodes often)
+	cache->node = slab_get_node();
+
+	num = cache->node+1;
+	while((cur = slab_num_of_arenas) < num)
+		__sync_bool_compare_and_swap(&slab_num_of_arenas, cur, num);
+
+	pthread_mutex_lock(&slab_registry_mutex);
+	cache->next = slab_registry;
+	if(slab_registry)
+		slab_registry->prev = cache;
+	slab_registry = cache;
+	pthread_mutex_unlock(&slab_registry_mutex);
+
+	pthread_setspecific(slab_cache_key, cache);
+
+	return cache;
+}
+
+static inline void slab_cache_flush_remote(slab_cache_class_t* cc, unsigned int cls){
+	slab_arena_free(cc->remote_node, cls, cc->remote, cc->remote_count, true);
+	cc->remote_count = 0;
+}
+
+//Thread exit; give the cached objects back
+static void slab_cache_destroy(void* param){
+
+	slab_cache_t* cache = (slab_cache_t*)param;
+	unsigned int i;
+
+	for(i=0; i<SLAB_NUM_OF_CLASSES; ++i){
+		if(cache->classes[i].count)
+			slab_arena_free(cache->node, i, cache->classes[i].objs, cache->classes[i].count, false);
+		if(cache->classes[i].remote_count)
+			slab_cache_flush_remote(&cache->classes[i], i);
+	}
+
+	pthread_mutex_lock(&slab_registry_mutex);
+	for(i=0; i<SLAB_NUM_OF_CLASSES; ++i){
+		slab_retired_allocs[i] += cache->classes[i].allocs;
+		slab_retired_frees[i] += cache->classes[i].frees;
+	}
+	if(cache->prev)
+		cache->prev->next = cache->next;
+	else
+		slab_registry = cache->next;
+	if(cache->next)
+		cache->next->prev = cache->prev;
+	pthread_mutex_unlock(&slab_registry_mutex);
+
+	if(slab_cache == cache)
+		slab_cache = NULL;
+
+	free(cache);
+}
+
+static inline slab_cache_t* slab_get_cache(void){
+	if(likely(slab_cache != NULL))
+		return slab_cache;
+	return slab_cache = slab_cache_create();
+}
+
+/*
+* Large allocations
+*/
+
+//Taken from the libc heap (aligned), as mapping each of them could exhaust
+//the maximum number of mappings of the process
+static void* slab_alloc_large(size_t length){
+
+	size_t len = length + SLAB_HDR_SIZE;
+	slab_t* slab;
+
+	if(unlikely(posix_memalign((void**)&slab, SLAB_SIZE, len) != 0))
+		return NULL;
+
+	slab->magic = SLAB_MAGIC;
+	slab->class_id = SLAB_CLASS_LARGE;
+	slab->map_len = len;
+
+	__sync_add_and_fetch(&slab_large_in_use, 1);
+	__sync_add_and_fetch(&slab_large_bytes, len);
+
+	return (uint8_t*)slab + SLAB_HDR_SIZE;
+}
+
+static void slab_free_large(slab_t* slab){
+
+	__sync_sub_and_fetch(&slab_large_in_use, 1);
+	__sync_sub_and_fetch(&slab_large_bytes, slab->map_len);
+
+	//Do not let a stale header look like a slab
+	slab->magic = 0;
+	free(slab);
+}
+
+/*
+* API
+*/
+
+void* slab_alloc(size_t length){
+
+	slab_cache_t* cache = slab_get_cache();
+	slab_cache_class_t* cc;
+	unsigned int cls;
+	void* obj;
+
+	if(unlikely(length > SLAB_MAX_OBJ_SIZE))
+		return slab_alloc_large(length);
+
+	cls = slab_size_to_class[(length+15)>>4];
+
+	if(unlikely(!cache)){
+		//No thread cache; go to the arena
+		if(slab_arena_alloc(0, cls, &obj, 1) != 1)
+			return NULL;
+		return obj;
+	}
+
+	cc = &cache->classes[cls];
+
+	if(unlikely(cc->count == 0)){
+		cc->count = slab_arena_alloc(cache->node, cls, cc->objs, SLAB_CACHE_SIZE/2);
+		if(unlikely(cc->count == 0))
+			return NULL;
+	}
+
+	cc->allocs++;
+	return cc->objs[--cc->count];
+}
+
+void slab_free(void* data){
+
+	slab_cache_t* cache;
+	slab_cache_class_t* cc;
+	slab_t* slab;
+
+	if(unlikely(!data))
+		return;
+
+	slab = slab_of(data);
+
+	if(unlikely(slab->class_id == SLAB_CLASS_LARGE)){
+		slab_free_large(slab);
+		return;
+	}
+
+	cache = slab_get_cache();
+
+	if(unlikely(!cache)){
+		slab_arena_free(slab->node, slab->class_id, &data, 1, false);
+		return;
+	}
+
+	cc = &cache->classes[slab->class_id];
+	cc->frees++;
+
+	//Objects of other nodes go back to their arena, in batches
+	if(unlikely(slab->node != cache->node)){
+		if(cc->remote_count && (cc->remote_node != slab->node || cc->remote_count == SLAB_REMOTE_BATCH))
+			slab_cache_flush_remote(cc, slab->class_id);
+		cc->remote_node = slab->node;
+		cc->remote[cc->remote_count++] = data;
+		return;
+	}
+
+	if(unlikely(cc->count == SLAB_CACHE_SIZE)){
+		slab_arena_free(cache->node, slab->class_id, &cc->objs[SLAB_CACHE_SIZE/2], SLAB_CACHE_SIZE/2, false);
+		cc->count = SLAB_CACHE_SIZE/2;
+	}
+
+	cc->objs[cc->count++] = data;
+}
+
+void slab_get_stats(slab_stats_t* stats){
+
+	unsigned int i, j;
+	slab_cache_t* cache;
+	slab_class_stats_t* cs;
+
+	pthread_once(&slab_once, slab_init);
+
+	memset(stats, 0, sizeof(*stats));
+
+	for(i=0; i<SLAB_NUM_OF_CLASSES; ++i){
+		cs = &stats->classes[i];
+		cs->obj_size = slab_class_size[i];
+
+		for(j=0; j<SLAB_MAX_NUMA_NODES; ++j){
+			cs->slabs += slab_arenas[j][i].slabs;
+			cs->remote_frees += slab_arenas[j][i].remote_frees;
+		}
+		cs->capacity = cs->slabs * ((SLAB_SIZE - SLAB_HDR_SIZE) / cs->obj_size);
+	}
+
+	pthread_mutex_lock(&slab_registry_mutex);
+	for(i=0; i<SLAB_NUM_OF_CLASSES; ++i){
+		cs = &stats->classes[i];
+		cs->allocs = slab_retired_allocs[i];
+		cs->frees = slab_retired_frees[i];
+
+		for(cache = slab_registry; cache; cache = cache->next){
+			cs->allocs += cache->classes[i].allocs;
+			cs->frees += cache->classes[i].frees;
+			cs->cached += cache->classes[i].count + cache->classes[i].remote_count;
+		}
+
+		cs->in_use = (cs->allocs > cs->frees)? cs->allocs - cs->frees : 0;
+	}
+	pthread_mutex_unlock(&slab_registry_mutex);
+
+	stats->large_in_use = slab_large_in_use;
+	stats->large_bytes = slab_large_bytes;
+	stats->num_of_arenas = slab_num_of_arenas;
+}
@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <rofl.h>
+
+/**
+* @file slab.h
+*
+* @brief Size-class slab allocator used by the pipeline platform memory
+* hooks (platform_malloc, platform_malloc_shared)
+*
+* Objects are carved out of SLAB_SIZE, SLAB_SIZE aligned slabs, so that
+* the slab (and its size class) of an object is found by masking its
+* address. Every NUMA node has its own arena (set of slabs per class),
+* and every thread keeps a small cache of free objects per class in front
+* of the arena of its node, so that allocations and releases of the same
+* thread do not take any lock. Objects released by a thread running on
+* another node are batched per thread and class, and go back to the arena
+* of their slab SLAB_REMOTE_BATCH at a time.
+*
+* Allocations bigger than the largest class are taken from the libc heap,
+* SLAB_SIZE aligned and with the same header.
+*/
+
+//Slab size and alignment (power of 2)
+#define SLAB_SIZE (64*1024)
+
+//Number of size classes; the largest one is SLAB_MAX_OBJ_SIZE
+#define SLAB_NUM_OF_CLASSES 16
+#define SLAB_MAX_OBJ_SIZE 4096
+
+//Max. number of arenas; nodes beyond this share arenas
+#define SLAB_MAX_NUMA_NODES 8
+
+//Per-thread cache depth (objects per class). Half of it is moved
+//from/to the arena at once
+#define SLAB_CACHE_SIZE 64
+
+//Objects of other nodes a thread holds (per class) before returning them
+//to their arena
+#define SLAB_REMOTE_BATCH 16
+
+//Number of fully free slabs each class of an arena keeps mapped
+#define SLAB_MAX_EMPTY_SLABS 4
+
+/**
+* Usage of a size class (all arenas)
+*/
+typedef struct slab_class_stats{
+	size_t obj_size;
+	uint64_t slabs;		//Slabs mapped
+	uint64_t capacity;	//Objects in those slabs
+	uint64_t in_use;	//Objects allocated
+	uint64_t cached;	//Free objects held by thread caches (incl. remote batches)
+	uint64_t allocs;	//Total number of allocations
+	uint64_t frees;		//Total number of releases
+	uint64_t remote_frees;	//Releases from a thread running on another node
+}slab_class_stats_t;
+
+typedef struct slab_stats{
+	slab_class_stats_t classes[SLAB_NUM_OF_CLASSES];
+
+	//Allocations bigger than SLAB_MAX_OBJ_SIZE
+	uint64_t large_in_use;
+	uint64_t large_bytes;
+
+	unsigned int num_of_arenas;
+}slab_stats_t;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* Allocate length bytes (16 byte aligned). Returns NULL on failure
+*/
+void* slab_alloc(size_t length);
+
+/**
+* Release an object allocated with slab_alloc (NULL is ignored)
+*/
+void slab_free(void* data);
+
+/**
+* Snapshot of the usage of the allocator. Counters of the thread caches
+* are read without synchronization and may be slightly stale.
+*/
+void slab_get_stats(slab_stats_t* stats);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //SLAB_H
@@ -0,0 +1,141 @@
+#include "flow_stats_index.h"
+
+using namespace xdpd::gnu_linux;
+
+flow_stats_index::flow_stats_index(unsigned int num_of_tables, bool cookie_index) :
+		tables(num_of_tables),
+		cookie_index(cookie_index)
+{
+	for(unsigned int i=0;i<num_of_tables;i++)
+		tables[i].flow_count = 0;
+
+	pthread_mutex_init(&mutex, NULL);
+}
+
+flow_stats_index::~flow_stats_index(){
+	pthread_mutex_destroy(&mutex);
+}
+
+void flow_stats_index::add(unsigned int table_id, of1x_flow_entry_t* entry){
+
+	if(table_id >= tables.size())
+		return;
+
+	table_index_t& table = tables[table_id];
+
+	pthread_mutex_lock(&mutex);
+
+	if(table.entries.insert(entry).second){
+		table.flow_count++;
+		if(cookie_index)
+			table.cookies[entry->cookie].insert(entry);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void flow_stats_index::remove(unsigned int table_id, of1x_flow_entry_t* entry){
+
+	std::map<uint64_t, entry_set_t>::iterator it;
+
+	if(table_id >= tables.size())
+		return;
+
+	table_index_t& table = tables[table_id];
+
+	pthread_mutex_lock(&mutex);
+
+	if(table.entries.erase(entry)){
+		table.flow_count--;
+
+		if(cookie_index){
+			it = table.cookies.find(entry->cookie);
+			if(it != table.cookies.end()){
+				it->second.erase(entry);
+				if(it->second.empty())
+					table.cookies.erase(it);
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+//Must be called with the mutex held
+void flow_stats_index::aggregate_table(table_index_t& table, uint64_t cookie, uint64_t cookie_mask, uint64_t* packet_count, uint64_t* byte_count, uint32_t* flow_count){
+
+	std::map<uint64_t, entry_set_t>::iterator it;
+	entry_set_t::iterator entry;
+
+	if(!cookie_mask){
+		*flow_count += table.flow_count;
+		aggregate_entries(table.entries, packet_count, byte_count);
+		return;
+	}
+
+	if(cookie_index){
+		//Exact match
+		if(cookie_mask == 0xFFFFFFFFFFFFFFFFULL){
+			it = table.cookies.find(cookie);
+			if(it != table.cookies.end()){
+				*flow_count += it->second.size();
+				aggregate_entries(it->second, packet_count, byte_count);
+			}
+			return;
+		}
+
+		for(it = table.cookies.begin(); it != table.cookies.end(); ++it){
+			if((it->first & cookie_mask) != (cookie & cookie_mask))
+				continue;
+			*flow_count += it->second.size();
+			aggregate_entries(it->second, packet_count, byte_count);
+		}
+		return;
+	}
+
+	//No cookie index; check every entry of the table
+	for(entry = table.entries.begin(); entry != table.entries.end(); ++entry){
+		if(((*entry)->cookie & cookie_mask) != (cookie & cookie_mask))
+			continue;
+		(*flow_count)++;
+		*packet_count += (*entry)->stats.packet_count;
+		*byte_count += (*entry)->stats.byte_count;
+	}
+}
+
+void flow_stats_index::get_aggregate(unsigned int table_id, uint64_t cookie, uint64_t cookie_mask, uint64_t* packet_count, uint64_t* byte_count, uint32_t* flow_count){
+
+	*packet_count = *byte_count = 0;
+	*flow_count = 0;
+
+	pthread_mutex_lock(&mutex);
+
+	if(table_id < tables.size()){
+		aggregate_table(tables[table_id], cookie, cookie_mask, packet_count, byte_count, flow_count);
+	}else{
+		for(unsigned int i=0;i<tables.size();i++)
+			aggregate_table(tables[i], cookie, cookie_mask, packet_count, byte_count, flow_count);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+of1x_flow_entry_t* flow_stats_index::next(unsigned int table_id, of1x_flow_entry_t* after){
+
+	of1x_flow_entry_t* entry = NULL;
+	entry_set_t::iterator it;
+
+	if(table_id >= tables.size())
+		return NULL;
+
+	pthread_mutex_lock(&mutex);
+
+	//Entries are ordered by address; after need not be in the set anymore
+	it = (after)? tables[table_id].entries.upper_bound(after) : tables[table_id].entries.begin();
+	if(it != tables[table_id].entries.end())
+		entry = *it;
+
+	pthread_mutex_unlock(&mutex);
+
+	return entry;
+}
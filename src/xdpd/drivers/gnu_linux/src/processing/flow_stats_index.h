@@ -0,0 +1,101 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FLOW_STATS_INDEX_H_
+#define FLOW_STATS_INDEX_H_
+
+#include <map>
+#include <set>
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
+
+/**
+* @file flow_stats_index.h
+*
+* @brief Per table index of the flow entries of an LSI, used to answer
+* aggregate stats requests without walking the tables.
+*/
+
+namespace xdpd {
+namespace gnu_linux {
+
+/**
+* @brief Index of the flow entries of an LSI, by table and (optionally)
+* by cookie.
+*
+* @description The index is kept up to date by the add/remove entry hooks
+* of the pipeline. It is used to answer aggregate stats requests that only
+* filter by table and cookie (no matches, any out port and group):
+*
+* - the flow count of a table is a running total (O(1))
+* - packet and byte counters are kept per entry by the pipeline; they are
+*   added up over the entries of the table, or, with the cookie index, over
+*   the entries of the matching cookies only. No matching is performed and
+*   the tables are not locked.
+*
+* Entries are removed from the index (remove hook) before the pipeline
+* releases them; the index mutex guarantees they are not read afterwards.
+*
+* The index is also walked, table by table, to answer flow stats requests
+* in chunks (next()); the walk can be resumed after any entry, even if it
+* was removed meanwhile.
+*
+* @ingroup driver_gnu_linux_processing
+*/
+class flow_stats_index{
+
+public:
+	flow_stats_index(unsigned int num_of_tables, bool cookie_index);
+	~flow_stats_index();
+
+	/**
+	* Entry installed in/removed from table table_id
+	*/
+	void add(unsigned int table_id, of1x_flow_entry_t* entry);
+	void remove(unsigned int table_id, of1x_flow_entry_t* entry);
+
+	/**
+	* Aggregate counters of the entries of table_id (or all tables if
+	* table_id >= num_of_tables) for which
+	* (entry->cookie & cookie_mask) == (cookie & cookie_mask)
+	*/
+	void get_aggregate(unsigned int table_id, uint64_t cookie, uint64_t cookie_mask, uint64_t* packet_count, uint64_t* byte_count, uint32_t* flow_count);
+
+	/**
+	* Entry of table_id following after in the order of the index (the
+	* first one if after is NULL), or NULL if there are no more. Must be
+	* called with the table locked, so that the entry is not released
+	* while it is used
+	*/
+	of1x_flow_entry_t* next(unsigned int table_id, of1x_flow_entry_t* after);
+
+private:
+	typedef std::set<of1x_flow_entry_t*> entry_set_t;
+
+	typedef struct table_index{
+		uint32_t flow_count;
+		entry_set_t entries;
+		std::map<uint64_t, entry_set_t> cookies;
+	}table_index_t;
+
+	std::vector<table_index_t> tables;
+	bool cookie_index;
+	pthread_mutex_t mutex;
+
+	void aggregate_table(table_index_t& table, uint64_t cookie, uint64_t cookie_mask, uint64_t* packet_count, uint64_t* byte_count, uint32_t* flow_count);
+
+	static inline void aggregate_entries(entry_set_t& entries, uint64_t* packet_count, uint64_t* byte_count){
+		for(entry_set_t::iterator it = entries.begin(); it != entries.end(); ++it){
+			*packet_count += (*it)->stats.packet_count;
+			*byte_count += (*it)->stats.byte_count;
+		}
+	}
+};
+
+}// namespace xdpd::gnu_linux
+}// namespace xdpd
+
+#endif /* FLOW_STATS_INDEX_H_ */
@@ -5,9 +5,12 @@
 #ifndef LS_INTERNAL_STATE_H_
 #define LS_INTERNAL_STATE_H_
 
+#include <pthread.h>
 #include "../config.h"
 #include "../util/circular_queue.h"
 #include "../io/datapacket_storage.h"
+#include "../io/pktin_meter.h"
+#include "flow_stats_index.h"
 
 /**
 * @file ls_internal_state.h
@@ -22,6 +25,17 @@ namespace gnu_linux {
 
 #define PROCESSING_MAX_LSI_THREADS 16
 
+//Max. number of microflow caches (RX threads) with their own counters;
+//threads beyond this share them
+#define PROCESSING_MAX_MICROFLOW_CACHES 32
+
+//Microflow cache counters of an RX thread (padded to a cache line)
+typedef struct microflow_cache_stats{
+	uint64_t hits;
+	uint64_t misses;
+	uint8_t pad[64-2*sizeof(uint64_t)];
+}microflow_cache_stats_t;
+
 typedef struct switch_platform_state {
         
 	//Input queues
@@ -33,6 +47,27 @@ typedef struct switch_platform_state {
         //Packet storage pointer 
         datapacket_storage* storage;
 
+	//Memory for the buffered (stored) PKT_INs
+	pktin_arena* arena;
+
+	//PKT_IN rate limiting
+	pktin_meter* meter;
+
+	//Index of the flow entries (aggregate stats)
+	flow_stats_index* stats_index;
+
+	//PKT_IN dispatcher (thread, wake-up eventfd and state)
+	pthread_t pktin_thread;
+	int pktin_efd;
+	volatile bool pktin_keep_on;
+	volatile uint32_t pktin_sleeping;
+
+	//Microflow cache (see microflow_cache.h): enabled, generation of the
+	//flow tables and counters per RX thread
+	volatile bool mfc_enabled;
+	volatile uint64_t mfc_generation;
+	microflow_cache_stats_t mfc_stats[PROCESSING_MAX_MICROFLOW_CACHES];
+
 	//Threading information
 	unsigned int num_of_pgs;
 	int pg_index[PROCESSING_MAX_LSI_THREADS];
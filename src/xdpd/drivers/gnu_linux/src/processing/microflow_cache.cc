@@ -0,0 +1,109 @@
+#include "microflow_cache.h"
+#include <stdlib.h>
+#include <new>
+
+using namespace xdpd::gnu_linux;
+
+uint64_t microflow_cache::next_generation = 0;
+pthread_mutex_t microflow_cache::slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+bool microflow_cache::slots_used[PROCESSING_MAX_MICROFLOW_CACHES];
+unsigned int microflow_cache::next_shared_slot = 0;
+
+microflow_cache::microflow_cache(unsigned int num_of_entries) :
+		victim(0)
+{
+	unsigned int num_of_sets = 1;
+
+	while(num_of_sets*2*WAYS <= num_of_entries)
+		num_of_sets *= 2;
+	set_mask = num_of_sets-1;
+
+	if(posix_memalign((void**)&entries, 64, num_of_sets*WAYS*sizeof(entry_t)) != 0)
+		throw std::bad_alloc();
+	memset(entries, 0, num_of_sets*WAYS*sizeof(entry_t));
+
+	acquire_slot();
+}
+
+microflow_cache::~microflow_cache(){
+	release_slot();
+	free(entries);
+}
+
+void microflow_cache::acquire_slot(void){
+
+	pthread_mutex_lock(&slots_mutex);
+
+	for(slot=0; slot<PROCESSING_MAX_MICROFLOW_CACHES; ++slot){
+		if(!slots_used[slot]){
+			slots_used[slot] = true;
+			shared_slot = false;
+			pthread_mutex_unlock(&slots_mutex);
+			return;
+		}
+	}
+
+	//All of them in use
+	slot = next_shared_slot++ % PROCESSING_MAX_MICROFLOW_CACHES;
+	shared_slot = true;
+
+	pthread_mutex_unlock(&slots_mutex);
+}
+
+void microflow_cache::release_slot(void){
+
+	//Shared slots are owned by another cache
+	if(shared_slot)
+		return;
+
+	pthread_mutex_lock(&slots_mutex);
+	slots_used[slot] = false;
+	pthread_mutex_unlock(&slots_mutex);
+}
+
+void microflow_cache::insert(const of_switch_t* sw, uint64_t generation, const packet_matches_t* key, uint32_t hash, const step_t* steps, unsigned int num_of_steps){
+
+	entry_t* set = &entries[(hash & set_mask)*WAYS];
+	entry_t* entry = NULL;
+	unsigned int i;
+
+	if(num_of_steps > PROCESSING_MICROFLOW_CACHE_MAX_STEPS)
+		return;
+
+	//Entries of the same LSI with another generation are stale
+	for(i=0; i<WAYS; ++i){
+		if(set[i].generation == 0 || (set[i].sw == sw && set[i].generation != generation)){
+			entry = &set[i];
+			break;
+		}
+	}
+
+	if(!entry)
+		entry = &set[victim++ % WAYS];
+
+	entry->sw = sw;
+	entry->hash = hash;
+	entry->num_of_steps = num_of_steps;
+	memcpy(entry->steps, steps, num_of_steps*sizeof(step_t));
+	memcpy(&entry->key, key, sizeof(packet_matches_t));
+	entry->generation = generation;
+}
+
+void microflow_cache::init_lsi(switch_platform_state_t* ls_int){
+	ls_int->mfc_enabled = (PROCESSING_MICROFLOW_CACHE != 0);
+	invalidate(ls_int);
+}
+
+void microflow_cache::invalidate(switch_platform_state_t* ls_int){
+	ls_int->mfc_generation = __sync_add_and_fetch(&next_generation, 1);
+}
+
+void microflow_cache::get_stats(switch_platform_state_t* ls_int, uint64_t* hits, uint64_t* misses){
+
+	*hits = *misses = 0;
+
+	for(unsigned int i=0; i<PROCESSING_MAX_MICROFLOW_CACHES; ++i){
+		*hits += ls_int->mfc_stats[i].hits;
+		*misses += ls_int->mfc_stats[i].misses;
+	}
+}
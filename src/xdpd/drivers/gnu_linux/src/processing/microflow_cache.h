@@ -0,0 +1,188 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef MICROFLOW_CACHE_H_
+#define MICROFLOW_CACHE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+#include <rofl/datapath/pipeline/openflow/of_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h>
+#include "../config.h"
+#include "ls_internal_state.h"
+
+/**
+* @file microflow_cache.h
+*
+* @brief Per RX thread exact-match cache of the path of the packets through
+* the OpenFlow pipeline.
+*/
+
+namespace xdpd {
+namespace gnu_linux {
+
+/**
+* @brief Exact-match (microflow) cache in front of the OpenFlow pipeline
+*
+* @description Every RX thread owns a cache. Entries are keyed on the
+* matches of the packet as classified (all the fields the pipeline can
+* match on, but the packet size) and hold the flow entry the packet matched
+* in every table it went through. On a hit, the instructions of those
+* entries are executed and their counters updated as the pipeline does, but
+* no lookup is performed.
+*
+* Entries are tagged with the generation of the flow tables of the LSI
+* (switch_platform_state_t::mfc_generation), which is renewed by the
+* add/modify/remove entry hooks, with the table locked. The generation is
+* checked again, with the table read-locked, before each of the cached flow
+* entries is used; if the tables changed the packet continues through the
+* regular lookups from that table on.
+*
+* Generations are unique for all the LSIs, so entries of a destroyed LSI
+* are never taken for a new LSI at the same address.
+*
+* Every cache owns a slot of the counters of the LSIs
+* (switch_platform_state_t::mfc_stats), given back when the cache is
+* destroyed (RX threads are recreated on port group changes). Only if more
+* than PROCESSING_MAX_MICROFLOW_CACHES caches are alive at once, slots are
+* shared, and concurrent updates of their counters may be lost.
+*
+* Packets that end in a table miss are not cached.
+*
+* @ingroup driver_gnu_linux_processing
+*/
+class microflow_cache{
+
+public:
+	//Number of ways of each set (entries with the same hash bucket)
+	static const unsigned int WAYS = 4;
+
+	typedef struct step{
+		unsigned int table_id;
+		of1x_flow_entry_t* entry;
+	}step_t;
+
+	typedef struct entry{
+		uint64_t generation;	//0 if unused
+		const of_switch_t* sw;
+		uint32_t hash;
+		unsigned int num_of_steps;
+		step_t steps[PROCESSING_MICROFLOW_CACHE_MAX_STEPS];
+		packet_matches_t key;
+	}entry_t;
+
+	/**
+	* num_of_entries is rounded down to a power of 2 (at least WAYS)
+	*/
+	microflow_cache(unsigned int num_of_entries=PROCESSING_MICROFLOW_CACHE_ENTRIES);
+	~microflow_cache();
+
+	/**
+	* Process pkt through the pipeline of sw, using the cache if it is
+	* enabled for the LSI (see microflow_cache_pp.h)
+	*/
+	inline void process_packet(of_switch_t* sw, datapacket_t* pkt);
+
+	/*
+	* Cache lookups
+	*/
+	static inline void make_key(const packet_matches_t* matches, packet_matches_t* key){
+		memcpy(key, matches, sizeof(packet_matches_t));
+
+		//The only field which is not a match
+		key->__pkt_size_bytes = 0;
+	}
+
+	static inline uint32_t hash_key(const packet_matches_t* key){
+		const uint8_t* data = (const uint8_t*)key;
+		uint64_t h = 0xcbf29ce484222325ULL, word;
+		unsigned int i;
+
+		for(i=0; i+sizeof(uint64_t) <= sizeof(packet_matches_t); i+=sizeof(uint64_t)){
+			memcpy(&word, data+i, sizeof(uint64_t));
+			h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+			h ^= h >> 32;
+		}
+		for(; i<sizeof(packet_matches_t); ++i)
+			h = (h ^ data[i]) * 0x100000001b3ULL;
+
+		//Final mix, so that the low bits (set) depend on all of them
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+
+		return (uint32_t)h;
+	}
+
+	inline entry_t* lookup(const of_switch_t* sw, uint64_t generation, const packet_matches_t* key, uint32_t hash){
+		entry_t* set = &entries[(hash & set_mask)*WAYS];
+
+		for(unsigned int i=0; i<WAYS; ++i){
+			if(set[i].hash == hash && set[i].generation == generation && set[i].sw == sw && memcmp(&set[i].key, key, sizeof(packet_matches_t)) == 0)
+				return &set[i];
+		}
+		return NULL;
+	}
+
+	/**
+	* Insert (or overwrite) the path of key. Unused or stale entries of the
+	* set are taken first, then the set is overwritten round-robin
+	*/
+	void insert(const of_switch_t* sw, uint64_t generation, const packet_matches_t* key, uint32_t hash, const step_t* steps, unsigned int num_of_steps);
+
+	//Slot of the counters of this cache in switch_platform_state_t::mfc_stats
+	inline unsigned int get_slot(void){ return slot; }
+
+	/*
+	* LSI state
+	*/
+
+	/**
+	* Initialize the cache state of an LSI (enabled or not by default
+	* according to PROCESSING_MICROFLOW_CACHE)
+	*/
+	static void init_lsi(switch_platform_state_t* ls_int);
+
+	/**
+	* Flow tables of the LSI modified; must be called with the table
+	* locked
+	*/
+	static void invalidate(switch_platform_state_t* ls_int);
+
+	/**
+	* Counters of all the RX threads
+	*/
+	static void get_stats(switch_platform_state_t* ls_int, uint64_t* hits, uint64_t* misses);
+
+private:
+	entry_t* entries;
+	unsigned int set_mask;
+	unsigned int victim;
+	unsigned int slot;
+	bool shared_slot;
+
+	//Key of the packet being processed
+	packet_matches_t key;
+
+	//Generation source (all LSIs)
+	static uint64_t next_generation;
+
+	//Counters slots in use, and next slot to share if all of them are
+	static pthread_mutex_t slots_mutex;
+	static bool slots_used[PROCESSING_MAX_MICROFLOW_CACHES];
+	static unsigned int next_shared_slot;
+
+	void acquire_slot(void);
+	void release_slot(void);
+
+	static inline of1x_flow_entry_t* get_cached_entry(switch_platform_state_t* ls_state, of1x_flow_table_t* table, uint64_t generation, of1x_flow_entry_t* entry);
+};
+
+}// namespace xdpd::gnu_linux
+}// namespace xdpd
+
+#endif /* MICROFLOW_CACHE_H_ */
@@ -0,0 +1,184 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef MICROFLOW_CACHE_PP_H_
+#define MICROFLOW_CACHE_PP_H_
+
+//Make sure pipeline-imp are BEFORE _pp.h
+//so that functions can be inlined
+#include "../pipeline-imp/atomic_operations.h"
+#include "../pipeline-imp/pthread_lock.h"
+#include "../pipeline-imp/packet.h"
+
+#include <rofl/datapath/pipeline/openflow/of_switch_pp.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline_pp.h>
+
+#include "../util/likely.h"
+#include "microflow_cache.h"
+
+/**
+* @file microflow_cache_pp.h
+*
+* @brief Packet processing (inline) part of the microflow cache
+*/
+
+namespace xdpd {
+namespace gnu_linux {
+
+/*
+* Cached flow entry of table, read-locked (as returned by
+* __of1x_find_best_match_table()), or NULL if the flow tables of the LSI
+* changed since it was cached. The generation is renewed with the table
+* locked, so the entry cannot be released while the table is read-locked.
+*/
+inline of1x_flow_entry_t* microflow_cache::get_cached_entry(switch_platform_state_t* ls_state, of1x_flow_table_t* table, uint64_t generation, of1x_flow_entry_t* entry){
+
+	of1x_flow_entry_t* match = NULL;
+
+	platform_rwlock_rdlock(table->rwlock);
+
+	if(likely(ls_state->mfc_generation == generation)){
+		platform_rwlock_rdlock(entry->rwlock);
+		match = entry;
+	}
+
+	platform_rwlock_rdunlock(table->rwlock);
+
+	return match;
+}
+
+/*
+* Same as __of1x_process_packet_pipeline(), but taking the flow entries of
+* the cached path, while the flow tables do not change, instead of looking
+* them up. The path of the packet is recorded and cached if it only goes
+* through flow entries (no table misses).
+*/
+inline void microflow_cache::process_packet(of_switch_t* sw, datapacket_t* pkt){
+
+	of1x_switch_t* of1x_sw = (of1x_switch_t*)sw;
+	switch_platform_state_t* ls_state = (switch_platform_state_t*)sw->platform_state;
+	microflow_cache_stats_t* stats;
+	of1x_flow_table_t* table;
+	of1x_flow_entry_t* match;
+	entry_t* cached;
+	step_t steps[PROCESSING_MICROFLOW_CACHE_MAX_STEPS];
+	unsigned int i, num_of_steps, table_to_go, num_of_outputs;
+	uint64_t generation;
+	uint32_t hash;
+	bool cacheable = true;
+
+	if(!ls_state->mfc_enabled){
+		of_process_packet_pipeline(sw, pkt);
+		return;
+	}
+
+	stats = &ls_state->mfc_stats[slot];
+
+	//The key must be taken before the packet is modified by the actions
+	generation = ls_state->mfc_generation;
+	make_key(&pkt->matches, &key);
+	hash = hash_key(&key);
+	cached = lookup(sw, generation, &key, hash);
+	num_of_steps = 0;
+
+	//Initialize packet for OF1.X pipeline processing
+	__init_packet_metadata(pkt);
+	__of1x_init_packet_write_actions(&pkt->write_actions.of1x);
+
+	//Mark packet as being processed by this sw
+	pkt->sw = sw;
+
+	for(i=OF1X_FIRST_FLOW_TABLE_INDEX; i < of1x_sw->pipeline.num_of_tables; i++){
+
+		table = &of1x_sw->pipeline.tables[i];
+		match = NULL;
+
+		if(cached){
+			if(likely(num_of_steps < cached->num_of_steps && cached->steps[num_of_steps].table_id == i))
+				match = get_cached_entry(ls_state, table, cached->generation, cached->steps[num_of_steps].entry);
+
+			//Flow tables modified; regular lookups from here on
+			if(unlikely(match == NULL))
+				cached = NULL;
+		}
+
+		if(!match)
+			match = __of1x_find_best_match_table(table, pkt);
+
+		if(likely(match != NULL)){
+
+			if(likely(num_of_steps < PROCESSING_MICROFLOW_CACHE_MAX_STEPS)){
+				steps[num_of_steps].table_id = i;
+				steps[num_of_steps].entry = match;
+			}
+			num_of_steps++;
+
+			//Update table and entry statistics
+			__of1x_stats_table_matches_inc(table);
+			__of1x_stats_flow_update_match(match, platform_packet_get_size_bytes(pkt));
+
+			//Process instructions
+			table_to_go = __of1x_process_instructions(of1x_sw, i, pkt, &match->inst_grp);
+
+			if(table_to_go > i && likely(table_to_go < OF1X_MAX_FLOWTABLES)){
+				i = table_to_go-1;
+
+				//Unlock the entry so that it can eventually be modified/deleted
+				platform_rwlock_rdunlock(match->rwlock);
+				continue;
+			}
+
+			//Process WRITE actions
+			__of1x_process_write_actions(of1x_sw, i, pkt, __of1x_process_instructions_must_replicate(&match->inst_grp));
+
+			//Recover the num_of_outputs to release the lock asap
+			num_of_outputs = match->inst_grp.num_of_outputs;
+
+			//Unlock the entry so that it can eventually be modified/deleted
+			platform_rwlock_rdunlock(match->rwlock);
+
+			if(cached){
+				stats->hits++;
+			}else{
+				stats->misses++;
+				if(cacheable)
+					insert(sw, generation, &key, hash, steps, num_of_steps);
+			}
+
+			//Drop packet Only if there has been copy(cloning of the packet) due to
+			//multiple output actions
+			if(num_of_outputs != 1)
+				platform_packet_drop(pkt);
+
+			return;
+		}
+
+		//Update table statistics
+		__of1x_stats_table_lookup_inc(table);
+
+		//Not matched, look for table_miss behaviour
+		if(table->default_action == OF1X_TABLE_MISS_DROP){
+			stats->misses++;
+			platform_packet_drop(pkt);
+			return;
+		}else if(table->default_action == OF1X_TABLE_MISS_CONTROLLER){
+			stats->misses++;
+			platform_of1x_packet_in(of1x_sw, i, pkt, of1x_sw->pipeline.miss_send_len, OF1X_PKT_IN_NO_MATCH);
+			return;
+		}
+
+		//OF1X_TABLE_MISS_CONTINUE; next table. Paths with misses are
+		//not cached
+		cacheable = false;
+	}
+
+	//No table left
+	stats->misses++;
+	platform_packet_drop(pkt);
+}
+
+}// namespace xdpd::gnu_linux
+}// namespace xdpd
+
+#endif /* MICROFLOW_CACHE_PP_H_ */
@@ -0,0 +1,241 @@
+#include "telemetry.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <rofl/common/utils/c_logger.h>
+#include <rofl/datapath/pipeline/physical_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+#include "config.h"
+#include "io/bufferpool.h"
+#include "io/ports/ioport.h"
+#include "util/time_utils.h"
+
+using namespace xdpd::gnu_linux;
+
+//Mapped segment
+static telemetry_shm_hdr_t* hdr = NULL;
+static struct timeval last_publish = {0,0};
+
+#define TELEMETRY_MAX_QUEUES (TELEMETRY_MAX_PORTS*IO_IFACE_NUM_QUEUES)
+
+rofl_result_t telemetry_init(){
+
+	int fd;
+	size_t len;
+
+	len = sizeof(telemetry_shm_hdr_t) +
+		TELEMETRY_MAX_PORTS*sizeof(telemetry_port_t) +
+		TELEMETRY_MAX_QUEUES*sizeof(telemetry_queue_t) +
+		TELEMETRY_MAX_LSIS*sizeof(telemetry_lsi_t) +
+		TELEMETRY_MAX_TABLES*sizeof(telemetry_table_t) +
+		sizeof(telemetry_bufferpool_t);
+
+	fd = shm_open(TELEMETRY_SHM_NAME, O_CREAT | O_RDWR | O_TRUNC, 0644);
+	if(fd < 0){
+		ROFL_ERR(DRIVER_NAME"[telemetry] Unable to create shared memory segment %s, errno(%d): %s\n", TELEMETRY_SHM_NAME, errno, strerror(errno));
+		return ROFL_FAILURE;
+	}
+
+	if(ftruncate(fd, len) < 0){
+		ROFL_ERR(DRIVER_NAME"[telemetry] Unable to size shared memory segment %s, errno(%d): %s\n", TELEMETRY_SHM_NAME, errno, strerror(errno));
+		close(fd);
+		shm_unlink(TELEMETRY_SHM_NAME);
+		return ROFL_FAILURE;
+	}
+
+	hdr = (telemetry_shm_hdr_t*)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(hdr == MAP_FAILED){
+		ROFL_ERR(DRIVER_NAME"[telemetry] Unable to map shared memory segment %s, errno(%d): %s\n", TELEMETRY_SHM_NAME, errno, strerror(errno));
+		hdr = NULL;
+		shm_unlink(TELEMETRY_SHM_NAME);
+		return ROFL_FAILURE;
+	}
+
+	//Layout (the segment is zeroed by ftruncate)
+	hdr->version = TELEMETRY_SHM_VERSION;
+	hdr->len = len;
+	hdr->period_ms = TELEMETRY_PERIOD_MS;
+
+	hdr->ports_off = sizeof(telemetry_shm_hdr_t);
+	hdr->max_ports = TELEMETRY_MAX_PORTS;
+	hdr->queues_off = hdr->ports_off + TELEMETRY_MAX_PORTS*sizeof(telemetry_port_t);
+	hdr->max_queues = TELEMETRY_MAX_QUEUES;
+	hdr->lsis_off = hdr->queues_off + TELEMETRY_MAX_QUEUES*sizeof(telemetry_queue_t);
+	hdr->max_lsis = TELEMETRY_MAX_LSIS;
+	hdr->tables_off = hdr->lsis_off + TELEMETRY_MAX_LSIS*sizeof(telemetry_lsi_t);
+	hdr->max_tables = TELEMETRY_MAX_TABLES;
+	hdr->bufferpool_off = hdr->tables_off + TELEMETRY_MAX_TABLES*sizeof(telemetry_table_t);
+
+	//Readers check the magic last
+	__sync_synchronize();
+	hdr->magic = TELEMETRY_SHM_MAGIC;
+
+	ROFL_INFO(DRIVER_NAME"[telemetry] Publishing counters in shared memory segment %s (%u bytes) every %ums\n", TELEMETRY_SHM_NAME, (unsigned int)len, TELEMETRY_PERIOD_MS);
+
+	return ROFL_SUCCESS;
+}
+
+static void publish_ports(switch_port_t** ports, unsigned int max_ports){
+
+	unsigned int i, q, num_of_queues;
+	switch_port_t* port;
+	telemetry_port_t* tport;
+	telemetry_queue_t* tqueue;
+
+	for(i=0; i<max_ports; i++){
+
+		port = ports[i];
+		if(!port)
+			continue;
+
+		if(hdr->num_ports == hdr->max_ports)
+			return;
+
+		tport = (telemetry_port_t*)((uint8_t*)hdr + hdr->ports_off) + hdr->num_ports;
+
+		strncpy(tport->name, port->name, TELEMETRY_NAME_LEN-1);
+		tport->name[TELEMETRY_NAME_LEN-1] = '\0';
+		tport->flags = 0x0;
+		if(port->up)
+			tport->flags |= TELEMETRY_PORT_UP;
+		if(port->type == PORT_TYPE_VIRTUAL)
+			tport->flags |= TELEMETRY_PORT_VIRTUAL;
+		if(port->attached_sw){
+			tport->flags |= TELEMETRY_PORT_ATTACHED;
+			tport->dpid = port->attached_sw->dpid;
+			tport->of_port_num = port->of_port_num;
+		}else{
+			tport->dpid = 0x0;
+			tport->of_port_num = 0;
+		}
+
+		tport->rx_packets = port->stats.rx_packets;
+		tport->tx_packets = port->stats.tx_packets;
+		tport->rx_bytes = port->stats.rx_bytes;
+		tport->tx_bytes = port->stats.tx_bytes;
+		tport->rx_dropped = port->stats.rx_dropped;
+		tport->tx_dropped = port->stats.tx_dropped;
+		tport->rx_errors = port->stats.rx_errors;
+		tport->tx_errors = port->stats.tx_errors;
+		tport->rx_frame_err = port->stats.rx_frame_err;
+		tport->rx_over_err = port->stats.rx_over_err;
+		tport->rx_crc_err = port->stats.rx_crc_err;
+		tport->collisions = port->stats.collisions;
+
+		//Output queues
+		num_of_queues = (port->platform_port_state)? ((ioport*)port->platform_port_state)->get_num_of_queues() : 0;
+
+		for(q=0; q<num_of_queues && hdr->num_queues < hdr->max_queues; q++){
+			tqueue = (telemetry_queue_t*)((uint8_t*)hdr + hdr->queues_off) + hdr->num_queues;
+
+			tqueue->port = hdr->num_ports;
+			tqueue->queue_id = q;
+			tqueue->tx_packets = port->queues[q].stats.tx_packets;
+			tqueue->tx_bytes = port->queues[q].stats.tx_bytes;
+			tqueue->overrun = port->queues[q].stats.overrun;
+
+			hdr->num_queues++;
+		}
+
+		hdr->num_ports++;
+	}
+}
+
+static void publish_lsis(void){
+
+	unsigned int i, t, max_switches;
+	of_switch_t** switches;
+	of1x_switch_t* lsw;
+	telemetry_lsi_t* tlsi;
+	telemetry_table_t* ttable;
+
+	switches = physical_switch_get_logical_switches(&max_switches);
+
+	for(i=0; i<max_switches; i++){
+
+		lsw = (of1x_switch_t*)switches[i];
+		if(!lsw)
+			continue;
+
+		if(hdr->num_lsis == hdr->max_lsis)
+			return;
+
+		tlsi = (telemetry_lsi_t*)((uint8_t*)hdr + hdr->lsis_off) + hdr->num_lsis;
+
+		strncpy(tlsi->name, lsw->name, TELEMETRY_NAME_LEN-1);
+		tlsi->name[TELEMETRY_NAME_LEN-1] = '\0';
+		tlsi->dpid = lsw->dpid;
+		tlsi->of_version = lsw->of_ver;
+		tlsi->num_of_tables = lsw->pipeline.num_of_tables;
+
+		for(t=0; t<lsw->pipeline.num_of_tables && hdr->num_tables < hdr->max_tables; t++){
+			ttable = (telemetry_table_t*)((uint8_t*)hdr + hdr->tables_off) + hdr->num_tables;
+
+			ttable->lsi = hdr->num_lsis;
+			ttable->table_id = t;
+			ttable->num_of_entries = lsw->pipeline.tables[t].num_of_entries;
+			ttable->lookup_count = lsw->pipeline.tables[t].stats.lookup_count;
+			ttable->matched_count = lsw->pipeline.tables[t].stats.matched_count;
+
+			hdr->num_tables++;
+		}
+
+		hdr->num_lsis++;
+	}
+}
+
+void telemetry_publish(){
+
+	unsigned int max_ports;
+	struct timeval now;
+	struct timespec ts;
+	telemetry_bufferpool_t* tbp;
+
+	if(!hdr)
+		return;
+
+	gettimeofday(&now, NULL);
+	if(get_time_difference_ms(&now, &last_publish) < TELEMETRY_PERIOD_MS)
+		return;
+	last_publish = now;
+
+	//Enter the write section (odd)
+	hdr->seq++;
+	__sync_synchronize();
+
+	hdr->num_ports = hdr->num_queues = hdr->num_lsis = hdr->num_tables = 0;
+
+	publish_ports(physical_switch_get_physical_ports(&max_ports), max_ports);
+	publish_ports(physical_switch_get_virtual_ports(&max_ports), max_ports);
+	publish_lsis();
+
+	tbp = (telemetry_bufferpool_t*)((uint8_t*)hdr + hdr->bufferpool_off);
+	tbp->capacity = bufferpool::get_capacity();
+	tbp->in_use = bufferpool::get_num_of_buffers_in_use();
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	hdr->timestamp_ns = ts.tv_sec*1000000000ULL + ts.tv_nsec;
+	hdr->generation++;
+
+	//Leave the write section (even)
+	__sync_synchronize();
+	hdr->seq++;
+}
+
+void telemetry_destroy(){
+
+	if(!hdr)
+		return;
+
+	munmap(hdr, hdr->len);
+	hdr = NULL;
+
+	shm_unlink(TELEMETRY_SHM_NAME);
+}
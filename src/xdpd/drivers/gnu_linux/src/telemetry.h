@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef XDPD_GNU_LINUX_TELEMETRY_H
+#define XDPD_GNU_LINUX_TELEMETRY_H
+
+#include <rofl.h>
+#include "telemetry_shm.h"
+
+/**
+* @file telemetry.h
+*
+* @brief Publishing of the datapath counters in a shared-memory segment
+* (TELEMETRY_SHM_NAME), so that external collectors can sample them without
+* going through the control plane. The layout is defined in telemetry_shm.h.
+*
+* The segment is written by the background task manager thread only.
+*/
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* Create and map the segment
+*/
+rofl_result_t telemetry_init(void);
+
+/**
+* Update the segment, if TELEMETRY_PERIOD_MS have elapsed since the last update
+*/
+void telemetry_publish(void);
+
+/**
+* Unmap and remove the segment
+*/
+void telemetry_destroy(void);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //XDPD_GNU_LINUX_TELEMETRY_H
@@ -0,0 +1,132 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef XDPD_GNU_LINUX_TELEMETRY_SHM_H
+#define XDPD_GNU_LINUX_TELEMETRY_SHM_H
+
+#include <stdint.h>
+
+/**
+* @file telemetry_shm.h
+*
+* @brief Layout of the shared-memory telemetry segment of the GNU/Linux
+* driver. This header is self-contained, so that it can be used by external
+* readers (see tools/telemetry_reader.c).
+*
+* The segment starts with a telemetry_shm_hdr_t, followed by arrays of ports,
+* queues, LSIs and tables, and the bufferpool counters, at the offsets
+* specified in the header. The driver rewrites the whole segment every
+* period_ms. Readers must copy the data they are interested in between
+* telemetry_shm_read_begin() and telemetry_shm_read_retry(), and retry if the
+* latter returns true:
+*
+* @code
+*	do{
+*		seq = telemetry_shm_read_begin(hdr);
+*		... copy counters ...
+*	}while(telemetry_shm_read_retry(hdr, seq));
+* @endcode
+*/
+
+#define TELEMETRY_SHM_MAGIC 0x78647064544c4d59ULL
+#define TELEMETRY_SHM_VERSION 1
+
+#define TELEMETRY_NAME_LEN 32
+
+//Port flags
+#define TELEMETRY_PORT_UP 0x1
+#define TELEMETRY_PORT_ATTACHED 0x2
+#define TELEMETRY_PORT_VIRTUAL 0x4
+
+typedef struct telemetry_shm_hdr{
+	uint64_t magic;
+	uint32_t version;		//Layout version
+	uint32_t len;			//Total length of the segment
+
+	//Seqlock; odd while the segment is being updated
+	volatile uint32_t seq;
+	uint32_t period_ms;		//Publishing period
+
+	uint64_t timestamp_ns;		//Time of the last update (CLOCK_REALTIME)
+	uint64_t generation;		//Number of updates
+
+	//Arrays; offset from the beginning of the segment, capacity and valid entries
+	uint32_t ports_off, max_ports, num_ports;
+	uint32_t queues_off, max_queues, num_queues;
+	uint32_t lsis_off, max_lsis, num_lsis;
+	uint32_t tables_off, max_tables, num_tables;
+	uint32_t bufferpool_off;
+	uint32_t pad;
+}telemetry_shm_hdr_t;
+
+typedef struct telemetry_port{
+	char name[TELEMETRY_NAME_LEN];
+	uint64_t dpid;			//LSI the port is attached to (if TELEMETRY_PORT_ATTACHED)
+	uint32_t of_port_num;
+	uint32_t flags;
+
+	uint64_t rx_packets;
+	uint64_t tx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_bytes;
+	uint64_t rx_dropped;
+	uint64_t tx_dropped;
+	uint64_t rx_errors;
+	uint64_t tx_errors;
+	uint64_t rx_frame_err;
+	uint64_t rx_over_err;
+	uint64_t rx_crc_err;
+	uint64_t collisions;
+}telemetry_port_t;
+
+typedef struct telemetry_queue{
+	uint32_t port;			//Index in the ports array
+	uint32_t queue_id;
+
+	uint64_t tx_packets;
+	uint64_t tx_bytes;
+	uint64_t overrun;
+}telemetry_queue_t;
+
+typedef struct telemetry_lsi{
+	char name[TELEMETRY_NAME_LEN];
+	uint64_t dpid;
+	uint32_t of_version;
+	uint32_t num_of_tables;
+}telemetry_lsi_t;
+
+typedef struct telemetry_table{
+	uint32_t lsi;			//Index in the LSIs array
+	uint32_t table_id;
+
+	uint64_t num_of_entries;
+	uint64_t lookup_count;
+	uint64_t matched_count;
+}telemetry_table_t;
+
+typedef struct telemetry_bufferpool{
+	uint64_t capacity;
+	uint64_t in_use;
+}telemetry_bufferpool_t;
+
+/*
+* Read side of the seqlock
+*/
+static inline uint32_t telemetry_shm_read_begin(const telemetry_shm_hdr_t* hdr){
+
+	uint32_t seq;
+
+	//Wait for the writer to finish
+	while((seq = hdr->seq) & 0x1);
+
+	__sync_synchronize();
+	return seq;
+}
+
+static inline int telemetry_shm_read_retry(const telemetry_shm_hdr_t* hdr, uint32_t seq){
+	__sync_synchronize();
+	return hdr->seq != seq;
+}
+
+#endif //XDPD_GNU_LINUX_TELEMETRY_SHM_H
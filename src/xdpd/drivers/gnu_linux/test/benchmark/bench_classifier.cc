@@ -0,0 +1,652 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* Micro-benchmark of the C packet classifier (classify_packet,
+* reset_classifier and the push/pop operations) over synthetic traces
+* (one per protocol mix) and over pcap files, which are memory-mapped.
+*
+* The fuzz mode mutates the traces (bit flips, header floods, truncation)
+* and checks, for every packet, that the classifier state stays within the
+* packet boundaries. Packets are placed right before a PROT_NONE page, so
+* over-reads fault even without ASan.
+*
+* Usage: bench_classifier [-n iterations] [file.pcap ...]
+*        bench_classifier -f [-n iterations] [-s seed] [file.pcap ...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+#include "io/datapacketx86.h"
+#include "io/packet_classifiers/c_pktclassifier/c_pktclassifier.h"
+#include "bench_utils.h"
+
+using namespace xdpd::gnu_linux;
+
+#define TRACE_NUM_OF_PKTS 1024
+#define FUZZ_BUFFER_SIZE 4096
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET 1
+
+//Push&pop pair applied on each trace
+enum trace_op{
+	TRACE_OP_VLAN,		//push_vlan + pop_vlan
+	TRACE_OP_MPLS,		//push_mpls + pop_mpls
+	TRACE_OP_PPPOE,		//pop_pppoe + push_pppoe
+	TRACE_OP_GTP,		//pop_gtp + push_gtp
+};
+
+typedef struct trace{
+	char name[64];
+	enum trace_op op;
+
+	//Backing memory (malloc'ed or mmap'ed)
+	uint8_t* mem;
+	size_t mem_len;
+	bool mapped;
+
+	unsigned int num_of_pkts;
+	uint8_t** pkts;
+	size_t* lens;
+}trace_t;
+
+static datapacket_t pkt;
+static datapacketx86* pack;
+
+/*
+* Synthetic traces
+*/
+
+typedef struct writer{
+	uint8_t* p;
+}writer_t;
+
+static inline void put8(writer_t* w, uint8_t v){ *w->p++ = v; }
+static inline void put16(writer_t* w, uint16_t v){ put8(w, v >> 8); put8(w, v & 0xff); }
+static inline void put32(writer_t* w, uint32_t v){ put16(w, v >> 16); put16(w, v & 0xffff); }
+static inline void put_mac(writer_t* w, uint32_t id){ put16(w, 0x0000); put32(w, id); }
+
+static void put_ether(writer_t* w, unsigned int i, uint16_t type){
+	put_mac(w, 0x11000000 + (i & 0xff));
+	put_mac(w, 0x22000000 + (i & 0xff));
+	put16(w, type);
+}
+
+static void put_ipv4(writer_t* w, unsigned int i, uint16_t len, uint8_t proto){
+	put16(w, 0x4500);
+	put16(w, len);
+	put32(w, 0x00004000);	//id 0, DF
+	put8(w, 64);
+	put8(w, proto);
+	put16(w, 0);
+	put32(w, 0x0a000000 + (i & 0xffff));
+	put32(w, 0x0a010000 + ((i*7) & 0xffff));
+}
+
+static void put_l4(writer_t* w, unsigned int i, uint16_t len, bool tcp){
+	put16(w, 1024 + (i & 0x3ff));
+	put16(w, tcp? 80 : 53);
+	if(tcp){
+		put32(w, i);
+		put32(w, 0);
+		put16(w, 0x5010);
+		put16(w, 0xffff);
+		put32(w, 0);
+	}else{
+		put16(w, len);
+		put16(w, 0);
+	}
+}
+
+//L3/L4 part: IPv4 + UDP/TCP, ip_len bytes in total
+static void put_ipv4_l4(writer_t* w, unsigned int i, uint16_t ip_len, bool tcp){
+	put_ipv4(w, i, ip_len, tcp? 6 : 17);
+	put_l4(w, i, ip_len - 20, tcp);
+}
+
+static size_t build_l2(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	put_ether(&w, i, 0x0800);
+	put_ipv4_l4(&w, i, size - 14, i & 1);
+	return w.p - buf;
+}
+
+static size_t build_qinq(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	put_ether(&w, i, 0x88a8);
+	put16(&w, 1 + (i % 4094));
+	put16(&w, 0x8100);
+	put16(&w, 1 + ((i*3) % 4094));
+	put16(&w, 0x0800);
+	put_ipv4_l4(&w, i, size - 22, true);
+	return w.p - buf;
+}
+
+static size_t build_mpls(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	unsigned int j, labels = 1 + (i % 4);
+	put_ether(&w, i, 0x8847);
+	for(j=0;j<labels;j++)
+		put32(&w, ((16 + i + j) << 12) | ((j == labels-1)? 0x100 : 0) | 64);
+	put_ipv4_l4(&w, i, size - 14 - labels*4, false);
+	return w.p - buf;
+}
+
+static size_t build_pppoe(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	put_ether(&w, i, 0x8864);
+	put8(&w, 0x11);
+	put8(&w, 0x00);
+	put16(&w, 1 + (i & 0xfff));
+	put16(&w, size - 14 - 6);
+	put16(&w, 0x0021);
+	put_ipv4_l4(&w, i, size - 14 - 8, i & 1);
+	return w.p - buf;
+}
+
+//IPv6 + hop-by-hop + routing extension headers + TCP
+static size_t build_ipv6_ext(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	unsigned int j;
+	put_ether(&w, i, 0x86dd);
+	put32(&w, 0x60000000 | (i & 0xfffff));
+	put16(&w, size - 14 - 40);
+	put8(&w, 0);		//hop-by-hop
+	put8(&w, 64);
+	for(j=0;j<2;j++){
+		put32(&w, 0x20010db8);
+		put32(&w, j);
+		put32(&w, 0);
+		put32(&w, i);
+	}
+	//Hop-by-hop (PadN)
+	put8(&w, 43);
+	put8(&w, 0);
+	put16(&w, 0x0104);
+	put32(&w, 0);
+	//Routing (type 0 header, no addresses)
+	put8(&w, 6);
+	put8(&w, 0);
+	put8(&w, 0);
+	put8(&w, 0);
+	put32(&w, 0);
+	put_l4(&w, i, 0, true);
+	return w.p - buf;
+}
+
+static size_t build_gtp(uint8_t* buf, size_t size, unsigned int i){
+	writer_t w = { buf };
+	size_t ip_len = size - 14;
+	put_ether(&w, i, 0x0800);
+	put_ipv4(&w, i, ip_len, 17);
+	put16(&w, 2152);
+	put16(&w, 2152);
+	put16(&w, ip_len - 20);
+	put16(&w, 0);
+	put8(&w, 0x30);
+	put8(&w, 0xff);
+	put16(&w, ip_len - 36);
+	put32(&w, 0x1000 + i);
+	put_ipv4_l4(&w, i, ip_len - 36, true);
+	return w.p - buf;
+}
+
+typedef size_t (*builder_t)(uint8_t* buf, size_t size, unsigned int i);
+
+static void build_trace(trace_t* trace, const char* name, builder_t builder, enum trace_op op){
+	//Frame sizes of the trace (the headers of the largest mix fit in 128 bytes)
+	static const size_t sizes[] = { 128, 128, 576, 128, 1500, 128, 576, 256 };
+	unsigned int i;
+	size_t offset = 0;
+
+	memset(trace, 0, sizeof(*trace));
+	snprintf(trace->name, sizeof(trace->name), "%s", name);
+	trace->op = op;
+	trace->num_of_pkts = TRACE_NUM_OF_PKTS;
+	trace->pkts = (uint8_t**)malloc(sizeof(uint8_t*)*TRACE_NUM_OF_PKTS);
+	trace->lens = (size_t*)malloc(sizeof(size_t)*TRACE_NUM_OF_PKTS);
+
+	for(i=0;i<TRACE_NUM_OF_PKTS;i++)
+		trace->mem_len += sizes[i % (sizeof(sizes)/sizeof(sizes[0]))];
+	trace->mem = (uint8_t*)calloc(1, trace->mem_len);
+
+	for(i=0;i<TRACE_NUM_OF_PKTS;i++){
+		size_t size = sizes[i % (sizeof(sizes)/sizeof(sizes[0]))];
+		trace->pkts[i] = trace->mem + offset;
+		trace->lens[i] = size;
+		builder(trace->pkts[i], size, i);
+		offset += size;
+	}
+}
+
+/*
+* pcap traces
+*/
+
+static inline uint32_t pcap_field(uint32_t v, bool swapped){
+	return (swapped)? __builtin_bswap32(v) : v;
+}
+
+static bool load_pcap(trace_t* trace, const char* path){
+	int fd;
+	struct stat st;
+	uint32_t* hdr;
+	bool swapped;
+	size_t offset;
+	unsigned int n;
+
+	memset(trace, 0, sizeof(*trace));
+	snprintf(trace->name, sizeof(trace->name), "pcap %s", path);
+	trace->op = TRACE_OP_VLAN;
+
+	if((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st) < 0 || st.st_size < 24){
+		fprintf(stderr, "ERROR: unable to open %s\n", path);
+		if(fd >= 0)
+			close(fd);
+		return false;
+	}
+
+	trace->mem_len = st.st_size;
+	trace->mem = (uint8_t*)mmap(NULL, trace->mem_len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(trace->mem == MAP_FAILED){
+		trace->mem = NULL;
+		fprintf(stderr, "ERROR: unable to mmap %s\n", path);
+		return false;
+	}
+	trace->mapped = true;
+
+	//Global header
+	hdr = (uint32_t*)trace->mem;
+	if(hdr[0] == PCAP_MAGIC || hdr[0] == PCAP_MAGIC_NS){
+		swapped = false;
+	}else if(hdr[0] == __builtin_bswap32(PCAP_MAGIC) || hdr[0] == __builtin_bswap32(PCAP_MAGIC_NS)){
+		swapped = true;
+	}else{
+		fprintf(stderr, "ERROR: %s is not a pcap file\n", path);
+		return false;
+	}
+	if(pcap_field(hdr[5], swapped) != PCAP_LINKTYPE_ETHERNET){
+		fprintf(stderr, "ERROR: %s is not an Ethernet capture\n", path);
+		return false;
+	}
+
+	//Count and index records; packets are used in place
+	for(n=0, offset=24; offset + 16 <= trace->mem_len; n++)
+		offset += 16 + pcap_field(((uint32_t*)(trace->mem + offset))[2], swapped);
+
+	trace->pkts = (uint8_t**)malloc(sizeof(uint8_t*)*n);
+	trace->lens = (size_t*)malloc(sizeof(size_t)*n);
+
+	for(n=0, offset=24; offset + 16 <= trace->mem_len; ){
+		size_t caplen = pcap_field(((uint32_t*)(trace->mem + offset))[2], swapped);
+		if(offset + 16 + caplen > trace->mem_len)
+			break;
+		if(caplen > 0){
+			trace->pkts[n] = trace->mem + offset + 16;
+			trace->lens[n] = caplen;
+			n++;
+		}
+		offset += 16 + caplen;
+	}
+	trace->num_of_pkts = n;
+
+	return n > 0;
+}
+
+static void destroy_trace(trace_t* trace){
+	if(trace->mapped)
+		munmap(trace->mem, trace->mem_len);
+	else
+		free(trace->mem);
+	free(trace->pkts);
+	free(trace->lens);
+}
+
+/*
+* Benchmarks
+*/
+
+//Push&pop pair; leaves the packet with the same headers
+static void apply_op(enum trace_op op){
+	classify_state_t* clas_state = pack->headers;
+
+	switch(op){
+		case TRACE_OP_VLAN:
+			push_vlan(&pkt, clas_state, VLAN_CTAG_ETHER);
+			pop_vlan(&pkt, clas_state);
+			break;
+		case TRACE_OP_MPLS:
+			push_mpls(&pkt, clas_state, ETH_TYPE_MPLS_UNICAST);
+			pop_mpls(&pkt, clas_state, ETH_TYPE_MPLS_UNICAST);
+			break;
+		case TRACE_OP_PPPOE:
+			pop_pppoe(&pkt, clas_state, ETH_TYPE_IPV4);
+			push_pppoe(&pkt, clas_state, ETH_TYPE_PPPOE_SESSION);
+			break;
+		case TRACE_OP_GTP:
+			pop_gtp(&pkt, clas_state, 0);
+			push_gtp(&pkt, clas_state, ETH_TYPE_IPV4);
+			break;
+	}
+}
+
+static void bench_trace(trace_t* trace, unsigned int iterations){
+	unsigned int i, j, rounds = (iterations + trace->num_of_pkts - 1)/trace->num_of_pkts;
+	uint64_t start_ns, start_cy;
+	bench_result_t res, init_res;
+	char name[128];
+
+	bench_print_header(trace->name);
+
+	//Classification in place (as done on RX)
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+	for(i=0;i<rounds;i++)
+		for(j=0;j<trace->num_of_pkts;j++)
+			classify_packet(pack->headers, trace->pkts[j], trace->lens[j], 1, 1);
+	res.cycles = bench_cycles() - start_cy;
+	res.ns = bench_now_ns() - start_ns;
+	res.ops = (uint64_t)rounds*trace->num_of_pkts;
+	res.name = "classify_packet";
+	bench_print(&res);
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+	for(i=0;i<rounds;i++)
+		for(j=0;j<trace->num_of_pkts;j++)
+			reset_classifier(pack->headers);
+	res.cycles = bench_cycles() - start_cy;
+	res.ns = bench_now_ns() - start_ns;
+	res.name = "reset_classifier";
+	bench_print(&res);
+
+	//Copy to user space and classification
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+	for(i=0;i<rounds;i++){
+		for(j=0;j<trace->num_of_pkts;j++){
+			pack->init(trace->pkts[j], trace->lens[j], NULL, 1, 1, true);
+			pack->destroy();
+		}
+	}
+	init_res.cycles = bench_cycles() - start_cy;
+	init_res.ns = bench_now_ns() - start_ns;
+	init_res.ops = res.ops;
+	init_res.name = "init (copy+classify)";
+	bench_print(&init_res);
+
+	//Push&pop; the cost of init is subtracted
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+	for(i=0;i<rounds;i++){
+		for(j=0;j<trace->num_of_pkts;j++){
+			pack->init(trace->pkts[j], trace->lens[j], NULL, 1, 1, true);
+			apply_op(trace->op);
+			pack->destroy();
+		}
+	}
+	res.cycles = bench_cycles() - start_cy;
+	res.ns = bench_now_ns() - start_ns;
+	res.cycles = (res.cycles > init_res.cycles)? res.cycles - init_res.cycles : 0;
+	res.ns = (res.ns > init_res.ns)? res.ns - init_res.ns : 0;
+
+	switch(trace->op){
+		case TRACE_OP_VLAN: snprintf(name, sizeof(name), "push_vlan+pop_vlan"); break;
+		case TRACE_OP_MPLS: snprintf(name, sizeof(name), "push_mpls+pop_mpls"); break;
+		case TRACE_OP_PPPOE: snprintf(name, sizeof(name), "pop_pppoe+push_pppoe"); break;
+		case TRACE_OP_GTP: snprintf(name, sizeof(name), "pop_gtp+push_gtp"); break;
+	}
+	res.name = name;
+	bench_print(&res);
+}
+
+/*
+* Fuzzing
+*/
+
+static const unsigned int max_frames[HEADER_TYPE_MAX] = {
+	MAX_ETHER_FRAMES, MAX_VLAN_FRAMES, MAX_MPLS_FRAMES, MAX_ARPV4_FRAMES,
+	MAX_IPV4_FRAMES, MAX_ICMPV4_FRAMES, MAX_IPV6_FRAMES, MAX_ICMPV6_FRAMES,
+	MAX_ICMPV6_OPT_FRAMES, MAX_UDP_FRAMES, MAX_TCP_FRAMES, MAX_SCTP_FRAMES,
+	MAX_PPPOE_FRAMES, MAX_PPP_FRAMES, MAX_GTP_FRAMES,
+};
+
+//Values which steer the parsers into the different protocols
+static const uint16_t interesting[] = {
+	0x8100, 0x88a8, 0x88e7, 0x8847, 0x8848, 0x8863, 0x8864, 0x0806, 0x0800, 0x86dd,
+	0x0021, 2152, 0x4500, 0x6000, 0x0400, 0x1100, 0x0600, 0x3a00, 0x2900, 0xffff, 0x0000,
+};
+
+static inline uint32_t fuzz_rand(uint32_t* seed){
+	//xorshift32
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return *seed;
+}
+
+static size_t mutate(uint8_t* buf, size_t len, uint32_t* seed){
+	unsigned int i, n = 1 + fuzz_rand(seed) % 4;
+	size_t hdr_len = (len < 128)? len : 128;
+
+	for(i=0;i<n && len > 0;i++){
+		size_t pos = fuzz_rand(seed) % hdr_len;
+
+		switch(fuzz_rand(seed) % 5){
+			case 0: //bit flip
+				buf[pos] ^= 1 << (fuzz_rand(seed) % 8);
+				break;
+			case 1: //random byte
+				buf[pos] = fuzz_rand(seed);
+				break;
+			case 2: //interesting 16 bit value
+				if(pos + 1 < len){
+					uint16_t v = interesting[fuzz_rand(seed) % (sizeof(interesting)/sizeof(interesting[0]))];
+					buf[pos] = v >> 8;
+					buf[pos+1] = v & 0xff;
+				}
+				break;
+			case 3: //header flood (e.g. a stack of VLAN tags or MPLS labels)
+				{
+					size_t unit = 2 + 2*(fuzz_rand(seed) % 4), j;
+					for(j=pos+unit; j<len; j++)
+						buf[j] = buf[pos + (j-pos) % unit];
+				}
+				break;
+			case 4: //truncation
+				len = fuzz_rand(seed) % (len + 1);
+				if(hdr_len > len)
+					hdr_len = (len)? len : 1;
+				break;
+		}
+	}
+	return len;
+}
+
+static bool check_clas_state(classify_state_t* clas_state, uint8_t* base, size_t len){
+	unsigned int i;
+
+	for(i=0;i<HEADER_TYPE_MAX;i++){
+		if(clas_state->num_of_headers[i] > max_frames[i]){
+			fprintf(stderr, "ERROR: %u headers of type %u (max %u)\n", clas_state->num_of_headers[i], i, max_frames[i]);
+			return false;
+		}
+	}
+
+	for(i=0;i<MAX_HEADERS;i++){
+		uint8_t* frame = (uint8_t*)clas_state->headers[i].frame;
+
+		if(!clas_state->headers[i].present)
+			continue;
+
+		if(frame < base || frame >= base + len || clas_state->headers[i].length > (size_t)(base + len - frame)){
+			fprintf(stderr, "ERROR: header slot %u out of the packet boundaries (offset %ld, length %zu, packet length %zu)\n", i, (long)(frame - base), clas_state->headers[i].length, len);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void dump_buffer(const uint8_t* buf, size_t len){
+	size_t i;
+	for(i=0;i<len;i++)
+		fprintf(stderr, "%02x%s", buf[i], ((i+1) % 16)? " " : "\n");
+	fprintf(stderr, "\n");
+}
+
+static int fuzz(trace_t* traces, unsigned int num_of_traces, unsigned int iterations, uint32_t seed){
+	unsigned int i, idx;
+	size_t len = 0;
+	trace_t* trace;
+	uint8_t *area, *end, *buf;
+	uint8_t orig[FUZZ_BUFFER_SIZE];
+	long page = sysconf(_SC_PAGESIZE);
+	size_t area_len = ((FUZZ_BUFFER_SIZE + page - 1)/page + 1)*page;
+
+	fprintf(stdout, "Fuzzing %u packets, seed %u\n", iterations, seed);
+
+	//Packets end right before a guard page
+	area = (uint8_t*)mmap(NULL, area_len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if(area == MAP_FAILED)
+		return EXIT_FAILURE;
+	end = area + area_len - page;
+	mprotect(end, page, PROT_NONE);
+
+	for(i=0;i<iterations;i++){
+		trace = &traces[fuzz_rand(&seed) % num_of_traces];
+		idx = fuzz_rand(&seed) % trace->num_of_pkts;
+		len = trace->lens[idx];
+
+		if(len > FUZZ_BUFFER_SIZE)
+			len = FUZZ_BUFFER_SIZE;
+
+		memcpy(orig, trace->pkts[idx], len);
+		len = mutate(orig, len, &seed);
+
+		//Classification in place
+		buf = end - len;
+		memcpy(buf, orig, len);
+		classify_packet(pack->headers, buf, len, 1, 1);
+		if(!check_clas_state(pack->headers, buf, len))
+			goto ERROR;
+
+		//Push&pop on the (still in the RX buffer) packet; not defined (asserted) for non Ethernet frames
+		pack->init(buf, len, NULL, 1, 1, true, false);
+		if(!get_ether_hdr(pack->headers, 0)){
+			pack->destroy();
+			continue;
+		}
+		switch(fuzz_rand(&seed) % 8){
+			case 0: push_vlan(&pkt, pack->headers, VLAN_CTAG_ETHER); break;
+			case 1: pop_vlan(&pkt, pack->headers); break;
+			case 2: push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST); break;
+			case 3: pop_mpls(&pkt, pack->headers, ETH_TYPE_IPV4); break;
+			case 4: push_pppoe(&pkt, pack->headers, ETH_TYPE_PPPOE_SESSION); break;
+			case 5: pop_pppoe(&pkt, pack->headers, ETH_TYPE_IPV4); break;
+			case 6: push_gtp(&pkt, pack->headers, ETH_TYPE_IPV4); break;
+			case 7: pop_gtp(&pkt, pack->headers, 0); break;
+		}
+		if(!check_clas_state(pack->headers, pack->get_buffer(), pack->get_buffer_length())){
+			pack->destroy();
+			goto ERROR;
+		}
+		pack->destroy();
+	}
+
+	munmap(area, area_len);
+	fprintf(stdout, "OK\n");
+	return EXIT_SUCCESS;
+
+ERROR:
+	fprintf(stderr, "Offending packet (iteration %u, %zu bytes):\n", i, len);
+	dump_buffer(orig, len);
+	munmap(area, area_len);
+	return EXIT_FAILURE;
+}
+
+static void usage(const char* prog){
+	fprintf(stderr, "Usage: %s [-f] [-n iterations] [-s seed] [file.pcap ...]\n", prog);
+	fprintf(stderr, "  -f  fuzz mode\n");
+}
+
+int main(int argc, char** argv){
+
+	static const struct{
+		const char* name;
+		builder_t builder;
+		enum trace_op op;
+	}mixes[] = {
+		{ "L2 (ETH/IPv4/UDP|TCP)", build_l2, TRACE_OP_VLAN },
+		{ "QinQ (ETH/STAG/CTAG/IPv4/TCP)", build_qinq, TRACE_OP_VLAN },
+		{ "MPLS (1-4 labels/IPv4/UDP)", build_mpls, TRACE_OP_MPLS },
+		{ "PPPoE (ETH/PPPoE/PPP/IPv4)", build_pppoe, TRACE_OP_PPPOE },
+		{ "IPv6 (HBH/routing ext. headers/TCP)", build_ipv6_ext, TRACE_OP_VLAN },
+		{ "GTP-U (IPv4/UDP/GTP/IPv4/TCP)", build_gtp, TRACE_OP_GTP },
+	};
+	unsigned int num_of_mixes = sizeof(mixes)/sizeof(mixes[0]);
+	unsigned int i, num_of_traces, iterations = BENCH_DEFAULT_ITERATIONS;
+	uint32_t seed = time(NULL);
+	bool fuzz_mode = false;
+	trace_t* traces;
+	int opt, rv = EXIT_SUCCESS;
+
+	while((opt = getopt(argc, argv, "fn:s:h")) != -1){
+		switch(opt){
+			case 'f':
+				fuzz_mode = true;
+				break;
+			case 'n':
+				iterations = atoi(optarg);
+				break;
+			case 's':
+				seed = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if(iterations == 0 || seed == 0){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	pack = new datapacketx86(&pkt);
+	pkt.platform_state = pack;
+
+	traces = (trace_t*)malloc(sizeof(trace_t)*(num_of_mixes + argc - optind));
+
+	for(i=0;i<num_of_mixes;i++)
+		build_trace(&traces[i], mixes[i].name, mixes[i].builder, mixes[i].op);
+	num_of_traces = num_of_mixes;
+
+	for(i=optind;i<(unsigned int)argc;i++){
+		if(load_pcap(&traces[num_of_traces], argv[i]))
+			num_of_traces++;
+		else
+			destroy_trace(&traces[num_of_traces]);
+	}
+
+	if(fuzz_mode){
+		rv = fuzz(traces, num_of_traces, iterations, seed);
+	}else{
+		for(i=0;i<num_of_traces;i++)
+			bench_trace(&traces[i], iterations);
+	}
+
+	for(i=0;i<num_of_traces;i++)
+		destroy_trace(&traces[i]);
+	free(traces);
+	delete pack;
+
+	return rv;
+}
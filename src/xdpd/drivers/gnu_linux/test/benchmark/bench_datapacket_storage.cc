@@ -0,0 +1,219 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* Benchmark of the PKT_IN datapacket_storage (slot ring) against the
+* previous implementation (std::list under a mutex, linear lookup), which
+* is kept here as a reference.
+*
+* With N packets outstanding, each operation stores a new packet and
+* retrieves (PACKET_OUT) an outstanding one, either the oldest (FIFO) or
+* a random one.
+*
+* Usage: bench_datapacket_storage [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <list>
+#include <pthread.h>
+#include "io/datapacket_storage.h"
+#include "bench_utils.h"
+
+using namespace xdpd::gnu_linux;
+
+#define NUM_OF_THREADS 4
+
+/*
+* Previous implementation (reference)
+*/
+class list_storage{
+
+public:
+	list_storage(uint32_t size) : next_id(1), max_size(size){
+		pthread_mutex_init(&lock, NULL);
+	}
+	~list_storage(){
+		pthread_mutex_destroy(&lock);
+	}
+
+	storeid store_packet(datapacket_t* pkt){
+		store_mapping map;
+		map.pkt = pkt;
+
+		pthread_mutex_lock(&lock);
+		if (store.size() >= max_size) {
+			pthread_mutex_unlock(&lock);
+			return datapacket_storage::ERROR;
+		}
+		map.input_timestamp = time(NULL);
+		if(next_id+1 == 0xffffffff)
+			map.id = next_id = 1;
+		else
+			map.id = ++next_id;
+		store.push_back(map);
+		pthread_mutex_unlock(&lock);
+
+		return map.id;
+	}
+
+	datapacket_t* get_packet(storeid id){
+		std::list<store_mapping>::iterator iter;
+		store_mapping map = { 0, NULL, 0 };
+
+		pthread_mutex_lock(&lock);
+		for (iter = store.begin(); iter != store.end(); ++iter) {
+			if ( id == (*iter).id ) {
+				map = *iter;
+				store.erase(iter);
+				break;
+			}
+		}
+		pthread_mutex_unlock(&lock);
+
+		return map.pkt;
+	}
+
+private:
+	typedef struct {
+		storeid id;
+		datapacket_t* pkt;
+		time_t input_timestamp;
+	} store_mapping;
+
+	storeid next_id;
+	uint32_t max_size;
+	std::list<store_mapping> store;
+	pthread_mutex_t lock;
+};
+
+/*
+* Workloads
+*/
+static datapacket_t pkts[2];
+
+template<class T>
+static void bench_steady(T* storage, uint32_t outstanding, bool random_order, unsigned int iterations, bench_result_t* res){
+	unsigned int i;
+	uint32_t idx, oldest = 0, seed = 1;
+	uint64_t start_ns, start_cy;
+	storeid* ids = (storeid*)malloc(sizeof(storeid)*outstanding);
+
+	for(i=0;i<outstanding;i++)
+		ids[i] = storage->store_packet(&pkts[0]);
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		if(random_order){
+			seed = seed*1103515245 + 12345;
+			idx = (seed >> 8) % outstanding;
+		}else{
+			idx = oldest;
+			oldest = (oldest + 1 == outstanding)? 0 : oldest + 1;
+		}
+		if(storage->get_packet(ids[idx]) == NULL)
+			fprintf(stderr, "ERROR: id %u not found\n", ids[idx]);
+		ids[idx] = storage->store_packet(&pkts[0]);
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = iterations;
+
+	for(i=0;i<outstanding;i++)
+		storage->get_packet(ids[i]);
+	free(ids);
+}
+
+template<class T>
+struct thread_arg{
+	T* storage;
+	unsigned int iterations;
+};
+
+template<class T>
+static void* thread_routine(void* param){
+	struct thread_arg<T>* arg = (struct thread_arg<T>*)param;
+	storeid id;
+
+	for(unsigned int i=0;i<arg->iterations;i++){
+		id = arg->storage->store_packet(&pkts[1]);
+		arg->storage->get_packet(id);
+	}
+	return NULL;
+}
+
+template<class T>
+static void bench_contention(T* storage, unsigned int iterations, bench_result_t* res){
+	unsigned int i;
+	uint64_t start_ns, start_cy;
+	pthread_t threads[NUM_OF_THREADS];
+	struct thread_arg<T> arg = { storage, iterations/NUM_OF_THREADS };
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<NUM_OF_THREADS;i++)
+		pthread_create(&threads[i], NULL, thread_routine<T>, &arg);
+	for(i=0;i<NUM_OF_THREADS;i++)
+		pthread_join(threads[i], NULL);
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)arg.iterations*NUM_OF_THREADS;
+}
+
+template<class T>
+static void run(const char* impl, T* storage, uint32_t size, unsigned int iterations){
+	static const uint32_t fractions[] = { 8, 2, 1 }; //outstanding = size/fraction
+	char name[128];
+	bench_result_t res;
+	unsigned int i, iters;
+
+	for(i=0;i<sizeof(fractions)/sizeof(fractions[0]);i++){
+		uint32_t outstanding = size/fractions[i];
+
+		//Keep the list based runs bounded
+		iters = iterations;
+		if(outstanding > 1024)
+			iters = iterations/(outstanding/1024);
+
+		snprintf(name, sizeof(name), "%s fifo %u outst.", impl, outstanding);
+		res.name = name;
+		bench_steady(storage, outstanding, false, iters, &res);
+		bench_print(&res);
+
+		snprintf(name, sizeof(name), "%s random %u outst.", impl, outstanding);
+		res.name = name;
+		bench_steady(storage, outstanding, true, iters, &res);
+		bench_print(&res);
+	}
+
+	snprintf(name, sizeof(name), "%s %u threads", impl, NUM_OF_THREADS);
+	res.name = name;
+	bench_contention(storage, iterations, &res);
+	bench_print(&res);
+}
+
+int main(int argc, char** argv){
+
+	static const uint32_t sizes[] = { 512, 16384, 65536 };
+	unsigned int i, iterations = bench_iterations(argc, argv);
+	char title[128];
+
+	for(i=0;i<sizeof(sizes)/sizeof(sizes[0]);i++){
+		snprintf(title, sizeof(title), "PKT_IN storage, %u buffers (ops = store+get)", sizes[i]);
+		bench_print_header(title);
+
+		datapacket_storage ring(sizes[i], 10);
+		run("ring", &ring, sizes[i], iterations);
+
+		list_storage list(sizes[i]);
+		run("list", &list, sizes[i], iterations);
+	}
+
+	return EXIT_SUCCESS;
+}
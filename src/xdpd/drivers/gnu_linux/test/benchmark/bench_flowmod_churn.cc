@@ -0,0 +1,238 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* Flow-mod churn benchmark of the pipeline memory hooks (platform_malloc).
+*
+* Every thread owns an LSI with a single table holding a sliding window of
+* flows: each iteration builds and adds a new flow (matches, apply-actions
+* instruction with a set-field and an output action) and removes, strictly,
+* the oldest one. This is the allocation pattern of a controller churning
+* flow-mods: every add allocates the entry, its matches, instructions and
+* actions, and every delete frees the ones of the removed entry plus the
+* ones of the entry used to look it up.
+*
+* The same workload is run with a single thread and with all of them, to
+* expose allocator contention. The benchmark is built twice: with the slab
+* allocator (bench_flowmod_churn), whose per size class usage is printed at
+* the end, and with malloc (bench_flowmod_churn_malloc).
+*
+* Usage: bench_flowmod_churn [iterations per thread] [threads] [window]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <rofl/datapath/hal/driver.h>
+#include <rofl/datapath/pipeline/physical_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+#include "config.h"
+#include "pipeline-imp/slab.h"
+#include "bench_utils.h"
+
+#define CHURN_DEFAULT_ITERATIONS 200000
+#define CHURN_DEFAULT_THREADS 4
+#define CHURN_DEFAULT_WINDOW 1024
+#define CHURN_BASE_DPID 0x2000
+
+typedef struct churn_thread{
+	pthread_t thread;
+	pthread_barrier_t* barrier;
+	of1x_switch_t* sw;
+	unsigned int iterations;
+	unsigned int window;
+
+	//Results
+	uint64_t ns;
+	uint64_t cycles;
+	unsigned int failed;
+}churn_thread_t;
+
+//Flow i; the same matches and priority are used to remove it
+static of1x_flow_entry_t* churn_flow(unsigned int i, bool with_actions){
+
+	wrap_uint_t field;
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+	of1x_action_group_t* ac_group;
+
+	entry->priority = 0x8000;
+	entry->cookie = i;
+
+	of1x_add_match_to_entry(entry, of1x_init_eth_type_match(0x0800));
+	of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(0x0a000000 | i, 0xffffffff));
+
+	if(!with_actions)
+		return entry;
+
+	ac_group = of1x_init_action_group(NULL);
+
+	//Locally administered MAC 02:00:xx:xx:xx:xx
+	field.u64 = 0x020000000000ULL | i;
+	of1x_push_packet_action_to_group(ac_group, of1x_init_packet_action(OF1X_AT_SET_FIELD_ETH_DST, field, 0x0));
+	field.u64 = 1;
+	of1x_push_packet_action_to_group(ac_group, of1x_init_packet_action(OF1X_AT_OUTPUT, field, 0x0));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, ac_group, NULL, NULL, 0);
+
+	return entry;
+}
+
+static bool churn_add(of1x_switch_t* sw, unsigned int i){
+
+	of1x_flow_entry_t* entry = churn_flow(i, true);
+
+	if(of1x_add_flow_entry_table(&sw->pipeline, 0, &entry, false, false) != ROFL_OF1X_FM_SUCCESS){
+		if(entry)
+			of1x_destroy_flow_entry(entry);
+		return false;
+	}
+	return true;
+}
+
+static bool churn_remove(of1x_switch_t* sw, unsigned int i){
+
+	of1x_flow_entry_t* entry = churn_flow(i, false);
+	rofl_result_t res;
+
+	res = of1x_remove_flow_entry_table(&sw->pipeline, 0, entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY);
+	of1x_destroy_flow_entry(entry);
+
+	return res == ROFL_SUCCESS;
+}
+
+static void* churn_routine(void* param){
+
+	churn_thread_t* t = (churn_thread_t*)param;
+	uint64_t start, start_cycles;
+	unsigned int i;
+
+	//Fill the window
+	for(i=0; i<t->window; ++i){
+		if(!churn_add(t->sw, i))
+			t->failed++;
+	}
+
+	pthread_barrier_wait(t->barrier);
+
+	start = bench_now_ns();
+	start_cycles = bench_cycles();
+
+	for(i=0; i<t->iterations; ++i){
+		if(!churn_add(t->sw, i + t->window))
+			t->failed++;
+		if(!churn_remove(t->sw, i))
+			t->failed++;
+	}
+
+	t->cycles = bench_cycles() - start_cycles;
+	t->ns = bench_now_ns() - start;
+
+	return NULL;
+}
+
+static int churn_run(unsigned int num_threads, unsigned int iterations, unsigned int window){
+
+	of1x_matching_algorithm_available ma_list[] = { of1x_loop_matching_algorithm };
+	churn_thread_t* threads = (churn_thread_t*)calloc(num_threads, sizeof(churn_thread_t));
+	pthread_barrier_t barrier;
+	bench_result_t res;
+	char name[64];
+	unsigned int i, failed = 0;
+
+	pthread_barrier_init(&barrier, NULL, num_threads);
+
+	for(i=0; i<num_threads; ++i){
+		snprintf(name, sizeof(name), "churn%u", i);
+		if(hal_driver_create_switch(name, CHURN_BASE_DPID+i, OF_VERSION_12, 1, (int*)ma_list) != HAL_SUCCESS){
+			fprintf(stderr, "Unable to create LSI %u\n", i);
+			exit(EXIT_FAILURE);
+		}
+
+		threads[i].barrier = &barrier;
+		threads[i].sw = (of1x_switch_t*)physical_switch_get_logical_switch_by_dpid(CHURN_BASE_DPID+i);
+		threads[i].iterations = iterations;
+		threads[i].window = window;
+	}
+
+	for(i=0; i<num_threads; ++i)
+		pthread_create(&threads[i].thread, NULL, churn_routine, &threads[i]);
+
+	memset(&res, 0, sizeof(res));
+	snprintf(name, sizeof(name), "churn, %u thread(s)", num_threads);
+	res.name = name;
+
+	for(i=0; i<num_threads; ++i){
+		pthread_join(threads[i].thread, NULL);
+
+		res.ops += 2ULL*iterations;
+		if(threads[i].ns > res.ns)
+			res.ns = threads[i].ns;
+		if(threads[i].cycles > res.cycles)
+			res.cycles = threads[i].cycles;
+		failed += threads[i].failed;
+
+		hal_driver_destroy_switch_by_dpid(CHURN_BASE_DPID+i);
+	}
+
+	bench_print(&res);
+
+	pthread_barrier_destroy(&barrier);
+	free(threads);
+
+	if(failed)
+		fprintf(stderr, "%u flow-mods failed\n", failed);
+
+	return failed;
+}
+
+#if PIPELINE_SLAB_ALLOCATOR
+static void churn_print_slab_stats(void){
+
+	slab_stats_t stats;
+	unsigned int i;
+
+	slab_get_stats(&stats);
+
+	fprintf(stdout, "\nSlab allocator (%u arena(s))\n", stats.num_of_arenas);
+	fprintf(stdout, "%8s %8s %10s %10s %8s %12s %12s %10s\n", "size", "slabs", "capacity", "in_use", "cached", "allocs", "frees", "remote");
+
+	for(i=0; i<SLAB_NUM_OF_CLASSES; ++i){
+		slab_class_stats_t* cs = &stats.classes[i];
+		if(!cs->allocs)
+			continue;
+		fprintf(stdout, "%8zu %8llu %10llu %10llu %8llu %12llu %12llu %10llu\n", cs->obj_size, (unsigned long long)cs->slabs, (unsigned long long)cs->capacity, (unsigned long long)cs->in_use, (unsigned long long)cs->cached, (unsigned long long)cs->allocs, (unsigned long long)cs->frees, (unsigned long long)cs->remote_frees);
+	}
+
+	fprintf(stdout, "large: %llu in use, %llu bytes\n", (unsigned long long)stats.large_in_use, (unsigned long long)stats.large_bytes);
+}
+#endif
+
+int main(int argc, char** argv){
+
+	unsigned int iterations = (argc > 1 && atoi(argv[1]) > 0)? atoi(argv[1]) : CHURN_DEFAULT_ITERATIONS;
+	unsigned int num_threads = (argc > 2 && atoi(argv[2]) > 0)? atoi(argv[2]) : CHURN_DEFAULT_THREADS;
+	unsigned int window = (argc > 3 && atoi(argv[3]) > 0)? atoi(argv[3]) : CHURN_DEFAULT_WINDOW;
+	int failed = 0;
+	char title[128];
+
+	if(hal_driver_init(NULL) != HAL_SUCCESS){
+		fprintf(stderr, "Unable to initialize the driver\n");
+		return EXIT_FAILURE;
+	}
+
+	snprintf(title, sizeof(title), "Flow-mod churn (%s), %u flows installed per LSI", (PIPELINE_SLAB_ALLOCATOR)? "slab" : "malloc", window);
+	bench_print_header(title);
+
+	failed += churn_run(1, iterations, window);
+	if(num_threads > 1)
+		failed += churn_run(num_threads, iterations, window);
+
+#if PIPELINE_SLAB_ALLOCATOR
+	churn_print_slab_stats();
+#endif
+
+	hal_driver_destroy();
+
+	return (failed)? EXIT_FAILURE : EXIT_SUCCESS;
+}
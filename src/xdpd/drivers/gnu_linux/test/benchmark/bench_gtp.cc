@@ -0,0 +1,187 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* Throughput benchmark of the GTP-U encapsulation/decapsulation of the
+* C packet classifier, with a mix of packet sizes (IMIX-like) and several
+* tunnel endpoints.
+*
+* Usage: bench_gtp [iterations]
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+#include "io/datapacketx86.h"
+#include "io/packet_classifiers/c_pktclassifier/c_pktclassifier.h"
+#include "bench_utils.h"
+
+using namespace xdpd::gnu_linux;
+
+#define NUM_OF_ENDPOINTS 16
+
+//Packet size mix: 7x64, 4x576, 1x1500
+static const size_t mix[] = { 64, 64, 576, 64, 64, 1500, 64, 576, 64, 576, 64, 576 };
+#define MIX_LEN (sizeof(mix)/sizeof(mix[0]))
+
+static datapacket_t pkt;
+static datapacketx86* pack;
+static gtpu_tunnel_tmpl_t endpoints[NUM_OF_ENDPOINTS];
+
+//Builds an ETH/IPv4/UDP frame of len bytes
+static void fill_frame(uint8_t* frame, size_t len){
+
+	static const uint8_t hdr[] = {
+		//Ethernet
+		0x00, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x00, 0x22, 0x22, 0x22, 0x22, 0x22,
+		0x08, 0x00,
+		//IPv4 (proto UDP)
+		0x45, 0x00, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00,
+		0x40, 0x11, 0x00, 0x00,
+		0x0a, 0x01, 0x01, 0x01,
+		0x0a, 0x02, 0x02, 0x02,
+		//UDP
+		0x33, 0x33, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00,
+	};
+
+	memset(frame, 0x99, len);
+	memcpy(frame, hdr, sizeof(hdr));
+}
+
+static void init_endpoints(void){
+	unsigned int i;
+
+	for(i=0;i<NUM_OF_ENDPOINTS;i++){
+		init_gtpu_tunnel_tmpl(&endpoints[i],
+				HTONB32(0xc0a80001),		//192.168.0.1
+				HTONB32(0xc0a80100 + i + 1),	//192.168.1.x
+				HTONB16(2152),
+				HTONB32(0x1000 + i),
+				64, 0);
+	}
+}
+
+//Encapsulation and decapsulation in user space buffers (GTP gateway forwarding)
+static void bench_encap_decap(uint8_t** frames, unsigned int iterations, bench_result_t* res, uint64_t* bytes){
+	unsigned int i, j;
+	uint64_t start_ns, start_cy;
+
+	*bytes = 0;
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		for(j=0;j<MIX_LEN;j++){
+			pack->init(frames[j], mix[j], NULL, 1, 1, true);
+			push_gtp_tmpl(&pkt, pack->headers, &endpoints[(i+j)%NUM_OF_ENDPOINTS], ETH_TYPE_IPV4);
+			pop_gtp(&pkt, pack->headers, 0);
+			*bytes += mix[j];
+			pack->destroy();
+		}
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)iterations*MIX_LEN;
+}
+
+//Encapsulation of packets still in the RX buffer (tunnel ingress)
+static void bench_encap_rx(uint8_t** frames, unsigned int iterations, bench_result_t* res, uint64_t* bytes){
+	unsigned int i, j;
+	uint64_t start_ns, start_cy;
+
+	*bytes = 0;
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		for(j=0;j<MIX_LEN;j++){
+			pack->init(frames[j], mix[j], NULL, 1, 1, true, false);
+			push_gtp_tmpl(&pkt, pack->headers, &endpoints[(i+j)%NUM_OF_ENDPOINTS], ETH_TYPE_IPV4);
+			*bytes += mix[j];
+			pack->destroy();
+		}
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)iterations*MIX_LEN;
+}
+
+//Decapsulation of tunneled packets still in the RX buffer (tunnel egress)
+static void bench_decap_rx(uint8_t** frames, unsigned int iterations, bench_result_t* res, uint64_t* bytes){
+	unsigned int i, j;
+	uint64_t start_ns, start_cy;
+
+	*bytes = 0;
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		for(j=0;j<MIX_LEN;j++){
+			pack->init(frames[j], mix[j] + GTPU_TUNNEL_HDR_LEN, NULL, 1, 1, true, false);
+			pop_gtp(&pkt, pack->headers, 0);
+			*bytes += mix[j] + GTPU_TUNNEL_HDR_LEN;
+			pack->destroy();
+		}
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)iterations*MIX_LEN;
+}
+
+static void print(bench_result_t* res, uint64_t bytes){
+	bench_print(res);
+	fprintf(stdout, "%-36s %12.2f Gbit/s\n", "", (res->ns)? (double)bytes*8/res->ns : 0.0);
+}
+
+int main(int argc, char** argv){
+
+	unsigned int i, iterations = bench_iterations(argc, argv)/MIX_LEN;
+	uint8_t* frames[MIX_LEN];
+	uint8_t* tunneled[MIX_LEN];
+	bench_result_t res;
+	uint64_t bytes;
+
+	pack = new datapacketx86(&pkt);
+	pkt.platform_state = pack;
+
+	init_endpoints();
+
+	//Plain and encapsulated version of the mix
+	for(i=0;i<MIX_LEN;i++){
+		frames[i] = (uint8_t*)malloc(mix[i]);
+		tunneled[i] = (uint8_t*)malloc(mix[i] + GTPU_TUNNEL_HDR_LEN);
+		fill_frame(frames[i], mix[i]);
+
+		pack->init(frames[i], mix[i], NULL, 1, 1, true);
+		push_gtp_tmpl(&pkt, pack->headers, &endpoints[i%NUM_OF_ENDPOINTS], ETH_TYPE_IPV4);
+		memcpy(tunneled[i], pack->get_buffer(), pack->get_buffer_length());
+		pack->destroy();
+	}
+
+	bench_print_header("GTP-U, packet mix 7x64B/4x576B/1x1500B (ops = packets)");
+
+	res.name = "encap+decap (user space)";
+	bench_encap_decap(frames, iterations, &res, &bytes);
+	print(&res, bytes);
+
+	res.name = "encap (RX buffer)";
+	bench_encap_rx(frames, iterations, &res, &bytes);
+	print(&res, bytes);
+
+	res.name = "decap (RX buffer)";
+	bench_decap_rx(tunneled, iterations, &res, &bytes);
+	print(&res, bytes);
+
+	for(i=0;i<MIX_LEN;i++){
+		free(frames[i]);
+		free(tunneled[i]);
+	}
+	delete pack;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* Micro-benchmark of the VLAN and MPLS push/pop operations of the
+* datapacketx86 and the C packet classifier.
+*
+* Usage: bench_push_pop [iterations]
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+#include "io/datapacketx86.h"
+#include "io/packet_classifiers/c_pktclassifier/c_pktclassifier.h"
+#include "bench_utils.h"
+
+using namespace xdpd::gnu_linux;
+
+#define MPLS_STACK_DEPTH 4
+
+static datapacket_t pkt;
+static datapacketx86* pack;
+
+//Builds an ETH/IPv4/UDP frame of len bytes
+static void fill_frame(uint8_t* frame, size_t len){
+
+	static const uint8_t hdr[] = {
+		//Ethernet
+		0x00, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x00, 0x22, 0x22, 0x22, 0x22, 0x22,
+		0x08, 0x00,
+		//IPv4 (proto UDP)
+		0x45, 0x00, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00,
+		0x40, 0x11, 0x00, 0x00,
+		0x0a, 0x01, 0x01, 0x01,
+		0x0a, 0x02, 0x02, 0x02,
+		//UDP
+		0x33, 0x33, 0x44, 0x44, 0x00, 0x00, 0xcc, 0xcc,
+	};
+
+	memset(frame, 0x99, len);
+	memcpy(frame, hdr, sizeof(hdr));
+}
+
+static bool check_frame(uint8_t* frame, size_t len){
+	return pack->get_buffer_length() == len && memcmp(pack->get_buffer(), frame, len) == 0;
+}
+
+static void bench_vlan(uint8_t* frame, size_t len, unsigned int tags, unsigned int iterations, bench_result_t* res){
+	unsigned int i, j;
+	uint64_t start_ns, start_cy;
+
+	pack->init(frame, len, NULL, 1, 1, true);
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		for(j=0;j<tags;j++)
+			push_vlan(&pkt, pack->headers, VLAN_CTAG_ETHER);
+		for(j=0;j<tags;j++)
+			pop_vlan(&pkt, pack->headers);
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)iterations*tags*2;
+
+	if(!check_frame(frame, len))
+		fprintf(stderr, "ERROR: frame mismatch after %s\n", res->name);
+
+	pack->destroy();
+}
+
+static void bench_mpls(uint8_t* frame, size_t len, unsigned int labels, unsigned int iterations, bench_result_t* res){
+	unsigned int i, j;
+	uint64_t start_ns, start_cy;
+	uint16_t ether_type;
+
+	pack->init(frame, len, NULL, 1, 1, true);
+	ether_type = get_ether_type(get_ether_hdr(pack->headers, 0));
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		for(j=0;j<labels;j++)
+			push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST);
+		for(j=0;j<labels;j++)
+			pop_mpls(&pkt, pack->headers, (j == labels-1)? ether_type : ETH_TYPE_MPLS_UNICAST);
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = (uint64_t)iterations*labels*2;
+
+	if(!check_frame(frame, len))
+		fprintf(stderr, "ERROR: frame mismatch after %s\n", res->name);
+
+	pack->destroy();
+}
+
+//Packet still in the (NIC) RX buffer; the first push moves it to user space
+static void bench_vlan_nic(uint8_t* frame, size_t len, unsigned int iterations, bench_result_t* res){
+	unsigned int i;
+	uint64_t start_ns, start_cy;
+
+	start_ns = bench_now_ns();
+	start_cy = bench_cycles();
+
+	for(i=0;i<iterations;i++){
+		pack->init(frame, len, NULL, 1, 1, true, false);
+		push_vlan(&pkt, pack->headers, VLAN_CTAG_ETHER);
+		pack->destroy();
+	}
+
+	res->cycles = bench_cycles() - start_cy;
+	res->ns = bench_now_ns() - start_ns;
+	res->ops = iterations;
+}
+
+int main(int argc, char** argv){
+
+	static uint8_t frame_64[64], frame_1500[1500];
+	unsigned int iterations = bench_iterations(argc, argv);
+	bench_result_t res;
+
+	fill_frame(frame_64, sizeof(frame_64));
+	fill_frame(frame_1500, sizeof(frame_1500));
+
+	pack = new datapacketx86(&pkt);
+	pkt.platform_state = pack;
+
+	bench_print_header("VLAN/MPLS push&pop (ops = single push or pop)");
+
+	res.name = "vlan push+pop 64B";
+	bench_vlan(frame_64, sizeof(frame_64), 1, iterations, &res);
+	bench_print(&res);
+
+	res.name = "vlan push+pop 1500B";
+	bench_vlan(frame_1500, sizeof(frame_1500), 1, iterations, &res);
+	bench_print(&res);
+
+	res.name = "qinq push+pop 1500B";
+	bench_vlan(frame_1500, sizeof(frame_1500), 2, iterations, &res);
+	bench_print(&res);
+
+	res.name = "vlan 4-tag stack push+pop 1500B";
+	bench_vlan(frame_1500, sizeof(frame_1500), MAX_VLAN_FRAMES, iterations, &res);
+	bench_print(&res);
+
+	res.name = "mpls push+pop 64B";
+	bench_mpls(frame_64, sizeof(frame_64), 1, iterations, &res);
+	bench_print(&res);
+
+	res.name = "mpls 4-label stack push+pop 1500B";
+	bench_mpls(frame_1500, sizeof(frame_1500), MPLS_STACK_DEPTH, iterations, &res);
+	bench_print(&res);
+
+	bench_print_header("VLAN push from RX buffer (ops = init+classify+push)");
+
+	res.name = "vlan push (NIC buffered) 64B";
+	bench_vlan_nic(frame_64, sizeof(frame_64), iterations, &res);
+	bench_print(&res);
+
+	res.name = "vlan push (NIC buffered) 1500B";
+	bench_vlan_nic(frame_1500, sizeof(frame_1500), iterations, &res);
+	bench_print(&res);
+
+	delete pack;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+* @file bench_utils.h
+*
+* @brief Small helpers shared by the gnu_linux driver micro-benchmarks
+*/
+
+//Number of iterations if not overriden in the command line
+#define BENCH_DEFAULT_ITERATIONS 1000000
+
+inline static uint64_t bench_now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+inline static uint64_t bench_cycles(void){
+#if defined(__i386__) || defined(__x86_64__)
+	uint32_t lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t)hi << 32) | lo;
+#else
+	return 0;
+#endif
+}
+
+inline static unsigned int bench_iterations(int argc, char** argv){
+	if(argc > 1 && atoi(argv[1]) > 0)
+		return atoi(argv[1]);
+	return BENCH_DEFAULT_ITERATIONS;
+}
+
+//Measurement of a single workload
+typedef struct bench_result{
+	const char* name;
+	uint64_t ops;
+	uint64_t ns;
+	uint64_t cycles;
+}bench_result_t;
+
+inline static void bench_print_header(const char* title){
+	fprintf(stdout, "\n%s\n", title);
+	fprintf(stdout, "%-36s %12s %12s %12s %12s\n", "workload", "ops", "ns/op", "cycles/op", "Mops/s");
+}
+
+inline static void bench_print(const bench_result_t* res){
+	double ns_op = (res->ops)? (double)res->ns/res->ops : 0.0;
+	double cy_op = (res->ops)? (double)res->cycles/res->ops : 0.0;
+	double mops = (res->ns)? (double)res->ops*1000.0/res->ns : 0.0;
+
+	fprintf(stdout, "%-36s %12llu %12.2f %12.2f %12.2f\n", res->name, (unsigned long long)res->ops, ns_op, cy_op, mops);
+}
+
+#endif /* BENCH_UTILS_H */
@@ -43,16 +43,33 @@ private:
 	datapacket_t pkt;
 	datapacketx86* pack; // data packet for manipulation
 
+	//Classify len bytes of frame (in a buffer of exactly len bytes, so
+	//that over-reads are reported by valgrind/ASan) and check that all the
+	//classified headers are within the packet
+	void classifyAndCheckBounds(const uint8_t* frame, size_t len);
+
 public:
 	void setUp(void);
 	void tearDown(void);
 
 	void testPushPPPoE();
 	void testPopPPPoE();
+	void testPushPopVLANStack();
+	void testPushPopMPLSStack();
+	void testPushPopGTP();
+	void testTruncatedPackets();
+	void testHeaderFloods();
+	void testTruncatedICMPv6();
 
 	CPPUNIT_TEST_SUITE(DataPacketX86Test);
 	CPPUNIT_TEST(testPushPPPoE);
 	CPPUNIT_TEST(testPopPPPoE);
+	CPPUNIT_TEST(testPushPopVLANStack);
+	CPPUNIT_TEST(testPushPopMPLSStack);
+	CPPUNIT_TEST(testPushPopGTP);
+	CPPUNIT_TEST(testTruncatedPackets);
+	CPPUNIT_TEST(testHeaderFloods);
+	CPPUNIT_TEST(testTruncatedICMPv6);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -315,6 +332,281 @@ void DataPacketX86Test::testPopPPPoE()
 };
 
 
+void DataPacketX86Test::testPushPopVLANStack()
+{
+	pkt.platform_state = pack;
+	
+	pack->init(mRight.somem(), mRight.memlen(), NULL, 1, 1, true);
+
+	uint8_t* ipv4 = (uint8_t*)get_ipv4_hdr(pack->headers,0);
+
+	//Push two more tags; only the ethernet header may move
+	CPPUNIT_ASSERT(push_vlan(&pkt, pack->headers, VLAN_CTAG_ETHER) != NULL);
+	CPPUNIT_ASSERT(push_vlan(&pkt, pack->headers, VLAN_CTAG_ETHER) != NULL);
+
+	CPPUNIT_ASSERT(pack->get_buffer_length() == mRight.memlen() + 2*sizeof(cpc_vlan_hdr_t));
+	CPPUNIT_ASSERT(pkt.matches.__pkt_size_bytes == pack->get_buffer_length());
+	CPPUNIT_ASSERT(get_ether_hdr(pack->headers,0) == pack->get_buffer());
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,0) == pack->get_buffer() + sizeof(cpc_eth_hdr_t));
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,1) == pack->get_buffer() + sizeof(cpc_eth_hdr_t) + sizeof(cpc_vlan_hdr_t));
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,2) == pack->get_buffer() + sizeof(cpc_eth_hdr_t) + 2*sizeof(cpc_vlan_hdr_t));
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,-1) == get_vlan_hdr(pack->headers,2));
+	CPPUNIT_ASSERT(pack->headers->headers[FIRST_ETHER_FRAME_POS].length == pack->get_buffer_length());
+	CPPUNIT_ASSERT((uint8_t*)get_ipv4_hdr(pack->headers,0) == ipv4);
+
+	//Pop them back
+	pop_vlan(&pkt, pack->headers);
+	pop_vlan(&pkt, pack->headers);
+
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,0) == pack->get_buffer() + sizeof(cpc_eth_hdr_t));
+	CPPUNIT_ASSERT(get_vlan_hdr(pack->headers,1) == NULL);
+	CPPUNIT_ASSERT(pack->headers->headers[FIRST_ETHER_FRAME_POS].length == mRight.memlen());
+	CPPUNIT_ASSERT((uint8_t*)get_ipv4_hdr(pack->headers,0) == ipv4);
+
+	rofl::cmemory mResult(pack->get_buffer(), pack->get_buffer_length());
+
+	CPPUNIT_ASSERT(mRight == mResult);
+
+	pack->destroy();
+};
+
+
+void DataPacketX86Test::testPushPopMPLSStack()
+{
+	pkt.platform_state = pack;
+	
+	//Keep the packet in the "NIC" buffer; the first push moves it to user space
+	pack->init(mRight.somem(), mRight.memlen(), NULL, 1, 1, true, false);
+
+	uint16_t ether_type = get_ether_type(get_ether_hdr(pack->headers,0));
+	
+	CPPUNIT_ASSERT(push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST) != NULL);
+	CPPUNIT_ASSERT(pack->get_buffering_status() == X86_DATAPACKET_BUFFERED_IN_USER_SPACE);
+
+	uint8_t* vlan = (uint8_t*)get_vlan_hdr(pack->headers,0);
+	uint8_t* ipv4 = (uint8_t*)get_ipv4_hdr(pack->headers,0);
+	CPPUNIT_ASSERT(vlan == pack->get_buffer() + sizeof(cpc_eth_hdr_t) + sizeof(cpc_mpls_hdr_t));
+
+	CPPUNIT_ASSERT(push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST) != NULL);
+	CPPUNIT_ASSERT(push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST) != NULL);
+
+	CPPUNIT_ASSERT(get_mpls_hdr(pack->headers,0) == pack->get_buffer() + sizeof(cpc_eth_hdr_t));
+	CPPUNIT_ASSERT(get_mpls_hdr(pack->headers,2) == pack->get_buffer() + sizeof(cpc_eth_hdr_t) + 2*sizeof(cpc_mpls_hdr_t));
+	CPPUNIT_ASSERT(get_mpls_bos(get_mpls_hdr(pack->headers,2)));
+	CPPUNIT_ASSERT(!get_mpls_bos(get_mpls_hdr(pack->headers,0)));
+	CPPUNIT_ASSERT((uint8_t*)get_vlan_hdr(pack->headers,0) == vlan);
+	CPPUNIT_ASSERT((uint8_t*)get_ipv4_hdr(pack->headers,0) == ipv4);
+	
+	pop_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST);
+	pop_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST);
+	pop_mpls(&pkt, pack->headers, ether_type);
+
+	CPPUNIT_ASSERT(pkt.matches.__pkt_size_bytes == mRight.memlen());
+
+	rofl::cmemory mResult(pack->get_buffer(), pack->get_buffer_length());
+
+	CPPUNIT_ASSERT(mRight == mResult);
+
+	pack->destroy();
+};
+
+void DataPacketX86Test::testPushPopGTP()
+{
+	gtpu_tunnel_tmpl_t tmpl;
+	uint32_t sum = 0;
+
+	pkt.platform_state = pack;
+
+	init_gtpu_tunnel_tmpl(&tmpl, HTONB32(0xc0a80001), HTONB32(0xc0a80002), HTONB16(2152), HTONB32(0x12345678), 64, 0);
+
+	//Keep the packet in the "NIC" buffer; the push moves it to user space
+	pack->init(mRight.somem(), mRight.memlen(), NULL, 1, 1, true, false);
+
+	uint8_t* gtp = (uint8_t*)push_gtp_tmpl(&pkt, pack->headers, &tmpl, ETH_TYPE_IPV4);
+	CPPUNIT_ASSERT(gtp != NULL);
+	CPPUNIT_ASSERT(pack->get_buffer_length() == mRight.memlen() + GTPU_TUNNEL_HDR_LEN);
+	CPPUNIT_ASSERT(pkt.matches.__pkt_size_bytes == pack->get_buffer_length());
+
+	uint8_t* outer = (uint8_t*)get_ipv4_hdr(pack->headers,0);
+	uint8_t* inner = (uint8_t*)get_ipv4_hdr(pack->headers,1);
+	CPPUNIT_ASSERT(outer == pack->get_buffer() + sizeof(cpc_eth_hdr_t) + sizeof(cpc_vlan_hdr_t));
+	CPPUNIT_ASSERT(inner == outer + GTPU_TUNNEL_HDR_LEN);
+	CPPUNIT_ASSERT(gtp == inner - sizeof(struct cpc_gtpu_base_hdr_t));
+	CPPUNIT_ASSERT(get_udp_hdr(pack->headers,1) != NULL);
+
+	//Lengths and checksum of the outer headers
+	size_t ip_len = pack->get_buffer_length() - sizeof(cpc_eth_hdr_t) - sizeof(cpc_vlan_hdr_t);
+	CPPUNIT_ASSERT(NTOHB16(get_ipv4_length(outer)) == ip_len);
+	CPPUNIT_ASSERT(NTOHB16(get_udp_length(get_udp_hdr(pack->headers,0))) == ip_len - sizeof(cpc_ipv4_hdr_t));
+	CPPUNIT_ASSERT(NTOHB16(get_gtpu_length(gtp)) == ip_len - GTPU_TUNNEL_HDR_LEN);
+	for(unsigned int i=0;i<sizeof(cpc_ipv4_hdr_t);i+=2)
+		sum += (outer[i] << 8) | outer[i+1];
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	CPPUNIT_ASSERT(sum == 0xffff);
+
+	CPPUNIT_ASSERT(pkt.matches.__gtp_teid == HTONB32(0x12345678));
+	CPPUNIT_ASSERT(pkt.matches.__ipv4_dst == HTONB32(0xc0a80002));
+
+	//Decapsulation; ether type is derived from the inner packet
+	pop_gtp(&pkt, pack->headers, 0);
+
+	CPPUNIT_ASSERT(get_gtpu_hdr(pack->headers,0) == NULL);
+	CPPUNIT_ASSERT(get_ipv4_hdr(pack->headers,1) == NULL);
+	CPPUNIT_ASSERT(pkt.matches.__pkt_size_bytes == mRight.memlen());
+
+	rofl::cmemory mResult(pack->get_buffer(), pack->get_buffer_length());
+
+	CPPUNIT_ASSERT(mRight == mResult);
+
+	pack->destroy();
+};
+
+
+void DataPacketX86Test::classifyAndCheckBounds(const uint8_t* frame, size_t len)
+{
+	static const unsigned int max_frames[HEADER_TYPE_MAX] = {
+		MAX_ETHER_FRAMES, MAX_VLAN_FRAMES, MAX_MPLS_FRAMES, MAX_ARPV4_FRAMES,
+		MAX_IPV4_FRAMES, MAX_ICMPV4_FRAMES, MAX_IPV6_FRAMES, MAX_ICMPV6_FRAMES,
+		MAX_ICMPV6_OPT_FRAMES, MAX_UDP_FRAMES, MAX_TCP_FRAMES, MAX_SCTP_FRAMES,
+		MAX_PPPOE_FRAMES, MAX_PPP_FRAMES, MAX_GTP_FRAMES
+	};
+	uint8_t* buf = (uint8_t*)malloc(len ? len : 1);
+
+	memcpy(buf, frame, len);
+
+	pkt.platform_state = pack;
+
+	//Keep the packet in the "NIC" buffer (buf)
+	CPPUNIT_ASSERT(pack->init(buf, len, NULL, 1, 1, true, false) == ROFL_SUCCESS);
+
+	for(unsigned int i=0;i<HEADER_TYPE_MAX;i++)
+		CPPUNIT_ASSERT(pack->headers->num_of_headers[i] <= max_frames[i]);
+
+	for(unsigned int i=0;i<MAX_HEADERS;i++){
+		header_container_t* hdr = &pack->headers->headers[i];
+		if(!hdr->present)
+			continue;
+		CPPUNIT_ASSERT((uint8_t*)hdr->frame >= buf);
+		CPPUNIT_ASSERT((uint8_t*)hdr->frame + hdr->length <= buf + len);
+	}
+
+	pack->destroy();
+	free(buf);
+}
+
+void DataPacketX86Test::testTruncatedPackets()
+{
+	size_t l2_len = sizeof(cpc_eth_hdr_t) + sizeof(cpc_vlan_hdr_t);
+	size_t l3_len = l2_len + sizeof(cpc_ipv4_hdr_t);
+	size_t l4_len = l3_len + sizeof(cpc_udp_hdr_t);
+
+	//Every prefix of the VLAN/IPv4/UDP and PPPoE/PPP/IPv4/UDP frames
+	for(size_t len=0;len<=mRight.memlen();len++){
+		classifyAndCheckBounds(mRight.somem(), len);
+
+		pack->init(mRight.somem(), len, NULL, 1, 1, true);
+		CPPUNIT_ASSERT((get_vlan_hdr(pack->headers,0) != NULL) == (len >= l2_len));
+		CPPUNIT_ASSERT((get_ipv4_hdr(pack->headers,0) != NULL) == (len >= l3_len));
+		CPPUNIT_ASSERT((get_udp_hdr(pack->headers,0) != NULL) == (len >= l4_len));
+		if(len < l4_len)
+			CPPUNIT_ASSERT(pkt.matches.__udp_dst == 0);
+		pack->destroy();
+	}
+
+	for(size_t len=0;len<=mLeft.memlen();len++)
+		classifyAndCheckBounds(mLeft.somem(), len);
+
+	//LLC frame shorter than the LLC header (802.3 length instead of type)
+	uint8_t llc[sizeof(cpc_eth_hdr_t)+2];
+	memset(llc, 0, sizeof(llc));
+	llc[12] = 0x00;
+	llc[13] = 0x40;
+	llc[14] = 0xaa;
+	llc[15] = 0xaa;
+	classifyAndCheckBounds(llc, sizeof(llc));
+}
+
+void DataPacketX86Test::testHeaderFloods()
+{
+	uint8_t frame[sizeof(cpc_eth_hdr_t) + 32*sizeof(cpc_mpls_hdr_t)];
+	unsigned int i, idx;
+
+	//32 VLAN tags
+	memset(frame, 0, sizeof(frame));
+	frame[12] = 0x81;
+	frame[13] = 0x00;
+	for(i=0, idx=sizeof(cpc_eth_hdr_t);i<32;i++, idx+=sizeof(cpc_vlan_hdr_t)){
+		frame[idx+2] = 0x81;
+		frame[idx+3] = 0x00;
+	}
+	classifyAndCheckBounds(frame, sizeof(cpc_eth_hdr_t) + 32*sizeof(cpc_vlan_hdr_t));
+
+	pack->init(frame, sizeof(cpc_eth_hdr_t) + 32*sizeof(cpc_vlan_hdr_t), NULL, 1, 1, true);
+	CPPUNIT_ASSERT(pack->headers->num_of_headers[HEADER_TYPE_VLAN] == MAX_VLAN_FRAMES);
+	pack->destroy();
+
+	//32 MPLS labels without BoS
+	memset(frame, 0, sizeof(frame));
+	frame[12] = 0x88;
+	frame[13] = 0x47;
+	classifyAndCheckBounds(frame, sizeof(frame));
+
+	pack->init(frame, sizeof(frame), NULL, 1, 1, true);
+	CPPUNIT_ASSERT(pack->headers->num_of_headers[HEADER_TYPE_MPLS] == MAX_MPLS_FRAMES);
+
+	//The label stack is full
+	CPPUNIT_ASSERT(push_mpls(&pkt, pack->headers, ETH_TYPE_MPLS_UNICAST) == NULL);
+	pack->destroy();
+}
+
+void DataPacketX86Test::testTruncatedICMPv6()
+{
+	uint8_t frame[sizeof(cpc_eth_hdr_t) + sizeof(cpc_ipv6_hdr_t) + sizeof(struct cpc_icmpv6_neighbor_solicitation_hdr) + sizeof(struct cpc_icmpv6_lla_option)];
+	size_t icmpv6 = sizeof(cpc_eth_hdr_t) + sizeof(cpc_ipv6_hdr_t);
+	size_t opt = icmpv6 + sizeof(struct cpc_icmpv6_neighbor_solicitation_hdr);
+	uint8_t zero[sizeof(pkt.matches.__ipv6_nd_target)];
+
+	memset(zero, 0, sizeof(zero));
+
+	//Neighbor solicitation (target 2001:db8::1) with a source LL address option
+	memset(frame, 0, sizeof(frame));
+	frame[12] = 0x86;
+	frame[13] = 0xdd;
+	frame[sizeof(cpc_eth_hdr_t)] = 0x60;
+	frame[sizeof(cpc_eth_hdr_t)+6] = ICMPV6_IP_PROTO;
+	frame[icmpv6] = ICMPV6_TYPE_NEIGHBOR_SOLICITATION;
+	frame[opt-16] = 0x20;
+	frame[opt-15] = 0x01;
+	frame[opt-14] = 0x0d;
+	frame[opt-13] = 0xb8;
+	frame[opt-1] = 0x01;
+	frame[opt] = ICMPV6_OPT_LLADDR_SOURCE;
+	frame[opt+1] = 1;
+
+	for(size_t len=0;len<=sizeof(frame);len++){
+		classifyAndCheckBounds(frame, len);
+
+		pack->init(frame, len, NULL, 1, 1, true);
+		if(len >= icmpv6 + sizeof(cpc_icmpv6_hdr_t))
+			CPPUNIT_ASSERT(pkt.matches.__icmpv6_type == ICMPV6_TYPE_NEIGHBOR_SOLICITATION);
+
+		//The target and options are only taken if complete
+		CPPUNIT_ASSERT((memcmp(&pkt.matches.__ipv6_nd_target, zero, sizeof(zero)) != 0) == (len >= opt));
+		CPPUNIT_ASSERT((get_icmpv6_opt_lladr_source_hdr(pack->headers,0) != NULL) == (len == sizeof(frame)));
+		pack->destroy();
+	}
+
+	//Unknown option; parsing stops there
+	frame[opt] = 0x20;
+	classifyAndCheckBounds(frame, sizeof(frame));
+
+	pack->init(frame, sizeof(frame), NULL, 1, 1, true);
+	CPPUNIT_ASSERT(pack->headers->num_of_headers[HEADER_TYPE_ICMPV6_OPT] == 0);
+	pack->destroy();
+}
+
+
 int main(int argc, char** argv)
 {
 	CppUnit::TextUi::TestRunner runner;
@@ -56,6 +56,8 @@ rofl_result_t platform_post_init_of1x_switch(of1x_switch_t* sw){
 
 	ls_int->pkt_in_queue = new circular_queue<datapacket_t>(PROCESSING_PKT_IN_QUEUE_SLOTS);
 	ls_int->storage = new datapacket_storage( IO_PKT_IN_STORAGE_MAX_BUF, IO_PKT_IN_STORAGE_EXPIRATION_S); // todo make this value configurable
+	ls_int->arena = new pktin_arena(IO_PKT_IN_ARENA_BYTES);
+	ls_int->meter = new pktin_meter(sw->pipeline.num_of_tables, &pktin_meter::defaults);
 
 	sw->platform_state = (of_switch_platform_state_t*)ls_int;
 
@@ -77,6 +79,8 @@ rofl_result_t platform_pre_destroy_of1x_switch(of1x_switch_t* sw){
 	}
 	delete ls_int->pkt_in_queue;
 	delete ls_int->storage;
+	delete ls_int->arena;
+	delete ls_int->meter;
 	free(sw->platform_state);
 	
 	return ROFL_SUCCESS;
@@ -24,3 +24,6 @@ sudo ./test_portmmap
 #test for the hcl notifications for port events (add, delete & status change)
 sudo ./test_port_status
 
+#test for the invalidation of the microflow cache by the flow entry hooks
+sudo ./test_microflow_cache_hooks
+
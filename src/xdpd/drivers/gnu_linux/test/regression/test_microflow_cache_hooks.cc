@@ -0,0 +1,255 @@
+/**
+* This is a regression test that must check that the path
+* of a packet cached by the microflow cache is not used
+* after the flow tables are changed through the add,
+* modify and remove entry hooks of the driver
+* (platform_hooks_of1x.cc)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <rofl/datapath/pipeline/physical_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+#include <rofl/datapath/hal/driver.h>
+#include "hal-imp/driver_ext.h"
+#include "io/bufferpool.h"
+#include "io/datapacketx86.h"
+#include "processing/ls_internal_state.h"
+#include "processing/microflow_cache_pp.h"
+
+#define TEST_DPID 0x1016
+#define TEST_IPV4_DST 0x0a010001
+
+using namespace std;
+using namespace xdpd::gnu_linux;
+
+class MicroflowCacheHooksTestCase : public CppUnit::TestFixture{
+
+	CPPUNIT_TEST_SUITE(MicroflowCacheHooksTestCase);
+	CPPUNIT_TEST(test_add);
+	CPPUNIT_TEST(test_modify);
+	CPPUNIT_TEST(test_remove);
+	CPPUNIT_TEST_SUITE_END();
+
+	//Test methods
+	void test_add(void);
+	void test_modify(void);
+	void test_remove(void);
+
+	//Suff
+	of1x_switch_t* sw;
+	switch_platform_state_t* ls_int;
+	microflow_cache* mfc;
+
+	//IPv4 entry (exact on the destination if exact), going to goto_table
+	//or dropping the packet (goto_table 0)
+	of1x_flow_entry_t* ipv4_entry(uint16_t priority, bool exact, unsigned int goto_table);
+	void add_entry(unsigned int table_id, uint16_t priority, bool exact, unsigned int goto_table);
+
+	//Process an IPv4/UDP packet through the cache
+	void process_packet(void);
+
+	//Check the counters of the cache and the matches of the tables
+	void check(uint64_t hits, uint64_t misses, uint64_t t1_matched, uint64_t t2_matched);
+
+	public:
+		void setUp(void);
+		void tearDown(void);
+};
+
+/* Setup and tear down */
+void MicroflowCacheHooksTestCase::setUp(){
+
+	char switch_name[] = "mfc0";
+	of1x_matching_algorithm_available ma_list[] = { of1x_loop_matching_algorithm, of1x_loop_matching_algorithm, of1x_loop_matching_algorithm };
+
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+
+	CPPUNIT_ASSERT(hal_driver_init(NULL) == HAL_SUCCESS);
+
+	CPPUNIT_ASSERT(hal_driver_create_switch(switch_name,TEST_DPID,OF_VERSION_12,3,(int *) ma_list) == HAL_SUCCESS);
+	sw = (of1x_switch_t*)physical_switch_get_logical_switch_by_dpid(TEST_DPID);
+	CPPUNIT_ASSERT(sw && sw->platform_state);
+	ls_int = (switch_platform_state_t*)sw->platform_state;
+
+	CPPUNIT_ASSERT(hal_driver_set_microflow_cache(TEST_DPID, true) == HAL_SUCCESS);
+
+	//Cache of the "RX thread"
+	mfc = new microflow_cache();
+
+	//0 -> 2 -> drop; 1 -> drop
+	add_entry(0, 10, false, 2);
+	add_entry(1, 10, false, 0);
+	add_entry(2, 10, false, 0);
+
+	//Cached path
+	process_packet();
+	check(0, 1, 0, 1);
+	process_packet();
+	check(1, 1, 0, 2);
+}
+
+void MicroflowCacheHooksTestCase::tearDown(){
+
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+
+	delete mfc;
+
+	CPPUNIT_ASSERT(hal_driver_destroy_switch_by_dpid(TEST_DPID) == HAL_SUCCESS);
+	CPPUNIT_ASSERT(hal_driver_destroy() == HAL_SUCCESS);
+}
+
+of1x_flow_entry_t* MicroflowCacheHooksTestCase::ipv4_entry(uint16_t priority, bool exact, unsigned int goto_table){
+
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+	CPPUNIT_ASSERT(entry != NULL);
+
+	entry->priority = priority;
+	of1x_add_match_to_entry(entry, of1x_init_eth_type_match(0x0800));
+	if(exact)
+		of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(TEST_IPV4_DST, 0xffffffff));
+
+	if(goto_table)
+		of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_GOTO_TABLE, NULL, NULL, NULL, goto_table);
+
+	return entry;
+}
+
+void MicroflowCacheHooksTestCase::add_entry(unsigned int table_id, uint16_t priority, bool exact, unsigned int goto_table){
+
+	of1x_flow_entry_t* entry = ipv4_entry(priority, exact, goto_table);
+	CPPUNIT_ASSERT(of1x_add_flow_entry_table(&sw->pipeline, table_id, &entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+}
+
+void MicroflowCacheHooksTestCase::process_packet(void){
+
+	//Ethernet, IPv4 (10.0.0.1 -> 10.1.0.1), UDP 1000 -> 2000
+	uint8_t frame[64] = {
+		0x00,0x11,0x22,0x33,0x44,0x55, 0x00,0x66,0x77,0x88,0x99,0xaa, 0x08,0x00,
+		0x45,0x00,0x00,0x32, 0x00,0x00,0x00,0x00, 0x40,0x11,0x00,0x00,
+		0x0a,0x00,0x00,0x01, 0x0a,0x01,0x00,0x01,
+		0x03,0xe8,0x07,0xd0, 0x00,0x1e,0x00,0x00,
+	};
+	datapacket_t* pkt;
+	datapacketx86* pkt_x86;
+
+	pkt = bufferpool::get_free_buffer_nonblocking();
+	CPPUNIT_ASSERT(pkt != NULL);
+
+	pkt_x86 = (datapacketx86*)pkt->platform_state;
+	CPPUNIT_ASSERT(pkt_x86->init(frame, sizeof(frame), (of_switch_t*)sw, 1, 1, true, true) == ROFL_SUCCESS);
+
+	//Dropped (released) by the last table
+	mfc->process_packet((of_switch_t*)sw, pkt);
+}
+
+void MicroflowCacheHooksTestCase::check(uint64_t hits, uint64_t misses, uint64_t t1_matched, uint64_t t2_matched){
+
+	uint64_t mfc_hits, mfc_misses;
+
+	microflow_cache::get_stats(ls_int, &mfc_hits, &mfc_misses);
+
+	CPPUNIT_ASSERT(mfc_hits == hits);
+	CPPUNIT_ASSERT(mfc_misses == misses);
+	CPPUNIT_ASSERT(sw->pipeline.tables[1].stats.matched_count == t1_matched);
+	CPPUNIT_ASSERT(sw->pipeline.tables[2].stats.matched_count == t2_matched);
+}
+
+/* Tests */
+void MicroflowCacheHooksTestCase::test_add(){
+
+	uint64_t generation = ls_int->mfc_generation;
+
+	fprintf(stderr,"<%s:%d> ************** Add entry ************\n",__func__,__LINE__);
+
+	//0 -> 1 for this packet
+	add_entry(0, 20, true, 1);
+	CPPUNIT_ASSERT(ls_int->mfc_generation != generation);
+
+	//The cached path (0 -> 2) is not used
+	process_packet();
+	check(1, 2, 1, 2);
+
+	//The new one is cached
+	process_packet();
+	check(2, 2, 2, 2);
+}
+
+void MicroflowCacheHooksTestCase::test_modify(){
+
+	uint64_t generation;
+	of1x_flow_entry_t* entry;
+
+	fprintf(stderr,"<%s:%d> ************** Modify entry ************\n",__func__,__LINE__);
+
+	add_entry(0, 20, true, 1);
+	process_packet();
+	process_packet();
+	check(2, 2, 2, 2);
+
+	//0 -> 2 again, through the same entry
+	generation = ls_int->mfc_generation;
+	entry = ipv4_entry(20, true, 2);
+	CPPUNIT_ASSERT(of1x_modify_flow_entry_table(&sw->pipeline, 0, &entry, STRICT, false) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(ls_int->mfc_generation != generation);
+
+	//The cached path (0 -> 1) is not used
+	process_packet();
+	check(2, 3, 2, 3);
+
+	process_packet();
+	check(3, 3, 2, 4);
+}
+
+void MicroflowCacheHooksTestCase::test_remove(){
+
+	uint64_t generation;
+	of1x_flow_entry_t* entry;
+
+	fprintf(stderr,"<%s:%d> ************** Remove entry ************\n",__func__,__LINE__);
+
+	add_entry(0, 20, true, 1);
+	process_packet();
+	process_packet();
+	check(2, 2, 2, 2);
+
+	//Back to the initial path (0 -> 2)
+	generation = ls_int->mfc_generation;
+	entry = ipv4_entry(20, true, 1);
+	CPPUNIT_ASSERT(of1x_remove_flow_entry_table(&sw->pipeline, 0, entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	of1x_destroy_flow_entry(entry);
+	CPPUNIT_ASSERT(ls_int->mfc_generation != generation);
+
+	//The cached path (0 -> 1, through the removed entry) is not used
+	process_packet();
+	check(2, 3, 2, 3);
+
+	process_packet();
+	check(3, 3, 2, 4);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(MicroflowCacheHooksTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
@@ -12,10 +12,13 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <pthread.h>
 #include "io/datapacket_storage.h"
 
 #define STORE_SIZE 15
 #define EXPIRATION_SEC 3
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_ITERATIONS 100000
 
 using namespace std;
 using namespace xdpd::gnu_linux;
@@ -25,11 +28,15 @@ class DataPacketStorageTestCase : public CppUnit::TestFixture{
 	CPPUNIT_TEST(test_basic);
 	CPPUNIT_TEST(test_saturation);
 	CPPUNIT_TEST(test_expiration);
+	CPPUNIT_TEST(test_stale_id);
+	CPPUNIT_TEST(test_concurrent);
 	CPPUNIT_TEST_SUITE_END();
 	
 	void test_basic(void);
 	void test_saturation(void);
 	void test_expiration(void);
+	void test_stale_id(void);
+	void test_concurrent(void);
 	
 	datapacket_storage *dps;
 	datapacket_t pkt[STORE_SIZE], *recv;
@@ -116,6 +123,63 @@ void DataPacketStorageTestCase::test_expiration(void)
 	CPPUNIT_ASSERT(res==false);
 }
 
+void DataPacketStorageTestCase::test_stale_id(void)
+{
+	int i;
+	fprintf(stderr,"<%s:%d> ************** Test stale id ************\n",__func__,__LINE__);
+
+	id[0] = dps->store_packet(&pkt[0]);
+	CPPUNIT_ASSERT(dps->get_packet(id[0]) == &pkt[0]);
+
+	//Already retrieved
+	CPPUNIT_ASSERT(dps->get_packet(id[0]) == NULL);
+	CPPUNIT_ASSERT(dps->get_packet(datapacket_storage::ERROR) == NULL);
+	CPPUNIT_ASSERT(dps->get_packet(0) == NULL);
+
+	//Reuse all the slots; old ids must never match a newer packet
+	for(i=0;i<16*STORE_SIZE;i++){
+		id[1] = dps->store_packet(&pkt[1]);
+		CPPUNIT_ASSERT(id[1] != datapacket_storage::ERROR);
+		CPPUNIT_ASSERT(id[1] != 0);
+		CPPUNIT_ASSERT(id[1] != id[0]);
+		CPPUNIT_ASSERT(dps->get_packet(id[0]) == NULL);
+		CPPUNIT_ASSERT(dps->get_packet(id[1]) == &pkt[1]);
+	}
+	CPPUNIT_ASSERT(dps->get_storage_size() == 0);
+}
+
+static void* concurrent_routine(void* arg){
+	datapacket_storage* dps = (datapacket_storage*)arg;
+	datapacket_t pkt;
+	storeid id;
+
+	for(int i=0;i<CONCURRENT_ITERATIONS;i++){
+		id = dps->store_packet(&pkt);
+		if(id == datapacket_storage::ERROR)
+			continue;
+		if(dps->get_packet(id) != &pkt)
+			return (void*)1;
+	}
+	return NULL;
+}
+
+void DataPacketStorageTestCase::test_concurrent(void)
+{
+	int i;
+	void* rv;
+	pthread_t threads[CONCURRENT_THREADS];
+	fprintf(stderr,"<%s:%d> ************** Test concurrent ************\n",__func__,__LINE__);
+
+	for(i=0;i<CONCURRENT_THREADS;i++)
+		pthread_create(&threads[i], NULL, concurrent_routine, dps);
+
+	for(i=0;i<CONCURRENT_THREADS;i++){
+		pthread_join(threads[i], &rv);
+		CPPUNIT_ASSERT(rv == NULL);
+	}
+	CPPUNIT_ASSERT(dps->get_storage_size() == 0);
+}
+
 /*
 * Test MAIN
 */
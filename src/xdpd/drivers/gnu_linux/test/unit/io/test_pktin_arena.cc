@@ -0,0 +1,160 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the PKT_IN arena (pktin_arena)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <string.h>
+#include "io/pktin_arena.h"
+
+#define GRANULE pktin_arena::PKTIN_ARENA_GRANULE
+#define ARENA_SIZE (16*GRANULE)
+//Frame that fits in a single granule and in two granules
+#define SMALL_FRAME (GRANULE-sizeof(pktin_spill_t))
+#define LARGE_FRAME (2*GRANULE-sizeof(pktin_spill_t))
+
+using namespace std;
+using namespace xdpd::gnu_linux;
+
+class PktInArenaTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(PktInArenaTestCase);
+	CPPUNIT_TEST(test_basic);
+	CPPUNIT_TEST(test_saturation);
+	CPPUNIT_TEST(test_out_of_order);
+	CPPUNIT_TEST(test_wrap);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_basic(void);
+	void test_saturation(void);
+	void test_out_of_order(void);
+	void test_wrap(void);
+
+	pktin_arena* arena;
+	uint8_t frame[2*GRANULE];
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void PktInArenaTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+	arena = new pktin_arena(ARENA_SIZE);
+	for(unsigned int i=0;i<sizeof(frame);i++)
+		frame[i] = i;
+}
+
+void PktInArenaTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+	delete arena;
+}
+
+/* Tests */
+void PktInArenaTestCase::test_basic(void)
+{
+	pktin_spill_t* spill;
+	fprintf(stderr,"<%s:%d> ************** Test basic ************\n",__func__,__LINE__);
+
+	spill = arena->spill(frame, 100, 1, 2);
+	CPPUNIT_ASSERT(spill != NULL);
+	CPPUNIT_ASSERT(spill->len == 100);
+	CPPUNIT_ASSERT(spill->in_port == 1);
+	CPPUNIT_ASSERT(spill->in_phy_port == 2);
+	CPPUNIT_ASSERT(memcmp(spill->data, frame, 100) == 0);
+
+	//Sized to the frame
+	CPPUNIT_ASSERT(arena->get_used() == 2*GRANULE);
+
+	arena->release(spill);
+	CPPUNIT_ASSERT(arena->get_used() == 0);
+}
+
+void PktInArenaTestCase::test_saturation(void)
+{
+	unsigned int i;
+	pktin_spill_t* spills[16];
+	fprintf(stderr,"<%s:%d> ************** Test saturation ************\n",__func__,__LINE__);
+
+	for(i=0;i<16;i++){
+		spills[i] = arena->spill(frame, SMALL_FRAME, i, 0);
+		CPPUNIT_ASSERT(spills[i] != NULL);
+	}
+	CPPUNIT_ASSERT(arena->get_used() == ARENA_SIZE);
+	CPPUNIT_ASSERT(arena->spill(frame, 1, 0, 0) == NULL);
+	CPPUNIT_ASSERT(arena->get_num_of_failures() == 1);
+
+	for(i=0;i<16;i++){
+		CPPUNIT_ASSERT(spills[i]->in_port == i);
+		arena->release(spills[i]);
+	}
+	CPPUNIT_ASSERT(arena->get_used() == 0);
+}
+
+void PktInArenaTestCase::test_out_of_order(void)
+{
+	unsigned int i;
+	pktin_spill_t* spills[16];
+	fprintf(stderr,"<%s:%d> ************** Test out of order ************\n",__func__,__LINE__);
+
+	for(i=0;i<16;i++)
+		spills[i] = arena->spill(frame, SMALL_FRAME, i, 0);
+
+	//Released, but not reclaimable until the oldest is released
+	for(i=1;i<16;i++)
+		arena->release(spills[i]);
+	CPPUNIT_ASSERT(arena->get_used() == ARENA_SIZE);
+	CPPUNIT_ASSERT(arena->spill(frame, 1, 0, 0) == NULL);
+
+	arena->release(spills[0]);
+	CPPUNIT_ASSERT(arena->get_used() == 0);
+}
+
+void PktInArenaTestCase::test_wrap(void)
+{
+	unsigned int i, round;
+	pktin_spill_t* spills[16];
+	fprintf(stderr,"<%s:%d> ************** Test wrap ************\n",__func__,__LINE__);
+
+	//Keep 5 spills outstanding in FIFO order with sizes that do not
+	//divide the arena, so that padding is needed at the end of the ring
+	for(round=0;round<100;round++){
+		for(i=0;i<16;i++){
+			if(i >= 5){
+				CPPUNIT_ASSERT(memcmp(spills[(i-5)%16]->data, frame, LARGE_FRAME - (i-5)%2) == 0);
+				arena->release(spills[(i-5)%16]);
+			}
+			spills[i] = arena->spill(frame, LARGE_FRAME - i%2, i, 0);
+			CPPUNIT_ASSERT(spills[i] != NULL);
+		}
+		for(i=11;i<16;i++)
+			arena->release(spills[i]);
+		CPPUNIT_ASSERT(arena->get_used() == 0);
+	}
+	CPPUNIT_ASSERT(arena->get_num_of_failures() == 0);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(PktInArenaTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the PKT_IN meters (pktin_meter)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "io/pktin_meter.h"
+
+#define NUM_OF_TABLES 4
+#define BURST 10
+//1 PKT_IN every 100ms; the tests run well within one interval
+#define RATE 10
+
+#define NO_MATCH ((of_packet_in_reason_t)PKTIN_METER_REASON_NO_MATCH)
+#define ACTION ((of_packet_in_reason_t)PKTIN_METER_REASON_ACTION)
+
+using namespace std;
+using namespace xdpd::gnu_linux;
+
+class PktInMeterTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(PktInMeterTestCase);
+	CPPUNIT_TEST(test_unlimited);
+	CPPUNIT_TEST(test_lsi);
+	CPPUNIT_TEST(test_table);
+	CPPUNIT_TEST(test_reason);
+	CPPUNIT_TEST(test_refill);
+	CPPUNIT_TEST(test_configure);
+	CPPUNIT_TEST(test_params);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_unlimited(void);
+	void test_lsi(void);
+	void test_table(void);
+	void test_reason(void);
+	void test_refill(void);
+	void test_configure(void);
+	void test_params(void);
+
+	pktin_meter_config_t conf;
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void PktInMeterTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+	memset(&conf, 0, sizeof(conf));
+	conf.burst = BURST;
+}
+
+void PktInMeterTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+//Sends n PKT_INs and returns how many were accepted
+static int send_pktins(pktin_meter* m, int n, uint8_t table_id, of_packet_in_reason_t reason){
+	int i, accepted = 0;
+	for(i=0;i<n;i++){
+		if(m->admit(table_id, reason))
+			accepted++;
+	}
+	return accepted;
+}
+
+/* Tests */
+void PktInMeterTestCase::test_unlimited(void)
+{
+	pktin_meter_stats_t stats;
+	fprintf(stderr,"<%s:%d> ************** Test unlimited ************\n",__func__,__LINE__);
+
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	CPPUNIT_ASSERT(send_pktins(&m, 1000, 0, NO_MATCH) == 1000);
+
+	m.get_stats(&stats);
+	CPPUNIT_ASSERT(stats.accepted == 1000);
+	CPPUNIT_ASSERT(stats.dropped == 0);
+}
+
+void PktInMeterTestCase::test_lsi(void)
+{
+	pktin_meter_stats_t stats;
+	fprintf(stderr,"<%s:%d> ************** Test LSI ************\n",__func__,__LINE__);
+
+	conf.rate = RATE;
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	//Aggregated over tables and reasons
+	CPPUNIT_ASSERT(send_pktins(&m, BURST/2, 0, NO_MATCH) == BURST/2);
+	CPPUNIT_ASSERT(send_pktins(&m, BURST, 1, ACTION) == BURST/2);
+	CPPUNIT_ASSERT(send_pktins(&m, 1, 2, NO_MATCH) == 0);
+
+	m.get_stats(&stats);
+	CPPUNIT_ASSERT(stats.accepted == BURST);
+	CPPUNIT_ASSERT(stats.dropped == BURST/2 + 1);
+
+	m.get_lsi_stats(&stats);
+	CPPUNIT_ASSERT(stats.dropped == BURST/2 + 1);
+}
+
+void PktInMeterTestCase::test_table(void)
+{
+	pktin_meter_stats_t stats;
+	fprintf(stderr,"<%s:%d> ************** Test table ************\n",__func__,__LINE__);
+
+	conf.table_rate = RATE;
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	//A noisy table does not starve the others
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, NO_MATCH) == BURST);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 1, NO_MATCH) == BURST);
+
+	CPPUNIT_ASSERT(m.get_table_stats(0, &stats) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(stats.accepted == BURST);
+	CPPUNIT_ASSERT(stats.dropped == 100-BURST);
+	CPPUNIT_ASSERT(m.get_table_stats(2, &stats) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(stats.accepted == 0);
+	CPPUNIT_ASSERT(stats.dropped == 0);
+	CPPUNIT_ASSERT(m.get_table_stats(NUM_OF_TABLES, &stats) == ROFL_FAILURE);
+
+	//LSI limit; PKT_INs refused by the LSI meter do not consume table tokens
+	conf.rate = RATE;
+	pktin_meter m2(NUM_OF_TABLES, &conf);
+
+	CPPUNIT_ASSERT(send_pktins(&m2, BURST, 0, NO_MATCH) == BURST);
+	CPPUNIT_ASSERT(send_pktins(&m2, 100, 1, NO_MATCH) == 0);
+
+	CPPUNIT_ASSERT(m2.get_table_stats(1, &stats) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(stats.accepted == 0);
+	CPPUNIT_ASSERT(stats.dropped == 0);
+	m2.get_lsi_stats(&stats);
+	CPPUNIT_ASSERT(stats.accepted == BURST);
+	CPPUNIT_ASSERT(stats.dropped == 100);
+}
+
+void PktInMeterTestCase::test_reason(void)
+{
+	pktin_meter_stats_t stats;
+	fprintf(stderr,"<%s:%d> ************** Test reason ************\n",__func__,__LINE__);
+
+	conf.reason_rate[PKTIN_METER_REASON_NO_MATCH] = RATE;
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	//Table misses are limited, explicit output to controller is not
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, NO_MATCH) == BURST);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, ACTION) == 100);
+
+	CPPUNIT_ASSERT(m.get_reason_stats(PKTIN_METER_REASON_NO_MATCH, &stats) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(stats.accepted == BURST);
+	CPPUNIT_ASSERT(stats.dropped == 100-BURST);
+	CPPUNIT_ASSERT(m.get_reason_stats(PKTIN_METER_REASON_ACTION, &stats) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(stats.accepted == 100);
+	CPPUNIT_ASSERT(stats.dropped == 0);
+}
+
+void PktInMeterTestCase::test_refill(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test refill ************\n",__func__,__LINE__);
+
+	conf.rate = RATE;
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, NO_MATCH) == BURST);
+
+	//Half a second worth of PKT_INs (+-1 for the timing)
+	usleep(500000);
+	int accepted = send_pktins(&m, 100, 0, NO_MATCH);
+	CPPUNIT_ASSERT(accepted >= RATE/2-1 && accepted <= RATE/2+1);
+}
+
+void PktInMeterTestCase::test_configure(void)
+{
+	pktin_meter_stats_t stats;
+	fprintf(stderr,"<%s:%d> ************** Test configure ************\n",__func__,__LINE__);
+
+	pktin_meter m(NUM_OF_TABLES, &conf);
+
+	//Unlimited -> LSI limit (per LSI config)
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, NO_MATCH) == 100);
+	conf.rate = RATE;
+	m.configure(&conf);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 0, NO_MATCH) == BURST);
+
+	//Counters are kept
+	m.get_stats(&stats);
+	CPPUNIT_ASSERT(stats.accepted == 100+BURST);
+	CPPUNIT_ASSERT(stats.dropped == 100-BURST);
+
+	//Table limit instead; buckets start full
+	conf.rate = 0;
+	conf.table_rate = RATE;
+	m.configure(&conf);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 1, NO_MATCH) == BURST);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 2, NO_MATCH) == BURST);
+
+	//Back to unlimited
+	conf.table_rate = 0;
+	m.configure(&conf);
+	CPPUNIT_ASSERT(send_pktins(&m, 100, 1, NO_MATCH) == 100);
+}
+
+void PktInMeterTestCase::test_params(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test params ************\n",__func__,__LINE__);
+
+	memset(&conf, 0, sizeof(conf));
+	CPPUNIT_ASSERT(pktin_meter::parse_params("", &conf) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(pktin_meter::parse_params(NULL, &conf) == ROFL_SUCCESS);
+
+	CPPUNIT_ASSERT(pktin_meter::parse_params("pktin-rate=1000; pktin-table-rate = 200;other=abc;pktin-nomatch-rate=300;pktin-action-rate=400;pktin-burst=50", &conf) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(conf.rate == 1000);
+	CPPUNIT_ASSERT(conf.table_rate == 200);
+	CPPUNIT_ASSERT(conf.reason_rate[PKTIN_METER_REASON_NO_MATCH] == 300);
+	CPPUNIT_ASSERT(conf.reason_rate[PKTIN_METER_REASON_ACTION] == 400);
+	CPPUNIT_ASSERT(conf.burst == 50);
+
+	CPPUNIT_ASSERT(pktin_meter::parse_params("pktin-rate=abc", &conf) == ROFL_FAILURE);
+	CPPUNIT_ASSERT(pktin_meter::parse_params("pktin-rate=-1", &conf) == ROFL_FAILURE);
+	CPPUNIT_ASSERT(pktin_meter::parse_params("pktin-burst=", &conf) == ROFL_FAILURE);
+	CPPUNIT_ASSERT(pktin_meter::parse_params("pktin-rate=99999999999", &conf) == ROFL_FAILURE);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(PktInMeterTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
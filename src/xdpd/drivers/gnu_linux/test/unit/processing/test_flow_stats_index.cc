@@ -0,0 +1,245 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the flow entry index used for aggregate
+* stats (flow_stats_index)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include "processing/flow_stats_index.h"
+
+#define NUM_OF_TABLES 2
+#define NUM_OF_ENTRIES 16
+
+using namespace std;
+using namespace xdpd::gnu_linux;
+
+class FlowStatsIndexTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(FlowStatsIndexTestCase);
+	CPPUNIT_TEST(test_table);
+	CPPUNIT_TEST(test_cookie);
+	CPPUNIT_TEST(test_no_cookie_index);
+	CPPUNIT_TEST(test_remove);
+	CPPUNIT_TEST(test_walk);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_table(void);
+	void test_cookie(void);
+	void test_no_cookie_index(void);
+	void test_remove(void);
+	void test_walk(void);
+
+	//Entry i: cookie i%4 (high bits set for odd i), 1 packet, i bytes
+	of1x_flow_entry_t* entries[NUM_OF_ENTRIES];
+
+	void fill(flow_stats_index* index);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void FlowStatsIndexTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+
+	for(unsigned int i=0;i<NUM_OF_ENTRIES;i++){
+		entries[i] = (of1x_flow_entry_t*)calloc(1, sizeof(of1x_flow_entry_t));
+		entries[i]->cookie = (i%4) | ((i%2)? 0xAB00000000000000ULL : 0);
+		entries[i]->stats.packet_count = 1;
+		entries[i]->stats.byte_count = i;
+	}
+}
+
+void FlowStatsIndexTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+
+	for(unsigned int i=0;i<NUM_OF_ENTRIES;i++)
+		free(entries[i]);
+}
+
+//Even entries to table 0, odd to table 1
+void FlowStatsIndexTestCase::fill(flow_stats_index* index){
+	for(unsigned int i=0;i<NUM_OF_ENTRIES;i++)
+		index->add(i%2, entries[i]);
+}
+
+void FlowStatsIndexTestCase::test_table(void)
+{
+	uint64_t packets, bytes;
+	uint32_t flows;
+
+	fprintf(stderr,"<%s:%d> ************** Test table ************\n",__func__,__LINE__);
+
+	flow_stats_index index(NUM_OF_TABLES, true);
+	fill(&index);
+
+	//Table 0: 0,2,4..14
+	index.get_aggregate(0, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES/2);
+	CPPUNIT_ASSERT(packets == NUM_OF_ENTRIES/2);
+	CPPUNIT_ASSERT(bytes == 56);
+
+	//All tables
+	index.get_aggregate(0xFF, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES);
+	CPPUNIT_ASSERT(bytes == 120);
+
+	//Re-adding is a no-op
+	index.add(0, entries[0]);
+	index.get_aggregate(0, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES/2);
+
+	//Counters are read at query time
+	entries[0]->stats.packet_count = 10;
+	index.get_aggregate(0, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(packets == NUM_OF_ENTRIES/2 + 9);
+}
+
+void FlowStatsIndexTestCase::test_cookie(void)
+{
+	uint64_t packets, bytes;
+	uint32_t flows;
+
+	fprintf(stderr,"<%s:%d> ************** Test cookie ************\n",__func__,__LINE__);
+
+	flow_stats_index index(NUM_OF_TABLES, true);
+	fill(&index);
+
+	//Exact match: cookie 2 in table 0 -> 2,6,10,14
+	index.get_aggregate(0, 2, 0xFFFFFFFFFFFFFFFFULL, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 4);
+	CPPUNIT_ASSERT(bytes == 32);
+
+	//Exact match including the high bits: cookie 0xAB..01 in table 1 -> 1,5,9,13
+	index.get_aggregate(1, 0xAB00000000000001ULL, 0xFFFFFFFFFFFFFFFFULL, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 4);
+	CPPUNIT_ASSERT(bytes == 28);
+
+	//32 bit mask (high bits ignored); cookie 1 in all tables -> 1,5,9,13
+	index.get_aggregate(0xFF, 1, 0xFFFFFFFF, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 4);
+	CPPUNIT_ASSERT(packets == 4);
+
+	//Partial mask; odd cookies -> all the entries of table 1
+	index.get_aggregate(0xFF, 1, 0x1, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES/2);
+	CPPUNIT_ASSERT(bytes == 64);
+
+	//No such cookie
+	index.get_aggregate(0, 7, 0xFFFFFFFFFFFFFFFFULL, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 0);
+	CPPUNIT_ASSERT(packets == 0);
+	CPPUNIT_ASSERT(bytes == 0);
+}
+
+void FlowStatsIndexTestCase::test_no_cookie_index(void)
+{
+	uint64_t packets, bytes;
+	uint32_t flows;
+
+	fprintf(stderr,"<%s:%d> ************** Test without cookie index ************\n",__func__,__LINE__);
+
+	flow_stats_index index(NUM_OF_TABLES, false);
+	fill(&index);
+
+	//Same results as with the index
+	index.get_aggregate(0, 2, 0xFFFFFFFFFFFFFFFFULL, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 4);
+	CPPUNIT_ASSERT(bytes == 32);
+
+	index.get_aggregate(0xFF, 1, 0x1, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES/2);
+	CPPUNIT_ASSERT(bytes == 64);
+}
+
+void FlowStatsIndexTestCase::test_remove(void)
+{
+	uint64_t packets, bytes;
+	uint32_t flows;
+
+	fprintf(stderr,"<%s:%d> ************** Test remove ************\n",__func__,__LINE__);
+
+	flow_stats_index index(NUM_OF_TABLES, true);
+	fill(&index);
+
+	//Remove all the entries with cookie 2 (2,6,10,14)
+	for(unsigned int i=2;i<NUM_OF_ENTRIES;i+=4)
+		index.remove(0, entries[i]);
+
+	//Removing twice, or from the wrong table, is a no-op
+	index.remove(0, entries[2]);
+	index.remove(1, entries[0]);
+
+	index.get_aggregate(0, 2, 0xFFFFFFFFFFFFFFFFULL, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == 0);
+
+	index.get_aggregate(0, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES/4);
+	CPPUNIT_ASSERT(bytes == 24);
+
+	//Out of range tables are ignored
+	index.add(NUM_OF_TABLES, entries[2]);
+	index.get_aggregate(0xFF, 0, 0, &packets, &bytes, &flows);
+	CPPUNIT_ASSERT(flows == NUM_OF_ENTRIES - NUM_OF_ENTRIES/4);
+}
+
+void FlowStatsIndexTestCase::test_walk(void)
+{
+	of1x_flow_entry_t *entry, *last;
+	std::set<of1x_flow_entry_t*> seen;
+
+	fprintf(stderr,"<%s:%d> ************** Test walk ************\n",__func__,__LINE__);
+
+	flow_stats_index index(NUM_OF_TABLES, true);
+
+	//Empty table and out of range tables
+	CPPUNIT_ASSERT(index.next(0, NULL) == NULL);
+	CPPUNIT_ASSERT(index.next(NUM_OF_TABLES, NULL) == NULL);
+
+	fill(&index);
+
+	//All the entries of table 0, once
+	for(entry = index.next(0, NULL); entry; entry = index.next(0, entry)){
+		CPPUNIT_ASSERT(seen.insert(entry).second);
+		CPPUNIT_ASSERT(entry->stats.byte_count % 2 == 0);
+	}
+	CPPUNIT_ASSERT(seen.size() == NUM_OF_ENTRIES/2);
+
+	//Resume after an entry that has been removed meanwhile
+	seen.clear();
+	last = index.next(1, index.next(1, NULL));
+	seen.insert(index.next(1, NULL));
+	seen.insert(last);
+	index.remove(1, last);
+
+	for(entry = index.next(1, last); entry; entry = index.next(1, entry))
+		CPPUNIT_ASSERT(seen.insert(entry).second);
+	CPPUNIT_ASSERT(seen.size() == NUM_OF_ENTRIES/2);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(FlowStatsIndexTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
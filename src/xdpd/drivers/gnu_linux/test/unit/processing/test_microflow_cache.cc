@@ -0,0 +1,300 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the lookups and invalidation of the
+* microflow (exact-match) cache (microflow_cache) and
+* the recycling of the counters slots of the caches
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "processing/microflow_cache.h"
+
+#define NUM_OF_ENTRIES 64
+
+using namespace std;
+using namespace xdpd::gnu_linux;
+
+class MicroflowCacheTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(MicroflowCacheTestCase);
+	CPPUNIT_TEST(test_lookup);
+	CPPUNIT_TEST(test_key);
+	CPPUNIT_TEST(test_replacement);
+	CPPUNIT_TEST(test_lsi_state);
+	CPPUNIT_TEST(test_slots);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_lookup(void);
+	void test_key(void);
+	void test_replacement(void);
+	void test_lsi_state(void);
+	void test_slots(void);
+
+	//Never dereferenced by the cache
+	of_switch_t* sw1;
+	of_switch_t* sw2;
+	of1x_flow_entry_t* entries[PROCESSING_MICROFLOW_CACHE_MAX_STEPS];
+
+	//Packet matches of flow i (IPv4/UDP)
+	void flow_matches(unsigned int i, packet_matches_t* matches);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void MicroflowCacheTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+
+	sw1 = (of_switch_t*)0x1000;
+	sw2 = (of_switch_t*)0x2000;
+
+	for(unsigned int i=0;i<PROCESSING_MICROFLOW_CACHE_MAX_STEPS;i++)
+		entries[i] = (of1x_flow_entry_t*)(uintptr_t)(0x10000 + i*0x100);
+}
+
+void MicroflowCacheTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+void MicroflowCacheTestCase::flow_matches(unsigned int i, packet_matches_t* matches){
+	memset(matches, 0, sizeof(packet_matches_t));
+	matches->__pkt_size_bytes = 64 + i;
+	matches->__port_in = matches->__phy_port_in = 1;
+	matches->__eth_type = 0x0800;
+	matches->__ip_proto = 17;
+	matches->__ipv4_src = 0x0a000001;
+	matches->__ipv4_dst = 0x0a010000 | i;
+}
+
+void MicroflowCacheTestCase::test_lookup(void)
+{
+	microflow_cache cache(NUM_OF_ENTRIES);
+	microflow_cache::step_t steps[4];
+	microflow_cache::entry_t* entry;
+	packet_matches_t matches, key;
+	uint32_t hash;
+
+	fprintf(stderr,"<%s:%d> ************** Test lookup ************\n",__func__,__LINE__);
+
+	//4-table path
+	for(unsigned int i=0;i<4;i++){
+		steps[i].table_id = i;
+		steps[i].entry = entries[i];
+	}
+
+	flow_matches(1, &matches);
+	microflow_cache::make_key(&matches, &key);
+	hash = microflow_cache::hash_key(&key);
+
+	CPPUNIT_ASSERT(cache.lookup(sw1, 1, &key, hash) == NULL);
+
+	cache.insert(sw1, 1, &key, hash, steps, 4);
+
+	entry = cache.lookup(sw1, 1, &key, hash);
+	CPPUNIT_ASSERT(entry != NULL);
+	CPPUNIT_ASSERT(entry->num_of_steps == 4);
+	for(unsigned int i=0;i<4;i++){
+		CPPUNIT_ASSERT(entry->steps[i].table_id == i);
+		CPPUNIT_ASSERT(entry->steps[i].entry == entries[i]);
+	}
+
+	//Other generation or LSI
+	CPPUNIT_ASSERT(cache.lookup(sw1, 2, &key, hash) == NULL);
+	CPPUNIT_ASSERT(cache.lookup(sw2, 1, &key, hash) == NULL);
+
+	//Paths longer than PROCESSING_MICROFLOW_CACHE_MAX_STEPS are not cached
+	flow_matches(2, &matches);
+	microflow_cache::make_key(&matches, &key);
+	hash = microflow_cache::hash_key(&key);
+	cache.insert(sw1, 1, &key, hash, steps, PROCESSING_MICROFLOW_CACHE_MAX_STEPS+1);
+	CPPUNIT_ASSERT(cache.lookup(sw1, 1, &key, hash) == NULL);
+}
+
+void MicroflowCacheTestCase::test_key(void)
+{
+	microflow_cache cache(NUM_OF_ENTRIES);
+	microflow_cache::step_t step;
+	packet_matches_t matches, key1, key2;
+
+	fprintf(stderr,"<%s:%d> ************** Test key ************\n",__func__,__LINE__);
+
+	step.table_id = 0;
+	step.entry = entries[0];
+
+	//The packet size is not part of the key
+	flow_matches(1, &matches);
+	microflow_cache::make_key(&matches, &key1);
+	matches.__pkt_size_bytes = 1500;
+	microflow_cache::make_key(&matches, &key2);
+
+	CPPUNIT_ASSERT(memcmp(&key1, &key2, sizeof(packet_matches_t)) == 0);
+	CPPUNIT_ASSERT(microflow_cache::hash_key(&key1) == microflow_cache::hash_key(&key2));
+
+	cache.insert(sw1, 1, &key1, microflow_cache::hash_key(&key1), &step, 1);
+	CPPUNIT_ASSERT(cache.lookup(sw1, 1, &key2, microflow_cache::hash_key(&key2)) != NULL);
+
+	//Any match field is
+	matches.__udp_dst = 53;
+	microflow_cache::make_key(&matches, &key2);
+	CPPUNIT_ASSERT(cache.lookup(sw1, 1, &key2, microflow_cache::hash_key(&key2)) == NULL);
+
+	//Even with a colliding hash
+	CPPUNIT_ASSERT(cache.lookup(sw1, 1, &key2, microflow_cache::hash_key(&key1)) == NULL);
+}
+
+void MicroflowCacheTestCase::test_replacement(void)
+{
+	microflow_cache cache(NUM_OF_ENTRIES);
+	microflow_cache::step_t step;
+	packet_matches_t matches, keys[microflow_cache::WAYS+1];
+	unsigned int i;
+	uint32_t hash = 0xCAFE;
+
+	fprintf(stderr,"<%s:%d> ************** Test replacement ************\n",__func__,__LINE__);
+
+	step.table_id = 0;
+	step.entry = entries[0];
+
+	for(i=0;i<=microflow_cache::WAYS;i++){
+		flow_matches(i, &matches);
+		microflow_cache::make_key(&matches, &keys[i]);
+	}
+
+	//Fill the set (same hash)
+	for(i=0;i<microflow_cache::WAYS;i++)
+		cache.insert(sw1, 1, &keys[i], hash, &step, 1);
+	for(i=0;i<microflow_cache::WAYS;i++)
+		CPPUNIT_ASSERT(cache.lookup(sw1, 1, &keys[i], hash) != NULL);
+
+	//Set full; one of them is overwritten
+	cache.insert(sw2, 7, &keys[microflow_cache::WAYS], hash, &step, 1);
+	CPPUNIT_ASSERT(cache.lookup(sw2, 7, &keys[microflow_cache::WAYS], hash) != NULL);
+
+	unsigned int found = 0;
+	for(i=0;i<microflow_cache::WAYS;i++){
+		if(cache.lookup(sw1, 1, &keys[i], hash))
+			found++;
+	}
+	CPPUNIT_ASSERT(found == microflow_cache::WAYS-1);
+
+	//Stale entries of the LSI (older generation) are taken first; the
+	//entry of sw2 stays
+	for(i=0;i<microflow_cache::WAYS-1;i++)
+		cache.insert(sw1, 2, &keys[i], hash, &step, 1);
+
+	CPPUNIT_ASSERT(cache.lookup(sw2, 7, &keys[microflow_cache::WAYS], hash) != NULL);
+	for(i=0;i<microflow_cache::WAYS-1;i++)
+		CPPUNIT_ASSERT(cache.lookup(sw1, 2, &keys[i], hash) != NULL);
+}
+
+void MicroflowCacheTestCase::test_lsi_state(void)
+{
+	switch_platform_state_t* ls1 = (switch_platform_state_t*)calloc(1, sizeof(switch_platform_state_t));
+	switch_platform_state_t* ls2 = (switch_platform_state_t*)calloc(1, sizeof(switch_platform_state_t));
+	uint64_t gen, hits, misses;
+
+	fprintf(stderr,"<%s:%d> ************** Test LSI state ************\n",__func__,__LINE__);
+
+	microflow_cache::init_lsi(ls1);
+	microflow_cache::init_lsi(ls2);
+
+	CPPUNIT_ASSERT(ls1->mfc_enabled == (PROCESSING_MICROFLOW_CACHE != 0));
+
+	//Generations are never 0 (unused entries), and unique for all the LSIs
+	CPPUNIT_ASSERT(ls1->mfc_generation != 0);
+	CPPUNIT_ASSERT(ls2->mfc_generation != 0);
+	CPPUNIT_ASSERT(ls1->mfc_generation != ls2->mfc_generation);
+
+	gen = ls1->mfc_generation;
+	microflow_cache::invalidate(ls1);
+	CPPUNIT_ASSERT(ls1->mfc_generation != gen);
+	CPPUNIT_ASSERT(ls1->mfc_generation != ls2->mfc_generation);
+
+	//Counters of all the RX threads
+	ls1->mfc_stats[0].hits = 10;
+	ls1->mfc_stats[0].misses = 1;
+	ls1->mfc_stats[PROCESSING_MAX_MICROFLOW_CACHES-1].hits = 5;
+	ls1->mfc_stats[PROCESSING_MAX_MICROFLOW_CACHES-1].misses = 2;
+
+	microflow_cache::get_stats(ls1, &hits, &misses);
+	CPPUNIT_ASSERT(hits == 15);
+	CPPUNIT_ASSERT(misses == 3);
+
+	microflow_cache::get_stats(ls2, &hits, &misses);
+	CPPUNIT_ASSERT(hits == 0 && misses == 0);
+
+	free(ls1);
+	free(ls2);
+}
+
+void MicroflowCacheTestCase::test_slots(void)
+{
+	std::vector<microflow_cache*> caches;
+	bool used[PROCESSING_MAX_MICROFLOW_CACHES];
+	microflow_cache *cache, *shared;
+	unsigned int i, slot;
+
+	fprintf(stderr,"<%s:%d> ************** Test counters slots ************\n",__func__,__LINE__);
+
+	//Caches alive at once have their own slot
+	memset(used, 0, sizeof(used));
+	for(i=0;i<PROCESSING_MAX_MICROFLOW_CACHES;i++){
+		cache = new microflow_cache(NUM_OF_ENTRIES);
+		CPPUNIT_ASSERT(cache->get_slot() < PROCESSING_MAX_MICROFLOW_CACHES);
+		CPPUNIT_ASSERT(used[cache->get_slot()] == false);
+		used[cache->get_slot()] = true;
+		caches.push_back(cache);
+	}
+
+	//The slot of a destroyed cache (e.g. RX thread recreated) is reused
+	slot = caches[PROCESSING_MAX_MICROFLOW_CACHES/2]->get_slot();
+	delete caches[PROCESSING_MAX_MICROFLOW_CACHES/2];
+	caches[PROCESSING_MAX_MICROFLOW_CACHES/2] = new microflow_cache(NUM_OF_ENTRIES);
+	CPPUNIT_ASSERT(caches[PROCESSING_MAX_MICROFLOW_CACHES/2]->get_slot() == slot);
+
+	//All of them in use; shared
+	shared = new microflow_cache(NUM_OF_ENTRIES);
+	CPPUNIT_ASSERT(shared->get_slot() < PROCESSING_MAX_MICROFLOW_CACHES);
+
+	//A shared slot is not released by the cache sharing it
+	for(i=0;i<PROCESSING_MAX_MICROFLOW_CACHES;i++){
+		if(caches[i]->get_slot() != shared->get_slot())
+			break;
+	}
+	slot = caches[i]->get_slot();
+	delete shared;
+	delete caches[i];
+
+	caches[i] = new microflow_cache(NUM_OF_ENTRIES);
+	CPPUNIT_ASSERT(caches[i]->get_slot() == slot);
+
+	for(i=0;i<caches.size();i++)
+		delete caches[i];
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(MicroflowCacheTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,361 @@
+/**
+* This is a unit test that must check that the slab allocator
+* (pipeline-imp/slab.c) returns usable, non overlapping objects of every
+* size class and large allocations, that objects can be released by
+* threads other than the one that allocated them, that frees of objects of
+* other nodes are batched and that fully free slabs are given back.
+*
+* slab.c is included so that the node of a thread cache can be forced,
+* as the test cannot rely on running on a NUMA system.
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <vector>
+
+#include "pipeline-imp/slab.c"
+
+#define OBJS_PER_SIZE 300
+
+using namespace std;
+
+class SlabTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(SlabTestCase);
+	CPPUNIT_TEST(test_classes);
+	CPPUNIT_TEST(test_cross_thread);
+	CPPUNIT_TEST(test_large);
+	CPPUNIT_TEST(test_release);
+	CPPUNIT_TEST(test_remote_batch);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_classes(void);
+	void test_cross_thread(void);
+	void test_large(void);
+	void test_release(void);
+	void test_remote_batch(void);
+
+	//Run func(arg) in a new thread and wait for it (and for its cache to
+	//be flushed)
+	static void run_thread(void* (*func)(void*), void* arg);
+
+	static void check_in_use(slab_stats_t& baseline);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+//Objects handed between threads
+struct slab_test_objs{
+	size_t length;
+	unsigned int num;
+	int node;			//Node to force on the thread cache (-1 none)
+	vector<void*> objs;
+};
+
+static void* alloc_objs(void* param){
+	slab_test_objs* t = (slab_test_objs*)param;
+
+	if(t->node >= 0)
+		slab_get_cache()->node = t->node;
+
+	for(unsigned int i=0;i<t->num;i++){
+		void* obj = slab_alloc(t->length);
+		if(!obj)
+			break;
+		memset(obj, i&0xFF, t->length);
+		t->objs.push_back(obj);
+	}
+	return NULL;
+}
+
+static void* free_objs(void* param){
+	slab_test_objs* t = (slab_test_objs*)param;
+
+	if(t->node >= 0)
+		slab_get_cache()->node = t->node;
+
+	for(unsigned int i=0;i<t->objs.size();i++)
+		slab_free(t->objs[i]);
+	t->objs.clear();
+	return NULL;
+}
+
+void SlabTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+}
+
+void SlabTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+void SlabTestCase::run_thread(void* (*func)(void*), void* arg){
+	pthread_t thread;
+
+	CPPUNIT_ASSERT(pthread_create(&thread, NULL, func, arg) == 0);
+	CPPUNIT_ASSERT(pthread_join(thread, NULL) == 0);
+}
+
+void SlabTestCase::check_in_use(slab_stats_t& baseline){
+	slab_stats_t stats;
+
+	slab_get_stats(&stats);
+
+	for(unsigned int i=0;i<SLAB_NUM_OF_CLASSES;i++)
+		CPPUNIT_ASSERT(stats.classes[i].in_use == baseline.classes[i].in_use);
+	CPPUNIT_ASSERT(stats.large_in_use == baseline.large_in_use);
+	CPPUNIT_ASSERT(stats.large_bytes == baseline.large_bytes);
+}
+
+void SlabTestCase::test_classes(void)
+{
+	slab_stats_t baseline, stats;
+	vector<void*> objs;
+	vector<size_t> lengths;
+
+	fprintf(stderr,"<%s:%d> ************** Test alloc/free across classes ************\n",__func__,__LINE__);
+
+	slab_get_stats(&baseline);
+
+	//Every class, at its boundaries
+	for(unsigned int i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		size_t size = slab_class_size[i];
+		size_t prev = (i == 0)? 0 : slab_class_size[i-1];
+
+		lengths.push_back(prev+1);
+		lengths.push_back(size);
+	}
+	lengths.push_back(0);
+
+	for(unsigned int i=0;i<lengths.size();i++){
+		for(unsigned int j=0;j<OBJS_PER_SIZE;j++){
+			uint8_t* obj = (uint8_t*)slab_alloc(lengths[i]);
+
+			CPPUNIT_ASSERT(obj != NULL);
+			CPPUNIT_ASSERT(((uintptr_t)obj & 0xF) == 0);
+			CPPUNIT_ASSERT(slab_class_size[slab_of(obj)->class_id] >= lengths[i]);
+
+			memset(obj, (i+j)&0xFF, lengths[i]);
+			objs.push_back(obj);
+		}
+	}
+
+	slab_get_stats(&stats);
+	for(unsigned int i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		CPPUNIT_ASSERT(stats.classes[i].obj_size == slab_class_size[i]);
+		CPPUNIT_ASSERT(stats.classes[i].in_use >= baseline.classes[i].in_use + OBJS_PER_SIZE);
+		CPPUNIT_ASSERT(stats.classes[i].capacity >= stats.classes[i].in_use);
+	}
+
+	//No object was overwritten by another one
+	for(unsigned int i=0, k=0;i<lengths.size();i++){
+		for(unsigned int j=0;j<OBJS_PER_SIZE;j++, k++){
+			uint8_t* obj = (uint8_t*)objs[k];
+			for(size_t b=0;b<lengths[i];b++)
+				CPPUNIT_ASSERT(obj[b] == ((i+j)&0xFF));
+		}
+	}
+
+	for(unsigned int i=0;i<objs.size();i++)
+		slab_free(objs[i]);
+	slab_free(NULL);
+
+	check_in_use(baseline);
+}
+
+void SlabTestCase::test_cross_thread(void)
+{
+	slab_stats_t baseline;
+	slab_test_objs t, half;
+
+	fprintf(stderr,"<%s:%d> ************** Test cross-thread frees ************\n",__func__,__LINE__);
+
+	slab_get_stats(&baseline);
+
+	for(unsigned int i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		t.length = slab_class_size[i];
+		t.num = OBJS_PER_SIZE;
+		t.node = half.node = -1;
+
+		//Allocated by one thread, released by another one and by this one
+		run_thread(alloc_objs, &t);
+		CPPUNIT_ASSERT(t.objs.size() == OBJS_PER_SIZE);
+
+		half.objs.assign(t.objs.begin(), t.objs.begin()+OBJS_PER_SIZE/2);
+		t.objs.erase(t.objs.begin(), t.objs.begin()+OBJS_PER_SIZE/2);
+		run_thread(free_objs, &half);
+		free_objs(&t);
+	}
+
+	check_in_use(baseline);
+
+	//Objects released by other threads can be reused
+	t.length = slab_class_size[0];
+	run_thread(alloc_objs, &t);
+	CPPUNIT_ASSERT(t.objs.size() == OBJS_PER_SIZE);
+	free_objs(&t);
+
+	check_in_use(baseline);
+}
+
+void SlabTestCase::test_large(void)
+{
+	slab_stats_t baseline, stats;
+	size_t lengths[] = { SLAB_MAX_OBJ_SIZE+1, SLAB_SIZE, 3*SLAB_SIZE+17 };
+	const unsigned int num = sizeof(lengths)/sizeof(lengths[0]);
+	uint8_t* objs[num];
+
+	fprintf(stderr,"<%s:%d> ************** Test allocations bigger than %u bytes ************\n",__func__,__LINE__,SLAB_MAX_OBJ_SIZE);
+
+	slab_get_stats(&baseline);
+
+	for(unsigned int i=0;i<num;i++){
+		objs[i] = (uint8_t*)slab_alloc(lengths[i]);
+		CPPUNIT_ASSERT(objs[i] != NULL);
+		CPPUNIT_ASSERT(((uintptr_t)objs[i] & 0xF) == 0);
+		CPPUNIT_ASSERT(slab_of(objs[i])->class_id == SLAB_CLASS_LARGE);
+		memset(objs[i], i, lengths[i]);
+	}
+
+	slab_get_stats(&stats);
+	CPPUNIT_ASSERT(stats.large_in_use == baseline.large_in_use + num);
+	CPPUNIT_ASSERT(stats.large_bytes >= baseline.large_bytes + lengths[0] + lengths[1] + lengths[2]);
+
+	//Large allocations do not use the size classes
+	for(unsigned int i=0;i<SLAB_NUM_OF_CLASSES;i++)
+		CPPUNIT_ASSERT(stats.classes[i].in_use == baseline.classes[i].in_use);
+
+	for(unsigned int i=0;i<num;i++){
+		for(size_t b=0;b<lengths[i];b++)
+			CPPUNIT_ASSERT(objs[i][b] == i);
+	}
+
+	//Released from another thread
+	slab_test_objs t;
+	t.node = -1;
+	t.objs.assign(objs, objs+num);
+	run_thread(free_objs, &t);
+
+	check_in_use(baseline);
+}
+
+void SlabTestCase::test_release(void)
+{
+	slab_stats_t baseline, stats;
+	slab_test_objs t;
+	const unsigned int cls = SLAB_NUM_OF_CLASSES-1;
+	const unsigned int objs_per_slab = (SLAB_SIZE - SLAB_HDR_SIZE) / slab_class_size[cls];
+	const unsigned int num_of_slabs = 8*SLAB_MAX_EMPTY_SLABS;
+
+	fprintf(stderr,"<%s:%d> ************** Test slab release ************\n",__func__,__LINE__);
+
+	slab_get_stats(&baseline);
+
+	t.length = slab_class_size[cls];
+	t.num = num_of_slabs*objs_per_slab;
+	t.node = -1;
+
+	run_thread(alloc_objs, &t);
+	CPPUNIT_ASSERT(t.objs.size() == t.num);
+
+	//Slabs with free objects (kept by the arena) are used first
+	slab_get_stats(&stats);
+	CPPUNIT_ASSERT(stats.classes[cls].slabs >= num_of_slabs);
+	CPPUNIT_ASSERT(stats.classes[cls].slabs > baseline.classes[cls].slabs + SLAB_MAX_EMPTY_SLABS);
+
+	//Once the objects are back (incl. those in the cache of the thread),
+	//only SLAB_MAX_EMPTY_SLABS fully free slabs are kept
+	run_thread(free_objs, &t);
+
+	slab_get_stats(&stats);
+	CPPUNIT_ASSERT(stats.classes[cls].slabs <= baseline.classes[cls].slabs + SLAB_MAX_EMPTY_SLABS);
+	CPPUNIT_ASSERT(stats.classes[cls].in_use == baseline.classes[cls].in_use);
+}
+
+void SlabTestCase::test_remote_batch(void)
+{
+	slab_test_objs a, b;
+	unsigned int local = slab_get_node();
+	unsigned int node_a = (local+1) % SLAB_MAX_NUMA_NODES;
+	unsigned int node_b = (local+2) % SLAB_MAX_NUMA_NODES;
+	const unsigned int cls = 0;
+	uint64_t remote_a, remote_b;
+	slab_stats_t stats;
+
+	fprintf(stderr,"<%s:%d> ************** Test batching of remote frees ************\n",__func__,__LINE__);
+
+	//Objects of the arenas of two other nodes
+	a.length = b.length = slab_class_size[cls];
+	a.num = 2*SLAB_REMOTE_BATCH+1;
+	b.num = 1;
+	a.node = node_a;
+	b.node = node_b;
+	run_thread(alloc_objs, &a);
+	run_thread(alloc_objs, &b);
+	CPPUNIT_ASSERT(a.objs.size() == a.num && b.objs.size() == b.num);
+
+	remote_a = slab_arenas[node_a][cls].remote_frees;
+	remote_b = slab_arenas[node_b][cls].remote_frees;
+
+	//The arena is not touched until a batch is full...
+	slab_cache_t* cache = slab_get_cache();
+	CPPUNIT_ASSERT(cache != NULL);
+	CPPUNIT_ASSERT(cache->node == local);
+	CPPUNIT_ASSERT(cache->classes[cls].remote_count == 0);
+
+	for(unsigned int i=0;i<SLAB_REMOTE_BATCH;i++)
+		slab_free(a.objs[i]);
+	CPPUNIT_ASSERT(slab_arenas[node_a][cls].remote_frees == remote_a);
+	CPPUNIT_ASSERT(cache->classes[cls].remote_count == SLAB_REMOTE_BATCH);
+
+	slab_get_stats(&stats);
+	CPPUNIT_ASSERT(stats.classes[cls].cached >= SLAB_REMOTE_BATCH);
+
+	//...it is given back at once
+	slab_free(a.objs[SLAB_REMOTE_BATCH]);
+	CPPUNIT_ASSERT(slab_arenas[node_a][cls].remote_frees == remote_a + SLAB_REMOTE_BATCH);
+	CPPUNIT_ASSERT(cache->classes[cls].remote_count == 1);
+
+	//Objects of another node flush the batch
+	slab_free(b.objs[0]);
+	CPPUNIT_ASSERT(slab_arenas[node_a][cls].remote_frees == remote_a + SLAB_REMOTE_BATCH + 1);
+	CPPUNIT_ASSERT(slab_arenas[node_b][cls].remote_frees == remote_b);
+	CPPUNIT_ASSERT(cache->classes[cls].remote_count == 1);
+
+	//And so does the exit of the thread
+	a.objs.erase(a.objs.begin(), a.objs.begin()+SLAB_REMOTE_BATCH+1);
+	a.node = -1;
+	run_thread(free_objs, &a);
+	CPPUNIT_ASSERT(slab_arenas[node_a][cls].remote_frees == remote_a + 2*SLAB_REMOTE_BATCH + 1);
+
+	//Flush the one of node_b left in this thread
+	slab_cache_flush_remote(&cache->classes[cls], cls);
+	CPPUNIT_ASSERT(slab_arenas[node_b][cls].remote_frees == remote_b + 1);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(SlabTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
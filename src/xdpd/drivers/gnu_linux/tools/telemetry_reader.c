@@ -0,0 +1,163 @@
+/*
+* Example reader of the shared-memory telemetry segment published by the
+* GNU/Linux driver (see src/telemetry_shm.h).
+*
+* Usage: xdpd-telemetry-reader [interval_s] [segment_name]
+*
+* With an interval, the counters are printed periodically along with the
+* rates since the previous sample.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../src/telemetry_shm.h"
+
+#define DEFAULT_SHM_NAME "/xdpd-gnu-linux-telemetry"
+
+//Consistent copy of the segment
+static uint8_t* snapshot = NULL;
+static uint8_t* prev = NULL;
+
+static int take_snapshot(const telemetry_shm_hdr_t* hdr){
+
+	uint32_t seq;
+
+	do{
+		seq = telemetry_shm_read_begin(hdr);
+		memcpy(snapshot, hdr, hdr->len);
+	}while(telemetry_shm_read_retry(hdr, seq));
+
+	return ((telemetry_shm_hdr_t*)snapshot)->generation != 0;
+}
+
+static double rate(uint64_t now, uint64_t before, double secs){
+	return (secs > 0.0 && now >= before)? (now-before)/secs : 0.0;
+}
+
+static void print_snapshot(int has_prev){
+
+	unsigned int i;
+	double secs = 0.0;
+	const telemetry_shm_hdr_t* hdr = (telemetry_shm_hdr_t*)snapshot;
+	const telemetry_shm_hdr_t* phdr = (telemetry_shm_hdr_t*)prev;
+	const telemetry_port_t* ports = (telemetry_port_t*)(snapshot + hdr->ports_off);
+	const telemetry_port_t* pports = (telemetry_port_t*)(prev + phdr->ports_off);
+	const telemetry_queue_t* queues = (telemetry_queue_t*)(snapshot + hdr->queues_off);
+	const telemetry_lsi_t* lsis = (telemetry_lsi_t*)(snapshot + hdr->lsis_off);
+	const telemetry_table_t* tables = (telemetry_table_t*)(snapshot + hdr->tables_off);
+	const telemetry_bufferpool_t* bp = (telemetry_bufferpool_t*)(snapshot + hdr->bufferpool_off);
+
+	//Rates are only meaningful if the port set did not change
+	if(has_prev && phdr->num_ports == hdr->num_ports && hdr->timestamp_ns > phdr->timestamp_ns)
+		secs = (hdr->timestamp_ns - phdr->timestamp_ns)/1e9;
+
+	printf("generation %" PRIu64 ", timestamp %" PRIu64 ".%09" PRIu64 "\n", hdr->generation, (uint64_t)(hdr->timestamp_ns/1000000000ULL), (uint64_t)(hdr->timestamp_ns%1000000000ULL));
+
+	printf("\nPorts (%u):\n", hdr->num_ports);
+	for(i=0; i<hdr->num_ports; i++){
+		printf("  %-16s %s%s", ports[i].name, (ports[i].flags & TELEMETRY_PORT_UP)? "up  " : "down", (ports[i].flags & TELEMETRY_PORT_VIRTUAL)? " virtual" : "");
+		if(ports[i].flags & TELEMETRY_PORT_ATTACHED)
+			printf(" dpid 0x%" PRIx64 " port %u", ports[i].dpid, ports[i].of_port_num);
+		printf("\n    rx %" PRIu64 " pkts %" PRIu64 " bytes %" PRIu64 " dropped %" PRIu64 " errors\n", ports[i].rx_packets, ports[i].rx_bytes, ports[i].rx_dropped, ports[i].rx_errors);
+		printf("    tx %" PRIu64 " pkts %" PRIu64 " bytes %" PRIu64 " dropped %" PRIu64 " errors\n", ports[i].tx_packets, ports[i].tx_bytes, ports[i].tx_dropped, ports[i].tx_errors);
+		if(secs > 0.0 && !strcmp(ports[i].name, pports[i].name))
+			printf("    rx %.0f pps %.0f bps, tx %.0f pps %.0f bps\n",
+				rate(ports[i].rx_packets, pports[i].rx_packets, secs),
+				rate(ports[i].rx_bytes, pports[i].rx_bytes, secs)*8,
+				rate(ports[i].tx_packets, pports[i].tx_packets, secs),
+				rate(ports[i].tx_bytes, pports[i].tx_bytes, secs)*8);
+	}
+
+	printf("\nQueues (%u):\n", hdr->num_queues);
+	for(i=0; i<hdr->num_queues; i++){
+		if(!queues[i].tx_packets && !queues[i].overrun)
+			continue;
+		printf("  %-16s q%-2u tx %" PRIu64 " pkts %" PRIu64 " bytes %" PRIu64 " overrun\n", (queues[i].port < hdr->num_ports)? ports[queues[i].port].name : "?", queues[i].queue_id, queues[i].tx_packets, queues[i].tx_bytes, queues[i].overrun);
+	}
+
+	printf("\nLSIs (%u):\n", hdr->num_lsis);
+	for(i=0; i<hdr->num_lsis; i++)
+		printf("  %-16s dpid 0x%" PRIx64 " of_version %u tables %u\n", lsis[i].name, lsis[i].dpid, lsis[i].of_version, lsis[i].num_of_tables);
+
+	printf("\nTables (%u):\n", hdr->num_tables);
+	for(i=0; i<hdr->num_tables; i++)
+		printf("  %-16s table %-3u entries %" PRIu64 " lookups %" PRIu64 " matched %" PRIu64 "\n", (tables[i].lsi < hdr->num_lsis)? lsis[tables[i].lsi].name : "?", tables[i].table_id, tables[i].num_of_entries, tables[i].lookup_count, tables[i].matched_count);
+
+	printf("\nBufferpool: %" PRIu64 "/%" PRIu64 " buffers in use\n\n", bp->in_use, bp->capacity);
+	fflush(stdout);
+}
+
+int main(int argc, char** argv){
+
+	int fd;
+	struct stat st;
+	unsigned int interval = 0;
+	const char* name = DEFAULT_SHM_NAME;
+	const telemetry_shm_hdr_t* hdr;
+	uint8_t* tmp;
+	int has_prev = 0;
+
+	if(argc > 1)
+		interval = atoi(argv[1]);
+	if(argc > 2)
+		name = argv[2];
+
+	fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0){
+		perror("shm_open");
+		fprintf(stderr, "Is xdpd (gnu-linux driver) running?\n");
+		return EXIT_FAILURE;
+	}
+
+	if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(telemetry_shm_hdr_t)){
+		fprintf(stderr, "Invalid telemetry segment %s\n", name);
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	hdr = (const telemetry_shm_hdr_t*)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(hdr == MAP_FAILED){
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+
+	if(hdr->magic != TELEMETRY_SHM_MAGIC || hdr->version != TELEMETRY_SHM_VERSION || hdr->len > (uint64_t)st.st_size){
+		fprintf(stderr, "Unsupported telemetry segment %s (version %u, expected %u)\n", name, hdr->version, TELEMETRY_SHM_VERSION);
+		return EXIT_FAILURE;
+	}
+
+	snapshot = (uint8_t*)malloc(hdr->len);
+	prev = (uint8_t*)malloc(hdr->len);
+	if(!snapshot || !prev){
+		fprintf(stderr, "Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	do{
+		while(!take_snapshot(hdr))
+			usleep(hdr->period_ms*1000);
+
+		print_snapshot(has_prev);
+
+		tmp = prev;
+		prev = snapshot;
+		snapshot = tmp;
+		has_prev = 1;
+
+		if(interval)
+			sleep(interval);
+	}while(interval);
+
+	free(snapshot);
+	free(prev);
+	munmap((void*)hdr, st.st_size);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef HAL_EXT_H
+#define HAL_EXT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rofl.h>
+#include <rofl/datapath/hal/driver.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include <rofl/datapath/pipeline/switch_port.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_statistics.h>
+
+/**
+* @file hal_ext.h
+*
+* @brief Optional extensions of the HAL
+*
+* @description Calls that drivers MAY implement in addition to the HAL API
+* (e.g. the GNU/Linux driver). They are weak symbols; the caller must check
+* that the call is available (the function pointer is not NULL) and fall
+* back to the HAL API otherwise.
+*/
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/*
+* Port management
+*/
+
+/**
+* Bring up a set of ports at once, so that the driver can set them up in
+* parallel. If the driver does not implement it, the ports are brought up
+* one by one.
+*/
+hal_result_t hal_driver_bring_ports_up(const char** names, unsigned int num, hal_result_t* results) __attribute__((weak));
+
+/**
+* Copy the counters of the port attached at port_num of the LSI, without
+* taking a snapshot of the switch or of the port. If the driver does not
+* implement it, a port snapshot is used instead.
+*/
+hal_result_t hal_driver_get_port_stats(uint64_t dpid, unsigned int port_num, port_stats_t* stats) __attribute__((weak));
+
+/**
+* Number of packet buffers of the driver and number of buffers in use. If
+* the driver does not implement it, the bufferpool stats are not reported.
+*/
+hal_result_t hal_driver_get_bufferpool_stats(uint64_t* capacity, uint64_t* in_use) __attribute__((weak));
+
+/*
+* Memory
+*/
+
+/**
+* Counters of the size class class_id of the memory allocator of the driver;
+* fails past the last class. If the driver does not implement it, the
+* allocator stats are not reported.
+*/
+hal_result_t hal_driver_get_allocator_stats(unsigned int class_id, uint64_t* obj_size, uint64_t* capacity, uint64_t* in_use, uint64_t* cached, uint64_t* remote_frees) __attribute__((weak));
+
+/**
+* Number and size in bytes of the allocations of the driver allocator that
+* do not fit in any size class.
+*/
+hal_result_t hal_driver_get_allocator_large_stats(uint64_t* in_use, uint64_t* bytes) __attribute__((weak));
+
+/*
+* LSI options
+*/
+
+/**
+* Enable or disable the microflow (exact-match) cache of the packet
+* processing of the LSI. If the driver does not implement it, the option is
+* not supported.
+*/
+hal_result_t hal_driver_set_microflow_cache(uint64_t dpid, bool enabled) __attribute__((weak));
+
+/**
+* Whether the microflow cache of the LSI is enabled, and its hit and miss
+* counters. If the driver does not implement it, they are not reported.
+*/
+hal_result_t hal_driver_get_microflow_cache_stats(uint64_t dpid, bool* enabled, uint64_t* hits, uint64_t* misses) __attribute__((weak));
+
+/**
+* Replace the PKT_IN limits of the LSI (packets per second, 0: unlimited;
+* burst in packets, 0: one second worth of PKT_INs).
+*/
+hal_result_t hal_driver_set_pktin_meter(uint64_t dpid, uint32_t rate, uint32_t table_rate, uint32_t nomatch_rate, uint32_t action_rate, uint32_t burst) __attribute__((weak));
+
+/**
+* PKT_INs of the LSI accepted and dropped by its meters, and the drops due
+* to the LSI (aggregated) limit. Per reason (0: no match, 1: action; fails
+* past the last one) and per table counters.
+*/
+hal_result_t hal_driver_get_pktin_meter_stats(uint64_t dpid, uint64_t* accepted, uint64_t* dropped, uint64_t* lsi_dropped) __attribute__((weak));
+hal_result_t hal_driver_get_pktin_meter_reason_stats(uint64_t dpid, unsigned int reason, uint64_t* accepted, uint64_t* dropped) __attribute__((weak));
+hal_result_t hal_driver_get_pktin_meter_table_stats(uint64_t dpid, unsigned int table_id, uint64_t* accepted, uint64_t* dropped) __attribute__((weak));
+
+/*
+* OpenFlow 1.x
+*/
+
+/**
+* PACKET_OUT of hal_driver_of1x_process_packet_out_batch(); same semantics
+* as the arguments of hal_driver_of1x_process_packet_out()
+*/
+#ifndef OF1X_PACKET_OUT_T_DEFINED
+#define OF1X_PACKET_OUT_T_DEFINED
+typedef struct of1x_packet_out{
+	uint32_t buffer_id;
+	uint32_t in_port;
+	of1x_action_group_t* action_group;
+	uint8_t* buffer;
+	uint32_t buffer_size;
+
+	//Filled in by the driver
+	hal_result_t result;
+}of1x_packet_out_t;
+#endif
+
+/**
+* Batched hal_driver_of1x_process_packet_out() for a single LSI, processed
+* in order. The result of every PACKET_OUT is stored in pkt_outs[i].result.
+* If the driver does not implement it, PACKET_OUTs are processed one by one.
+*/
+hal_result_t hal_driver_of1x_process_packet_out_batch(uint64_t dpid, of1x_packet_out_t* pkt_outs, unsigned int num) __attribute__((weak));
+
+/**
+* Batched hal_driver_of1x_process_flow_mod_add() (same semantics, without
+* buffer_id) for a single table. The result of every entry is stored in
+* results[i]. If the driver does not implement it, entries are installed
+* one by one.
+*/
+hal_result_t hal_driver_of1x_process_flow_mod_add_batch(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** entries, unsigned int num, bool check_overlap, bool reset_counts, hal_result_t* results) __attribute__((weak));
+
+/**
+* Chunked hal_driver_of1x_get_flow_stats(); at most max_flows entries per
+* call, resumed with *cursor (0 on the first call, set back to 0 when done).
+* If the driver does not implement it, the whole table is retrieved at once.
+*/
+of1x_stats_flow_msg_t* hal_driver_of1x_get_flow_stats_chunk(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, unsigned int max_flows, uint64_t* cursor) __attribute__((weak));
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif /* HAL_EXT_H */
@@ -0,0 +1,251 @@
+#include "plugin_event_bus.h"
+
+#include <string.h>
+#include <rofl/common/utils/c_logger.h>
+
+using namespace xdpd;
+
+plugin_event_bus::plugin_event_bus(dispatch_cb_t dispatch) :
+		dispatch(dispatch),
+		queue_len(0),
+		running(false),
+		keep_on(false),
+		total_latency_us(0)
+{
+	memset(&stats, 0, sizeof(stats));
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+plugin_event_bus::~plugin_event_bus(){
+
+	stop();
+
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+void plugin_event_bus::start(){
+
+	pthread_mutex_lock(&mutex);
+
+	if(running){
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	keep_on = true;
+	if(pthread_create(&thread, NULL, dispatch_routine, this) != 0){
+		ROFL_ERR("[xdpd][plugin_manager][event-bus] ERROR: unable to launch the dispatch thread; plugins will be notified synchronously\n");
+		keep_on = false;
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+	running = true;
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void plugin_event_bus::stop(){
+
+	pthread_mutex_lock(&mutex);
+
+	if(!running){
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	//The dispatch thread drains the queue before exiting
+	keep_on = false;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+
+	pthread_join(thread, NULL);
+
+	pthread_mutex_lock(&mutex);
+	running = false;
+	pthread_mutex_unlock(&mutex);
+}
+
+bool plugin_event_bus::post_port_event(plugin_event_type_t type, const switch_port_snapshot_t* port_snapshot){
+
+	switch_port_snapshot_t* copy;
+
+	if(!is_running())
+		return false;
+
+	copy = switch_port_clone_snapshot((switch_port_snapshot_t*)port_snapshot);
+	if(!copy){
+		ROFL_ERR("[xdpd][plugin_manager][event-bus] ERROR: unable to clone the snapshot of port %s; event dropped\n", port_snapshot->name);
+		return true;
+	}
+
+	if(!post(type, copy, copy->name)){
+		switch_port_destroy_snapshot(copy);
+		return false;
+	}
+
+	return true;
+}
+
+bool plugin_event_bus::post_monitoring_event(const monitoring_snapshot_state_t* monitoring_snapshot){
+
+	monitoring_snapshot_state_t* copy;
+
+	if(!is_running())
+		return false;
+
+	copy = monitoring_clone_snapshot((monitoring_snapshot_state_t*)monitoring_snapshot);
+	if(!copy){
+		ROFL_ERR("[xdpd][plugin_manager][event-bus] ERROR: unable to clone the monitoring snapshot; event dropped\n");
+		return true;
+	}
+
+	if(!post(PLUGIN_EVENT_MONITORING_STATE_CHANGED, copy, NULL)){
+		monitoring_destroy_snapshot(copy);
+		return false;
+	}
+
+	return true;
+}
+
+bool plugin_event_bus::is_running(){
+
+	bool ret;
+
+	pthread_mutex_lock(&mutex);
+	ret = running;
+	pthread_mutex_unlock(&mutex);
+
+	return ret;
+}
+
+bool plugin_event_bus::post(plugin_event_type_t type, void* snapshot, const char* port_name){
+
+	event_t ev;
+	std::map<std::string, queue_t::iterator>::iterator it;
+
+	ev.type = type;
+	ev.snapshot = snapshot;
+	clock_gettime(CLOCK_MONOTONIC, &ev.posted);
+
+	pthread_mutex_lock(&mutex);
+
+	if(!keep_on){
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+
+	stats.posted++;
+
+	if(port_name){
+		it = pending_status.find(port_name);
+
+		if(it != pending_status.end()){
+			if(type == PLUGIN_EVENT_PORT_STATUS_CHANGED){
+				//Coalesce; keep the position (and post time) of the pending one
+				destroy_snapshot(*it->second);
+				it->second->snapshot = snapshot;
+				stats.coalesced++;
+				pthread_mutex_unlock(&mutex);
+				return true;
+			}
+
+			//Later status changes must not be merged before this event
+			pending_status.erase(it);
+		}
+	}
+
+	if(queue_len >= MAX_QUEUE_LEN){
+		stats.dropped++;
+		pthread_mutex_unlock(&mutex);
+
+		ROFL_ERR("[xdpd][plugin_manager][event-bus] ERROR: event queue full (%u events); event dropped\n", MAX_QUEUE_LEN);
+		destroy_snapshot(ev);
+		return true;
+	}
+
+	queue.push_back(ev);
+	queue_len++;
+	if(queue_len > stats.max_queue_len)
+		stats.max_queue_len = queue_len;
+
+	if(type == PLUGIN_EVENT_PORT_STATUS_CHANGED)
+		pending_status[port_name] = --queue.end();
+
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+
+	return true;
+}
+
+void plugin_event_bus::get_stats(plugin_event_bus_stats_t* s){
+
+	pthread_mutex_lock(&mutex);
+
+	*s = stats;
+	s->queue_len = queue_len;
+	s->avg_latency_us = (stats.dispatched)? total_latency_us/stats.dispatched : 0;
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void plugin_event_bus::destroy_snapshot(const event_t& ev){
+
+	if(ev.type == PLUGIN_EVENT_MONITORING_STATE_CHANGED)
+		monitoring_destroy_snapshot((monitoring_snapshot_state_t*)ev.snapshot);
+	else
+		switch_port_destroy_snapshot((switch_port_snapshot_t*)ev.snapshot);
+}
+
+void* plugin_event_bus::dispatch_routine(void* param){
+
+	plugin_event_bus* bus = (plugin_event_bus*)param;
+	std::map<std::string, queue_t::iterator>::iterator it;
+	struct timespec now;
+	uint64_t latency_us;
+	event_t ev;
+
+	pthread_mutex_lock(&bus->mutex);
+
+	while(true){
+
+		if(!bus->queue_len){
+			if(!bus->keep_on)
+				break;
+			pthread_cond_wait(&bus->cond, &bus->mutex);
+			continue;
+		}
+
+		ev = bus->queue.front();
+
+		//No longer pending for coalescing
+		if(ev.type == PLUGIN_EVENT_PORT_STATUS_CHANGED){
+			it = bus->pending_status.find(((switch_port_snapshot_t*)ev.snapshot)->name);
+			if(it != bus->pending_status.end() && it->second == bus->queue.begin())
+				bus->pending_status.erase(it);
+		}
+
+		bus->queue.pop_front();
+		bus->queue_len--;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		latency_us = (now.tv_sec - ev.posted.tv_sec)*1000000ULL + (now.tv_nsec - ev.posted.tv_nsec)/1000;
+
+		bus->total_latency_us += latency_us;
+		if(latency_us > bus->stats.max_latency_us)
+			bus->stats.max_latency_us = latency_us;
+		bus->stats.dispatched++;
+
+		pthread_mutex_unlock(&bus->mutex);
+
+		(*bus->dispatch)(ev.type, ev.snapshot);
+		destroy_snapshot(ev);
+
+		pthread_mutex_lock(&bus->mutex);
+	}
+
+	pthread_mutex_unlock(&bus->mutex);
+
+	return NULL;
+}
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PLUGIN_EVENT_BUS_H
+#define PLUGIN_EVENT_BUS_H
+
+#include <map>
+#include <list>
+#include <string>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <rofl/datapath/pipeline/switch_port.h>
+#include <rofl/datapath/pipeline/monitoring.h>
+
+/**
+* @file plugin_event_bus.h
+*
+* @brief Asynchronous delivery of the plugin notifications
+*/
+
+namespace xdpd {
+
+/**
+* Plugin event types; plugins subscribe to a mask of them
+*/
+typedef enum plugin_event_type{
+	PLUGIN_EVENT_PORT_ADDED			= 1 << 0,
+	PLUGIN_EVENT_PORT_ATTACHED		= 1 << 1,
+	PLUGIN_EVENT_PORT_STATUS_CHANGED	= 1 << 2,
+	PLUGIN_EVENT_PORT_DETACHED		= 1 << 3,
+	PLUGIN_EVENT_PORT_DELETED		= 1 << 4,
+	PLUGIN_EVENT_MONITORING_STATE_CHANGED	= 1 << 5,
+
+	PLUGIN_EVENT_ALL			= (1 << 6) - 1,
+}plugin_event_type_t;
+
+/**
+* Event bus metrics
+*/
+typedef struct plugin_event_bus_stats{
+	unsigned int queue_len;		//Events waiting to be dispatched
+	unsigned int max_queue_len;	//High watermark of queue_len
+
+	uint64_t posted;		//Events posted (including coalesced and dropped)
+	uint64_t dispatched;		//Events delivered to the plugins
+	uint64_t coalesced;		//Port status changes merged with a pending one
+	uint64_t dropped;		//Events dropped (queue full)
+
+	//Time from post (of the oldest coalesced event) to dispatch
+	uint64_t avg_latency_us;
+	uint64_t max_latency_us;
+}plugin_event_bus_stats_t;
+
+/**
+* @brief Bounded queue of plugin events, delivered by a dedicated thread.
+* @ingroup cmm_mgmt
+*
+* @description Events are posted by the thread that raises them (e.g. the
+* driver's background thread) with a private copy of the snapshot, and
+* delivered to the plugins by the dispatch thread, so that slow plugins
+* do not stall the event sources.
+*
+* A port status change is merged with a status change of the same port
+* still waiting in the queue (the latest snapshot is delivered), unless
+* another event of that port has been posted in between. Events posted
+* while the queue is full are dropped and counted.
+*/
+class plugin_event_bus {
+
+public:
+	static const unsigned int MAX_QUEUE_LEN = 4096;
+
+	typedef void (*dispatch_cb_t)(plugin_event_type_t type, const void* snapshot);
+
+	plugin_event_bus(dispatch_cb_t dispatch);
+	~plugin_event_bus();
+
+	/**
+	* Launch the dispatch thread
+	*/
+	void start(void);
+
+	/**
+	* Deliver the pending events and stop the dispatch thread
+	*/
+	void stop(void);
+
+	/**
+	* Post a port event. Returns false if the bus is not running; the
+	* caller must then deliver the event itself.
+	*/
+	bool post_port_event(plugin_event_type_t type, const switch_port_snapshot_t* port_snapshot);
+
+	/**
+	* Post a monitoring state change. Same semantics as post_port_event()
+	*/
+	bool post_monitoring_event(const monitoring_snapshot_state_t* monitoring_snapshot);
+
+	void get_stats(plugin_event_bus_stats_t* stats);
+
+private:
+	typedef struct event{
+		plugin_event_type_t type;
+		void* snapshot;		//Owned by the bus
+		struct timespec posted;
+	}event_t;
+
+	typedef std::list<event_t> queue_t;
+
+	dispatch_cb_t dispatch;
+
+	queue_t queue;
+	unsigned int queue_len; //std::list::size() is O(n)
+
+	//Pending status changes by port name
+	std::map<std::string, queue_t::iterator> pending_status;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool running;
+	bool keep_on;
+
+	//Metrics (protected by mutex)
+	plugin_event_bus_stats_t stats;
+	uint64_t total_latency_us;
+
+	bool is_running(void);
+	bool post(plugin_event_type_t type, void* snapshot, const char* port_name);
+	static void destroy_snapshot(const event_t& ev);
+	static void* dispatch_routine(void* param);
+
+	// this class is noncopyable
+	plugin_event_bus(const plugin_event_bus&);
+	plugin_event_bus& operator=(const plugin_event_bus&);
+};
+
+}// namespace xdpd
+
+#endif /* PLUGIN_EVENT_BUS_H */
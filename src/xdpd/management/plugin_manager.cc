@@ -7,6 +7,7 @@ using namespace std;
 
 //Static initialization
 std::vector<plugin*> plugin_manager::plugins;
+plugin_event_bus plugin_manager::event_bus(plugin_manager::dispatch_event);
 
 //Getopt 
 extern int optind;
@@ -22,6 +23,9 @@ rofl_result_t plugin_manager::init(){
 	}
 
 	ROFL_INFO("[xdpd][plugin_manager] All plugins loaded.\n");
+
+	//From now on, events are delivered by the event bus thread
+	event_bus.start();
 	
 	return ROFL_SUCCESS;
 }
@@ -37,8 +41,17 @@ plugin* plugin_manager::get_plugin_by_name(std::string name){
 	return NULL;
 }
 
+void plugin_manager::reload(){
+
+	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it)
+		(*it)->reload();
+}
+
 rofl_result_t plugin_manager::destroy(){
 
+	//Deliver pending events
+	event_bus.stop();
+
 	//Destroy all plugins
 	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
 		delete *it;
@@ -56,23 +69,55 @@ void plugin_manager::register_plugin(plugin* p){
 // Events sub-API
 //
 
+//Deliver the event to the subscribed plugins
+void plugin_manager::dispatch_event(plugin_event_type_t type, const void* snapshot){
 
-/*
-* Notify plugins of a new port on the system
-* @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
-*/
-void plugin_manager::__notify_port_added(const switch_port_snapshot_t* port_snapshot){
+	const switch_port_snapshot_t* port_snapshot = (const switch_port_snapshot_t*)snapshot;
 
 	//Distribute event
 	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
 		try{
-			(*it)->notify_port_added(port_snapshot);
- 		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
+			if(!((*it)->get_event_subscriptions() & type))
+				continue;
+
+			switch(type){
+				case PLUGIN_EVENT_PORT_ADDED:
+					(*it)->notify_port_added(port_snapshot);
+					break;
+				case PLUGIN_EVENT_PORT_ATTACHED:
+					(*it)->notify_port_attached(port_snapshot);
+					break;
+				case PLUGIN_EVENT_PORT_STATUS_CHANGED:
+					(*it)->notify_port_status_changed(port_snapshot);
+					break;
+				case PLUGIN_EVENT_PORT_DETACHED:
+					(*it)->notify_port_detached(port_snapshot);
+					break;
+				case PLUGIN_EVENT_PORT_DELETED:
+					(*it)->notify_port_deleted(port_snapshot);
+					break;
+				case PLUGIN_EVENT_MONITORING_STATE_CHANGED:
+					(*it)->notify_monitoring_state_changed((const monitoring_snapshot_state_t*)snapshot);
+					break;
+				default:
+					assert(0);
+					break;
+			}
+		}catch(...){
+			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of event 0x%x. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), type);
 			assert(0);
 			//Continue with the rest of the plugins
 		}
 	}
+}
+
+/*
+* Notify plugins of a new port on the system
+* @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
+*/
+void plugin_manager::__notify_port_added(const switch_port_snapshot_t* port_snapshot){
+	if(!event_bus.post_port_event(PLUGIN_EVENT_PORT_ADDED, port_snapshot))
+		dispatch_event(PLUGIN_EVENT_PORT_ADDED, port_snapshot);
 }	
 	
 /*
@@ -80,17 +125,8 @@ void plugin_manager::__notify_port_added(const switch_port_snapshot_t* port_snap
 * @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
 */
 void plugin_manager::__notify_port_attached(const switch_port_snapshot_t* port_snapshot){
-
-	//Distribute event
-	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
-		try{
-			(*it)->notify_port_attached(port_snapshot);
- 		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
-			assert(0);
-			//Continue with the rest of the plugins
-		}
-	}
+	if(!event_bus.post_port_event(PLUGIN_EVENT_PORT_ATTACHED, port_snapshot))
+		dispatch_event(PLUGIN_EVENT_PORT_ATTACHED, port_snapshot);
 }
 
 /*
@@ -98,17 +134,8 @@ void plugin_manager::__notify_port_attached(const switch_port_snapshot_t* port_s
 * @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
 */
 void plugin_manager::__notify_port_status_changed(const switch_port_snapshot_t* port_snapshot){
-
-	//Distribute event
-	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
-		try{
-			(*it)->notify_port_status_changed(port_snapshot); 
-		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
-			assert(0);
-			//Continue with the rest of the plugins
-		}
-	}
+	if(!event_bus.post_port_event(PLUGIN_EVENT_PORT_STATUS_CHANGED, port_snapshot))
+		dispatch_event(PLUGIN_EVENT_PORT_STATUS_CHANGED, port_snapshot);
 }	
 
 /*
@@ -116,18 +143,8 @@ void plugin_manager::__notify_port_status_changed(const switch_port_snapshot_t*
 * @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
 */
 void plugin_manager::__notify_port_detached(const switch_port_snapshot_t* port_snapshot){
-
-	//Distribute event
-	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
-		try{
-			(*it)->notify_port_detached(port_snapshot); 
-		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
-			assert(0);
-			//Continue with the rest of the plugins
-		}
-	}
-
+	if(!event_bus.post_port_event(PLUGIN_EVENT_PORT_DETACHED, port_snapshot))
+		dispatch_event(PLUGIN_EVENT_PORT_DETACHED, port_snapshot);
 }
 
 /*
@@ -135,18 +152,8 @@ void plugin_manager::__notify_port_detached(const switch_port_snapshot_t* port_s
 * @warning: port_snapshot MUST NOT be written or destroyed, use switch_port_clone_snapshot() in case of need.
 */
 void plugin_manager::__notify_port_deleted(const switch_port_snapshot_t* port_snapshot){
-
-	//Distribute event
-	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
-		try{
-			(*it)->notify_port_deleted(port_snapshot); 
-		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
-			assert(0);
-			//Continue with the rest of the plugins
-		}
-	}
-
+	if(!event_bus.post_port_event(PLUGIN_EVENT_PORT_DELETED, port_snapshot))
+		dispatch_event(PLUGIN_EVENT_PORT_DELETED, port_snapshot);
 }	
 
 /**
@@ -154,17 +161,8 @@ void plugin_manager::__notify_port_deleted(const switch_port_snapshot_t* port_sn
 * @warning: monitoring_snapshot MUST NOT be written or destroyed, use monitoring_clone_snapshot() in case of need.
 */
 void plugin_manager::__notify_monitoring_state_changed(const monitoring_snapshot_state_t* monitoring_snapshot){
-
-	//Distribute event
-	for(std::vector<plugin*>::iterator it = plugins.begin(); it != plugins.end(); ++it) {
-		try{
-			(*it)->notify_monitoring_state_changed(monitoring_snapshot); 
-		}catch(...){
-			ROFL_ERR("[xdpd][plugin_manager] ERROR: uncaught exception throw by plugin [%s] thrown during callback of %s. This is a bug in the plugin code, please contact the mantainer of the plugin...\n", (*it)->get_name().c_str(), __func__);
-			assert(0);
-			//Continue with the rest of the plugins
-		}
-	}
+	if(!event_bus.post_monitoring_event(monitoring_snapshot))
+		dispatch_event(PLUGIN_EVENT_MONITORING_STATE_CHANGED, monitoring_snapshot);
 }
 
 /**
@@ -12,6 +12,8 @@
 #include <rofl/datapath/pipeline/monitoring.h>
 #include <rofl/platform/unix/cunixenv.h>
 
+#include "plugin_event_bus.h"
+
 /**
 * @file plugin_manager.h
 * @author Marc Sune<marc.sune (at) bisdn.de>
@@ -85,6 +87,14 @@ public:
 	*/
 	virtual void notify_monitoring_state_changed(const monitoring_snapshot_state_t* monitoring_snapshot){};
 
+	/**
+	* Returns the mask of plugin_event_type_t the plugin is notified of. Events are
+	* delivered by the plugin_manager event bus thread once the plugins are initialized.
+	*/
+	virtual uint32_t get_event_subscriptions(void){
+		return PLUGIN_EVENT_ALL;
+	};
+
 protected:
 	friend class plugin_manager; //Let plugin_manager call plugin's init and destroy 
 	
@@ -141,6 +151,15 @@ protected:
 		return std::string();
 	};
 
+	/**
+	* @brief Reload the configuration of the plugin
+	*
+	* Called by plugin_manager::reload() (e.g. on SIGHUP). Plugins that keep a
+	* configuration shall apply the changes without disrupting the unaffected
+	* state. Errors shall be handled (logged) by the plugin.
+	*/
+	virtual void reload(void){};
+
 
 	virtual ~plugin(){}; 
 };
@@ -175,6 +194,11 @@ public:
 	*/
 	static plugin* get_plugin_by_name(std::string name);
 
+	/**
+	* Reload the configuration of all the plugins. This shall only be called by system_manager
+	*/
+	static void reload(void);
+
 	/**
 	* Registers a plugin must be called on pre_init()
 	*/
@@ -217,6 +241,13 @@ public:
 	* @warning: monitoring_snapshot MUST NOT be written or destroyed, use monitoring_clone_snapshot() in case of need.
 	*/
 	static void __notify_monitoring_state_changed(const monitoring_snapshot_state_t* monitoring_snapshot);
+
+	/**
+	* Get the metrics of the event bus (queue depth, latency...)
+	*/
+	static void get_event_bus_stats(plugin_event_bus_stats_t* stats){
+		event_bus.get_stats(stats);
+	}
 	
 	/**
 	* Get plugin specific command line options. This shall only be called by system_manager
@@ -237,6 +268,16 @@ private:
 	* Registered plugins vector
 	*/	
 	static std::vector<plugin*> plugins;
+
+	/**
+	* Asynchronous delivery of the events
+	*/
+	static plugin_event_bus event_bus;
+
+	/**
+	* Deliver an event to the subscribed plugins
+	*/
+	static void dispatch_event(plugin_event_type_t type, const void* snapshot);
 };
 
 
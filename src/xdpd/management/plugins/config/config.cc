@@ -3,6 +3,7 @@
 
 #include "../../system_manager.h"
 #include "root_scope.h"
+#include "openflow/lsi_diff.h"
 
 using namespace xdpd;
 using namespace rofl;
@@ -45,6 +46,7 @@ void config::init(){
 	root_scope* root = new root_scope();
 
 	//Dry run
+	lsi_scope::clear_parsed_lsis();
 	get_config_file_contents(cfg);
 	root->execute(*cfg,true);
 
@@ -57,9 +59,50 @@ void config::init(){
 		cfg = new Config;
 		root = new root_scope();
 
+		lsi_scope::clear_parsed_lsis();
 		get_config_file_contents(cfg);
 		root->execute(*cfg);
+		applied_lsis = lsi_scope::get_parsed_lsis();
 		delete cfg;
 		delete root;
 	}
 }
+
+void config::reload(){
+
+	Config* cfg = new Config;
+	root_scope* root = new root_scope();
+	std::map<uint64_t, lsi_config> desired;
+	unsigned int failed;
+	
+	ROFL_INFO(CONF_PLUGIN_ID "Reloading configuration file %s\n", system_manager::get_option_value(CONFIG_FILE_OPT_FULL_NAME).c_str());
+
+	//Parse and validate only (dry run); nothing is touched if the file is not valid
+	try{
+		lsi_scope::clear_parsed_lsis();
+		get_config_file_contents(cfg);
+		root->execute(*cfg, true);
+		desired = lsi_scope::get_parsed_lsis();
+	}catch(...){
+		ROFL_ERR(CONF_PLUGIN_ID "Invalid configuration; reload aborted. The running configuration has not been modified\n");
+		delete cfg;
+		delete root;
+		return;
+	}
+	delete cfg;
+	delete root;
+
+	//Apply the differences only
+	lsi_diff diff(applied_lsis, desired);
+	diff.dump();
+
+	if(diff.empty())
+		return;
+
+	failed = diff.apply(applied_lsis);
+
+	if(failed)
+		ROFL_ERR(CONF_PLUGIN_ID "Configuration reloaded with %u errors\n", failed);
+	else
+		ROFL_INFO(CONF_PLUGIN_ID "Configuration reloaded\n");
+}
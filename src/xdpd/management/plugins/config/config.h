@@ -15,6 +15,9 @@
 //get params
 #include "system/system_scope.h" 
 
+//reload
+#include "openflow/lsi_scope.h" 
+
 /**
 * @file config_plugin.h
 * @author Marc Sune<marc.sune (at) bisdn.de>
@@ -59,7 +62,16 @@ public:
 		return std::string("config");
 	};
 
+	/**
+	* Re-read the config file and apply the differences in the LSIs (see lsi_diff)
+	*/
+	virtual void reload(void);
+
 private:
+	//LSIs created from the config file, as they were applied (failed
+	//operations are not recorded)
+	std::map<uint64_t, lsi_config> applied_lsis;
+
 	void get_config_file_contents(libconfig::Config* cfg);
 	static const std::string CONFIG_FILE_OPT_FULL_NAME;
 	static const char CONFIG_FILE_OPT_CODE = 'c';
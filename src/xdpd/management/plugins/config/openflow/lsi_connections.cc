@@ -1,4 +1,5 @@
 #include "lsi_connections.h"
+#include <map>
 #include <sstream>
 
 //Default
@@ -180,9 +181,45 @@ lsi_connection lsi_connections_scope::parse_connection(libconfig::Setting& setti
 	//Fill common parameters
 	parse_connection_params(setting, con);
 
+	con.key = get_connection_key(setting);
+
 	return con;
 }
 
+std::string lsi_connections_scope::get_connection_key(libconfig::Setting& setting){
+
+	std::map<std::string, std::string> values;
+	std::map<std::string, std::string>::iterator it;
+	std::stringstream ss;
+
+	//Sorted by parameter name, regardless of the order in the file
+ 	for(int i = 0; i<setting.getLength(); ++i){
+		std::stringstream value;
+
+		switch(setting[i].getType()){
+			case libconfig::Setting::TypeString:
+				value << (const char*)setting[i];
+				break;
+			case libconfig::Setting::TypeBoolean:
+				value << (bool)setting[i];
+				break;
+			case libconfig::Setting::TypeInt:
+			case libconfig::Setting::TypeInt64:
+				value << (long long)setting[i];
+				break;
+			default:
+				value << "?";
+				break;
+		}
+		values[setting[i].getName()] = value.str();
+	}
+
+	for(it = values.begin(); it != values.end(); ++it)
+		ss << it->first << "=" << it->second << ";";
+
+	return ss.str();
+}
+
 
 void lsi_connections_scope::pre_validate(libconfig::Setting& setting, bool dry_run){
 
@@ -1,6 +1,7 @@
 #ifndef CONFIG_OPENFLOW_CONN_PLUGIN_H
 #define CONFIG_OPENFLOW_CONN_PLUGIN_H 
 
+#include <string>
 #include <vector>
 #include <libconfig.h++>
 #include <rofl/common/csocket.h>
@@ -22,6 +23,7 @@ class lsi_connection{
 public:
 	rofl::csocket::socket_type_t type;
 	rofl::cparams params;	
+	std::string key;	//Canonical form of the parameters, used to compare connections
 };
 
 class lsi_connection_scope:public scope {
@@ -45,6 +47,7 @@ protected:
 	void parse_connection_params(libconfig::Setting& setting, lsi_connection& con);
 	void parse_ssl_connection_params(libconfig::Setting& setting, lsi_connection& con, bool dry_run);
 	lsi_connection parse_connection(libconfig::Setting& setting, bool dry_run);
+	std::string get_connection_key(libconfig::Setting& setting);
 };
 
 }// namespace xdpd 
@@ -0,0 +1,351 @@
+#include "lsi_diff.h"
+#include <inttypes.h>
+#include <rofl/datapath/hal/driver.h>
+#include "../../../switch_manager.h"
+#include "../../../port_manager.h"
+
+#include "../config.h"
+
+using namespace xdpd;
+
+lsi_diff::lsi_diff(const std::map<uint64_t, lsi_config>& running, const std::map<uint64_t, lsi_config>& desired){
+
+	std::map<uint64_t, lsi_config>::const_iterator it, found;
+	std::map<std::string, port_op> ports;
+
+	get_attached_ports(ports);
+
+	//Running LSIs
+	for(it = running.begin(); it != running.end(); ++it){
+
+		found = desired.find(it->first);
+
+		if(found == desired.end()){
+			if(switch_manager::exists(it->first))
+				destroyed.push_back(it->first);
+			continue;
+		}
+
+		//Destroyed in the meantime (e.g. by another plugin)
+		if(!switch_manager::exists(it->first)){
+			created.push_back(found->second);
+			continue;
+		}
+
+		if(must_recreate(it->second, found->second)){
+			destroyed.push_back(it->first);
+			created.push_back(found->second);
+			continue;
+		}
+
+		diff_ports(found->second, ports);
+		diff_connections(it->second, found->second);
+
+		if(found->second.microflow_cache != -1 && found->second.microflow_cache != it->second.microflow_cache){
+			mfc_op op;
+			op.lsi = found->second;
+			op.enabled = found->second.microflow_cache;
+			cache_set.push_back(op);
+		}
+
+		if(pktin_meter_changed(it->second, found->second))
+			meter_set.push_back(found->second);
+
+		if(found->second.flow_mod_batch_size != -1 && found->second.flow_mod_batch_size != it->second.flow_mod_batch_size)
+			batch_sizes[it->first] = found->second.flow_mod_batch_size;
+	}
+
+	//New LSIs
+	for(it = desired.begin(); it != desired.end(); ++it){
+
+		if(running.find(it->first) != running.end())
+			continue;
+
+		if(switch_manager::exists(it->first)){
+			ROFL_ERR(CONF_PLUGIN_ID "%s: an LSI with dpid 0x%"PRIx64" already exists and was not created by the configuration file; ignoring it\n", it->second.name.c_str(), it->first);
+			continue;
+		}
+
+		created.push_back(it->second);
+	}
+}
+
+bool lsi_diff::must_recreate(const lsi_config& running, const lsi_config& desired){
+
+	if(running.name != desired.name ||
+		running.version != desired.version ||
+		running.num_of_tables != desired.num_of_tables ||
+		running.reconnect_time != desired.reconnect_time)
+		return true;
+
+	for(unsigned int i=0; i<desired.num_of_tables; ++i){
+		if(running.ma_list[i] != desired.ma_list[i])
+			return true;
+	}
+
+	return false;
+}
+
+bool lsi_diff::pktin_meter_changed(const lsi_config& running, const lsi_config& desired){
+
+	if(!desired.pktin_meter)
+		return false;
+
+	return !running.pktin_meter ||
+		running.pktin_rate != desired.pktin_rate ||
+		running.pktin_table_rate != desired.pktin_table_rate ||
+		running.pktin_nomatch_rate != desired.pktin_nomatch_rate ||
+		running.pktin_action_rate != desired.pktin_action_rate ||
+		running.pktin_burst != desired.pktin_burst;
+}
+
+void lsi_diff::get_attached_ports(std::map<std::string, port_op>& ports){
+
+	switch_port_name_list_t* port_names;
+	switch_port_snapshot_t* port;
+	port_op op;
+
+	port_names = hal_driver_get_all_port_names();
+	if(!port_names)
+		return;
+
+	for(unsigned int i=0; i<port_names->num_of_ports; ++i){
+
+		port = hal_driver_get_port_snapshot_by_name(port_names->names[i].name);
+		if(!port)
+			continue;
+
+		//Virtual links are not part of the ports list of the LSIs
+		if(port->is_attached_to_sw && port->type != PORT_TYPE_VIRTUAL){
+			op.dpid = port->attached_sw_dpid;
+			op.port = port->name;
+			op.of_port_num = port->of_port_num;
+			ports[op.port] = op;
+		}
+
+		switch_port_destroy_snapshot(port);
+	}
+
+	switch_port_name_list_destroy(port_names);
+}
+
+void lsi_diff::diff_ports(const lsi_config& desired, std::map<std::string, port_op>& ports){
+
+	std::map<std::string, unsigned int> wanted;
+	std::map<std::string, unsigned int>::iterator w_it;
+	std::map<std::string, port_op>::iterator it;
+	port_op op;
+
+	for(unsigned int i=0; i<desired.ports.size(); ++i){
+		if(desired.ports[i] != "")
+			wanted[desired.ports[i]] = i+1;
+	}
+
+	//Ports of the LSI that are no longer (or differently) attached
+	for(it = ports.begin(); it != ports.end(); ++it){
+		if(it->second.dpid != desired.dpid)
+			continue;
+
+		w_it = wanted.find(it->first);
+		if(w_it == wanted.end() || w_it->second != it->second.of_port_num)
+			detached.push_back(it->second);
+	}
+
+	//Ports to be attached
+	op.dpid = desired.dpid;
+	for(w_it = wanted.begin(); w_it != wanted.end(); ++w_it){
+		it = ports.find(w_it->first);
+		if(it != ports.end() && it->second.dpid == desired.dpid && it->second.of_port_num == w_it->second)
+			continue;
+
+		op.port = w_it->first;
+		op.of_port_num = w_it->second;
+		attached.push_back(op);
+	}
+}
+
+void lsi_diff::diff_connections(const lsi_config& running, const lsi_config& desired){
+
+	std::vector<lsi_connection>::const_iterator it, it2;
+	ctl_op op;
+
+	op.dpid = desired.dpid;
+
+	for(it = running.connections.begin(); it != running.connections.end(); ++it){
+		for(it2 = desired.connections.begin(); it2 != desired.connections.end(); ++it2){
+			if(it->key == it2->key)
+				break;
+		}
+		if(it2 == desired.connections.end()){
+			op.connection = *it;
+			disconnected.push_back(op);
+		}
+	}
+
+	for(it = desired.connections.begin(); it != desired.connections.end(); ++it){
+		for(it2 = running.connections.begin(); it2 != running.connections.end(); ++it2){
+			if(it->key == it2->key)
+				break;
+		}
+		if(it2 == running.connections.end()){
+			op.connection = *it;
+			connected.push_back(op);
+		}
+	}
+}
+
+bool lsi_diff::empty() const{
+	return destroyed.empty() && detached.empty() && created.empty() && attached.empty() && disconnected.empty() && connected.empty() && cache_set.empty() && meter_set.empty() && batch_sizes.empty();
+}
+
+void lsi_diff::dump() const{
+
+	if(empty()){
+		ROFL_INFO(CONF_PLUGIN_ID "No changes in the LSIs\n");
+		return;
+	}
+
+	for(std::list<uint64_t>::const_iterator it = destroyed.begin(); it != destroyed.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  destroy LSI 0x%"PRIx64"\n", *it);
+	for(std::list<port_op>::const_iterator it = detached.begin(); it != detached.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  detach port %s (%u) from LSI 0x%"PRIx64"\n", it->port.c_str(), it->of_port_num, it->dpid);
+	for(std::list<lsi_config>::const_iterator it = created.begin(); it != created.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  create LSI %s (0x%"PRIx64")\n", it->name.c_str(), it->dpid);
+	for(std::list<port_op>::const_iterator it = attached.begin(); it != attached.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  attach port %s (%u) to LSI 0x%"PRIx64"\n", it->port.c_str(), it->of_port_num, it->dpid);
+	for(std::list<ctl_op>::const_iterator it = disconnected.begin(); it != disconnected.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  disconnect LSI 0x%"PRIx64" from controller [%s]\n", it->dpid, it->connection.key.c_str());
+	for(std::list<ctl_op>::const_iterator it = connected.begin(); it != connected.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  connect LSI 0x%"PRIx64" to controller [%s]\n", it->dpid, it->connection.key.c_str());
+	for(std::list<mfc_op>::const_iterator it = cache_set.begin(); it != cache_set.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  %s the microflow cache of LSI 0x%"PRIx64"\n", (it->enabled)? "enable" : "disable", it->lsi.dpid);
+	for(std::list<lsi_config>::const_iterator it = meter_set.begin(); it != meter_set.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  set the PKT_IN limits of LSI 0x%"PRIx64"\n", it->dpid);
+	for(std::map<uint64_t, unsigned int>::const_iterator it = batch_sizes.begin(); it != batch_sizes.end(); ++it)
+		ROFL_INFO(CONF_PLUGIN_ID "  set flow-mod-batch-size of LSI 0x%"PRIx64" to %u\n", it->first, it->second);
+}
+
+unsigned int lsi_diff::apply(std::map<uint64_t, lsi_config>& applied){
+
+	unsigned int failed = 0;
+	std::list<std::string> brought_up;
+	std::vector<lsi_connection>* connections;
+
+	for(std::list<uint64_t>::iterator it = destroyed.begin(); it != destroyed.end(); ++it){
+		try{
+			switch_manager::destroy_switch(*it);
+			applied.erase(*it);
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to destroy LSI 0x%"PRIx64"\n", *it);
+			failed++;
+		}
+	}
+
+	for(std::list<port_op>::iterator it = detached.begin(); it != detached.end(); ++it){
+		try{
+			port_manager::detach_port_from_switch(it->dpid, it->port);
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to detach port %s from LSI 0x%"PRIx64"\n", it->port.c_str(), it->dpid);
+			failed++;
+		}
+	}
+
+	for(std::list<lsi_config>::iterator it = created.begin(); it != created.end(); ++it){
+		try{
+			lsi_scope::create_lsi(*it);
+			applied[it->dpid] = *it;
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "%s: unable to create LSI 0x%"PRIx64"\n", it->name.c_str(), it->dpid);
+			failed++;
+
+			//Created, but the ports or the additional controllers
+			//failed; only the initial connection is known to be set
+			if(applied.find(it->dpid) == applied.end() && switch_manager::exists(it->dpid)){
+				applied[it->dpid] = *it;
+				applied[it->dpid].connections.resize(1);
+			}
+		}
+	}
+
+	for(std::list<port_op>::iterator it = attached.begin(); it != attached.end(); ++it){
+		try{
+			port_manager::attach_port_to_switch(it->dpid, it->port, &it->of_port_num);
+			brought_up.push_back(it->port);
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to attach port %s to LSI 0x%"PRIx64"\n", it->port.c_str(), it->dpid);
+			failed++;
+		}
+	}
+
+	try{
+		port_manager::bring_up(brought_up);
+	}catch(...){
+		//port_manager logs which ones
+		failed++;
+	}
+
+	for(std::list<ctl_op>::iterator it = disconnected.begin(); it != disconnected.end(); ++it){
+		try{
+			switch_manager::rpc_disconnect_from_ctl(it->dpid, it->connection.type, it->connection.params);
+
+			connections = &applied[it->dpid].connections;
+			for(std::vector<lsi_connection>::iterator c_it = connections->begin(); c_it != connections->end(); ++c_it){
+				if(c_it->key == it->connection.key){
+					connections->erase(c_it);
+					break;
+				}
+			}
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to disconnect LSI 0x%"PRIx64" from controller [%s]\n", it->dpid, it->connection.key.c_str());
+			failed++;
+		}
+	}
+
+	for(std::list<ctl_op>::iterator it = connected.begin(); it != connected.end(); ++it){
+		try{
+			switch_manager::rpc_connect_to_ctl(it->dpid, it->connection.type, it->connection.params);
+			applied[it->dpid].connections.push_back(it->connection);
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to connect LSI 0x%"PRIx64" to controller [%s]\n", it->dpid, it->connection.key.c_str());
+			failed++;
+		}
+	}
+
+	for(std::list<mfc_op>::iterator it = cache_set.begin(); it != cache_set.end(); ++it){
+		try{
+			lsi_scope::set_microflow_cache(it->lsi, it->enabled);
+			applied[it->lsi.dpid].microflow_cache = it->enabled;
+		}catch(...){
+			//set_microflow_cache() logs the error
+			failed++;
+		}
+	}
+
+	for(std::list<lsi_config>::iterator it = meter_set.begin(); it != meter_set.end(); ++it){
+		try{
+			lsi_scope::set_pktin_meter(*it);
+			lsi_config& lsi = applied[it->dpid];
+			lsi.pktin_meter = true;
+			lsi.pktin_rate = it->pktin_rate;
+			lsi.pktin_table_rate = it->pktin_table_rate;
+			lsi.pktin_nomatch_rate = it->pktin_nomatch_rate;
+			lsi.pktin_action_rate = it->pktin_action_rate;
+			lsi.pktin_burst = it->pktin_burst;
+		}catch(...){
+			//set_pktin_meter() logs the error
+			failed++;
+		}
+	}
+
+	for(std::map<uint64_t, unsigned int>::iterator it = batch_sizes.begin(); it != batch_sizes.end(); ++it){
+		try{
+			switch_manager::set_flow_mod_batch_size(it->first, it->second);
+			applied[it->first].flow_mod_batch_size = it->second;
+		}catch(...){
+			ROFL_ERR(CONF_PLUGIN_ID "Unable to set the flow-mod-batch-size of LSI 0x%"PRIx64"\n", it->first);
+			failed++;
+		}
+	}
+
+	return failed;
+}
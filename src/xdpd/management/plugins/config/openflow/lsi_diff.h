@@ -0,0 +1,97 @@
+#ifndef CONFIG_OF_LSI_DIFF_PLUGIN_H
+#define CONFIG_OF_LSI_DIFF_PLUGIN_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <stdint.h>
+#include "lsi_scope.h"
+
+/**
+* @file lsi_diff.h
+*
+* @brief Minimal set of operations to go from the running LSIs to a new
+* configuration (hot reload)
+*
+*/
+
+namespace xdpd {
+
+/**
+* @brief Difference between the running LSIs and the ones of a new configuration
+*
+* LSIs whose immutable attributes (name, version, number of tables, matching
+* algorithms, reconnect time) have not changed are kept, and only their port
+* attachments, controller connections, microflow cache option, PKT_IN
+* limits and FLOW_MOD batch size are updated (options removed from the
+* configuration are left as they are).
+* The rest are destroyed and/or created.
+*/
+class lsi_diff {
+
+public:
+	/**
+	* Compute the operations. running are the LSIs previously created by the
+	* config plugin; the port attachments are read from the driver.
+	*/
+	lsi_diff(const std::map<uint64_t, lsi_config>& running, const std::map<uint64_t, lsi_config>& desired);
+
+	bool empty(void) const;
+
+	/**
+	* Log the operations
+	*/
+	void dump(void) const;
+
+	/**
+	* Apply the operations. Operations that fail are logged and skipped.
+	* Only the operations that succeed are recorded in applied (the running
+	* LSIs passed to the constructor), so that the failed ones are retried
+	* on the next reload.
+	*
+	* @return number of operations that failed
+	*/
+	unsigned int apply(std::map<uint64_t, lsi_config>& applied);
+
+private:
+	class port_op{
+	public:
+		uint64_t dpid;
+		std::string port;
+		unsigned int of_port_num;
+	};
+
+	class ctl_op{
+	public:
+		uint64_t dpid;
+		lsi_connection connection;
+	};
+
+	class mfc_op{
+	public:
+		lsi_config lsi;
+		bool enabled;
+	};
+
+	//Operations, applied in this order
+	std::list<uint64_t> destroyed;
+	std::list<port_op> detached;
+	std::list<lsi_config> created;
+	std::list<port_op> attached;
+	std::list<ctl_op> disconnected;
+	std::list<ctl_op> connected;
+	std::list<mfc_op> cache_set;
+	std::list<lsi_config> meter_set;
+	std::map<uint64_t, unsigned int> batch_sizes;
+
+	static bool must_recreate(const lsi_config& running, const lsi_config& desired);
+	static bool pktin_meter_changed(const lsi_config& running, const lsi_config& desired);
+	static void get_attached_ports(std::map<std::string, port_op>& ports);
+	void diff_ports(const lsi_config& desired, std::map<std::string, port_op>& ports);
+	void diff_connections(const lsi_config& running, const lsi_config& desired);
+};
+
+}// namespace xdpd
+
+#endif /* CONFIG_OF_LSI_DIFF_PLUGIN_H_ */
+
@@ -2,11 +2,15 @@
 #include <vector>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 #include <algorithm>
+#include <list>
+#include <sys/time.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline.h>
 #include "../../../switch_manager.h"
 #include "../../../port_manager.h"
+#include "../../../hal_ext.h"
 
 #include "../config.h"
 #include "lsi_connections.h"
@@ -14,6 +18,9 @@
 using namespace xdpd;
 using namespace rofl;
 
+//Static members
+std::map<uint64_t, lsi_config> lsi_scope::parsed_lsis;
+
 //Constants
 #define LSI_DPID "dpid"
 #define LSI_VERSION "version"
@@ -21,7 +28,18 @@ using namespace rofl;
 #define LSI_RECONNECT_TIME "reconnect-time"
 #define LSI_NUM_OF_TABLES "num-of-tables"
 #define LSI_TABLES_MATCHING_ALGORITHM "tables-matching-algorithm"
+#define LSI_FLOW_MOD_BATCH_SIZE "flow-mod-batch-size"
 #define LSI_PORTS "ports" 
+#define LSI_MICROFLOW_CACHE "microflow-cache"
+#define LSI_PKTIN_RATE "pktin-rate"
+#define LSI_PKTIN_TABLE_RATE "pktin-table-rate"
+#define LSI_PKTIN_NOMATCH_RATE "pktin-nomatch-rate"
+#define LSI_PKTIN_ACTION_RATE "pktin-action-rate"
+#define LSI_PKTIN_BURST "pktin-burst"
+
+static unsigned long long elapsed_ms(struct timeval* now, struct timeval* last){
+	return (now->tv_sec - last->tv_sec)*1000ULL + (now->tv_usec - last->tv_usec)/1000;
+}
 
 lsi_scope::lsi_scope(std::string name, bool mandatory):scope(name, mandatory){
 
@@ -39,8 +57,19 @@ lsi_scope::lsi_scope(std::string name, bool mandatory):scope(name, mandatory){
 	register_parameter(LSI_NUM_OF_TABLES);
 	register_parameter(LSI_TABLES_MATCHING_ALGORITHM);
 
+	//FLOW_MOD ADD batching
+	register_parameter(LSI_FLOW_MOD_BATCH_SIZE);
+
 	//Port mappings
 	register_parameter(LSI_PORTS, true);
+
+	//Driver options
+	register_parameter(LSI_MICROFLOW_CACHE);
+	register_parameter(LSI_PKTIN_RATE);
+	register_parameter(LSI_PKTIN_TABLE_RATE);
+	register_parameter(LSI_PKTIN_NOMATCH_RATE);
+	register_parameter(LSI_PKTIN_ACTION_RATE);
+	register_parameter(LSI_PKTIN_BURST);
 }
 
 
@@ -74,6 +103,56 @@ void lsi_scope::parse_reconnect_time(libconfig::Setting& setting, unsigned int*
 	}
 }
 
+void lsi_scope::parse_microflow_cache(libconfig::Setting& setting, int* microflow_cache){
+
+	if(!setting.exists(LSI_MICROFLOW_CACHE))
+		return;
+
+	if(setting[LSI_MICROFLOW_CACHE].getType() != libconfig::Setting::TypeBoolean){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: invalid %s. Value must be true or false\n", setting.getPath().c_str(), LSI_MICROFLOW_CACHE);
+		throw eConfParseError(); 	
+	}
+
+	*microflow_cache = (bool)setting[LSI_MICROFLOW_CACHE];
+}
+
+void lsi_scope::parse_flow_mod_batch_size(libconfig::Setting& setting, int* flow_mod_batch_size){
+
+	if(!setting.exists(LSI_FLOW_MOD_BATCH_SIZE))
+		return;
+
+	if(setting[LSI_FLOW_MOD_BATCH_SIZE].getType() != libconfig::Setting::TypeInt || (int)setting[LSI_FLOW_MOD_BATCH_SIZE] < 0 || (int)setting[LSI_FLOW_MOD_BATCH_SIZE] > 65536){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: invalid %s. Value must be <= 65536 (0 disables batching)\n", setting.getPath().c_str(), LSI_FLOW_MOD_BATCH_SIZE);
+		throw eConfParseError(); 	
+	}
+
+	*flow_mod_batch_size = (int)setting[LSI_FLOW_MOD_BATCH_SIZE];
+}
+
+static void parse_pktin_value(libconfig::Setting& setting, const char* key, unsigned int* value, bool* set){
+
+	if(!setting.exists(key))
+		return;
+
+	if(setting[key].getType() != libconfig::Setting::TypeInt || (int)setting[key] < 0){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: invalid %s. Value must be an integer >= 0 (0: unlimited)\n", setting.getPath().c_str(), key);
+		throw eConfParseError(); 	
+	}
+
+	*value = (int)setting[key];
+	*set = true;
+}
+
+void lsi_scope::parse_pktin_meter(libconfig::Setting& setting, lsi_config& lsi){
+
+	//Any of them replaces all the driver defaults; the rest are unlimited
+	parse_pktin_value(setting, LSI_PKTIN_RATE, &lsi.pktin_rate, &lsi.pktin_meter);
+	parse_pktin_value(setting, LSI_PKTIN_TABLE_RATE, &lsi.pktin_table_rate, &lsi.pktin_meter);
+	parse_pktin_value(setting, LSI_PKTIN_NOMATCH_RATE, &lsi.pktin_nomatch_rate, &lsi.pktin_meter);
+	parse_pktin_value(setting, LSI_PKTIN_ACTION_RATE, &lsi.pktin_action_rate, &lsi.pktin_meter);
+	parse_pktin_value(setting, LSI_PKTIN_BURST, &lsi.pktin_burst, &lsi.pktin_meter);
+}
+
 void lsi_scope::parse_ports(libconfig::Setting& setting, std::vector<std::string>& ports, bool dry_run){
 
 	//TODO: improve conf file to be able to control the OF port number when attaching
@@ -164,95 +243,165 @@ void lsi_scope::parse_matching_algorithms(libconfig::Setting& setting, of_versio
 /* Case insensitive */
 void lsi_scope::post_validate(libconfig::Setting& setting, bool dry_run){
 
-	uint64_t dpid;
-	of_version_t version;
-	std::vector<lsi_connection> connections;
- 
+	lsi_config lsi;
+
 	//Default values
-	//bool passive = false;
-	unsigned int num_of_tables = 1;
-	caddress master_controller;
-	caddress slave_controller;
-	unsigned int reconnect_time = 5;
-	//std::string bind_address_ip = "0.0.0.0";
-	//caddress bind_address;
-	std::vector<std::string> ports;
-	int ma_list[OF1X_MAX_FLOWTABLES] = { 0 };
+	lsi.name = name;
+	lsi.num_of_tables = 1;
+	lsi.reconnect_time = 5;
+	lsi.microflow_cache = -1;
+	lsi.flow_mod_batch_size = -1;
+	lsi.pktin_meter = false;
+	lsi.pktin_rate = lsi.pktin_table_rate = lsi.pktin_nomatch_rate = lsi.pktin_action_rate = lsi.pktin_burst = 0;
+	memset(lsi.ma_list, 0, sizeof(lsi.ma_list));
 
 	//Recover dpid and try to parse
 	std::string dpid_s = setting[LSI_DPID];
-	dpid = strtoull(dpid_s.c_str(),NULL,0);
-	if(!dpid){
+	lsi.dpid = strtoull(dpid_s.c_str(),NULL,0);
+	if(!lsi.dpid){
 		ROFL_ERR(CONF_PLUGIN_ID "%s: Unable to convert parameter DPID to a proper uint64_t\n", setting.getPath().c_str());
 		throw eConfParseError(); 	
 	}
 
+	if(parsed_lsis.find(lsi.dpid) != parsed_lsis.end()){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: DPID 0x%"PRIx64" is already used by LSI %s\n", setting.getPath().c_str(), lsi.dpid, parsed_lsis[lsi.dpid].name.c_str());
+		throw eConfParseError(); 	
+	}
+
 	//Parse version
-	parse_version(setting, &version);
+	parse_version(setting, &lsi.version);
 
 	//Parse reconnect 
-	parse_reconnect_time(setting, &reconnect_time);
+	parse_reconnect_time(setting, &lsi.reconnect_time);
+
+	//Parse microflow cache
+	parse_microflow_cache(setting, &lsi.microflow_cache);
+
+	//Parse PKT_IN limits
+	parse_pktin_meter(setting, lsi);
+
+	//FLOW_MOD ADD batching
+	parse_flow_mod_batch_size(setting, &lsi.flow_mod_batch_size);
 
 
 	//Num of tables
 	if(setting.exists(LSI_NUM_OF_TABLES)){
 		//Parse num_of_tables
-		num_of_tables = setting[LSI_NUM_OF_TABLES];
+		lsi.num_of_tables = setting[LSI_NUM_OF_TABLES];
 
-		if(version == OF_VERSION_10 && num_of_tables > 1){
-			ROFL_ERR(CONF_PLUGIN_ID "%s: number of tables %u > 1. An LSI running in OF 1.0 native mode, can only be instantiated with 1 table.\n", setting.getPath().c_str(), num_of_tables);
+		if(lsi.version == OF_VERSION_10 && lsi.num_of_tables > 1){
+			ROFL_ERR(CONF_PLUGIN_ID "%s: number of tables %u > 1. An LSI running in OF 1.0 native mode, can only be instantiated with 1 table.\n", setting.getPath().c_str(), lsi.num_of_tables);
 			throw eConfParseError(); 	
 		}	
 	}
-	if(num_of_tables < 1 || num_of_tables > 255){
-		ROFL_ERR(CONF_PLUGIN_ID "%s: invalid num of tables %u. An LSI shall have from 1 to 255 tables.\n", setting.getPath().c_str(), num_of_tables);
+	if(lsi.num_of_tables < 1 || lsi.num_of_tables > 255){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: invalid num of tables %u. An LSI shall have from 1 to 255 tables.\n", setting.getPath().c_str(), lsi.num_of_tables);
 		throw eConfParseError(); 	
 	
 	}
 
 	//Parse matching algorithms
-	parse_matching_algorithms(setting, version, num_of_tables, ma_list, dry_run);
+	parse_matching_algorithms(setting, lsi.version, lsi.num_of_tables, lsi.ma_list, dry_run);
 
 	//Parse ports	
-	parse_ports(setting, ports, dry_run);
+	parse_ports(setting, lsi.ports, dry_run);
+
+	//Connections
+	lsi.connections = static_cast<lsi_connections_scope*>(get_subscope(lsi_connections_scope::SCOPE_NAME))->get_parsed_connections();
+
+	//Keep it (reload)
+	parsed_lsis[lsi.dpid] = lsi;
 
 	//Execute
-	if(!dry_run){
-		std::vector<lsi_connection> conns = static_cast<lsi_connections_scope*>(get_subscope(lsi_connections_scope::SCOPE_NAME))->get_parsed_connections();
-		openflow_switch* sw;
+	if(!dry_run)
+		create_lsi(lsi);
+}
 
-		//Create switch with the initial connection (connection 0)
-		sw = switch_manager::create_switch(version, dpid, name, num_of_tables, ma_list, reconnect_time, conns[0].type, conns[0].params);
+void lsi_scope::create_lsi(const lsi_config& lsi){
 
+	openflow_switch* sw;
+	std::vector<std::string>::const_iterator port_it;
+	std::list<std::string> attached;
+	unsigned int i;
+	struct timeval start, attach_done, end;
+	int ma_list[OF1X_MAX_FLOWTABLES];
 
-		if(!sw){
-			ROFL_ERR(CONF_PLUGIN_ID "%s: Unable to create LSI %s; unknown error.\n", setting.getPath().c_str(), name.c_str());
-			throw eConfParseError(); 	
-		}	
+	//Create switch with the initial connection (connection 0)
+	memcpy(ma_list, lsi.ma_list, sizeof(ma_list));
+	sw = switch_manager::create_switch(lsi.version, lsi.dpid, lsi.name, lsi.num_of_tables, ma_list, lsi.reconnect_time, lsi.connections[0].type, lsi.connections[0].params);
+
+	if(!sw){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: Unable to create LSI; unknown error.\n", lsi.name.c_str());
+		throw eConfParseError(); 	
+	}	
+
+	//Before the ports are brought up, so that all the packets are processed the same way
+	if(lsi.microflow_cache != -1)
+		set_microflow_cache(lsi, lsi.microflow_cache);
+	if(lsi.pktin_meter)
+		set_pktin_meter(lsi);
+	if(lsi.flow_mod_batch_size != -1)
+		switch_manager::set_flow_mod_batch_size(lsi.dpid, lsi.flow_mod_batch_size);
+
+	//Attach ports
+	gettimeofday(&start, NULL);
+	for(port_it = lsi.ports.begin(), i=1; port_it != lsi.ports.end(); ++port_it, ++i){
+			
+		//Ignore empty ports	
+		if(*port_it == "")
+			continue;
 	
-		//Attach ports
-		std::vector<std::string>::iterator port_it;
-		unsigned int i;
-		for(port_it = ports.begin(), i=1; port_it != ports.end(); ++port_it, ++i){
-				
-			//Ignore empty ports	
-			if(*port_it == "")
-				continue;
-		
-			try{
-				//Attach
-				port_manager::attach_port_to_switch(dpid, *port_it, &i);
-				//Bring up
-				port_manager::bring_up(*port_it);
-			}catch(...){	
-				ROFL_ERR(CONF_PLUGIN_ID "%s: unable to attach port '%s'. Unknown error.\n", setting.getPath().c_str(), (*port_it).c_str());
-				throw;
-			}
+		try{
+			//Attach
+			std::string port = *port_it;
+			port_manager::attach_port_to_switch(lsi.dpid, port, &i);
+			attached.push_back(port);
+		}catch(...){	
+			ROFL_ERR(CONF_PLUGIN_ID "%s: unable to attach port '%s'. Unknown error.\n", lsi.name.c_str(), (*port_it).c_str());
+			throw;
 		}
-	
-		//Connect(1..N-1)
-		for(std::vector<lsi_connection>::iterator it = (conns.begin()+1); it != conns.end(); ++it) {
-			switch_manager::rpc_connect_to_ctl(dpid, it->type, it->params); 
-		}	
+	}
+	gettimeofday(&attach_done, NULL);
+
+	//Bring them up at once, so that the driver can set them up in parallel
+	try{
+		port_manager::bring_up(attached);
+	}catch(...){	
+		ROFL_ERR(CONF_PLUGIN_ID "%s: unable to bring up the ports of the LSI. Unknown error.\n", lsi.name.c_str());
+		throw;
+	}
+	gettimeofday(&end, NULL);
+
+	ROFL_INFO(CONF_PLUGIN_ID "%s: %u ports attached in %llu ms and brought up in %llu ms\n", lsi.name.c_str(), (unsigned int)attached.size(), elapsed_ms(&attach_done, &start), elapsed_ms(&end, &attach_done));
+
+	//Connect(1..N-1)
+	for(std::vector<lsi_connection>::const_iterator it = (lsi.connections.begin()+1); it != lsi.connections.end(); ++it) {
+		switch_manager::rpc_connect_to_ctl(lsi.dpid, it->type, it->params); 
+	}	
+}
+
+void lsi_scope::set_microflow_cache(const lsi_config& lsi, bool enabled){
+
+	if(!hal_driver_set_microflow_cache){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: the driver does not support %s\n", lsi.name.c_str(), LSI_MICROFLOW_CACHE);
+		throw eConfParseError(); 	
+	}
+
+	if(hal_driver_set_microflow_cache(lsi.dpid, enabled) != HAL_SUCCESS){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: unable to %s the microflow cache\n", lsi.name.c_str(), (enabled)? "enable" : "disable");
+		throw eConfParseError(); 	
+	}
+}
+
+void lsi_scope::set_pktin_meter(const lsi_config& lsi){
+
+	if(!hal_driver_set_pktin_meter){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: the driver does not support PKT_IN limits per LSI\n", lsi.name.c_str());
+		throw eConfParseError(); 	
+	}
+
+	if(hal_driver_set_pktin_meter(lsi.dpid, lsi.pktin_rate, lsi.pktin_table_rate, lsi.pktin_nomatch_rate, lsi.pktin_action_rate, lsi.pktin_burst) != HAL_SUCCESS){
+		ROFL_ERR(CONF_PLUGIN_ID "%s: unable to set the PKT_IN limits\n", lsi.name.c_str());
+		throw eConfParseError(); 	
 	}
 }
@@ -1,11 +1,17 @@
 #ifndef CONFIG_OF_LSI_PLUGIN_H
 #define CONFIG_OF_LSI_PLUGIN_H 
 
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
 #include <rofl/common/caddress.h>
 #include <rofl/datapath/pipeline/openflow/of_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline.h>
 #include <rofl/common/csocket.h>
 #include <rofl/common/cparams.h>
 #include "../scope.h"
+#include "lsi_connections.h"
 
 /**
 * @file lsi_scope.h 
@@ -17,17 +23,65 @@
 
 namespace xdpd {
 
+/**
+* Parsed configuration of an LSI
+*/
+class lsi_config{
+
+public:
+	std::string name;
+	uint64_t dpid;
+	of_version_t version;
+	unsigned int num_of_tables;
+	int ma_list[OF1X_MAX_FLOWTABLES];
+	unsigned int reconnect_time;
+	int microflow_cache;	//1 enabled, 0 disabled, -1 driver default
+	int flow_mod_batch_size;	//0 disabled, -1 endpoint default
+	bool pktin_meter;	//PKT_IN limits set (pktin_*), otherwise driver defaults
+	unsigned int pktin_rate, pktin_table_rate, pktin_nomatch_rate, pktin_action_rate, pktin_burst;
+	std::vector<lsi_connection> connections;
+	std::vector<std::string> ports;	//OF port number is the position+1; "" is an empty slot
+};
+
 class lsi_scope:public scope {
 	
 public:
 	lsi_scope(std::string scope_name, bool mandatory=false);
+
+	/**
+	* Create the LSI, attach and bring up its ports and connect it to the controllers
+	*/
+	static void create_lsi(const lsi_config& lsi);
+
+	/**
+	* Enable or disable the microflow cache of the LSI, if the driver
+	* supports it (optional HAL extension). Throws eConfParseError otherwise
+	*/
+	static void set_microflow_cache(const lsi_config& lsi, bool enabled);
+
+	/**
+	* Set the PKT_IN limits (pktin_*) of the LSI, if the driver supports it
+	* (optional HAL extension). Throws eConfParseError otherwise
+	*/
+	static void set_pktin_meter(const lsi_config& lsi);
+
+	/**
+	* LSIs parsed (dry run or not) since the last clear_parsed_lsis(), by dpid
+	*/
+	static const std::map<uint64_t, lsi_config>& get_parsed_lsis(void){ return parsed_lsis; };
+	static void clear_parsed_lsis(void){ parsed_lsis.clear(); };
 		
 protected:
+	static std::map<uint64_t, lsi_config> parsed_lsis;
+
 	virtual void post_validate(libconfig::Setting& setting, bool dry_run);
 
 	//Parsing routines
 	void parse_version(libconfig::Setting& setting, of_version_t* version);
 	void parse_reconnect_time(libconfig::Setting& setting, unsigned int* reconnect_time);
+	void parse_microflow_cache(libconfig::Setting& setting, int* microflow_cache);
+	void parse_flow_mod_batch_size(libconfig::Setting& setting, int* flow_mod_batch_size);
+	void parse_pktin_meter(libconfig::Setting& setting, lsi_config& lsi);
 	void parse_active_connections(libconfig::Setting& setting, std::string& master_controller, int& master_controller_port, std::string& slave_controller, int& slave_controller_port);
 	void parse_matching_algorithms(libconfig::Setting& setting, of_version_t version, unsigned int num_of_tables, int* ma_list, bool dry_run);
 	void parse_ports(libconfig::Setting& setting, std::vector<std::string>& ports, bool dry_run);
@@ -9,6 +9,9 @@
  */
 
 #include "qmfagent.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
 #include <rofl/platform/unix/cunixenv.h>
 #include "../../system_manager.h"
 
@@ -25,9 +28,10 @@ const std::string qmfagent::QMF_SSL_VERIFY_MODE("qmf-ssl-verify-mode");
 const std::string qmfagent::QMF_SSL_VERIFY_DEPTH("qmf-ssl-verify-depth");
 const std::string qmfagent::QMF_SSL_CIPHERS("qmf-ssl-ciphers");
 
-qmfagent::qmfagent():qmf_package("de.bisdn.xdpd")
+qmfagent::qmfagent():qmf_package("de.bisdn.xdpd"),
+		batch_next_id(1)
 {
-	//Do nothing
+	batch_pipe[0] = batch_pipe[1] = -1;
 }
 		
 
@@ -64,12 +68,31 @@ void qmfagent::init()
 	qxdpd.addr = session.addData(qxdpd.data, name.str());
 
 	register_filedesc_r(notifier.getHandle());
+
+	// slices of the batch methods
+	if (pipe(batch_pipe) < 0) {
+		throw eQmfAgentBase();
+	}
+	fcntl(batch_pipe[0], F_SETFL, fcntl(batch_pipe[0], F_GETFL) | O_NONBLOCK);
+	fcntl(batch_pipe[1], F_SETFL, fcntl(batch_pipe[1], F_GETFL) | O_NONBLOCK);
+
+	register_filedesc_r(batch_pipe[0]);
 }
 
 
 
 qmfagent::~qmfagent()
 {
+	// jobs not completed
+	for (std::list<struct batch_job_t*>::iterator it = batch_pending.begin(); it != batch_pending.end(); ++it)
+		delete *it;
+
+	if (batch_pipe[0] >= 0) {
+		deregister_filedesc_r(batch_pipe[0]);
+		close(batch_pipe[0]);
+		close(batch_pipe[1]);
+	}
+
 	session.close();
 	connection.close();
 }
@@ -91,6 +114,11 @@ qmfagent::handle_timeout(int opaque, void *data)
 void
 qmfagent::handle_revent(int fd)
 {
+	if (fd == batch_pipe[0]) {
+		batch_run_slice();
+		return;
+	}
+
 	qmf::AgentEvent event;
 	while (session.nextEvent(event, qpid::messaging::Duration::IMMEDIATE)) {
 		switch (event.getType()) {
@@ -146,6 +174,31 @@ qmfagent::set_qmf_schema()
     lsiCreateVirtualLinkMethod.addArgument(qmf::SchemaProperty("devname2",	qmf::SCHEMA_DATA_STRING, 	"{dir:OUT}"));
     sch_xdpd.addMethod(lsiCreateVirtualLinkMethod);
 
+    // batch methods; every element of the list is a map with the arguments of the single operation
+    qmf::SchemaMethod lsiCreateBatchMethod("lsiCreateBatch", "{desc:'add a list of LSIs (asynchronous)'}");
+    lsiCreateBatchMethod.addArgument(qmf::SchemaProperty("lsis", 	qmf::SCHEMA_DATA_LIST, 		"{dir:IN}"));
+    lsiCreateBatchMethod.addArgument(qmf::SchemaProperty("jobID", 	qmf::SCHEMA_DATA_INT, 		"{dir:OUT}"));
+    sch_xdpd.addMethod(lsiCreateBatchMethod);
+
+    qmf::SchemaMethod portAttachBatchMethod("portAttachBatch", "{desc:'attach a list of ports (asynchronous)'}");
+    portAttachBatchMethod.addArgument(qmf::SchemaProperty("ports", 	qmf::SCHEMA_DATA_LIST, 		"{dir:IN}"));
+    portAttachBatchMethod.addArgument(qmf::SchemaProperty("jobID", 	qmf::SCHEMA_DATA_INT, 		"{dir:OUT}"));
+    sch_xdpd.addMethod(portAttachBatchMethod);
+
+    qmf::SchemaMethod ctlConnectBatchMethod("ctlConnectBatch", "{desc:'connect a list of LSIs to controllers (asynchronous)'}");
+    ctlConnectBatchMethod.addArgument(qmf::SchemaProperty("ctls", 	qmf::SCHEMA_DATA_LIST, 		"{dir:IN}"));
+    ctlConnectBatchMethod.addArgument(qmf::SchemaProperty("jobID", 	qmf::SCHEMA_DATA_INT, 		"{dir:OUT}"));
+    sch_xdpd.addMethod(ctlConnectBatchMethod);
+
+    // batch completion event
+    sch_batch_completed = qmf::Schema(qmf::SCHEMA_TYPE_EVENT, qmf_package, "batchCompleted");
+    sch_batch_completed.addProperty(qmf::SchemaProperty("xdpdID", 	qmf::SCHEMA_DATA_STRING));
+    sch_batch_completed.addProperty(qmf::SchemaProperty("jobID", 	qmf::SCHEMA_DATA_INT));
+    sch_batch_completed.addProperty(qmf::SchemaProperty("method", 	qmf::SCHEMA_DATA_STRING));
+    sch_batch_completed.addProperty(qmf::SchemaProperty("total", 	qmf::SCHEMA_DATA_INT));
+    sch_batch_completed.addProperty(qmf::SchemaProperty("failed", 	qmf::SCHEMA_DATA_INT));
+    sch_batch_completed.addProperty(qmf::SchemaProperty("results", 	qmf::SCHEMA_DATA_LIST));
+
 
 
     // lsi
@@ -191,6 +244,7 @@ qmfagent::set_qmf_schema()
     session.registerSchema(sch_exception);
     session.registerSchema(sch_xdpd);
     session.registerSchema(sch_lsi);
+    session.registerSchema(sch_batch_completed);
 }
 
 
@@ -224,6 +278,15 @@ qmfagent::method(qmf::AgentEvent& event)
 		else if (name == "lsiCreateVirtualLink") {
 			return methodLsiCreateVirtualLink(event);
 		}
+		else if (name == "lsiCreateBatch") {
+			return methodLsiCreateBatch(event);
+		}
+		else if (name == "portAttachBatch") {
+			return methodPortAttachBatch(event);
+		}
+		else if (name == "ctlConnectBatch") {
+			return methodCtlConnectBatch(event);
+		}
 
 		else {
 			session.raiseException(event, "command not found");
@@ -258,7 +321,6 @@ qmfagent::methodLsiCreate(qmf::AgentEvent& event)
 		event.addReturnArgument("dpid", dpid);
 
 		int ma_list[256] = { 0 };
-		rofl::caddress caddr(ctlaf, ctladdr.c_str(), ctlport);
 
 		enum rofl::csocket::socket_type_t socket_type;
 		if (enable_ssl) {
@@ -267,37 +329,12 @@ qmfagent::methodLsiCreate(qmf::AgentEvent& event)
 			socket_type = rofl::csocket::SOCKET_TYPE_PLAIN;
 		}
 
-		rofl::cparams socket_params = csocket::get_default_params(socket_type);
-		std::stringstream sctlport; sctlport << ctlport;
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string(ctladdr);
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string(sctlport.str());
-
-		if (enable_ssl) {
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CA_FILE).set_string(s_cafile);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CERT).set_string(s_certificate);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY).set_string(s_private_key);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY_PASSWORD).set_string(s_pswdfile);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_VERIFY_MODE).set_string(s_verify_mode);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_VERIFY_DEPTH).set_string(s_verify_depth);
-			socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CIPHERS).set_string(s_ciphers);
-		}
+		rofl::cparams socket_params = get_ctl_params(socket_type, ctladdr, ctlport);
 
 		xdpd::switch_manager::create_switch((of_version_t)of_version, dpid, dpname, ntables, ma_list, reconnect, socket_type, socket_params);
 
 		// create QMF LSI object
-		qLSIs[dpid].data = qmf::Data(sch_lsi);
-		qLSIs[dpid].data.setProperty("xdpdID", xdpd_id);
-		qLSIs[dpid].data.setProperty("dpid", dpid);
-		qLSIs[dpid].data.setProperty("dpname", dpname);
-		qLSIs[dpid].data.setProperty("ntables", ntables);
-		qLSIs[dpid].data.setProperty("ctlaf", ctlaf);
-		qLSIs[dpid].data.setProperty("ctladdr", ctladdr);
-		qLSIs[dpid].data.setProperty("ctlport", ctlport);
-		qLSIs[dpid].data.setProperty("reconnect", reconnect);
-		qLSIs[dpid].data.setProperty("ssl", enable_ssl);
-
-		std::stringstream name("lsi-"); name << xdpd_id << "-" << dpid;
-		qLSIs[dpid].addr = session.addData(qLSIs[dpid].data, name.str());
+		add_qmf_lsi(dpid, dpname, ntables, ctlaf, ctladdr, ctlport, reconnect, enable_ssl);
 
 		session.methodSuccess(event);
 
@@ -428,11 +465,7 @@ qmfagent::methodCtlConnect(qmf::AgentEvent& event)
 
 		// TODO: add socket_type to AMQP/QMF communication
 		enum rofl::csocket::socket_type_t socket_type = rofl::csocket::SOCKET_TYPE_PLAIN;
-		rofl::cparams socket_params = csocket::get_default_params(socket_type);
-
-		std::stringstream sctlport; sctlport << ctlport;
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string(ctladdr);
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string(sctlport.str());
+		rofl::cparams socket_params = get_ctl_params(socket_type, ctladdr, ctlport);
 
 		xdpd::switch_manager::rpc_connect_to_ctl(dpid, socket_type, socket_params);
 
@@ -467,11 +500,7 @@ qmfagent::methodCtlDisconnect(qmf::AgentEvent& event)
 
 		// TODO: add socket_type to AMQP/QMF communication
 		enum rofl::csocket::socket_type_t socket_type = rofl::csocket::SOCKET_TYPE_PLAIN;
-		rofl::cparams socket_params = csocket::get_default_params(socket_type);
-
-		std::stringstream sctlport; sctlport << ctlport;
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string(ctladdr);
-		socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string(sctlport.str());
+		rofl::cparams socket_params = get_ctl_params(socket_type, ctladdr, ctlport);
 
 		xdpd::switch_manager::rpc_disconnect_from_ctl(dpid, socket_type, socket_params);
 
@@ -525,3 +554,343 @@ qmfagent::methodLsiCreateVirtualLink(qmf::AgentEvent& event)
 }
 
 
+
+rofl::cparams
+qmfagent::get_ctl_params(
+		enum rofl::csocket::socket_type_t socket_type,
+		std::string const& ctladdr,
+		unsigned short ctlport)
+{
+	rofl::cparams socket_params = csocket::get_default_params(socket_type);
+
+	std::stringstream sctlport; sctlport << ctlport;
+	socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string(ctladdr);
+	socket_params.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string(sctlport.str());
+
+	if (socket_type == rofl::csocket::SOCKET_TYPE_OPENSSL) {
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CA_FILE).set_string(s_cafile);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CERT).set_string(s_certificate);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY).set_string(s_private_key);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY_PASSWORD).set_string(s_pswdfile);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_VERIFY_MODE).set_string(s_verify_mode);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_VERIFY_DEPTH).set_string(s_verify_depth);
+		socket_params.set_param(rofl::csocket::PARAM_SSL_KEY_CIPHERS).set_string(s_ciphers);
+	}
+
+	return socket_params;
+}
+
+
+
+void
+qmfagent::add_qmf_lsi(
+		uint64_t dpid,
+		std::string const& dpname,
+		unsigned int ntables,
+		int ctlaf,
+		std::string const& ctladdr,
+		unsigned short ctlport,
+		unsigned int reconnect,
+		bool ssl)
+{
+	qLSIs[dpid].data = qmf::Data(sch_lsi);
+	qLSIs[dpid].data.setProperty("xdpdID", xdpd_id);
+	qLSIs[dpid].data.setProperty("dpid", dpid);
+	qLSIs[dpid].data.setProperty("dpname", dpname);
+	qLSIs[dpid].data.setProperty("ntables", ntables);
+	qLSIs[dpid].data.setProperty("ctlaf", ctlaf);
+	qLSIs[dpid].data.setProperty("ctladdr", ctladdr);
+	qLSIs[dpid].data.setProperty("ctlport", ctlport);
+	qLSIs[dpid].data.setProperty("reconnect", reconnect);
+	qLSIs[dpid].data.setProperty("ssl", ssl);
+
+	std::stringstream name("lsi-"); name << xdpd_id << "-" << dpid;
+	qLSIs[dpid].addr = session.addData(qLSIs[dpid].data, name.str());
+}
+
+
+
+/*
+* Batch methods
+*/
+
+//Optional arguments of the operations of a batch
+static qpid::types::Variant
+batch_arg(qpid::types::Variant::Map const& args, std::string const& key, qpid::types::Variant const& def)
+{
+	qpid::types::Variant::Map::const_iterator it = args.find(key);
+	if (it == args.end())
+		return def;
+	return it->second;
+}
+
+
+
+bool
+qmfagent::methodLsiCreateBatch(qmf::AgentEvent& event)
+{
+	struct batch_job_t* job = new struct batch_job_t;
+	job->type = BATCH_LSI_CREATE;
+	job->method = "lsiCreateBatch";
+
+	try {
+		qpid::types::Variant::List const& lsis = event.getArguments()["lsis"].asList();
+
+		for (qpid::types::Variant::List::const_iterator it = lsis.begin(); it != lsis.end(); ++it) {
+			qpid::types::Variant::Map const& args = it->asMap();
+			struct batch_op_t op;
+
+			op.dpid			= batch_arg(args, "dpid", qpid::types::Variant()).asUint64();
+			op.dpname		= batch_arg(args, "dpname", qpid::types::Variant()).asString();
+			op.of_version	= batch_arg(args, "ofversion", qpid::types::Variant()).asInt32();
+			op.ntables		= batch_arg(args, "ntables", (uint32_t)1).asUint32();
+			op.ctlaf		= batch_arg(args, "ctlaf", (int32_t)AF_INET).asInt32();
+			op.ctladdr		= batch_arg(args, "ctladdr", std::string("127.0.0.1")).asString();
+			op.ctlport		= batch_arg(args, "ctlport", (uint16_t)6633).asUint16();
+			op.reconnect	= batch_arg(args, "reconnect", (uint32_t)2).asUint32();
+			op.ssl			= batch_arg(args, "ssl", false).asBool();
+			op.portno		= 0;
+
+			job->ops.push_back(op);
+		}
+
+	} catch (std::exception const& e) {
+		delete job;
+		session.raiseException(event, std::string("lsiCreateBatch failed: invalid argument: ") + e.what());
+		return false;
+	}
+
+	return batch_submit(event, job);
+}
+
+
+
+bool
+qmfagent::methodPortAttachBatch(qmf::AgentEvent& event)
+{
+	struct batch_job_t* job = new struct batch_job_t;
+	job->type = BATCH_PORT_ATTACH;
+	job->method = "portAttachBatch";
+
+	try {
+		qpid::types::Variant::List const& ports = event.getArguments()["ports"].asList();
+
+		for (qpid::types::Variant::List::const_iterator it = ports.begin(); it != ports.end(); ++it) {
+			qpid::types::Variant::Map const& args = it->asMap();
+			struct batch_op_t op;
+
+			op.dpid			= batch_arg(args, "dpid", qpid::types::Variant()).asUint64();
+			op.devname		= batch_arg(args, "devname", qpid::types::Variant()).asString();
+			op.portno		= 0;
+
+			job->ops.push_back(op);
+		}
+
+	} catch (std::exception const& e) {
+		delete job;
+		session.raiseException(event, std::string("portAttachBatch failed: invalid argument: ") + e.what());
+		return false;
+	}
+
+	return batch_submit(event, job);
+}
+
+
+
+bool
+qmfagent::methodCtlConnectBatch(qmf::AgentEvent& event)
+{
+	struct batch_job_t* job = new struct batch_job_t;
+	job->type = BATCH_CTL_CONNECT;
+	job->method = "ctlConnectBatch";
+
+	try {
+		qpid::types::Variant::List const& ctls = event.getArguments()["ctls"].asList();
+
+		for (qpid::types::Variant::List::const_iterator it = ctls.begin(); it != ctls.end(); ++it) {
+			qpid::types::Variant::Map const& args = it->asMap();
+			struct batch_op_t op;
+
+			op.dpid			= batch_arg(args, "dpid", qpid::types::Variant()).asUint64();
+			op.ctladdr		= batch_arg(args, "ctladdr", qpid::types::Variant()).asString();
+			op.ctlport		= batch_arg(args, "ctlport", qpid::types::Variant()).asUint16();
+			op.portno		= 0;
+
+			job->ops.push_back(op);
+		}
+
+	} catch (std::exception const& e) {
+		delete job;
+		session.raiseException(event, std::string("ctlConnectBatch failed: invalid argument: ") + e.what());
+		return false;
+	}
+
+	return batch_submit(event, job);
+}
+
+
+
+bool
+qmfagent::batch_submit(qmf::AgentEvent& event, struct batch_job_t* job)
+{
+	job->id = batch_next_id++;
+	job->next = 0;
+	batch_pending.push_back(job);
+	batch_schedule();
+
+	event.addReturnArgument("jobID", job->id);
+	session.methodSuccess(event);
+
+	return true;
+}
+
+
+
+void
+qmfagent::batch_schedule()
+{
+	char c = 0;
+
+	//If the pipe is full a slice is already scheduled
+	if (write(batch_pipe[1], &c, sizeof(c)) < 0) {
+		//Do nothing
+	}
+}
+
+
+
+void
+qmfagent::batch_run_slice()
+{
+	char buf[64];
+	unsigned int ops = 0;
+
+	while (read(batch_pipe[0], buf, sizeof(buf)) > 0);
+
+	while (!batch_pending.empty() && ops < BATCH_SLICE_OPS) {
+		struct batch_job_t* job = batch_pending.front();
+
+		for (; job->next < job->ops.size() && ops < BATCH_SLICE_OPS; job->next++, ops++)
+			batch_execute(job, job->ops[job->next]);
+
+		if (job->next < job->ops.size())
+			break;
+
+		batch_pending.pop_front();
+		batch_complete(job);
+	}
+
+	//Let the loop service the rest of the events first
+	if (!batch_pending.empty())
+		batch_schedule();
+}
+
+
+
+void
+qmfagent::batch_execute(struct batch_job_t* job, struct batch_op_t& op)
+{
+	switch (job->type) {
+	case BATCH_LSI_CREATE: {
+		try {
+			int ma_list[256] = { 0 };
+			enum rofl::csocket::socket_type_t socket_type = (op.ssl) ? rofl::csocket::SOCKET_TYPE_OPENSSL : rofl::csocket::SOCKET_TYPE_PLAIN;
+
+			xdpd::switch_manager::create_switch((of_version_t)op.of_version, op.dpid, op.dpname, op.ntables, ma_list, op.reconnect, socket_type, get_ctl_params(socket_type, op.ctladdr, op.ctlport));
+
+		} catch (xdpd::eOfSmExists& e) {
+			op.error = "LSI creation failed: already exists";
+		} catch (xdpd::eOfSmErrorOnCreation& e) {
+			op.error = "LSI creation failed: internal error";
+		} catch (xdpd::eOfSmVersionNotSupported& e) {
+			op.error = "LSI creation failed: unsupported OpenFlow version";
+		} catch (...) {
+			op.error = "LSI creation failed: internal error";
+		}
+	} break;
+	case BATCH_PORT_ATTACH: {
+		try {
+			port_manager::attach_port_to_switch(op.dpid, op.devname, &op.portno);
+			job->attached.push_back(op.devname);
+
+		} catch (xdpd::eOfSmDoesNotExist& e) {
+			op.error = "port attachment failed: LSI does not exist";
+		} catch (xdpd::eOfSmErrorOnCreation& e) {
+			op.error = "port attachment failed: physical port does not exist";
+		} catch (...) {
+			op.error = "port attachment failed: internal error";
+		}
+	} break;
+	case BATCH_CTL_CONNECT: {
+		try {
+			// TODO: add socket_type to AMQP/QMF communication
+			enum rofl::csocket::socket_type_t socket_type = rofl::csocket::SOCKET_TYPE_PLAIN;
+
+			xdpd::switch_manager::rpc_connect_to_ctl(op.dpid, socket_type, get_ctl_params(socket_type, op.ctladdr, op.ctlport));
+
+		} catch (xdpd::eOfSmDoesNotExist& e) {
+			op.error = "controller connect failed: LSI does not exist";
+		} catch (...) {
+			op.error = "controller connect failed: internal error";
+		}
+	} break;
+	}
+}
+
+
+
+void
+qmfagent::batch_complete(struct batch_job_t* job)
+{
+	qpid::types::Variant::List results;
+	unsigned int failed = 0;
+
+	//Bring all the attached ports up at once
+	if (!job->attached.empty()) {
+		try {
+			port_manager::bring_up(job->attached);
+		} catch (...) {
+			for (std::vector<struct batch_op_t>::iterator it = job->ops.begin(); it != job->ops.end(); ++it) {
+				if (it->error.empty() && !port_manager::get_admin_state(it->devname))
+					it->error = "port attachment failed: unable to bring the port up";
+			}
+		}
+	}
+
+	for (std::vector<struct batch_op_t>::iterator op = job->ops.begin(); op != job->ops.end(); ++op) {
+		qpid::types::Variant::Map result;
+
+		result["dpid"] = op->dpid;
+		switch (job->type) {
+		case BATCH_LSI_CREATE: {
+			if (op->error.empty())
+				add_qmf_lsi(op->dpid, op->dpname, op->ntables, op->ctlaf, op->ctladdr, op->ctlport, op->reconnect, op->ssl);
+		} break;
+		case BATCH_PORT_ATTACH: {
+			result["devname"] = op->devname;
+			result["portno"] = op->portno;
+		} break;
+		case BATCH_CTL_CONNECT: {
+			result["ctladdr"] = op->ctladdr;
+			result["ctlport"] = op->ctlport;
+		} break;
+		}
+
+		if (not op->error.empty()) {
+			result["error"] = op->error;
+			failed++;
+		}
+		results.push_back(result);
+	}
+
+	qmf::Data data(sch_batch_completed);
+	data.setProperty("xdpdID", xdpd_id);
+	data.setProperty("jobID", job->id);
+	data.setProperty("method", job->method);
+	data.setProperty("total", (uint32_t)job->ops.size());
+	data.setProperty("failed", failed);
+	data.setProperty("results", results);
+	session.raiseEvent(data);
+
+	delete job;
+}
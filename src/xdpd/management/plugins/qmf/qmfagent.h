@@ -6,7 +6,9 @@
 #define QMFAGENT_H_ 
 
 #include <inttypes.h>
+#include <list>
 #include <map>
+#include <vector>
 #include <string>
 #include <ostream>
 #include <exception>
@@ -53,6 +55,13 @@ class eQmfAgentInvalSubcmd	: public eQmfAgentInval {};
 * @brief Qpid Management Framework (QMF) management plugin
 *
 * @description This plugin exposes xDPd's Port and Switch management APIs via a QMF broker
+*
+* The batch methods (lsiCreateBatch, portAttachBatch, ctlConnectBatch) take a
+* list of operations and return a job ID right away. The jobs are executed in
+* order by the ioloop thread (LSIs and controller connections own ciosrv
+* objects, which must be created by that thread), a slice of operations at a
+* time, and a batchCompleted event carrying the result of every operation is
+* raised when a job is done.
 * @ingroup cmm_mgmt_plugins
 */
 class qmfagent :
@@ -76,6 +85,7 @@ private:
 	qmf::Schema						sch_exception;
 	qmf::Schema						sch_xdpd;
 	qmf::Schema						sch_lsi;
+	qmf::Schema						sch_batch_completed;
 
 	struct qmf_data_t {
 		qmf::Data 					data;
@@ -86,6 +96,48 @@ private:
 
 	std::map<uint64_t, struct qmf_data_t>	qLSIs;
 
+	enum batch_type_t {
+		BATCH_LSI_CREATE,
+		BATCH_PORT_ATTACH,
+		BATCH_CTL_CONNECT,
+	};
+
+	struct batch_op_t {
+		uint64_t					dpid;
+		std::string					dpname;
+		int							of_version;
+		unsigned int				ntables;
+		int							ctlaf;
+		std::string					ctladdr;
+		unsigned short				ctlport;
+		unsigned int				reconnect;
+		bool						ssl;
+		std::string					devname;
+
+		//Results
+		uint32_t					portno;
+		std::string					error;		//Empty on success
+	};
+
+	struct batch_job_t {
+		uint64_t					id;
+		enum batch_type_t			type;
+		std::string					method;
+		std::vector<struct batch_op_t> ops;
+		size_t						next;		//Next operation to run
+		std::list<std::string>		attached;	//Ports to bring up once all are attached
+	};
+
+	//Operations run per ioloop iteration; the QMF session and the rest of
+	//the ciosrv objects are serviced between slices
+	static const unsigned int		BATCH_SLICE_OPS = 16;
+
+	//Jobs are queued and run by the ioloop thread; a byte in batch_pipe
+	//schedules the next slice
+	uint64_t						batch_next_id;
+	std::list<struct batch_job_t*>	batch_pending;
+	int								batch_pipe[2];
+
 public:
 
 	/**
@@ -204,6 +256,78 @@ private:
 	bool
 	methodLsiCreateVirtualLink(qmf::AgentEvent& event);
 
+	/**
+	 *
+	 */
+	bool
+	methodLsiCreateBatch(qmf::AgentEvent& event);
+
+	/**
+	 *
+	 */
+	bool
+	methodPortAttachBatch(qmf::AgentEvent& event);
+
+	/**
+	 *
+	 */
+	bool
+	methodCtlConnectBatch(qmf::AgentEvent& event);
+
+	/**
+	 * queue the job and return its ID to the caller
+	 */
+	bool
+	batch_submit(qmf::AgentEvent& event, struct batch_job_t* job);
+
+	/**
+	 * schedule a slice in the ioloop
+	 */
+	void
+	batch_schedule();
+
+	/**
+	 * run the next BATCH_SLICE_OPS operations of the pending jobs (ioloop thread)
+	 */
+	void
+	batch_run_slice();
+
+	/**
+	 * run a single operation of a job
+	 */
+	void
+	batch_execute(struct batch_job_t* job, struct batch_op_t& op);
+
+	/**
+	 * bring the attached ports up, publish the LSIs created and raise the
+	 * batchCompleted event of a job
+	 */
+	void
+	batch_complete(struct batch_job_t* job);
+
+	/**
+	 *
+	 */
+	rofl::cparams
+	get_ctl_params(
+			enum rofl::csocket::socket_type_t socket_type,
+			std::string const& ctladdr,
+			unsigned short ctlport);
+
+	/**
+	 *
+	 */
+	void
+	add_qmf_lsi(
+			uint64_t dpid,
+			std::string const& dpname,
+			unsigned int ntables,
+			int ctlaf,
+			std::string const& ctladdr,
+			unsigned short ctlport,
+			unsigned int reconnect,
+			bool ssl);
+
 	/**
 	 *
 	 */
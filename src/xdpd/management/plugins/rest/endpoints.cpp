@@ -9,6 +9,8 @@
 
 #include "json_spirit/json_spirit_writer_template.h"
 
+#include "stats_cache.hpp"
+
 #include "../../plugin_manager.h"
 
 #define _LINUX_IF_H
@@ -35,11 +37,6 @@ namespace endpoints
     rep.content = json_spirit::write_string(pa);
     }
 
-  void list_ports (const http::server::request &req, http::server::reply &rep)
-    {
-	  json_spirit::Value tbd(std::string("tdb"));
-	  rep.content = json_spirit::write_string(tbd);
-    }
 
   void list_datapaths (const http::server::request &req, http::server::reply &rep)
     {
@@ -48,4 +45,83 @@ namespace endpoints
     rep.content = json_spirit::write_string(dl);
     }
 
+  void list_ports (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("ports");
+    }
+
+  void list_queues (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("queues");
+    }
+
+  void list_lsis (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("lsis");
+    }
+
+  void list_tables (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("tables");
+    }
+
+  void get_bufferpool (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("bufferpool");
+    }
+
+  void get_allocator (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("allocator");
+    }
+
+  void get_event_bus (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->get_json("event_bus");
+    }
+
+  void get_stats (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.content = cache.get()->to_json();
+    }
+
+  /**
+  * Per-connection state of a stats stream; sends a snapshot event first
+  * and then a delta event for every new generation of the cache
+  */
+  class stats_stream
+    {
+  public:
+    stats_stream (const xdpd::stats_cache &cache)
+      : cache(&cache)
+      { }
+
+    bool operator() (std::string &chunk)
+      {
+      xdpd::stats_snapshot_ptr current = cache->get();
+
+      if (!last)
+        {
+        chunk = "event: snapshot\ndata: " + current->to_json() + "\n\n";
+        }
+      else if (current->generation != last->generation)
+        {
+        chunk = "event: delta\ndata: " + current->delta_json(*last) + "\n\n";
+        }
+
+      last = current;
+      return true;
+      }
+
+  private:
+    const xdpd::stats_cache     *cache;
+    xdpd::stats_snapshot_ptr    last;
+    };
+
+  void stream_stats (const xdpd::stats_cache &cache, const http::server::request &req, http::server::reply &rep)
+    {
+    rep.stream = stats_stream(cache);
+    rep.stream_interval_ms = cache.get_interval_ms();
+    }
+
   } // namespace endpoints 
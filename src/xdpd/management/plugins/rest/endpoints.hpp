@@ -9,9 +9,26 @@ namespace http
     }
   }
 
+namespace xdpd
+  {
+  class stats_cache;
+  }
+
 namespace endpoints
   {
   void list_plugins (const http::server::request &, http::server::reply &);
   void list_datapaths (const http::server::request &, http::server::reply &);
-  void list_ports (const http::server::request &, http::server::reply &);
+
+  // Served from the stats cache
+  void list_ports (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void list_queues (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void list_lsis (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void list_tables (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void get_bufferpool (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void get_allocator (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void get_event_bus (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+  void get_stats (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
+
+  // Server-Sent Events: a full snapshot, then the deltas of every refresh
+  void stream_stats (const xdpd::stats_cache &, const http::server::request &, http::server::reply &);
   } // namespace endpoints
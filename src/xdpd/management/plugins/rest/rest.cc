@@ -6,6 +6,7 @@
 #include <rofl/common/utils/c_logger.h>
 
 #include <boost/asio.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <signal.h>
@@ -14,10 +15,18 @@
 #include "server/rest_handler.hpp"
 
 #include "endpoints.hpp"
+#include "stats_cache.hpp"
+
+#include "../../system_manager.h"
 
 namespace xdpd
   {
-  void srvthread ()
+  const std::string rest::REST_STATS_INTERVAL_OPT("rest-stats-interval");
+
+  //Outlives the (detached) server thread
+  static stats_cache cache;
+
+  void srvthread (stats_cache* cache)
     {
     boost::asio::io_service io_service;
     
@@ -27,7 +36,15 @@ namespace xdpd
 
       handler.register_path("/plugins", boost::bind(endpoints::list_plugins, _1, _2));
       handler.register_path("/datapaths", boost::bind(endpoints::list_datapaths, _1, _2));
-      handler.register_path("/ports", boost::bind(endpoints::list_ports, _1, _2));
+      handler.register_path("/ports", boost::bind(endpoints::list_ports, boost::cref(*cache), _1, _2));
+      handler.register_path("/queues", boost::bind(endpoints::list_queues, boost::cref(*cache), _1, _2));
+      handler.register_path("/lsis", boost::bind(endpoints::list_lsis, boost::cref(*cache), _1, _2));
+      handler.register_path("/tables", boost::bind(endpoints::list_tables, boost::cref(*cache), _1, _2));
+      handler.register_path("/bufferpool", boost::bind(endpoints::get_bufferpool, boost::cref(*cache), _1, _2));
+      handler.register_path("/allocator", boost::bind(endpoints::get_allocator, boost::cref(*cache), _1, _2));
+      handler.register_path("/event-bus", boost::bind(endpoints::get_event_bus, boost::cref(*cache), _1, _2));
+      handler.register_path("/stats", boost::bind(endpoints::get_stats, boost::cref(*cache), _1, _2));
+      handler.register_path("/stats/stream", boost::bind(endpoints::stream_stats, boost::cref(*cache), _1, _2));
 
       http::server::server(io_service, "0.0.0.0", "80", handler)();
       boost::asio::signal_set signals(io_service);
@@ -44,10 +61,28 @@ namespace xdpd
       }
     }
 
+  rest::~rest()
+    {
+    cache.stop();
+    }
+
   void rest::init()
     {
-    ROFL_INFO("[xdpd][rest] Starting REST server\n");
-    boost::thread t(&srvthread);
+    unsigned int interval_ms = stats_cache::DEFAULT_INTERVAL_MS;
+
+    try
+      {
+      interval_ms = boost::lexical_cast<unsigned int>(system_manager::get_option_value(REST_STATS_INTERVAL_OPT));
+      }
+    catch (...)
+      {
+      ROFL_ERR("[xdpd][rest] Invalid %s value; using %ums\n", REST_STATS_INTERVAL_OPT.c_str(), interval_ms);
+      }
+
+    cache.start(interval_ms);
+
+    ROFL_INFO("[xdpd][rest] Starting REST server (stats refreshed every %ums)\n", cache.get_interval_ms());
+    boost::thread t(boost::bind(&srvthread, &cache));
 
     return;
     };
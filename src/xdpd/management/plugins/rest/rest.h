@@ -2,6 +2,7 @@
 #define REST_PLUGIN_H 
 
 #include <string>
+#include <vector>
 
 #include "../../plugin_manager.h"
 
@@ -18,8 +19,10 @@
 
 namespace xdpd {
 
+  class stats_cache;
+
   void list_plugins (const http::server::request&, http::server::reply&);
-  void srvthread (void);
+  void srvthread (stats_cache*);
 
   /**
   * @brief Dummy management plugin rest
@@ -28,11 +31,24 @@ namespace xdpd {
   class rest:public plugin {
     
   public:
+    virtual ~rest();
+
     virtual void init();
 
+    virtual std::vector<rofl::coption> get_options(void){
+      std::vector<rofl::coption> vec;
+
+      //Refresh period of the stats served by the REST API (ms)
+      vec.push_back(rofl::coption(true, REQUIRED_ARGUMENT, 'S', REST_STATS_INTERVAL_OPT, "REST stats refresh interval (ms)", std::string("1000")));
+
+      return vec;
+    }
+
     virtual std::string get_name(void){
       return std::string("rest");
     };
+
+    static const std::string REST_STATS_INTERVAL_OPT;
   };
 
 }// namespace xdpd 
@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 #include <boost/asio.hpp>
+#include <boost/function.hpp>
 #include "header.hpp"
 
 namespace http {
@@ -22,6 +23,8 @@ namespace http {
     /// A reply to be sent to a client.
     struct reply
     {
+      reply() : stream_interval_ms(0) {}
+
       /// The status of the reply.
       enum status_type
       {
@@ -49,6 +52,15 @@ namespace http {
       /// The content to be sent in the reply.
       std::string content;
 
+      /// Optional producer of a streamed body (e.g. Server-Sent Events). The
+      /// headers and content are sent first; then the producer is called every
+      /// stream_interval_ms, and what it appends to the chunk is written to the
+      /// connection, until it returns false or the client goes away.
+      boost::function<bool (std::string& chunk)> stream;
+
+      /// Period of the stream producer calls.
+      unsigned int stream_interval_ms;
+
       /// Convert the reply into a vector of buffers. The buffers do not own the
       /// underlying memory blocks, therefore the reply object must remain valid and
       /// not be changed until the write operation has completed.
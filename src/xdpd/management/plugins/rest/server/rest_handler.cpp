@@ -27,11 +27,23 @@ namespace http
         {
         RestFuncT func = this->handler_map[request_path];
         func(req, rep);
-        rep.headers.resize(2);
-        rep.headers[0].name = "Content-Length";
-        rep.headers[0].value = boost::lexical_cast<std::string>(rep.content.size());
-        rep.headers[1].name = "Content-Type";
-        rep.headers[1].value = "application/json";
+        if (rep.stream)
+          {
+          // No length; the body lasts as long as the connection
+          rep.headers.resize(2);
+          rep.headers[0].name = "Content-Type";
+          rep.headers[0].value = "text/event-stream";
+          rep.headers[1].name = "Cache-Control";
+          rep.headers[1].value = "no-cache";
+          }
+        else
+          {
+          rep.headers.resize(2);
+          rep.headers[0].name = "Content-Length";
+          rep.headers[0].value = boost::lexical_cast<std::string>(rep.content.size());
+          rep.headers[1].name = "Content-Type";
+          rep.headers[1].value = "application/json";
+          }
         rep.status = reply::ok;
         return;
         }
@@ -103,6 +103,26 @@ namespace http {
           // Send the reply back to the client.
           yield boost::asio::async_write(*socket_, reply_->to_buffers(), *this);
 
+          // Streamed reply: keep pushing chunks until the producer is done.
+          // A failed write (client gone) ends the coroutine like any error.
+          if (reply_->stream)
+          {
+            stream_timer_.reset(new boost::asio::deadline_timer(socket_->get_io_service()));
+            stream_chunk_.reset(new std::string);
+
+            while (reply_->stream(*stream_chunk_))
+            {
+              if (!stream_chunk_->empty())
+              {
+                yield boost::asio::async_write(*socket_, boost::asio::buffer(*stream_chunk_), *this);
+                stream_chunk_->clear();
+              }
+
+              stream_timer_->expires_from_now(boost::posix_time::milliseconds(reply_->stream_interval_ms));
+              yield stream_timer_->async_wait(*this);
+            }
+          }
+
           // Initiate graceful connection closure.
           socket_->shutdown(tcp::socket::shutdown_both, ec);
         }
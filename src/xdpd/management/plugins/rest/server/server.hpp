@@ -65,6 +65,10 @@ namespace http {
 
       /// The reply to be sent back to the client.
       boost::shared_ptr<reply> reply_;
+
+      /// Timer and pending chunk of a streamed reply.
+      boost::shared_ptr<boost::asio::deadline_timer> stream_timer_;
+      boost::shared_ptr<std::string> stream_chunk_;
     };
 
   } // namespace server
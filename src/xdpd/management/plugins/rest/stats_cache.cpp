@@ -0,0 +1,484 @@
+#include "stats_cache.hpp"
+
+#include <sstream>
+#include <time.h>
+
+#include <boost/bind.hpp>
+
+#include <rofl/common/utils/c_logger.h>
+#include <rofl/datapath/hal/driver.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+
+#include "json_spirit/json_spirit_writer_template.h"
+
+#define _LINUX_IF_H
+#include "../../switch_manager.h"
+#include "../../plugin_manager.h"
+#include "../../hal_ext.h"
+
+namespace xdpd
+  {
+  namespace
+    {
+    const char* sections[] = { "ports", "queues", "lsis", "tables", "bufferpool", "allocator", "event_bus" };
+    const unsigned int num_of_sections = sizeof(sections)/sizeof(sections[0]);
+
+    std::string to_hex (uint64_t value)
+      {
+      std::ostringstream os;
+      os << "0x" << std::hex << value;
+      return os.str();
+      }
+
+    const char* of_version_str (of_version_t version)
+      {
+      switch (version)
+        {
+        case OF_VERSION_10: return "1.0";
+        case OF_VERSION_12: return "1.2";
+        case OF_VERSION_13: return "1.3";
+        default: return "unknown";
+        }
+      }
+
+    //Adds the counter both to the JSON object and to the counters of the entity
+    void add_counter (json_spirit::Object& obj, stats_snapshot::counters_t& counters, const char* name, uint64_t value)
+      {
+      obj.push_back(json_spirit::Pair(name, json_spirit::Value((boost::uint64_t)value)));
+      counters[name] = value;
+      }
+
+    json_spirit::Object counters_to_json (const stats_snapshot::counters_t& counters)
+      {
+      json_spirit::Object obj;
+      for (stats_snapshot::counters_t::const_iterator it = counters.begin(); it != counters.end(); ++it)
+        obj.push_back(json_spirit::Pair(it->first, json_spirit::Value((boost::uint64_t)it->second)));
+      return obj;
+      }
+
+    uint64_t now_ms (void)
+      {
+      struct timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      return ts.tv_sec*1000ULL + ts.tv_nsec/1000000;
+      }
+    }
+
+  //
+  // stats_snapshot
+  //
+
+  const std::string& stats_snapshot::get_json (const std::string& section) const
+    {
+    static const std::string null_json("null");
+    std::map<std::string, std::string>::const_iterator it = json.find(section);
+    return (it != json.end())? it->second : null_json;
+    }
+
+  std::string stats_snapshot::to_json (void) const
+    {
+    std::ostringstream os;
+
+    os << "{\"generation\":" << generation << ",\"timestamp_ms\":" << timestamp_ms;
+    for (unsigned int i = 0; i < num_of_sections; ++i)
+      os << ",\"" << sections[i] << "\":" << get_json(sections[i]);
+    os << "}";
+
+    return os.str();
+    }
+
+  std::string stats_snapshot::delta_json (const stats_snapshot& prev) const
+    {
+    json_spirit::Object delta, changed, added, removed;
+
+    for (unsigned int i = 0; i < num_of_sections; ++i)
+      {
+      json_spirit::Object sec_changed, sec_added;
+      json_spirit::Array sec_removed;
+      std::map<std::string, entities_t>::const_iterator cur_it = counters.find(sections[i]);
+      std::map<std::string, entities_t>::const_iterator prev_it = prev.counters.find(sections[i]);
+      const entities_t empty;
+      const entities_t& cur_entities = (cur_it != counters.end())? cur_it->second : empty;
+      const entities_t& prev_entities = (prev_it != prev.counters.end())? prev_it->second : empty;
+
+      for (entities_t::const_iterator e = cur_entities.begin(); e != cur_entities.end(); ++e)
+        {
+        entities_t::const_iterator p = prev_entities.find(e->first);
+
+        if (p == prev_entities.end())
+          {
+          sec_added.push_back(json_spirit::Pair(e->first, counters_to_json(e->second)));
+          continue;
+          }
+
+        //Differences; gauges (e.g. entries, buffers in use) may go down
+        json_spirit::Object diffs;
+        for (counters_t::const_iterator c = e->second.begin(); c != e->second.end(); ++c)
+          {
+          counters_t::const_iterator pc = p->second.find(c->first);
+          int64_t diff = (int64_t)(c->second - ((pc != p->second.end())? pc->second : 0));
+          if (diff)
+            diffs.push_back(json_spirit::Pair(c->first, json_spirit::Value((boost::int64_t)diff)));
+          }
+
+        if (!diffs.empty())
+          sec_changed.push_back(json_spirit::Pair(e->first, diffs));
+        }
+
+      for (entities_t::const_iterator p = prev_entities.begin(); p != prev_entities.end(); ++p)
+        {
+        if (cur_entities.find(p->first) == cur_entities.end())
+          sec_removed.push_back(json_spirit::Value(p->first));
+        }
+
+      if (!sec_changed.empty())
+        changed.push_back(json_spirit::Pair(sections[i], sec_changed));
+      if (!sec_added.empty())
+        added.push_back(json_spirit::Pair(sections[i], sec_added));
+      if (!sec_removed.empty())
+        removed.push_back(json_spirit::Pair(sections[i], sec_removed));
+      }
+
+    delta.push_back(json_spirit::Pair("generation", json_spirit::Value((boost::uint64_t)generation)));
+    delta.push_back(json_spirit::Pair("timestamp_ms", json_spirit::Value((boost::uint64_t)timestamp_ms)));
+    delta.push_back(json_spirit::Pair("elapsed_ms", json_spirit::Value((boost::uint64_t)(timestamp_ms - prev.timestamp_ms))));
+    delta.push_back(json_spirit::Pair("changed", changed));
+    delta.push_back(json_spirit::Pair("added", added));
+    delta.push_back(json_spirit::Pair("removed", removed));
+
+    return json_spirit::write_string(json_spirit::Value(delta));
+    }
+
+  //
+  // stats_cache
+  //
+
+  stats_cache::stats_cache (void)
+    : running(false), interval_ms(DEFAULT_INTERVAL_MS), generation(0)
+    {
+    stats_snapshot* empty = new stats_snapshot;
+    empty->generation = 0;
+    empty->timestamp_ms = 0;
+    current.reset(empty);
+    }
+
+  stats_cache::~stats_cache (void)
+    {
+    stop();
+    }
+
+  void stats_cache::start (unsigned int interval)
+    {
+    if (running)
+      return;
+
+    interval_ms = (interval < MIN_INTERVAL_MS)? MIN_INTERVAL_MS : interval;
+    running = true;
+    thread = boost::thread(boost::bind(&stats_cache::run, this));
+    }
+
+  void stats_cache::stop (void)
+    {
+    if (!running)
+      return;
+
+    thread.interrupt();
+    thread.join();
+    running = false;
+    }
+
+  stats_snapshot_ptr stats_cache::get (void) const
+    {
+    boost::mutex::scoped_lock lock(mutex);
+    return current;
+    }
+
+  void stats_cache::run (void)
+    {
+    try
+      {
+      while (true)
+        {
+        refresh();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(interval_ms));
+        }
+      }
+    catch (boost::thread_interrupted&)
+      {
+      return;
+      }
+    }
+
+  void stats_cache::refresh (void)
+    {
+    boost::shared_ptr<stats_snapshot> snapshot(new stats_snapshot);
+
+    snapshot->generation = ++generation;
+    snapshot->timestamp_ms = now_ms();
+
+    try
+      {
+      snapshot_ports(*snapshot);
+      snapshot_lsis(*snapshot);
+      snapshot_bufferpool(*snapshot);
+      snapshot_allocator(*snapshot);
+      snapshot_event_bus(*snapshot);
+      }
+    catch (...)
+      {
+      ROFL_ERR("[xdpd][rest] ERROR: unable to refresh the stats snapshot\n");
+      return;
+      }
+
+    //Publish
+    boost::mutex::scoped_lock lock(mutex);
+    current = snapshot;
+    }
+
+  void stats_cache::snapshot_ports (stats_snapshot& snapshot)
+    {
+    json_spirit::Array ports, queues;
+    stats_snapshot::entities_t& port_counters = snapshot.counters["ports"];
+    stats_snapshot::entities_t& queue_counters = snapshot.counters["queues"];
+    switch_port_name_list_t* port_names;
+    switch_port_snapshot_t* port;
+
+    port_names = hal_driver_get_all_port_names();
+    if (!port_names)
+      throw std::exception();
+
+    for (unsigned int i = 0; i < port_names->num_of_ports; ++i)
+      {
+      port = hal_driver_get_port_snapshot_by_name(port_names->names[i].name);
+      if (!port)
+        continue; //Removed in the meantime
+
+      json_spirit::Object obj, stats;
+      stats_snapshot::counters_t& c = port_counters[port->name];
+
+      obj.push_back(json_spirit::Pair("name", std::string(port->name)));
+      obj.push_back(json_spirit::Pair("up", port->up));
+      obj.push_back(json_spirit::Pair("link", (port->state & PORT_STATE_LINK_DOWN) == 0));
+      obj.push_back(json_spirit::Pair("attached", port->is_attached_to_sw));
+      if (port->is_attached_to_sw)
+        {
+        obj.push_back(json_spirit::Pair("dpid", to_hex(port->attached_sw_dpid)));
+        obj.push_back(json_spirit::Pair("of_port_num", json_spirit::Value((boost::uint64_t)port->of_port_num)));
+        }
+
+      add_counter(stats, c, "rx_packets", port->stats.rx_packets);
+      add_counter(stats, c, "tx_packets", port->stats.tx_packets);
+      add_counter(stats, c, "rx_bytes", port->stats.rx_bytes);
+      add_counter(stats, c, "tx_bytes", port->stats.tx_bytes);
+      add_counter(stats, c, "rx_dropped", port->stats.rx_dropped);
+      add_counter(stats, c, "tx_dropped", port->stats.tx_dropped);
+      add_counter(stats, c, "rx_errors", port->stats.rx_errors);
+      add_counter(stats, c, "tx_errors", port->stats.tx_errors);
+      add_counter(stats, c, "rx_frame_err", port->stats.rx_frame_err);
+      add_counter(stats, c, "rx_over_err", port->stats.rx_over_err);
+      add_counter(stats, c, "rx_crc_err", port->stats.rx_crc_err);
+      add_counter(stats, c, "collisions", port->stats.collisions);
+      obj.push_back(json_spirit::Pair("stats", stats));
+
+      ports.push_back(obj);
+
+      //Queues
+      for (unsigned int q = 0; q < port->max_queues; ++q)
+        {
+        if (!port->queues[q].set)
+          continue;
+
+        json_spirit::Object qobj;
+        std::ostringstream key;
+        key << port->name << "/" << q;
+        stats_snapshot::counters_t& qc = queue_counters[key.str()];
+
+        qobj.push_back(json_spirit::Pair("port", std::string(port->name)));
+        qobj.push_back(json_spirit::Pair("queue_id", json_spirit::Value((boost::uint64_t)q)));
+        add_counter(qobj, qc, "tx_packets", port->queues[q].stats.tx_packets);
+        add_counter(qobj, qc, "tx_bytes", port->queues[q].stats.tx_bytes);
+        add_counter(qobj, qc, "overrun", port->queues[q].stats.overrun);
+
+        queues.push_back(qobj);
+        }
+
+      switch_port_destroy_snapshot(port);
+      }
+
+    switch_port_name_list_destroy(port_names);
+
+    snapshot.json["ports"] = json_spirit::write_string(json_spirit::Value(ports));
+    snapshot.json["queues"] = json_spirit::write_string(json_spirit::Value(queues));
+    }
+
+  void stats_cache::snapshot_lsis (stats_snapshot& snapshot)
+    {
+    json_spirit::Array lsis, tables;
+    stats_snapshot::entities_t& lsi_counters = snapshot.counters["lsis"];
+    stats_snapshot::entities_t& table_counters = snapshot.counters["tables"];
+    std::list<uint64_t> dpids = switch_manager::list_dpids();
+    of1x_switch_snapshot_t* sw;
+
+    for (std::list<uint64_t>::iterator it = dpids.begin(); it != dpids.end(); ++it)
+      {
+      sw = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(*it);
+      if (!sw)
+        continue; //Destroyed in the meantime
+
+      json_spirit::Object obj;
+      unsigned int num_of_ports = 0;
+
+      for (unsigned int i = 0; i < sw->max_ports; ++i)
+        {
+        if (sw->logical_ports[i].port && sw->logical_ports[i].attachment_state == LOGICAL_PORT_STATE_ATTACHED)
+          num_of_ports++;
+        }
+
+      obj.push_back(json_spirit::Pair("name", std::string(sw->name)));
+      obj.push_back(json_spirit::Pair("dpid", to_hex(sw->dpid)));
+      obj.push_back(json_spirit::Pair("of_version", std::string(of_version_str(sw->of_ver))));
+      obj.push_back(json_spirit::Pair("num_of_tables", json_spirit::Value((boost::uint64_t)sw->pipeline.num_of_tables)));
+      obj.push_back(json_spirit::Pair("num_of_ports", json_spirit::Value((boost::uint64_t)num_of_ports)));
+
+      //Microflow cache, if the driver has one
+      bool mfc_enabled;
+      uint64_t mfc_hits, mfc_misses;
+      if (hal_driver_get_microflow_cache_stats && hal_driver_get_microflow_cache_stats(sw->dpid, &mfc_enabled, &mfc_hits, &mfc_misses) == HAL_SUCCESS)
+        {
+        json_spirit::Object mobj;
+        stats_snapshot::counters_t& lc = lsi_counters[sw->name];
+
+        mobj.push_back(json_spirit::Pair("enabled", mfc_enabled));
+        add_counter(mobj, lc, "hits", mfc_hits);
+        add_counter(mobj, lc, "misses", mfc_misses);
+        obj.push_back(json_spirit::Pair("microflow_cache", mobj));
+        }
+
+      //PKT_IN meters, if the driver has them
+      uint64_t accepted, dropped, lsi_dropped;
+      if (hal_driver_get_pktin_meter_stats && hal_driver_get_pktin_meter_stats(sw->dpid, &accepted, &dropped, &lsi_dropped) == HAL_SUCCESS)
+        {
+        const char* reasons[][2] = { { "no_match_accepted", "no_match_dropped" }, { "action_accepted", "action_dropped" } };
+        json_spirit::Object pobj;
+        stats_snapshot::counters_t& lc = lsi_counters[sw->name];
+
+        add_counter(pobj, lc, "accepted", accepted);
+        add_counter(pobj, lc, "dropped", dropped);
+        add_counter(pobj, lc, "lsi_dropped", lsi_dropped);
+        for (unsigned int r = 0; r < sizeof(reasons)/sizeof(reasons[0]); ++r)
+          {
+          if (!hal_driver_get_pktin_meter_reason_stats || hal_driver_get_pktin_meter_reason_stats(sw->dpid, r, &accepted, &dropped) != HAL_SUCCESS)
+            continue;
+          add_counter(pobj, lc, reasons[r][0], accepted);
+          add_counter(pobj, lc, reasons[r][1], dropped);
+          }
+        obj.push_back(json_spirit::Pair("pktin_meter", pobj));
+        }
+
+      lsis.push_back(obj);
+
+      for (unsigned int n = 0; n < sw->pipeline.num_of_tables; ++n)
+        {
+        of1x_flow_table_t* table = &sw->pipeline.tables[n];
+        json_spirit::Object tobj;
+        std::ostringstream key;
+        key << sw->name << "/" << n;
+        stats_snapshot::counters_t& tc = table_counters[key.str()];
+
+        tobj.push_back(json_spirit::Pair("lsi", std::string(sw->name)));
+        tobj.push_back(json_spirit::Pair("table_id", json_spirit::Value((boost::uint64_t)table->number)));
+        add_counter(tobj, tc, "num_of_entries", table->num_of_entries);
+        add_counter(tobj, tc, "lookup_count", table->stats.lookup_count);
+        add_counter(tobj, tc, "matched_count", table->stats.matched_count);
+
+        uint64_t pktin_accepted, pktin_dropped;
+        if (hal_driver_get_pktin_meter_table_stats && hal_driver_get_pktin_meter_table_stats(sw->dpid, n, &pktin_accepted, &pktin_dropped) == HAL_SUCCESS)
+          {
+          add_counter(tobj, tc, "pktin_accepted", pktin_accepted);
+          add_counter(tobj, tc, "pktin_dropped", pktin_dropped);
+          }
+        tables.push_back(tobj);
+        }
+
+      of_switch_destroy_snapshot((of_switch_snapshot_t*)sw);
+      }
+
+    snapshot.json["lsis"] = json_spirit::write_string(json_spirit::Value(lsis));
+    snapshot.json["tables"] = json_spirit::write_string(json_spirit::Value(tables));
+    }
+
+  void stats_cache::snapshot_bufferpool (stats_snapshot& snapshot)
+    {
+    uint64_t capacity, in_use;
+    json_spirit::Object obj;
+
+    if (!hal_driver_get_bufferpool_stats || hal_driver_get_bufferpool_stats(&capacity, &in_use) != HAL_SUCCESS)
+      return; //null
+
+    stats_snapshot::counters_t& c = snapshot.counters["bufferpool"]["bufferpool"];
+    add_counter(obj, c, "capacity", capacity);
+    add_counter(obj, c, "in_use", in_use);
+
+    snapshot.json["bufferpool"] = json_spirit::write_string(json_spirit::Value(obj));
+    }
+
+  void stats_cache::snapshot_allocator (stats_snapshot& snapshot)
+    {
+    uint64_t obj_size, capacity, in_use, cached, remote_frees, large_in_use, large_bytes;
+    json_spirit::Object obj;
+    json_spirit::Array classes;
+    stats_snapshot::entities_t& entities = snapshot.counters["allocator"];
+
+    if (!hal_driver_get_allocator_stats || !hal_driver_get_allocator_large_stats)
+      return; //null
+
+    for (unsigned int i = 0; hal_driver_get_allocator_stats(i, &obj_size, &capacity, &in_use, &cached, &remote_frees) == HAL_SUCCESS; ++i)
+      {
+      json_spirit::Object cobj;
+      std::ostringstream key;
+      key << obj_size;
+      stats_snapshot::counters_t& c = entities[key.str()];
+
+      cobj.push_back(json_spirit::Pair("obj_size", json_spirit::Value((boost::uint64_t)obj_size)));
+      add_counter(cobj, c, "capacity", capacity);
+      add_counter(cobj, c, "in_use", in_use);
+      add_counter(cobj, c, "cached", cached);
+      add_counter(cobj, c, "remote_frees", remote_frees);
+
+      classes.push_back(cobj);
+      }
+    obj.push_back(json_spirit::Pair("classes", classes));
+
+    if (hal_driver_get_allocator_large_stats(&large_in_use, &large_bytes) == HAL_SUCCESS)
+      {
+      json_spirit::Object lobj;
+      stats_snapshot::counters_t& c = entities["large"];
+      add_counter(lobj, c, "in_use", large_in_use);
+      add_counter(lobj, c, "bytes", large_bytes);
+      obj.push_back(json_spirit::Pair("large", lobj));
+      }
+
+    snapshot.json["allocator"] = json_spirit::write_string(json_spirit::Value(obj));
+    }
+
+  void stats_cache::snapshot_event_bus (stats_snapshot& snapshot)
+    {
+    plugin_event_bus_stats_t stats;
+    json_spirit::Object obj;
+
+    plugin_manager::get_event_bus_stats(&stats);
+
+    stats_snapshot::counters_t& c = snapshot.counters["event_bus"]["event_bus"];
+    add_counter(obj, c, "queue_len", stats.queue_len);
+    add_counter(obj, c, "max_queue_len", stats.max_queue_len);
+    add_counter(obj, c, "posted", stats.posted);
+    add_counter(obj, c, "dispatched", stats.dispatched);
+    add_counter(obj, c, "coalesced", stats.coalesced);
+    add_counter(obj, c, "dropped", stats.dropped);
+    add_counter(obj, c, "avg_latency_us", stats.avg_latency_us);
+    add_counter(obj, c, "max_latency_us", stats.max_latency_us);
+
+    snapshot.json["event_bus"] = json_spirit::write_string(json_spirit::Value(obj));
+    }
+
+  } // namespace xdpd
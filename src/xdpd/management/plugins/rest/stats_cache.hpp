@@ -0,0 +1,113 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef REST_STATS_CACHE_HPP
+#define REST_STATS_CACHE_HPP
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+/**
+* @file stats_cache.hpp
+*
+* @brief Periodically refreshed snapshot of the port, queue, LSI, table,
+* bufferpool, allocator and plugin event bus state served by the REST endpoints
+*/
+
+namespace xdpd
+  {
+  /**
+  * @brief Immutable snapshot of the switch state
+  *
+  * Every section (ports, queues, lsis, tables, bufferpool, allocator, event_bus) is kept both
+  * serialized (so that requests only copy a string) and as counters by
+  * entity, used to compute the deltas pushed to the streams.
+  */
+  struct stats_snapshot
+    {
+    typedef std::map<std::string, uint64_t>       counters_t; //counter name -> value
+    typedef std::map<std::string, counters_t>     entities_t; //entity key -> counters
+
+    uint64_t  generation;
+    uint64_t  timestamp_ms;
+
+    std::map<std::string, std::string>  json;     //section -> JSON
+    std::map<std::string, entities_t>   counters; //section -> entities
+
+    /**
+    * JSON of a section; "null" if unknown
+    */
+    const std::string& get_json (const std::string& section) const;
+
+    /**
+    * Serializes all the sections in a single JSON object
+    */
+    std::string to_json (void) const;
+
+    /**
+    * Serializes the counters that changed since prev, the new entities
+    * and the keys of the ones that disappeared
+    */
+    std::string delta_json (const stats_snapshot& prev) const;
+    };
+
+  typedef boost::shared_ptr<const stats_snapshot> stats_snapshot_ptr;
+
+  /**
+  * @brief Holder of the current stats_snapshot, refreshed by its own thread
+  *
+  * The snapshot is built from the HAL every interval_ms; the dpids of the
+  * LSIs are obtained through switch_manager::list_dpids(), which does not
+  * take the switch_manager locks. Requests only take a reference to the
+  * current snapshot, so their rate does not have any impact on the datapath.
+  */
+  class stats_cache
+    {
+  public:
+    static const unsigned int DEFAULT_INTERVAL_MS = 1000;
+    static const unsigned int MIN_INTERVAL_MS = 100;
+
+    stats_cache (void);
+    ~stats_cache (void);
+
+    void  start (unsigned int interval_ms);
+    void  stop (void);
+
+    /**
+    * Current snapshot; never NULL (empty before the first refresh)
+    */
+    stats_snapshot_ptr  get (void) const;
+
+    unsigned int  get_interval_ms (void) const { return interval_ms; }
+
+  private:
+    void  run (void);
+    void  refresh (void);
+
+    static void  snapshot_ports (stats_snapshot& snapshot);
+    static void  snapshot_lsis (stats_snapshot& snapshot);
+    static void  snapshot_bufferpool (stats_snapshot& snapshot);
+    static void  snapshot_allocator (stats_snapshot& snapshot);
+    static void  snapshot_event_bus (stats_snapshot& snapshot);
+
+    mutable boost::mutex  mutex;
+    stats_snapshot_ptr    current;
+
+    boost::thread   thread;
+    bool            running;
+    unsigned int    interval_ms;
+    uint64_t        generation;
+
+    // this class is noncopyable
+    stats_cache (const stats_cache&);
+    stats_cache& operator= (const stats_cache&);
+    };
+
+  } // namespace xdpd
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * cxmpie_bufferpool.cc
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "cxmpie_bufferpool.h"
+
+using namespace xdpd::mgmt::protocol;
+
+cxmpie_bufferpool::cxmpie_bufferpool(
+		uint64_t capacity, uint64_t in_use) :
+				cxmpie(XMPIET_BUFFERPOOL, sizeof(struct xmp_ie_bufferpool_t))
+{
+	xmpie_generic = somem();
+	set_capacity(capacity);
+	set_in_use(in_use);
+}
+
+
+cxmpie_bufferpool::cxmpie_bufferpool(
+		uint8_t *buf, size_t buflen) :
+				cxmpie(buf, buflen)
+{
+	xmpie_generic = somem();
+	if (buflen < sizeof(struct xmp_ie_bufferpool_t))
+		throw eXmpIeInval();
+	unpack(buf, buflen);
+}
+
+
+cxmpie_bufferpool::cxmpie_bufferpool(
+		cxmpie_bufferpool const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_bufferpool&
+cxmpie_bufferpool::operator= (
+		cxmpie_bufferpool const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_bufferpool::cxmpie_bufferpool(
+		cxmpie const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_bufferpool&
+cxmpie_bufferpool::operator= (
+		cxmpie const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	if (XMPIET_BUFFERPOOL != elem.get_type())
+		throw eXmpIeInval();
+	if (elem.length() < sizeof(struct xmp_ie_bufferpool_t))
+		throw eXmpIeInval();
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_bufferpool::~cxmpie_bufferpool()
+{
+
+}
+
+
+uint8_t*
+cxmpie_bufferpool::resize(
+		size_t len)
+{
+	return (xmpie_generic = cxmpie::resize(len));
+}
+
+
+size_t
+cxmpie_bufferpool::length() const
+{
+	return sizeof(struct xmp_ie_bufferpool_t);
+}
+
+
+void
+cxmpie_bufferpool::pack(
+		uint8_t *buf, size_t buflen)
+{
+	if (buflen < length())
+		throw eXmpIeInval();
+	cxmpie::pack(buf, length());
+}
+
+
+void
+cxmpie_bufferpool::unpack(
+		uint8_t* buf, size_t buflen)
+{
+	if (buflen < sizeof(struct xmp_ie_bufferpool_t))
+		throw eXmpIeInval();
+	cxmpie::unpack(buf, buflen);
+	xmpie_generic = somem();
+}
+
+
+
+
+
@@ -0,0 +1,154 @@
+/*
+ * cxmpie_bufferpool.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CXMPIE_BUFFERPOOL_H_
+#define CXMPIE_BUFFERPOOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <inttypes.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include "cxmpie.h"
+#include "xdpd_mgmt_protocol.h"
+
+namespace xdpd {
+namespace mgmt {
+namespace protocol {
+
+class cxmpie_bufferpool :
+		public cxmpie
+{
+	union {
+		uint8_t						*xmpu_generic;
+		struct xmp_ie_bufferpool_t		*xmpu_bufferpool;
+	} xmpie_xmpu;
+
+#define xmpie_generic	xmpie_xmpu.xmpu_generic
+#define xmpie_bufferpool	xmpie_xmpu.xmpu_bufferpool
+
+public:
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool(
+			uint64_t capacity = 0, uint64_t in_use = 0);
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool(
+			cxmpie_bufferpool const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool&
+	operator= (
+			cxmpie_bufferpool const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool(
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_bufferpool&
+	operator= (
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	virtual
+	~cxmpie_bufferpool();
+
+public:
+
+	/**
+	 *
+	 */
+	virtual uint8_t*
+	resize(
+			size_t len);
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const;
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	virtual void
+	unpack(
+			uint8_t *buf, size_t buflen);
+
+public:
+
+	/**
+	 *
+	 */
+	uint64_t
+	get_capacity() const { return be64toh(xmpie_bufferpool->capacity); };
+
+	/**
+	 *
+	 */
+	void
+	set_capacity(uint64_t capacity) { xmpie_bufferpool->capacity = htobe64(capacity); };
+
+	/**
+	 *
+	 */
+	uint64_t
+	get_in_use() const { return be64toh(xmpie_bufferpool->in_use); };
+
+	/**
+	 *
+	 */
+	void
+	set_in_use(uint64_t in_use) { xmpie_bufferpool->in_use = htobe64(in_use); };
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, cxmpie_bufferpool const& elem) {
+		os << dynamic_cast<cxmpie const&>( elem );
+		os << rofl::indent(2) << "<cxmpie-bufferpool ";
+			os << "capacity:" << (unsigned long long)elem.get_capacity() << " ";
+			os << "in-use:" << (unsigned long long)elem.get_in_use() << " ";
+		os << ">" << std::endl;
+		return os;
+	};
+};
+
+}; // end of namespace protocol
+}; // end of namespace mgmt
+}; // end of namespace xdpd
+
+#endif /* CXMPIE_BUFFERPOOL_H_ */
@@ -0,0 +1,177 @@
+/*
+ * cxmpie_portstats.cc
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "cxmpie_portstats.h"
+
+using namespace xdpd::mgmt::protocol;
+
+//Byte order conversion of an entry; the same for both directions
+static void
+swap_port(
+		struct xmp_portstats_t& dst, struct xmp_portstats_t const& src, bool to_network)
+{
+	memcpy(dst.portname, src.portname, XMPIE_PORTNAME_SIZE);
+	dst.dpid = (to_network) ? htobe64(src.dpid) : be64toh(src.dpid);
+	dst.rx_packets = (to_network) ? htobe64(src.rx_packets) : be64toh(src.rx_packets);
+	dst.tx_packets = (to_network) ? htobe64(src.tx_packets) : be64toh(src.tx_packets);
+	dst.rx_bytes = (to_network) ? htobe64(src.rx_bytes) : be64toh(src.rx_bytes);
+	dst.tx_bytes = (to_network) ? htobe64(src.tx_bytes) : be64toh(src.tx_bytes);
+	dst.rx_dropped = (to_network) ? htobe64(src.rx_dropped) : be64toh(src.rx_dropped);
+	dst.tx_dropped = (to_network) ? htobe64(src.tx_dropped) : be64toh(src.tx_dropped);
+	dst.rx_errors = (to_network) ? htobe64(src.rx_errors) : be64toh(src.rx_errors);
+	dst.tx_errors = (to_network) ? htobe64(src.tx_errors) : be64toh(src.tx_errors);
+	dst.rx_frame_err = (to_network) ? htobe64(src.rx_frame_err) : be64toh(src.rx_frame_err);
+	dst.rx_over_err = (to_network) ? htobe64(src.rx_over_err) : be64toh(src.rx_over_err);
+	dst.rx_crc_err = (to_network) ? htobe64(src.rx_crc_err) : be64toh(src.rx_crc_err);
+	dst.collisions = (to_network) ? htobe64(src.collisions) : be64toh(src.collisions);
+	dst.of_port_num = (to_network) ? htobe32(src.of_port_num) : be32toh(src.of_port_num);
+	dst.flags = (to_network) ? htobe32(src.flags) : be32toh(src.flags);
+}
+
+
+cxmpie_portstats::cxmpie_portstats() :
+				cxmpie(XMPIET_PORTSTATS, sizeof(struct xmp_ie_portstats_t))
+{
+	xmpie_generic = somem();
+}
+
+
+cxmpie_portstats::cxmpie_portstats(
+		uint8_t *buf, size_t buflen) :
+				cxmpie(buf, buflen)
+{
+	xmpie_generic = somem();
+	if (buflen < sizeof(struct xmp_ie_portstats_t))
+		throw eXmpIeInval();
+	unpack(buf, buflen);
+}
+
+
+cxmpie_portstats::cxmpie_portstats(
+		cxmpie_portstats const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_portstats&
+cxmpie_portstats::operator= (
+		cxmpie_portstats const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_portstats::cxmpie_portstats(
+		cxmpie const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_portstats&
+cxmpie_portstats::operator= (
+		cxmpie const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	if (XMPIET_PORTSTATS != elem.get_type())
+		throw eXmpIeInval();
+	if (elem.length() < sizeof(struct xmp_ie_portstats_t))
+		throw eXmpIeInval();
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_portstats::~cxmpie_portstats()
+{
+
+}
+
+
+uint8_t*
+cxmpie_portstats::resize(
+		size_t len)
+{
+	return (xmpie_generic = cxmpie::resize(len));
+}
+
+
+size_t
+cxmpie_portstats::length() const
+{
+	return sizeof(struct xmp_ie_portstats_t) + get_num_of_ports() * sizeof(struct xmp_portstats_t);
+}
+
+
+void
+cxmpie_portstats::pack(
+		uint8_t *buf, size_t buflen)
+{
+	if (buflen < length())
+		throw eXmpIeInval();
+	cxmpie::pack(buf, length());
+}
+
+
+void
+cxmpie_portstats::unpack(
+		uint8_t* buf, size_t buflen)
+{
+	if (buflen < sizeof(struct xmp_ie_portstats_t))
+		throw eXmpIeInval();
+	cxmpie::unpack(buf, buflen);
+	xmpie_generic = somem();
+}
+
+
+unsigned int
+cxmpie_portstats::get_num_of_ports() const
+{
+	return (cxmpie::length() - sizeof(struct xmp_ie_portstats_t)) / sizeof(struct xmp_portstats_t);
+}
+
+
+struct xmp_portstats_t
+cxmpie_portstats::get_port(
+		unsigned int index) const
+{
+	struct xmp_portstats_t port;
+
+	if (index >= get_num_of_ports())
+		throw eXmpIeInval();
+
+	swap_port(port, xmpie_portstats->ports[index], false);
+
+	return port;
+}
+
+
+void
+cxmpie_portstats::add_port(
+		struct xmp_portstats_t const& port)
+{
+	unsigned int index = get_num_of_ports();
+
+	resize(sizeof(struct xmp_ie_portstats_t) + (index + 1) * sizeof(struct xmp_portstats_t));
+	swap_port(xmpie_portstats->ports[index], port, true);
+	set_length(length());
+}
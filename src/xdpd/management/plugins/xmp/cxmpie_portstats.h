@@ -0,0 +1,159 @@
+/*
+ * cxmpie_portstats.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CXMPIE_PORTSTATS_H_
+#define CXMPIE_PORTSTATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <inttypes.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include "cxmpie.h"
+#include "xdpd_mgmt_protocol.h"
+
+namespace xdpd {
+namespace mgmt {
+namespace protocol {
+
+/**
+ * List of xmp_portstats_t (port counters); entries are in host byte order
+ * for the users of this class
+ */
+class cxmpie_portstats :
+		public cxmpie
+{
+	union {
+		uint8_t						*xmpu_generic;
+		struct xmp_ie_portstats_t		*xmpu_portstats;
+	} xmpie_xmpu;
+
+#define xmpie_generic	xmpie_xmpu.xmpu_generic
+#define xmpie_portstats	xmpie_xmpu.xmpu_portstats
+
+public:
+
+	/**
+	 *
+	 */
+	cxmpie_portstats();
+
+	/**
+	 *
+	 */
+	cxmpie_portstats(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	cxmpie_portstats(
+			cxmpie_portstats const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_portstats&
+	operator= (
+			cxmpie_portstats const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_portstats(
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_portstats&
+	operator= (
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	virtual
+	~cxmpie_portstats();
+
+public:
+
+	/**
+	 *
+	 */
+	virtual uint8_t*
+	resize(
+			size_t len);
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const;
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	virtual void
+	unpack(
+			uint8_t *buf, size_t buflen);
+
+public:
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_of_ports() const;
+
+	/**
+	 *
+	 */
+	struct xmp_portstats_t
+	get_port(unsigned int index) const;
+
+	/**
+	 *
+	 */
+	void
+	add_port(struct xmp_portstats_t const& port);
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, cxmpie_portstats const& elem) {
+		os << dynamic_cast<cxmpie const&>( elem );
+		os << rofl::indent(2) << "<cxmpie-portstats #ports:" << elem.get_num_of_ports() << " >" << std::endl;
+		for (unsigned int i = 0; i < elem.get_num_of_ports(); i++) {
+			struct xmp_portstats_t port = elem.get_port(i);
+			os << rofl::indent(4) << "<port " << std::string(port.portname, strnlen(port.portname, XMPIE_PORTNAME_SIZE)) << " ";
+			if (port.flags & XMP_PORTSTATS_ATTACHED)
+				os << "dpid:" << (unsigned long long)port.dpid << " port-no:" << port.of_port_num << " ";
+			os << "rx-pkts:" << (unsigned long long)port.rx_packets << " tx-pkts:" << (unsigned long long)port.tx_packets << " ";
+			os << "rx-bytes:" << (unsigned long long)port.rx_bytes << " tx-bytes:" << (unsigned long long)port.tx_bytes << " ";
+			os << "rx-drops:" << (unsigned long long)port.rx_dropped << " tx-drops:" << (unsigned long long)port.tx_dropped << " ";
+			os << "rx-errs:" << (unsigned long long)port.rx_errors << " tx-errs:" << (unsigned long long)port.tx_errors << " ";
+			os << ">" << std::endl;
+		}
+		return os;
+	};
+};
+
+}; // end of namespace protocol
+}; // end of namespace mgmt
+}; // end of namespace xdpd
+
+#endif /* CXMPIE_PORTSTATS_H_ */
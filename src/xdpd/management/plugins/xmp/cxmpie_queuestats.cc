@@ -0,0 +1,167 @@
+/*
+ * cxmpie_queuestats.cc
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "cxmpie_queuestats.h"
+
+using namespace xdpd::mgmt::protocol;
+
+//Byte order conversion of an entry; the same for both directions
+static void
+swap_queue(
+		struct xmp_queuestats_t& dst, struct xmp_queuestats_t const& src, bool to_network)
+{
+	memcpy(dst.portname, src.portname, XMPIE_PORTNAME_SIZE);
+	dst.tx_packets = (to_network) ? htobe64(src.tx_packets) : be64toh(src.tx_packets);
+	dst.tx_bytes = (to_network) ? htobe64(src.tx_bytes) : be64toh(src.tx_bytes);
+	dst.overrun = (to_network) ? htobe64(src.overrun) : be64toh(src.overrun);
+	dst.queue_id = (to_network) ? htobe32(src.queue_id) : be32toh(src.queue_id);
+	dst.pad = (to_network) ? htobe32(src.pad) : be32toh(src.pad);
+}
+
+
+cxmpie_queuestats::cxmpie_queuestats() :
+				cxmpie(XMPIET_QUEUESTATS, sizeof(struct xmp_ie_queuestats_t))
+{
+	xmpie_generic = somem();
+}
+
+
+cxmpie_queuestats::cxmpie_queuestats(
+		uint8_t *buf, size_t buflen) :
+				cxmpie(buf, buflen)
+{
+	xmpie_generic = somem();
+	if (buflen < sizeof(struct xmp_ie_queuestats_t))
+		throw eXmpIeInval();
+	unpack(buf, buflen);
+}
+
+
+cxmpie_queuestats::cxmpie_queuestats(
+		cxmpie_queuestats const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_queuestats&
+cxmpie_queuestats::operator= (
+		cxmpie_queuestats const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_queuestats::cxmpie_queuestats(
+		cxmpie const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_queuestats&
+cxmpie_queuestats::operator= (
+		cxmpie const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	if (XMPIET_QUEUESTATS != elem.get_type())
+		throw eXmpIeInval();
+	if (elem.length() < sizeof(struct xmp_ie_queuestats_t))
+		throw eXmpIeInval();
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_queuestats::~cxmpie_queuestats()
+{
+
+}
+
+
+uint8_t*
+cxmpie_queuestats::resize(
+		size_t len)
+{
+	return (xmpie_generic = cxmpie::resize(len));
+}
+
+
+size_t
+cxmpie_queuestats::length() const
+{
+	return sizeof(struct xmp_ie_queuestats_t) + get_num_of_queues() * sizeof(struct xmp_queuestats_t);
+}
+
+
+void
+cxmpie_queuestats::pack(
+		uint8_t *buf, size_t buflen)
+{
+	if (buflen < length())
+		throw eXmpIeInval();
+	cxmpie::pack(buf, length());
+}
+
+
+void
+cxmpie_queuestats::unpack(
+		uint8_t* buf, size_t buflen)
+{
+	if (buflen < sizeof(struct xmp_ie_queuestats_t))
+		throw eXmpIeInval();
+	cxmpie::unpack(buf, buflen);
+	xmpie_generic = somem();
+}
+
+
+unsigned int
+cxmpie_queuestats::get_num_of_queues() const
+{
+	return (cxmpie::length() - sizeof(struct xmp_ie_queuestats_t)) / sizeof(struct xmp_queuestats_t);
+}
+
+
+struct xmp_queuestats_t
+cxmpie_queuestats::get_queue(
+		unsigned int index) const
+{
+	struct xmp_queuestats_t queue;
+
+	if (index >= get_num_of_queues())
+		throw eXmpIeInval();
+
+	swap_queue(queue, xmpie_queuestats->queues[index], false);
+
+	return queue;
+}
+
+
+void
+cxmpie_queuestats::add_queue(
+		struct xmp_queuestats_t const& queue)
+{
+	unsigned int index = get_num_of_queues();
+
+	resize(sizeof(struct xmp_ie_queuestats_t) + (index + 1) * sizeof(struct xmp_queuestats_t));
+	swap_queue(xmpie_queuestats->queues[index], queue, true);
+	set_length(length());
+}
@@ -0,0 +1,155 @@
+/*
+ * cxmpie_queuestats.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CXMPIE_QUEUESTATS_H_
+#define CXMPIE_QUEUESTATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <inttypes.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include "cxmpie.h"
+#include "xdpd_mgmt_protocol.h"
+
+namespace xdpd {
+namespace mgmt {
+namespace protocol {
+
+/**
+ * List of xmp_queuestats_t (output queue counters); entries are in host byte order
+ * for the users of this class
+ */
+class cxmpie_queuestats :
+		public cxmpie
+{
+	union {
+		uint8_t						*xmpu_generic;
+		struct xmp_ie_queuestats_t		*xmpu_queuestats;
+	} xmpie_xmpu;
+
+#define xmpie_generic	xmpie_xmpu.xmpu_generic
+#define xmpie_queuestats	xmpie_xmpu.xmpu_queuestats
+
+public:
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats();
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats(
+			cxmpie_queuestats const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats&
+	operator= (
+			cxmpie_queuestats const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats(
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_queuestats&
+	operator= (
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	virtual
+	~cxmpie_queuestats();
+
+public:
+
+	/**
+	 *
+	 */
+	virtual uint8_t*
+	resize(
+			size_t len);
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const;
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	virtual void
+	unpack(
+			uint8_t *buf, size_t buflen);
+
+public:
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_of_queues() const;
+
+	/**
+	 *
+	 */
+	struct xmp_queuestats_t
+	get_queue(unsigned int index) const;
+
+	/**
+	 *
+	 */
+	void
+	add_queue(struct xmp_queuestats_t const& queue);
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, cxmpie_queuestats const& elem) {
+		os << dynamic_cast<cxmpie const&>( elem );
+		os << rofl::indent(2) << "<cxmpie-queuestats #queues:" << elem.get_num_of_queues() << " >" << std::endl;
+		for (unsigned int i = 0; i < elem.get_num_of_queues(); i++) {
+			struct xmp_queuestats_t queue = elem.get_queue(i);
+			os << rofl::indent(4) << "<queue " << std::string(queue.portname, strnlen(queue.portname, XMPIE_PORTNAME_SIZE)) << "/" << queue.queue_id << " ";
+			os << "tx-pkts:" << (unsigned long long)queue.tx_packets << " tx-bytes:" << (unsigned long long)queue.tx_bytes << " ";
+			os << "overrun:" << (unsigned long long)queue.overrun << " ";
+			os << ">" << std::endl;
+		}
+		return os;
+	};
+};
+
+}; // end of namespace protocol
+}; // end of namespace mgmt
+}; // end of namespace xdpd
+
+#endif /* CXMPIE_QUEUESTATS_H_ */
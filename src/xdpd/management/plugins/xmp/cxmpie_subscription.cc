@@ -0,0 +1,127 @@
+/*
+ * cxmpie_subscription.cc
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "cxmpie_subscription.h"
+
+using namespace xdpd::mgmt::protocol;
+
+cxmpie_subscription::cxmpie_subscription(
+		uint32_t interval, uint32_t duration) :
+				cxmpie(XMPIET_SUBSCRIPTION, sizeof(struct xmp_ie_subscription_t))
+{
+	xmpie_generic = somem();
+	set_interval(interval);
+	set_duration(duration);
+}
+
+
+cxmpie_subscription::cxmpie_subscription(
+		uint8_t *buf, size_t buflen) :
+				cxmpie(buf, buflen)
+{
+	xmpie_generic = somem();
+	if (buflen < sizeof(struct xmp_ie_subscription_t))
+		throw eXmpIeInval();
+	unpack(buf, buflen);
+}
+
+
+cxmpie_subscription::cxmpie_subscription(
+		cxmpie_subscription const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_subscription&
+cxmpie_subscription::operator= (
+		cxmpie_subscription const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_subscription::cxmpie_subscription(
+		cxmpie const& elem) :
+				cxmpie(elem)
+{
+	*this = elem;
+}
+
+
+cxmpie_subscription&
+cxmpie_subscription::operator= (
+		cxmpie const& elem)
+{
+	if (this == &elem)
+		return *this;
+
+	if (XMPIET_SUBSCRIPTION != elem.get_type())
+		throw eXmpIeInval();
+	if (elem.length() < sizeof(struct xmp_ie_subscription_t))
+		throw eXmpIeInval();
+
+	cxmpie::operator= (elem);
+
+	xmpie_generic = somem();
+
+	return *this;
+}
+
+
+cxmpie_subscription::~cxmpie_subscription()
+{
+
+}
+
+
+uint8_t*
+cxmpie_subscription::resize(
+		size_t len)
+{
+	return (xmpie_generic = cxmpie::resize(len));
+}
+
+
+size_t
+cxmpie_subscription::length() const
+{
+	return sizeof(struct xmp_ie_subscription_t);
+}
+
+
+void
+cxmpie_subscription::pack(
+		uint8_t *buf, size_t buflen)
+{
+	if (buflen < length())
+		throw eXmpIeInval();
+	cxmpie::pack(buf, length());
+}
+
+
+void
+cxmpie_subscription::unpack(
+		uint8_t* buf, size_t buflen)
+{
+	if (buflen < sizeof(struct xmp_ie_subscription_t))
+		throw eXmpIeInval();
+	cxmpie::unpack(buf, buflen);
+	xmpie_generic = somem();
+}
+
+
+
+
+
@@ -0,0 +1,154 @@
+/*
+ * cxmpie_subscription.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CXMPIE_SUBSCRIPTION_H_
+#define CXMPIE_SUBSCRIPTION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <inttypes.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include "cxmpie.h"
+#include "xdpd_mgmt_protocol.h"
+
+namespace xdpd {
+namespace mgmt {
+namespace protocol {
+
+class cxmpie_subscription :
+		public cxmpie
+{
+	union {
+		uint8_t						*xmpu_generic;
+		struct xmp_ie_subscription_t	*xmpu_subscription;
+	} xmpie_xmpu;
+
+#define xmpie_generic	xmpie_xmpu.xmpu_generic
+#define xmpie_subscription	xmpie_xmpu.xmpu_subscription
+
+public:
+
+	/**
+	 *
+	 */
+	cxmpie_subscription(
+			uint32_t interval = 0, uint32_t duration = 0);
+
+	/**
+	 *
+	 */
+	cxmpie_subscription(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	cxmpie_subscription(
+			cxmpie_subscription const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_subscription&
+	operator= (
+			cxmpie_subscription const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_subscription(
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	cxmpie_subscription&
+	operator= (
+			cxmpie const& elem);
+
+	/**
+	 *
+	 */
+	virtual
+	~cxmpie_subscription();
+
+public:
+
+	/**
+	 *
+	 */
+	virtual uint8_t*
+	resize(
+			size_t len);
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const;
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf, size_t buflen);
+
+	/**
+	 *
+	 */
+	virtual void
+	unpack(
+			uint8_t *buf, size_t buflen);
+
+public:
+
+	/**
+	 *
+	 */
+	uint32_t
+	get_interval() const { return be32toh(xmpie_subscription->interval); };
+
+	/**
+	 *
+	 */
+	void
+	set_interval(uint32_t interval) { xmpie_subscription->interval = htobe32(interval); };
+
+	/**
+	 *
+	 */
+	uint32_t
+	get_duration() const { return be32toh(xmpie_subscription->duration); };
+
+	/**
+	 *
+	 */
+	void
+	set_duration(uint32_t duration) { xmpie_subscription->duration = htobe32(duration); };
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, cxmpie_subscription const& elem) {
+		os << dynamic_cast<cxmpie const&>( elem );
+		os << rofl::indent(2) << "<cxmpie-subscription ";
+			os << "interval:" << elem.get_interval() << "s ";
+			os << "duration:" << elem.get_duration() << "s ";
+		os << ">" << std::endl;
+		return os;
+	};
+};
+
+}; // end of namespace protocol
+}; // end of namespace mgmt
+}; // end of namespace xdpd
+
+#endif /* CXMPIE_SUBSCRIPTION_H_ */
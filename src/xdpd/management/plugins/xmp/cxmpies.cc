@@ -129,6 +129,18 @@ cxmpies::map_and_insert(
 	case XMPIET_DPID: {
 		xmpmap[XMPIET_DPID] = new cxmpie_dpid(xmpie);
 	} break;
+	case XMPIET_PORTSTATS: {
+		xmpmap[XMPIET_PORTSTATS] = new cxmpie_portstats(xmpie);
+	} break;
+	case XMPIET_QUEUESTATS: {
+		xmpmap[XMPIET_QUEUESTATS] = new cxmpie_queuestats(xmpie);
+	} break;
+	case XMPIET_BUFFERPOOL: {
+		xmpmap[XMPIET_BUFFERPOOL] = new cxmpie_bufferpool(xmpie);
+	} break;
+	case XMPIET_SUBSCRIPTION: {
+		xmpmap[XMPIET_SUBSCRIPTION] = new cxmpie_subscription(xmpie);
+	} break;
 	default: {
 		xmpmap[xmpie.get_type()] = new cxmpie(xmpie);
 	};
@@ -283,3 +295,199 @@ cxmpies::has_ie_dpid() const
 }
 
 
+cxmpie_portstats&
+cxmpies::add_ie_portstats()
+{
+	if (xmpmap.find(XMPIET_PORTSTATS) != xmpmap.end()) {
+		delete xmpmap[XMPIET_PORTSTATS];
+	}
+	xmpmap[XMPIET_PORTSTATS] = new cxmpie_portstats();
+	return *(dynamic_cast<cxmpie_portstats*>( xmpmap[XMPIET_PORTSTATS] ));
+}
+
+
+cxmpie_portstats&
+cxmpies::set_ie_portstats()
+{
+	if (xmpmap.find(XMPIET_PORTSTATS) == xmpmap.end()) {
+		xmpmap[XMPIET_PORTSTATS] = new cxmpie_portstats();
+	}
+	return *(dynamic_cast<cxmpie_portstats*>( xmpmap[XMPIET_PORTSTATS] ));
+}
+
+
+cxmpie_portstats const&
+cxmpies::get_ie_portstats() const
+{
+	if (xmpmap.find(XMPIET_PORTSTATS) == xmpmap.end()) {
+		throw eXmpIEsNotFound();
+	}
+	return *(dynamic_cast<cxmpie_portstats const*>( xmpmap.at(XMPIET_PORTSTATS) ));
+}
+
+
+void
+cxmpies::drop_ie_portstats()
+{
+	if (xmpmap.find(XMPIET_PORTSTATS) == xmpmap.end()) {
+		return;
+	}
+	delete xmpmap[XMPIET_PORTSTATS];
+	xmpmap.erase(XMPIET_PORTSTATS);
+}
+
+
+bool
+cxmpies::has_ie_portstats() const
+{
+	return (xmpmap.find(XMPIET_PORTSTATS) != xmpmap.end());
+}
+
+
+cxmpie_queuestats&
+cxmpies::add_ie_queuestats()
+{
+	if (xmpmap.find(XMPIET_QUEUESTATS) != xmpmap.end()) {
+		delete xmpmap[XMPIET_QUEUESTATS];
+	}
+	xmpmap[XMPIET_QUEUESTATS] = new cxmpie_queuestats();
+	return *(dynamic_cast<cxmpie_queuestats*>( xmpmap[XMPIET_QUEUESTATS] ));
+}
+
+
+cxmpie_queuestats&
+cxmpies::set_ie_queuestats()
+{
+	if (xmpmap.find(XMPIET_QUEUESTATS) == xmpmap.end()) {
+		xmpmap[XMPIET_QUEUESTATS] = new cxmpie_queuestats();
+	}
+	return *(dynamic_cast<cxmpie_queuestats*>( xmpmap[XMPIET_QUEUESTATS] ));
+}
+
+
+cxmpie_queuestats const&
+cxmpies::get_ie_queuestats() const
+{
+	if (xmpmap.find(XMPIET_QUEUESTATS) == xmpmap.end()) {
+		throw eXmpIEsNotFound();
+	}
+	return *(dynamic_cast<cxmpie_queuestats const*>( xmpmap.at(XMPIET_QUEUESTATS) ));
+}
+
+
+void
+cxmpies::drop_ie_queuestats()
+{
+	if (xmpmap.find(XMPIET_QUEUESTATS) == xmpmap.end()) {
+		return;
+	}
+	delete xmpmap[XMPIET_QUEUESTATS];
+	xmpmap.erase(XMPIET_QUEUESTATS);
+}
+
+
+bool
+cxmpies::has_ie_queuestats() const
+{
+	return (xmpmap.find(XMPIET_QUEUESTATS) != xmpmap.end());
+}
+
+
+cxmpie_bufferpool&
+cxmpies::add_ie_bufferpool()
+{
+	if (xmpmap.find(XMPIET_BUFFERPOOL) != xmpmap.end()) {
+		delete xmpmap[XMPIET_BUFFERPOOL];
+	}
+	xmpmap[XMPIET_BUFFERPOOL] = new cxmpie_bufferpool();
+	return *(dynamic_cast<cxmpie_bufferpool*>( xmpmap[XMPIET_BUFFERPOOL] ));
+}
+
+
+cxmpie_bufferpool&
+cxmpies::set_ie_bufferpool()
+{
+	if (xmpmap.find(XMPIET_BUFFERPOOL) == xmpmap.end()) {
+		xmpmap[XMPIET_BUFFERPOOL] = new cxmpie_bufferpool();
+	}
+	return *(dynamic_cast<cxmpie_bufferpool*>( xmpmap[XMPIET_BUFFERPOOL] ));
+}
+
+
+cxmpie_bufferpool const&
+cxmpies::get_ie_bufferpool() const
+{
+	if (xmpmap.find(XMPIET_BUFFERPOOL) == xmpmap.end()) {
+		throw eXmpIEsNotFound();
+	}
+	return *(dynamic_cast<cxmpie_bufferpool const*>( xmpmap.at(XMPIET_BUFFERPOOL) ));
+}
+
+
+void
+cxmpies::drop_ie_bufferpool()
+{
+	if (xmpmap.find(XMPIET_BUFFERPOOL) == xmpmap.end()) {
+		return;
+	}
+	delete xmpmap[XMPIET_BUFFERPOOL];
+	xmpmap.erase(XMPIET_BUFFERPOOL);
+}
+
+
+bool
+cxmpies::has_ie_bufferpool() const
+{
+	return (xmpmap.find(XMPIET_BUFFERPOOL) != xmpmap.end());
+}
+
+
+cxmpie_subscription&
+cxmpies::add_ie_subscription()
+{
+	if (xmpmap.find(XMPIET_SUBSCRIPTION) != xmpmap.end()) {
+		delete xmpmap[XMPIET_SUBSCRIPTION];
+	}
+	xmpmap[XMPIET_SUBSCRIPTION] = new cxmpie_subscription();
+	return *(dynamic_cast<cxmpie_subscription*>( xmpmap[XMPIET_SUBSCRIPTION] ));
+}
+
+
+cxmpie_subscription&
+cxmpies::set_ie_subscription()
+{
+	if (xmpmap.find(XMPIET_SUBSCRIPTION) == xmpmap.end()) {
+		xmpmap[XMPIET_SUBSCRIPTION] = new cxmpie_subscription();
+	}
+	return *(dynamic_cast<cxmpie_subscription*>( xmpmap[XMPIET_SUBSCRIPTION] ));
+}
+
+
+cxmpie_subscription const&
+cxmpies::get_ie_subscription() const
+{
+	if (xmpmap.find(XMPIET_SUBSCRIPTION) == xmpmap.end()) {
+		throw eXmpIEsNotFound();
+	}
+	return *(dynamic_cast<cxmpie_subscription const*>( xmpmap.at(XMPIET_SUBSCRIPTION) ));
+}
+
+
+void
+cxmpies::drop_ie_subscription()
+{
+	if (xmpmap.find(XMPIET_SUBSCRIPTION) == xmpmap.end()) {
+		return;
+	}
+	delete xmpmap[XMPIET_SUBSCRIPTION];
+	xmpmap.erase(XMPIET_SUBSCRIPTION);
+}
+
+
+bool
+cxmpies::has_ie_subscription() const
+{
+	return (xmpmap.find(XMPIET_SUBSCRIPTION) != xmpmap.end());
+}
+
+
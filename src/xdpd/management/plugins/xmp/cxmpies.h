@@ -22,6 +22,10 @@ extern "C" {
 #include "cxmpie_command.h"
 #include "cxmpie_portname.h"
 #include "cxmpie_dpid.h"
+#include "cxmpie_portstats.h"
+#include "cxmpie_queuestats.h"
+#include "cxmpie_bufferpool.h"
+#include "cxmpie_subscription.h"
 #include "xdpd_mgmt_protocol.h"
 #include "rofl/common/croflexception.h"
 
@@ -176,6 +180,82 @@ public:
 	bool
 	has_ie_dpid() const;
 
+	/*
+	 * information element: portstats
+	 */
+
+	cxmpie_portstats&
+	add_ie_portstats();
+
+	cxmpie_portstats&
+	set_ie_portstats();
+
+	cxmpie_portstats const&
+	get_ie_portstats() const;
+
+	void
+	drop_ie_portstats();
+
+	bool
+	has_ie_portstats() const;
+
+	/*
+	 * information element: queuestats
+	 */
+
+	cxmpie_queuestats&
+	add_ie_queuestats();
+
+	cxmpie_queuestats&
+	set_ie_queuestats();
+
+	cxmpie_queuestats const&
+	get_ie_queuestats() const;
+
+	void
+	drop_ie_queuestats();
+
+	bool
+	has_ie_queuestats() const;
+
+	/*
+	 * information element: bufferpool
+	 */
+
+	cxmpie_bufferpool&
+	add_ie_bufferpool();
+
+	cxmpie_bufferpool&
+	set_ie_bufferpool();
+
+	cxmpie_bufferpool const&
+	get_ie_bufferpool() const;
+
+	void
+	drop_ie_bufferpool();
+
+	bool
+	has_ie_bufferpool() const;
+
+	/*
+	 * information element: subscription
+	 */
+
+	cxmpie_subscription&
+	add_ie_subscription();
+
+	cxmpie_subscription&
+	set_ie_subscription();
+
+	cxmpie_subscription const&
+	get_ie_subscription() const;
+
+	void
+	drop_ie_subscription();
+
+	bool
+	has_ie_subscription() const;
+
 private:
 
 	/**
@@ -206,6 +286,18 @@ public:
 			case XMPIET_DPID: {
 				os << "  " << dynamic_cast<cxmpie_dpid const&>( *(it->second) );
 			} break;
+			case XMPIET_PORTSTATS: {
+				os << "  " << dynamic_cast<cxmpie_portstats const&>( *(it->second) );
+			} break;
+			case XMPIET_QUEUESTATS: {
+				os << "  " << dynamic_cast<cxmpie_queuestats const&>( *(it->second) );
+			} break;
+			case XMPIET_BUFFERPOOL: {
+				os << "  " << dynamic_cast<cxmpie_bufferpool const&>( *(it->second) );
+			} break;
+			case XMPIET_SUBSCRIPTION: {
+				os << "  " << dynamic_cast<cxmpie_subscription const&>( *(it->second) );
+			} break;
 			default: {
 				os << "  " << *(it->second);
 			};
@@ -7,6 +7,10 @@
 
 #include "cxmpclient.h"
 
+#include <errno.h>
+#include <string.h>
+#include <iostream>
+
 using namespace xdpd::mgmt::protocol;
 
 cxmpclient::cxmpclient() :
@@ -135,3 +139,123 @@ cxmpclient::port_disable(
 }
 
 
+void
+cxmpclient::config_reload()
+{
+	cxmpmsg msg(XMP_VERSION, XMPT_REQUEST);
+
+	msg.get_xmpies().add_ie_command().set_command(XMPIEMCT_CONFIG_RELOAD);
+
+	std::cerr << "[xmpclient] sending Config-Reload request:" << std::endl << msg;
+
+	rofl::cmemory *mem = new rofl::cmemory(msg.length());
+
+	msg.pack(mem->somem(), mem->memlen());
+
+	socket->send(mem, raddr);
+
+	register_timer(TIMER_XMPCLNT_EXIT, 1);
+}
+
+
+
+void
+cxmpclient::handle_read(
+		rofl::csocket& socket)
+{
+	rofl::cmemory mem(65536);
+
+	int nbytes = socket.recv(mem.somem(), mem.memlen());
+
+	if (nbytes <= 0) {
+		std::cerr << "[xmpclient] reading xmp socket failed, errno:" << errno << " (" << strerror(errno) << ")" << std::endl;
+		return;
+	}
+
+	if ((unsigned int)nbytes < sizeof(struct xmp_header_t)) {
+		std::cerr << "[xmpclient] short packet rcvd, rc:" << nbytes << std::endl;
+		return;
+	}
+
+	cxmpmsg msg(mem.somem(), nbytes);
+
+	std::cout << msg;
+}
+
+
+void
+cxmpclient::send_request(
+		cxmpmsg& msg, bool wait_for_exit)
+{
+	rofl::cmemory *mem = new rofl::cmemory(msg.length());
+
+	msg.pack(mem->somem(), mem->memlen());
+
+	socket->send(mem, raddr);
+
+	if (wait_for_exit)
+		register_timer(TIMER_XMPCLNT_EXIT, 1);
+}
+
+
+void
+cxmpclient::stats_ports(
+		bool has_dpid, uint64_t dpid)
+{
+	cxmpmsg msg(XMP_VERSION, XMPT_REQUEST);
+
+	msg.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_PORTS);
+	if (has_dpid)
+		msg.get_xmpies().add_ie_dpid().set_dpid(dpid);
+
+	std::cerr << "[xmpclient] sending Stats-Ports request:" << std::endl << msg;
+
+	send_request(msg);
+}
+
+
+void
+cxmpclient::stats_queues(
+		std::string const& portname)
+{
+	cxmpmsg msg(XMP_VERSION, XMPT_REQUEST);
+
+	msg.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_QUEUES);
+	if (not portname.empty())
+		msg.get_xmpies().add_ie_portname().set_portname(portname);
+
+	std::cerr << "[xmpclient] sending Stats-Queues request:" << std::endl << msg;
+
+	send_request(msg);
+}
+
+
+void
+cxmpclient::stats_bufferpool()
+{
+	cxmpmsg msg(XMP_VERSION, XMPT_REQUEST);
+
+	msg.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_BUFFERPOOL);
+
+	std::cerr << "[xmpclient] sending Stats-Bufferpool request:" << std::endl << msg;
+
+	send_request(msg);
+}
+
+
+void
+cxmpclient::stats_subscribe(
+		uint32_t interval, uint32_t duration, bool has_dpid, uint64_t dpid)
+{
+	cxmpmsg msg(XMP_VERSION, XMPT_REQUEST);
+
+	msg.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_SUBSCRIBE);
+	msg.get_xmpies().add_ie_subscription().set_interval(interval);
+	msg.get_xmpies().set_ie_subscription().set_duration(duration);
+	if (has_dpid)
+		msg.get_xmpies().add_ie_dpid().set_dpid(dpid);
+
+	std::cerr << "[xmpclient] sending Stats-Subscribe request:" << std::endl << msg;
+
+	send_request(msg, false);
+}
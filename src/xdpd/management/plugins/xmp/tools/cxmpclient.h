@@ -51,6 +51,10 @@ public:
 	virtual
 	~cxmpclient();
 
+	void
+	send_request(
+			cxmpmsg& msg, bool wait_for_exit = true);
+
 public:
 
 	/**
@@ -81,6 +85,39 @@ public:
 	port_disable(
 			std::string const& portname);
 
+	/**
+	 *
+	 */
+	void
+	config_reload();
+
+	/**
+	 * all ports (has_dpid false) or only the ones of an LSI
+	 */
+	void
+	stats_ports(
+			bool has_dpid, uint64_t dpid);
+
+	/**
+	 * all queues or only the ones of a port (portname not empty)
+	 */
+	void
+	stats_queues(
+			std::string const& portname);
+
+	/**
+	 *
+	 */
+	void
+	stats_bufferpool();
+
+	/**
+	 * notifications are printed until the client is stopped
+	 */
+	void
+	stats_subscribe(
+			uint32_t interval, uint32_t duration, bool has_dpid, uint64_t dpid);
+
 protected:
 
 	virtual void
@@ -107,7 +144,7 @@ protected:
 	handle_write(rofl::csocket& socket) {};
 
 	virtual void
-	handle_read(rofl::csocket& socket) {};
+	handle_read(rofl::csocket& socket);
 
 	virtual void
 	handle_closed(rofl::csocket& socket) {};
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <stdlib.h>
 
 #include <string>
 
@@ -35,6 +36,32 @@ main(int argc, char** argv)
 		} else {
 
 		}
+	} else if ((argc >= 2) && (std::string(argv[1]) == std::string("config"))) {
+
+		// xmpclient config reload
+		if ((argc >= 3) && (std::string(argv[2]) == std::string("reload"))) {
+			xmpclient.config_reload();
+		}
+	} else if ((argc >= 2) && (std::string(argv[1]) == std::string("stats"))) {
+
+		// xmpclient stats ports [<dpid>]
+		if ((argc >= 3) && (std::string(argv[2]) == std::string("ports"))) {
+			xmpclient.stats_ports((argc >= 4), (argc >= 4) ? strtoull(argv[3], NULL, 0) : 0);
+
+		// xmpclient stats queues [<portname>]
+		} else if ((argc >= 3) && (std::string(argv[2]) == std::string("queues"))) {
+			xmpclient.stats_queues((argc >= 4) ? std::string(argv[3]) : std::string(""));
+
+		// xmpclient stats bufferpool
+		} else if ((argc >= 3) && (std::string(argv[2]) == std::string("bufferpool"))) {
+			xmpclient.stats_bufferpool();
+
+		// xmpclient stats subscribe <interval> [<duration> [<dpid>]]
+		} else if ((argc >= 3) && (std::string(argv[2]) == std::string("subscribe"))) {
+			assert(argc >= 4);
+			xmpclient.stats_subscribe(atoi(argv[3]), (argc >= 5) ? atoi(argv[4]) : 0,
+					(argc >= 6), (argc >= 6) ? strtoull(argv[5], NULL, 0) : 0);
+		}
 	} else {
 
 	}
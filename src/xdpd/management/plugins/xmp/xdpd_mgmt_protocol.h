@@ -32,6 +32,12 @@ enum xmpie_command_t {
 	XMPIEMCT_PORT_DETACH		= 2,
 	XMPIEMCT_PORT_ENABLE		= 3,
 	XMPIEMCT_PORT_DISABLE		= 4,
+	XMPIEMCT_CONFIG_RELOAD		= 5,
+	XMPIEMCT_STATS_PORTS		= 6,	// optional DPID IE: only the ports of the LSI
+	XMPIEMCT_STATS_QUEUES		= 7,	// optional DPID or PORTNAME IE
+	XMPIEMCT_STATS_BUFFERPOOL	= 8,
+	XMPIEMCT_STATS_SUBSCRIBE	= 9,	// SUBSCRIPTION IE, optional DPID IE
+	XMPIEMCT_STATS_UNSUBSCRIBE	= 10,
 };
 
 struct xmp_header_t {
@@ -60,6 +66,10 @@ enum xmpie_type_t {
 	XMPIET_COMMAND			= 1,
 	XMPIET_PORTNAME			= 2,
 	XMPIET_DPID				= 3,
+	XMPIET_PORTSTATS		= 4,
+	XMPIET_QUEUESTATS		= 5,
+	XMPIET_BUFFERPOOL		= 6,
+	XMPIET_SUBSCRIPTION		= 7,
 };
 
 struct xmp_ie_header_t {
@@ -88,6 +98,77 @@ struct xmp_ie_portname_t {
 	char		portname[XMPIE_PORTNAME_SIZE];
 } __attribute__((packed));
 
+/*
+ * Statistics
+ *
+ * Replies (and notifications) to the stats commands are sent to the address
+ * the request came from, with the xid of the request. Ports and queues are
+ * split across several messages (same xid) if they do not fit in one.
+ *
+ * Notifications of a subscription carry the COMMAND IE (STATS_SUBSCRIBE),
+ * the deltas of the port and queue counters that changed since the previous
+ * notification (the first one, since the subscription) and the current
+ * bufferpool occupancy.
+ */
+
+#define XMP_PORTSTATS_UP		(1 << 0)
+#define XMP_PORTSTATS_LINK_UP	(1 << 1)
+#define XMP_PORTSTATS_ATTACHED	(1 << 2)
+
+struct xmp_portstats_t {
+	char		portname[XMPIE_PORTNAME_SIZE];
+	uint64_t	dpid;			// only if attached
+	uint32_t	of_port_num;	// only if attached
+	uint32_t	flags;
+	uint64_t	rx_packets;
+	uint64_t	tx_packets;
+	uint64_t	rx_bytes;
+	uint64_t	tx_bytes;
+	uint64_t	rx_dropped;
+	uint64_t	tx_dropped;
+	uint64_t	rx_errors;
+	uint64_t	tx_errors;
+	uint64_t	rx_frame_err;
+	uint64_t	rx_over_err;
+	uint64_t	rx_crc_err;
+	uint64_t	collisions;
+} __attribute__((packed));
+
+struct xmp_ie_portstats_t {
+	uint16_t	type;
+	uint16_t	len;	// including header and payload
+	struct xmp_portstats_t ports[0];
+} __attribute__((packed));
+
+struct xmp_queuestats_t {
+	char		portname[XMPIE_PORTNAME_SIZE];
+	uint32_t	queue_id;
+	uint32_t	pad;
+	uint64_t	tx_packets;
+	uint64_t	tx_bytes;
+	uint64_t	overrun;
+} __attribute__((packed));
+
+struct xmp_ie_queuestats_t {
+	uint16_t	type;
+	uint16_t	len;	// including header and payload
+	struct xmp_queuestats_t queues[0];
+} __attribute__((packed));
+
+struct xmp_ie_bufferpool_t {
+	uint16_t	type;
+	uint16_t	len;	// including header and payload
+	uint64_t	capacity;
+	uint64_t	in_use;
+} __attribute__((packed));
+
+struct xmp_ie_subscription_t {
+	uint16_t	type;
+	uint16_t	len;	// including header and payload
+	uint32_t	interval;	// seconds between notifications
+	uint32_t	duration;	// seconds until the subscription expires, 0: until unsubscribed
+} __attribute__((packed));
+
 #endif /* MGMT_PROTOCOL_H_ */
 
 
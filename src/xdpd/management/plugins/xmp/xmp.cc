@@ -7,13 +7,18 @@
 
 #include "xmp.h"
 
+#include <sstream>
+#include <rofl/datapath/hal/driver.h>
+#include "../../hal_ext.h"
+
 using namespace rofl; 
 using namespace xdpd::mgmt::protocol;
 
 
 
 xmp::xmp() :
-		socket(NULL)
+		socket(NULL),
+		notify_timer_running(false)
 {
 	socket = rofl::csocket::csocket_factory(rofl::csocket::SOCKET_TYPE_PLAIN, this);
 
@@ -48,6 +53,26 @@ xmp::handle_timeout(
 		int opaque, void *data)
 {
 	switch (opaque) {
+	case TIMER_XMP_STATS_NOTIFY: {
+		time_t now = time(NULL);
+
+		for (std::list<subscription>::iterator it = subscriptions.begin(); it != subscriptions.end();) {
+			if (it->expires && now >= it->expires) {
+				rofl::logging::error << "[xdpd][plugin][xmp] stats subscription of " << it->addr << " expired" << std::endl;
+				it = subscriptions.erase(it);
+				continue;
+			}
+			if (--(it->remaining) == 0) {
+				it->remaining = it->interval;
+				notify_subscription(*it);
+			}
+			++it;
+		}
+
+		notify_timer_running = not subscriptions.empty();
+		if (notify_timer_running)
+			register_timer(TIMER_XMP_STATS_NOTIFY, 1);
+	} break;
 	default:
 		;;
 	}
@@ -59,8 +84,9 @@ xmp::handle_read(
 		csocket& socket)
 {
 	cmemory mem(128);
+	caddress from;
 
-	int nbytes = socket.recv(mem.somem(), mem.memlen());
+	int nbytes = socket.recv(mem.somem(), mem.memlen(), 0, from);
 
 	if (nbytes == 0) {
 		// socket closed
@@ -83,7 +109,7 @@ xmp::handle_read(
 
 	switch (hdr->type) {
 	case XMPT_REQUEST: {
-		handle_request(msg);
+		handle_request(msg, from);
 	} break;
 	case XMPT_REPLY:
 	case XMPT_NOTIFICATION:
@@ -96,7 +122,7 @@ xmp::handle_read(
 
 void
 xmp::handle_request(
-		cxmpmsg& msg)
+		cxmpmsg& msg, caddress const& from)
 {
 	rofl::logging::error << "[xdpd][plugin][xmp] rcvd message:" << std::endl << msg;
 
@@ -118,6 +144,24 @@ xmp::handle_request(
 	case XMPIEMCT_PORT_DISABLE: {
 		handle_port_disable(msg);
 	} break;
+	case XMPIEMCT_CONFIG_RELOAD: {
+		handle_config_reload(msg);
+	} break;
+	case XMPIEMCT_STATS_PORTS: {
+		handle_stats_ports(msg, from);
+	} break;
+	case XMPIEMCT_STATS_QUEUES: {
+		handle_stats_queues(msg, from);
+	} break;
+	case XMPIEMCT_STATS_BUFFERPOOL: {
+		handle_stats_bufferpool(msg, from);
+	} break;
+	case XMPIEMCT_STATS_SUBSCRIBE: {
+		handle_stats_subscribe(msg, from);
+	} break;
+	case XMPIEMCT_STATS_UNSUBSCRIBE: {
+		handle_stats_unsubscribe(msg, from);
+	} break;
 	case XMPIEMCT_NONE:
 	default: {
 		rofl::logging::error << "[xdpd][plugin][xmp] rcvd xmp request with unknown command:"
@@ -266,4 +310,372 @@ xmp::handle_port_disable(
 }
 
 
+void
+xmp::handle_config_reload(
+		cxmpmsg& msg)
+{
+	rofl::logging::error << "[xdpd][plugin][xmp] reloading configuration" << std::endl;
+
+	//Errors are reported by the plugins
+	system_manager::reload_configuration();
+}
+
+
+
+//Key of a port (or queue) in the subscriptions
+static inline std::string
+stats_key(
+		const char* portname, int queue_id = -1)
+{
+	std::stringstream key;
+	key << std::string(portname, strnlen(portname, XMPIE_PORTNAME_SIZE));
+	if (queue_id >= 0)
+		key << "/" << queue_id;
+	return key.str();
+}
+
+
+//Counters are reset if a port is removed and added again
+static inline uint64_t
+counter_delta(
+		uint64_t cur, uint64_t last)
+{
+	return (cur >= last) ? cur - last : cur;
+}
+
+
+void
+xmp::handle_stats_ports(
+		cxmpmsg& msg, caddress const& from)
+{
+	std::vector<struct xmp_portstats_t> ports;
+	std::vector<struct xmp_queuestats_t> queues;
+	bool has_dpid = msg.get_xmpies().has_ie_dpid();
+	uint64_t dpid = (has_dpid) ? msg.get_xmpies().get_ie_dpid().get_dpid() : 0;
+
+	if (has_dpid && not switch_manager::exists(dpid)) {
+		rofl::logging::error << "[xdpd][plugin][xmp] port stats of dpid:" << (unsigned long long)dpid
+				<< " failed, LSI does not exist" << std::endl;
+		return;
+	}
+
+	collect_stats(has_dpid, dpid, "", ports, queues);
+	queues.clear();
 
+	send_stats(from, XMPT_REPLY, msg.get_xid(), XMPIEMCT_STATS_PORTS, ports, queues, false);
+}
+
+
+void
+xmp::handle_stats_queues(
+		cxmpmsg& msg, caddress const& from)
+{
+	std::vector<struct xmp_portstats_t> ports;
+	std::vector<struct xmp_queuestats_t> queues;
+	bool has_dpid = msg.get_xmpies().has_ie_dpid();
+	uint64_t dpid = (has_dpid) ? msg.get_xmpies().get_ie_dpid().get_dpid() : 0;
+	std::string portname;
+
+	if (msg.get_xmpies().has_ie_portname())
+		portname = msg.get_xmpies().get_ie_portname().get_portname();
+
+	collect_stats(has_dpid, dpid, portname, ports, queues);
+	ports.clear();
+
+	send_stats(from, XMPT_REPLY, msg.get_xid(), XMPIEMCT_STATS_QUEUES, ports, queues, false);
+}
+
+
+void
+xmp::handle_stats_bufferpool(
+		cxmpmsg& msg, caddress const& from)
+{
+	std::vector<struct xmp_portstats_t> ports;
+	std::vector<struct xmp_queuestats_t> queues;
+
+	send_stats(from, XMPT_REPLY, msg.get_xid(), XMPIEMCT_STATS_BUFFERPOOL, ports, queues, true);
+}
+
+
+void
+xmp::handle_stats_subscribe(
+		cxmpmsg& msg, caddress const& from)
+{
+	std::vector<struct xmp_portstats_t> ports;
+	std::vector<struct xmp_queuestats_t> queues;
+	std::list<subscription>::iterator it;
+	subscription sub;
+
+	if (not msg.get_xmpies().has_ie_subscription()) {
+		rofl::logging::error << "[xdpd][plugin][xmp] rcvd xmp Stats-Subscribe request without -SUBSCRIPTION- IE, dropping message." << std::endl;
+		return;
+	}
+
+	for (it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+		if (it->addr == from)
+			break;
+	}
+
+	if ((it == subscriptions.end()) && (subscriptions.size() >= XMP_STATS_MAX_SUBSCRIPTIONS)) {
+		rofl::logging::error << "[xdpd][plugin][xmp] stats subscription of " << from
+				<< " refused, too many subscriptions" << std::endl;
+		return;
+	}
+
+	sub.addr = from;
+	sub.xid = msg.get_xid();
+	sub.has_dpid = msg.get_xmpies().has_ie_dpid();
+	sub.dpid = (sub.has_dpid) ? msg.get_xmpies().get_ie_dpid().get_dpid() : 0;
+	sub.interval = msg.get_xmpies().get_ie_subscription().get_interval();
+	if (sub.interval == 0)
+		sub.interval = 1;
+	sub.remaining = sub.interval;
+	sub.expires = (msg.get_xmpies().get_ie_subscription().get_duration()) ?
+			time(NULL) + msg.get_xmpies().get_ie_subscription().get_duration() : 0;
+
+	//Baseline of the deltas
+	collect_stats(sub.has_dpid, sub.dpid, "", ports, queues);
+	for (unsigned int i = 0; i < ports.size(); i++)
+		sub.ports[stats_key(ports[i].portname)] = ports[i];
+	for (unsigned int i = 0; i < queues.size(); i++)
+		sub.queues[stats_key(queues[i].portname, queues[i].queue_id)] = queues[i];
+
+	//A new subscription of the same address replaces the previous one
+	if (it != subscriptions.end())
+		*it = sub;
+	else
+		subscriptions.push_back(sub);
+
+	rofl::logging::error << "[xdpd][plugin][xmp] stats subscription of " << from
+			<< " every " << sub.interval << "s" << std::endl;
+
+	//Acknowledge
+	cxmpmsg reply(XMP_VERSION, XMPT_REPLY, sizeof(struct xmp_header_t), msg.get_xid());
+	reply.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_SUBSCRIBE);
+	cxmpie_subscription& ie = reply.get_xmpies().add_ie_subscription();
+	ie.set_interval(sub.interval);
+	ie.set_duration(msg.get_xmpies().get_ie_subscription().get_duration());
+	send_msg(reply, from);
+
+	if (not notify_timer_running) {
+		register_timer(TIMER_XMP_STATS_NOTIFY, 1);
+		notify_timer_running = true;
+	}
+}
+
+
+void
+xmp::handle_stats_unsubscribe(
+		cxmpmsg& msg, caddress const& from)
+{
+	for (std::list<subscription>::iterator it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+		if (it->addr == from) {
+			subscriptions.erase(it);
+			rofl::logging::error << "[xdpd][plugin][xmp] stats subscription of " << from << " removed" << std::endl;
+			break;
+		}
+	}
+
+	//Acknowledge (also if there was none)
+	cxmpmsg reply(XMP_VERSION, XMPT_REPLY, sizeof(struct xmp_header_t), msg.get_xid());
+	reply.get_xmpies().add_ie_command().set_command(XMPIEMCT_STATS_UNSUBSCRIBE);
+	send_msg(reply, from);
+}
+
+
+void
+xmp::notify_subscription(
+		subscription& sub)
+{
+	std::vector<struct xmp_portstats_t> ports, port_deltas;
+	std::vector<struct xmp_queuestats_t> queues, queue_deltas;
+	std::map<std::string, struct xmp_portstats_t> last_ports;
+	std::map<std::string, struct xmp_queuestats_t> last_queues;
+	struct xmp_portstats_t zero_port, last_port, port;
+	struct xmp_queuestats_t zero_queue, last_queue, queue;
+
+	memset(&zero_port, 0, sizeof(zero_port));
+	memset(&zero_queue, 0, sizeof(zero_queue));
+
+	collect_stats(sub.has_dpid, sub.dpid, "", ports, queues);
+
+	for (unsigned int i = 0; i < ports.size(); i++) {
+		std::string key = stats_key(ports[i].portname);
+		std::map<std::string, struct xmp_portstats_t>::iterator it = sub.ports.find(key);
+		last_port = (it != sub.ports.end()) ? it->second : zero_port;
+
+		port = ports[i];
+		port.rx_packets		= counter_delta(ports[i].rx_packets, last_port.rx_packets);
+		port.tx_packets		= counter_delta(ports[i].tx_packets, last_port.tx_packets);
+		port.rx_bytes		= counter_delta(ports[i].rx_bytes, last_port.rx_bytes);
+		port.tx_bytes		= counter_delta(ports[i].tx_bytes, last_port.tx_bytes);
+		port.rx_dropped		= counter_delta(ports[i].rx_dropped, last_port.rx_dropped);
+		port.tx_dropped		= counter_delta(ports[i].tx_dropped, last_port.tx_dropped);
+		port.rx_errors		= counter_delta(ports[i].rx_errors, last_port.rx_errors);
+		port.tx_errors		= counter_delta(ports[i].tx_errors, last_port.tx_errors);
+		port.rx_frame_err	= counter_delta(ports[i].rx_frame_err, last_port.rx_frame_err);
+		port.rx_over_err	= counter_delta(ports[i].rx_over_err, last_port.rx_over_err);
+		port.rx_crc_err		= counter_delta(ports[i].rx_crc_err, last_port.rx_crc_err);
+		port.collisions		= counter_delta(ports[i].collisions, last_port.collisions);
+
+		//Only what changed (or the state of the port); every counter is
+		//checked, since the baseline is advanced for all the ports
+		if (port.rx_packets || port.tx_packets || port.rx_bytes || port.tx_bytes ||
+				port.rx_dropped || port.tx_dropped || port.rx_errors || port.tx_errors ||
+				port.rx_frame_err || port.rx_over_err || port.rx_crc_err || port.collisions ||
+				(it == sub.ports.end()) || (port.flags != last_port.flags))
+			port_deltas.push_back(port);
+
+		last_ports[key] = ports[i];
+	}
+
+	for (unsigned int i = 0; i < queues.size(); i++) {
+		std::string key = stats_key(queues[i].portname, queues[i].queue_id);
+		std::map<std::string, struct xmp_queuestats_t>::iterator it = sub.queues.find(key);
+		last_queue = (it != sub.queues.end()) ? it->second : zero_queue;
+
+		queue = queues[i];
+		queue.tx_packets	= counter_delta(queues[i].tx_packets, last_queue.tx_packets);
+		queue.tx_bytes		= counter_delta(queues[i].tx_bytes, last_queue.tx_bytes);
+		queue.overrun		= counter_delta(queues[i].overrun, last_queue.overrun);
+
+		if (queue.tx_packets || queue.tx_bytes || queue.overrun)
+			queue_deltas.push_back(queue);
+
+		last_queues[key] = queues[i];
+	}
+
+	//Ports (and queues) that disappeared are forgotten
+	sub.ports.swap(last_ports);
+	sub.queues.swap(last_queues);
+
+	send_stats(sub.addr, XMPT_NOTIFICATION, sub.xid, XMPIEMCT_STATS_SUBSCRIBE, port_deltas, queue_deltas, true);
+}
+
+
+void
+xmp::send_msg(
+		cxmpmsg& msg, caddress const& to)
+{
+	rofl::cmemory *mem = new rofl::cmemory(msg.length());
+
+	msg.pack(mem->somem(), mem->memlen());
+
+	socket->send(mem, to);
+}
+
+
+void
+xmp::send_stats(
+		caddress const& to, uint8_t type, uint32_t xid, uint32_t command,
+		std::vector<struct xmp_portstats_t> const& ports,
+		std::vector<struct xmp_queuestats_t> const& queues,
+		bool bufferpool)
+{
+	unsigned int p = 0, q = 0, n;
+	uint64_t capacity, in_use;
+
+	do {
+		cxmpmsg msg(XMP_VERSION, type, sizeof(struct xmp_header_t), xid);
+
+		msg.get_xmpies().add_ie_command().set_command(command);
+
+		if ((command == XMPIEMCT_STATS_PORTS) || not ports.empty()) {
+			cxmpie_portstats& ie = msg.get_xmpies().add_ie_portstats();
+			for (n = 0; (n < XMP_STATS_MAX_ENTRIES_PER_MSG) && (p < ports.size()); n++, p++)
+				ie.add_port(ports[p]);
+		}
+
+		if ((command == XMPIEMCT_STATS_QUEUES) || not queues.empty()) {
+			cxmpie_queuestats& ie = msg.get_xmpies().add_ie_queuestats();
+			for (n = 0; (n < XMP_STATS_MAX_ENTRIES_PER_MSG) && (q < queues.size()); n++, q++)
+				ie.add_queue(queues[q]);
+		}
+
+		if (bufferpool) {
+			if (hal_driver_get_bufferpool_stats && (hal_driver_get_bufferpool_stats(&capacity, &in_use) == HAL_SUCCESS)) {
+				cxmpie_bufferpool& ie = msg.get_xmpies().add_ie_bufferpool();
+				ie.set_capacity(capacity);
+				ie.set_in_use(in_use);
+			}
+			bufferpool = false;
+		}
+
+		send_msg(msg, to);
+
+	} while ((p < ports.size()) || (q < queues.size()));
+}
+
+
+void
+xmp::collect_stats(
+		bool has_dpid, uint64_t dpid, std::string const& portname,
+		std::vector<struct xmp_portstats_t>& ports,
+		std::vector<struct xmp_queuestats_t>& queues)
+{
+	switch_port_name_list_t* port_names;
+	switch_port_snapshot_t* port;
+	struct xmp_portstats_t pstats;
+	struct xmp_queuestats_t qstats;
+
+	port_names = hal_driver_get_all_port_names();
+	if (!port_names)
+		return;
+
+	for (unsigned int i = 0; i < port_names->num_of_ports; i++) {
+
+		if ((portname != "") && (portname != port_names->names[i].name))
+			continue;
+
+		port = hal_driver_get_port_snapshot_by_name(port_names->names[i].name);
+		if (!port)
+			continue; //Removed in the meantime
+
+		if (has_dpid && (!port->is_attached_to_sw || (port->attached_sw_dpid != dpid))) {
+			switch_port_destroy_snapshot(port);
+			continue;
+		}
+
+		memset(&pstats, 0, sizeof(pstats));
+		strncpy(pstats.portname, port->name, XMPIE_PORTNAME_SIZE);
+		if (port->up)
+			pstats.flags |= XMP_PORTSTATS_UP;
+		if (!(port->state & PORT_STATE_LINK_DOWN))
+			pstats.flags |= XMP_PORTSTATS_LINK_UP;
+		if (port->is_attached_to_sw) {
+			pstats.flags |= XMP_PORTSTATS_ATTACHED;
+			pstats.dpid = port->attached_sw_dpid;
+			pstats.of_port_num = port->of_port_num;
+		}
+		pstats.rx_packets	= port->stats.rx_packets;
+		pstats.tx_packets	= port->stats.tx_packets;
+		pstats.rx_bytes		= port->stats.rx_bytes;
+		pstats.tx_bytes		= port->stats.tx_bytes;
+		pstats.rx_dropped	= port->stats.rx_dropped;
+		pstats.tx_dropped	= port->stats.tx_dropped;
+		pstats.rx_errors	= port->stats.rx_errors;
+		pstats.tx_errors	= port->stats.tx_errors;
+		pstats.rx_frame_err	= port->stats.rx_frame_err;
+		pstats.rx_over_err	= port->stats.rx_over_err;
+		pstats.rx_crc_err	= port->stats.rx_crc_err;
+		pstats.collisions	= port->stats.collisions;
+		ports.push_back(pstats);
+
+		for (unsigned int q = 0; q < port->max_queues; q++) {
+			if (!port->queues[q].set)
+				continue;
+
+			memset(&qstats, 0, sizeof(qstats));
+			memcpy(qstats.portname, pstats.portname, XMPIE_PORTNAME_SIZE);
+			qstats.queue_id		= q;
+			qstats.tx_packets	= port->queues[q].stats.tx_packets;
+			qstats.tx_bytes		= port->queues[q].stats.tx_bytes;
+			qstats.overrun		= port->queues[q].stats.overrun;
+			queues.push_back(qstats);
+		}
+
+		switch_port_destroy_snapshot(port);
+	}
+
+	switch_port_name_list_destroy(port_names);
+}
@@ -9,11 +9,16 @@
 #define XDPD_MANAGER_H_
 
 #include <inttypes.h>
+#include <time.h>
+#include <list>
+#include <map>
+#include <vector>
 #include <rofl/common/csocket.h>
 
 #include "../../switch_manager.h"
 #include "../../port_manager.h"
 #include "../../plugin_manager.h"
+#include "../../system_manager.h"
 
 #include "cxmpmsg.h"
 
@@ -32,6 +37,34 @@ class xmp :
 #define MGMT_PORT_UDP_ADDR	"127.0.0.1"
 #define MGMT_PORT_UDP_PORT	"8444"
 
+#define XMP_STATS_MAX_ENTRIES_PER_MSG	256	// ports (and queues) per reply/notification
+#define XMP_STATS_MAX_SUBSCRIPTIONS		16
+
+	enum xmp_timer_t {
+		TIMER_XMP_STATS_NOTIFY		= 1,	// every second while there are subscriptions
+	};
+
+	/*
+	 * subscriber of the periodic counter deltas
+	 */
+	class subscription {
+	public:
+		rofl::caddress		addr;		// where the notifications are sent
+		uint32_t			xid;		// of the subscription request
+		bool				has_dpid;	// only the ports of an LSI
+		uint64_t			dpid;
+		unsigned int		interval;	// seconds between notifications
+		unsigned int		remaining;	// seconds until the next one
+		time_t				expires;	// 0: never
+
+		// counters at the last notification
+		std::map<std::string, struct xmp_portstats_t>	ports;
+		std::map<std::string, struct xmp_queuestats_t>	queues;
+	};
+
+	std::list<subscription>	subscriptions;
+	bool					notify_timer_running;
+
 public:
 
 	xmp();
@@ -88,7 +121,7 @@ private:
 
 	void
 	handle_request(
-			cxmpmsg& msg);
+			cxmpmsg& msg, rofl::caddress const& from);
 
 	void
 	handle_port_attach(
@@ -105,6 +138,55 @@ private:
 	void
 	handle_port_disable(
 			cxmpmsg& msg);
+
+	void
+	handle_config_reload(
+			cxmpmsg& msg);
+
+	void
+	handle_stats_ports(
+			cxmpmsg& msg, rofl::caddress const& from);
+
+	void
+	handle_stats_queues(
+			cxmpmsg& msg, rofl::caddress const& from);
+
+	void
+	handle_stats_bufferpool(
+			cxmpmsg& msg, rofl::caddress const& from);
+
+	void
+	handle_stats_subscribe(
+			cxmpmsg& msg, rofl::caddress const& from);
+
+	void
+	handle_stats_unsubscribe(
+			cxmpmsg& msg, rofl::caddress const& from);
+
+	void
+	notify_subscription(
+			subscription& sub);
+
+	void
+	send_msg(
+			cxmpmsg& msg, rofl::caddress const& to);
+
+	/*
+	 * Send the entries in as many messages as needed (at least one); the
+	 * bufferpool IE is added to the first one
+	 */
+	void
+	send_stats(
+			rofl::caddress const& to, uint8_t type, uint32_t xid, uint32_t command,
+			std::vector<struct xmp_portstats_t> const& ports,
+			std::vector<struct xmp_queuestats_t> const& queues,
+			bool bufferpool);
+
+	static void
+	collect_stats(
+			bool has_dpid, uint64_t dpid, std::string const& portname,
+			std::vector<struct xmp_portstats_t>& ports,
+			std::vector<struct xmp_queuestats_t>& queues);
 };
 
 }; // end of namespace protocol
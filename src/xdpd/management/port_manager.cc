@@ -1,5 +1,6 @@
 #include "port_manager.h"
 #include <assert.h>
+#include <vector>
 #include "switch_manager.h"
 #include "plugin_manager.h"
 
@@ -74,6 +75,49 @@ void port_manager::bring_up(std::string& name){
 	ROFL_DEBUG("[xdpd][port_manager] Port %s brought administratively up\n", name.c_str());
 }
 
+void port_manager::bring_up(std::list<std::string>& names){
+
+	unsigned int i;
+	bool failed = false;
+	std::list<std::string>::iterator it;
+	std::vector<const char*> c_names;
+	std::vector<hal_result_t> results(names.size(), HAL_FAILURE);
+
+	if(names.empty())
+		return;
+
+	pthread_mutex_lock(&port_manager::mutex);
+
+	//Check port existance
+	for(it = names.begin(); it != names.end(); ++it){
+		if(!port_exists(*it)){
+			pthread_mutex_unlock(&port_manager::mutex);
+			throw ePmInvalidPort();
+		}
+		c_names.push_back(it->c_str());
+	}
+
+	if(hal_driver_bring_ports_up){
+		hal_driver_bring_ports_up(&c_names[0], c_names.size(), &results[0]);
+	}else{
+		for(i=0;i<c_names.size();++i)
+			results[i] = hal_driver_bring_port_up(c_names[i]);
+	}
+	pthread_mutex_unlock(&port_manager::mutex);
+
+	for(i=0;i<c_names.size();++i){
+		if(results[i] != HAL_SUCCESS){
+			ROFL_ERR("[xdpd][port_manager] Unable to bring port %s administratively up\n", c_names[i]);
+			failed = true;
+		}else{
+			ROFL_DEBUG("[xdpd][port_manager] Port %s brought administratively up\n", c_names[i]);
+		}
+	}
+
+	if(failed)
+		throw ePmUnknownError();
+}
+
 void port_manager::bring_down(std::string& name){
 
 	hal_result_t result;
@@ -14,6 +14,7 @@
 #include <rofl/datapath/hal/driver.h>
 #include <rofl/datapath/pipeline/switch_port.h>
 #include <rofl/common/croflexception.h>
+#include "hal_ext.h"
 
 /**
 * @file port_manager.h
@@ -75,6 +76,12 @@ public:
 	* Set the port administratively up (meta up) 
 	*/
 	static void bring_up(std::string& name);
+
+	/**
+	* Set a set of ports administratively up (meta up). If any of the ports
+	* can not be brought up, the rest are still brought up and the call throws
+	*/
+	static void bring_up(std::list<std::string>& names);
 	
 	/**
 	* Set the port administratively down (meta down) 
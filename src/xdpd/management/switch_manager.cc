@@ -1,9 +1,13 @@
 #include "switch_manager.h"
 
+#include <errno.h>
+#include <unistd.h>
+
 #include <rofl/datapath/hal/hal.h>
 #include <rofl/datapath/hal/cmm.h>
 #include <rofl/common/utils/c_logger.h>
 #include "port_manager.h"
+#include "../openflow/flow_checkpoint.h"
 
 //Add here the headers of the version-dependant Openflow switchs 
 #include "../openflow/openflow_switch.h"
@@ -19,9 +23,16 @@ const caddress switch_manager::binding_addr = caddress(AF_INET, "0.0.0.0", 6632)
 
 //Static initialization
 std::map<uint64_t, openflow_switch*> switch_manager::switchs;
-uint64_t switch_manager::dpid_under_destruction = 0x0;
-pthread_rwlock_t switch_manager::rwlock = PTHREAD_RWLOCK_INITIALIZER; //Used to prevent deletion of a switch during notification treatment (e.g. port_status_changed)
+switch_registry switch_manager::registry;
+pthread_rwlock_t switch_manager::rwlock = PTHREAD_RWLOCK_INITIALIZER; //Used to prevent deletion of a switch during management calls (notifications use the registry)
 pthread_mutex_t switch_manager::mutex = PTHREAD_MUTEX_INITIALIZER; //Used to serialize management actions 
+std::string switch_manager::checkpoint_dir("");
+pthread_t switch_manager::checkpoint_thread;
+pthread_mutex_t switch_manager::checkpoint_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t switch_manager::checkpoint_cond = PTHREAD_COND_INITIALIZER;
+bool switch_manager::checkpoint_thread_running = false;
+unsigned int switch_manager::checkpoint_interval = 0;
+pthread_mutex_t switch_manager::checkpoint_write_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /**
 * Static methods of the manager
@@ -85,6 +96,11 @@ openflow_switch* switch_manager::create_switch(
 	
 	//Store in the switch list
 	switch_manager::switchs[dpid] = dp;
+	switch_manager::registry.insert(dpid, dp);
+
+	//Warm restart; no port can be attached until the mutex is released
+	if(switch_manager::checkpoint_dir != "")
+		flow_checkpoint::restore(dp, flow_checkpoint::get_path(switch_manager::checkpoint_dir, dpid), &dp->checkpoint_generation);
 	
 	pthread_mutex_unlock(&switch_manager::mutex);
 	
@@ -98,6 +114,12 @@ openflow_switch* switch_manager::create_switch(
 
 //static
 void switch_manager::destroy_switch(uint64_t dpid) throw (eOfSmDoesNotExist){
+	//The tables of a switch that is explicitly destroyed are not restored
+	__destroy_switch(dpid, true);
+}
+
+//static
+void switch_manager::__destroy_switch(uint64_t dpid, bool drop_checkpoint){
 
 	unsigned int i;
 	of_switch_snapshot_t* sw_snapshot;
@@ -121,9 +143,6 @@ void switch_manager::destroy_switch(uint64_t dpid) throw (eOfSmDoesNotExist){
 		throw eOfSmGeneralError(); 
 	}
 
-	//Set the dpid under destruction
-	dpid_under_destruction = dpid;
-
 	for(i=0;i<sw_snapshot->max_ports;++i){
 		port = sw_snapshot->logical_ports[i].port;
 		if(!port || sw_snapshot->logical_ports[i].attachment_state != LOGICAL_PORT_STATE_ATTACHED)
@@ -143,6 +162,10 @@ void switch_manager::destroy_switch(uint64_t dpid) throw (eOfSmDoesNotExist){
 		}
 	}
 	
+	//Stop dispatching notifications to the LSI; once remove() returns no
+	//notification is being processed by it
+	switch_manager::registry.remove(dpid);
+
 	pthread_rwlock_wrlock(&switch_manager::rwlock);
 	
 	//Get switch instance 
@@ -153,12 +176,19 @@ void switch_manager::destroy_switch(uint64_t dpid) throw (eOfSmDoesNotExist){
 
 	//Destroy element
 	delete dp;	
-	
-	dpid_under_destruction = 0x0;
+
+	std::string checkpoint_path = (drop_checkpoint && switch_manager::checkpoint_dir != "")? flow_checkpoint::get_path(switch_manager::checkpoint_dir, dpid) : "";
 	
 	pthread_rwlock_unlock(&switch_manager::rwlock);
 	pthread_mutex_unlock(&switch_manager::mutex);
 
+	//After any checkpoint of the switch in progress
+	if(checkpoint_path != ""){
+		pthread_mutex_lock(&switch_manager::checkpoint_write_mutex);
+		unlink(checkpoint_path.c_str());
+		pthread_mutex_unlock(&switch_manager::checkpoint_write_mutex);
+	}
+
 	//Destroy snapshot
 	of_switch_destroy_snapshot(sw_snapshot);		
 }
@@ -166,11 +196,14 @@ void switch_manager::destroy_switch(uint64_t dpid) throw (eOfSmDoesNotExist){
 //static
 void switch_manager::destroy_all_switches(){
 
+	//Shutdown; keep the tables for the next start
+	checkpoint_all_switches();
+
 	std::map<uint64_t, openflow_switch*>::iterator it = switchs.begin(), tmp;
 	while( it != switchs.end() ){
 		tmp = it;	
 		it++;
-		destroy_switch(tmp->second->dpid);
+		__destroy_switch(tmp->second->dpid, false);
 	}
 	switchs.clear();
 }
@@ -190,6 +223,18 @@ std::list<std::string> switch_manager::list_sw_names(void){
 	return name_list;
 }
 
+std::list<uint64_t> switch_manager::list_dpids(void){
+
+	std::list<uint64_t> dpids;
+	unsigned int idx;
+
+	idx = registry.read_lock();
+	registry.get_dpids(dpids);
+	registry.read_unlock(idx);
+
+	return dpids;
+}
+
 /* static */std::list<std::string>
 switch_manager::list_matching_algorithms(of_version_t of_version)
 {
@@ -301,6 +346,164 @@ switch_manager::rpc_disconnect_from_ctl(uint64_t dpid, enum rofl::csocket::socke
 }
 
 
+void
+switch_manager::set_flow_mod_batch_size(uint64_t dpid, unsigned int size){
+
+	pthread_rwlock_wrlock(&switch_manager::rwlock);
+	
+	if (switch_manager::switchs.find(dpid) == switch_manager::switchs.end()){
+		pthread_rwlock_unlock(&switch_manager::rwlock);
+		throw eOfSmDoesNotExist();
+	}
+
+	//Get switch instance
+	openflow_switch* dp = switch_manager::switchs[dpid];
+	dp->set_flow_mod_batch_size(size);
+	pthread_rwlock_unlock(&switch_manager::rwlock);
+}
+
+
+//
+// Warm restart
+//
+
+void switch_manager::set_checkpoint_dir(std::string const& dir){
+
+	pthread_mutex_lock(&switch_manager::mutex);
+	switch_manager::checkpoint_dir = dir;
+	pthread_mutex_unlock(&switch_manager::mutex);
+
+	if(dir != "")
+		ROFL_INFO("[xdpd][switch_manager] Flow tables are checkpointed to %s\n", dir.c_str());
+}
+
+//The tables are serialized with the mutex held, but the file is written
+//without it, so that the rest of the switch_manager calls are not stalled
+//by the disk
+bool switch_manager::__checkpoint_switch(uint64_t dpid){
+
+	openflow_switch* sw;
+	std::vector<uint8_t> image;
+	std::string path;
+	uint64_t generation;
+	rofl_result_t result;
+
+	pthread_mutex_lock(&switch_manager::checkpoint_write_mutex);
+	pthread_mutex_lock(&switch_manager::mutex);
+
+	if(switch_manager::switchs.find(dpid) == switch_manager::switchs.end()){
+		pthread_mutex_unlock(&switch_manager::mutex);
+		pthread_mutex_unlock(&switch_manager::checkpoint_write_mutex);
+		return false;
+	}
+
+	if(switch_manager::checkpoint_dir == ""){
+		pthread_mutex_unlock(&switch_manager::mutex);
+		pthread_mutex_unlock(&switch_manager::checkpoint_write_mutex);
+		return true;
+	}
+
+	sw = switch_manager::switchs[dpid];
+	generation = sw->checkpoint_generation+1;
+	path = flow_checkpoint::get_path(switch_manager::checkpoint_dir, dpid);
+	result = flow_checkpoint::serialize(sw, generation, image);
+
+	pthread_mutex_unlock(&switch_manager::mutex);
+
+	if(result == ROFL_SUCCESS)
+		result = flow_checkpoint::write(path, image);
+
+	//The switch may have been destroyed in the meantime
+	if(result == ROFL_SUCCESS){
+		pthread_mutex_lock(&switch_manager::mutex);
+		if(switch_manager::switchs.find(dpid) != switch_manager::switchs.end() && switch_manager::switchs[dpid]->checkpoint_generation < generation)
+			switch_manager::switchs[dpid]->checkpoint_generation = generation;
+		pthread_mutex_unlock(&switch_manager::mutex);
+	}
+
+	pthread_mutex_unlock(&switch_manager::checkpoint_write_mutex);
+
+	return true;
+}
+
+void switch_manager::checkpoint_switch(uint64_t dpid){
+
+	if(!__checkpoint_switch(dpid))
+		throw eOfSmDoesNotExist();
+}
+
+void switch_manager::checkpoint_all_switches(){
+
+	std::list<uint64_t> dpids;
+
+	pthread_mutex_lock(&switch_manager::mutex);
+
+	for(std::map<uint64_t, openflow_switch*>::iterator it = switchs.begin(); it != switchs.end(); ++it)
+		dpids.push_back(it->first);
+
+	pthread_mutex_unlock(&switch_manager::mutex);
+
+	//Switches destroyed in the meantime are skipped
+	for(std::list<uint64_t>::iterator it = dpids.begin(); it != dpids.end(); ++it)
+		__checkpoint_switch(*it);
+}
+
+void* switch_manager::checkpoint_routine(void* param){
+
+	struct timespec deadline;
+
+	pthread_mutex_lock(&switch_manager::checkpoint_mutex);
+
+	while(switch_manager::checkpoint_interval){
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += switch_manager::checkpoint_interval;
+
+		if(pthread_cond_timedwait(&switch_manager::checkpoint_cond, &switch_manager::checkpoint_mutex, &deadline) != ETIMEDOUT)
+			continue;
+
+		pthread_mutex_unlock(&switch_manager::checkpoint_mutex);
+		checkpoint_all_switches();
+		pthread_mutex_lock(&switch_manager::checkpoint_mutex);
+	}
+
+	pthread_mutex_unlock(&switch_manager::checkpoint_mutex);
+
+	return NULL;
+}
+
+void switch_manager::start_periodic_checkpoints(unsigned int interval){
+
+	stop_periodic_checkpoints();
+
+	if(!interval)
+		return;
+
+	switch_manager::checkpoint_interval = interval;
+
+	if(pthread_create(&switch_manager::checkpoint_thread, NULL, checkpoint_routine, NULL) != 0){
+		ROFL_ERR("[xdpd][switch_manager] Unable to launch the checkpointing thread; flow tables will only be checkpointed on shutdown\n");
+		switch_manager::checkpoint_interval = 0;
+		return;
+	}
+
+	switch_manager::checkpoint_thread_running = true;
+}
+
+void switch_manager::stop_periodic_checkpoints(){
+
+	if(!switch_manager::checkpoint_thread_running)
+		return;
+
+	pthread_mutex_lock(&switch_manager::checkpoint_mutex);
+	switch_manager::checkpoint_interval = 0;
+	pthread_cond_signal(&switch_manager::checkpoint_cond);
+	pthread_mutex_unlock(&switch_manager::checkpoint_mutex);
+
+	pthread_join(switch_manager::checkpoint_thread, NULL);
+	switch_manager::checkpoint_thread_running = false;
+}
+
 openflow_switch* switch_manager::__get_switch_by_dpid(uint64_t dpid){
 
 	if (switch_manager::switchs.find(dpid) == switch_manager::switchs.end()){
@@ -319,25 +522,21 @@ rofl_result_t switch_manager::__notify_port_attached(const switch_port_snapshot_
 	
 	rofl_result_t result;
 	openflow_switch* sw;	
+	unsigned int idx;
 
-	if(!port_snapshot || port_snapshot->attached_sw_dpid == dpid_under_destruction)
+	if(!port_snapshot)
 		return ROFL_FAILURE;
 
-	while( pthread_rwlock_tryrdlock(&switch_manager::rwlock) != 0 ){
-		//This can happen while destroying the LSI
-		if(port_snapshot->attached_sw_dpid == dpid_under_destruction)
-			return ROFL_FAILURE;
-		usleep(50); //Calm down
-	}
+	idx = switch_manager::registry.read_lock();
 
-	sw = switch_manager::__get_switch_by_dpid(port_snapshot->attached_sw_dpid); 
+	sw = switch_manager::registry.lookup(port_snapshot->attached_sw_dpid); 
 
 	if(sw)
 		result = sw->notify_port_attached(port_snapshot);
 	else	
 		result = ROFL_FAILURE;
 	
-	pthread_rwlock_unlock(&switch_manager::rwlock);
+	switch_manager::registry.read_unlock(idx);
 
 	return result;	
 }	
@@ -346,53 +545,44 @@ rofl_result_t switch_manager::__notify_port_status_changed(const switch_port_sna
 	
 	rofl_result_t result;
 	openflow_switch* sw;	
+	unsigned int idx;
 
-	if(!port_snapshot || port_snapshot->attached_sw_dpid == dpid_under_destruction)
+	if(!port_snapshot)
 		return ROFL_FAILURE;
 
-	while( pthread_rwlock_tryrdlock(&switch_manager::rwlock) != 0 ){
-		//This can happen while destroying the LSI
-		if(port_snapshot->attached_sw_dpid == dpid_under_destruction)
-			return ROFL_FAILURE;
-		usleep(50); //Calm down
-	}
+	idx = switch_manager::registry.read_lock();
 
-	sw = switch_manager::__get_switch_by_dpid(port_snapshot->attached_sw_dpid); 
+	sw = switch_manager::registry.lookup(port_snapshot->attached_sw_dpid); 
 
 	if(sw)
 		result = sw->notify_port_status_changed(port_snapshot);
 	else	
 		result = ROFL_FAILURE;
 	
-	pthread_rwlock_unlock(&switch_manager::rwlock);
+	switch_manager::registry.read_unlock(idx);
 
 	return result;	
-
 }
 
 rofl_result_t switch_manager::__notify_port_detached(const switch_port_snapshot_t* port_snapshot){
 	
 	rofl_result_t result;
 	openflow_switch* sw;	
+	unsigned int idx;
 
-	if(!port_snapshot || port_snapshot->attached_sw_dpid == dpid_under_destruction)
+	if(!port_snapshot)
 		return ROFL_FAILURE;
 
-	while( pthread_rwlock_tryrdlock(&switch_manager::rwlock) != 0 ){
-		//This can happen while destroying the LSI
-		if(port_snapshot->attached_sw_dpid == dpid_under_destruction)
-			return ROFL_FAILURE;
-		usleep(50); //Calm down
-	}
+	idx = switch_manager::registry.read_lock();
 
-	sw = switch_manager::__get_switch_by_dpid(port_snapshot->attached_sw_dpid); 
+	sw = switch_manager::registry.lookup(port_snapshot->attached_sw_dpid); 
 
 	if(sw)
 		result = sw->notify_port_detached(port_snapshot);
 	else	
 		result = ROFL_FAILURE;
 	
-	pthread_rwlock_unlock(&switch_manager::rwlock);
+	switch_manager::registry.read_unlock(idx);
 
 	return result;	
 }
@@ -408,25 +598,18 @@ rofl_result_t switch_manager::__process_of1x_packet_in(uint64_t dpid,
 				packet_matches_t* matches){
 	rofl_result_t result;
 	openflow_switch* sw;	
+	unsigned int idx;
 
-	if(dpid == dpid_under_destruction)
-		return ROFL_SUCCESS;
-
-	while( pthread_rwlock_tryrdlock(&switch_manager::rwlock) != 0 ){
-		//This can happen while destroying the LSI
-		if(dpid == dpid_under_destruction)
-			return ROFL_FAILURE;
-		usleep(50); //Calm down
-	}
+	idx = switch_manager::registry.read_lock();
 
-	sw = switch_manager::__get_switch_by_dpid(dpid); 
+	sw = switch_manager::registry.lookup(dpid); 
 
 	if(sw)
 		result = sw->process_packet_in(table_id, reason, in_port, buffer_id, pkt_buffer, buf_len, total_len, matches);
 	else	
 		result = ROFL_FAILURE;
 	
-	pthread_rwlock_unlock(&switch_manager::rwlock);
+	switch_manager::registry.read_unlock(idx);
 
 	return result;	
 
@@ -438,25 +621,18 @@ rofl_result_t switch_manager::__process_of1x_flow_removed(uint64_t dpid,
 
 	rofl_result_t result;
 	openflow_switch* sw;	
+	unsigned int idx;
 
-	if(dpid == dpid_under_destruction)
-		return ROFL_SUCCESS;
+	idx = switch_manager::registry.read_lock();
 
-	while( pthread_rwlock_tryrdlock(&switch_manager::rwlock) != 0 ){
-		//This can happen while destroying the LSI
-		if(dpid == dpid_under_destruction)
-			return ROFL_FAILURE;
-		usleep(50); //Calm down
-	}
-
-	sw = switch_manager::__get_switch_by_dpid(dpid); 
+	sw = switch_manager::registry.lookup(dpid); 
 
 	if(sw)
 		result = sw->process_flow_removed(reason, removed_flow_entry);
 	else	
 		result = ROFL_FAILURE;
 	
-	pthread_rwlock_unlock(&switch_manager::rwlock);
+	switch_manager::registry.read_unlock(idx);
 
 	return result;	
 
@@ -29,6 +29,8 @@
 #include <rofl/datapath/pipeline/openflow/of_switch.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
 
+#include "switch_registry.h"
+
 /**
 * @file switch_manager.h
 * @author Marc Sune<marc.sune (at) bisdn.de>
@@ -116,6 +118,12 @@ public:
 	 */
 	static std::list<std::string> list_sw_names(void);
 
+	/**
+	 * Lists the dpids of the existing switches. Does not take the
+	 * switch_manager locks (the list may be stale as soon as it returns)
+	 */
+	static std::list<uint64_t> list_dpids(void);
+
 	/**
 	 * Return true if switch exists
 	 */
@@ -151,6 +159,39 @@ public:
 	 */
 	static void rpc_disconnect_from_ctl(uint64_t dpid, enum rofl::csocket::socket_type_t socket_type, rofl::cparams const& socket_params);
 
+	/**
+	 * Set the maximum size of the FLOW_MOD ADD batches of the switch (0 disables batching)
+	 */
+	static void set_flow_mod_batch_size(uint64_t dpid, unsigned int size);
+
+	//
+	// Warm restart
+	//
+
+	/**
+	 * Set the directory where the flow and group tables of the switches
+	 * are checkpointed ("" disables checkpointing, the default). Switches
+	 * created afterwards restore their tables from their checkpoint, if any,
+	 * before any port is attached.
+	 */
+	static void set_checkpoint_dir(std::string const& dir);
+
+	/**
+	 * Checkpoint the flow and group tables of a switch
+	 */
+	static void checkpoint_switch(uint64_t dpid);
+
+	/**
+	 * Checkpoint the flow and group tables of all the switches
+	 */
+	static void checkpoint_all_switches(void);
+
+	/**
+	 * Checkpoint all the switches every interval seconds (0 stops it)
+	 */
+	static void start_periodic_checkpoints(unsigned int interval);
+	static void stop_periodic_checkpoints(void);
+
 	//
 	//CMM demux
 	//
@@ -176,7 +217,9 @@ private:
 	/* Static members */
 	//Switch container
 	static std::map<uint64_t, openflow_switch*> switchs; 
-	static uint64_t dpid_under_destruction;
+
+	//Lookups of the notification paths (CMM demux)
+	static switch_registry registry;
 
 	//Shall never be used except for the cmm
 	static openflow_switch* __get_switch_by_dpid(uint64_t dpid);	
@@ -188,6 +231,20 @@ private:
 	static pthread_mutex_t mutex;
 	static pthread_rwlock_t rwlock;
 
+	//Warm restart
+	static std::string checkpoint_dir;
+	static pthread_t checkpoint_thread;
+	static pthread_mutex_t checkpoint_mutex;
+	static pthread_cond_t checkpoint_cond;
+	static bool checkpoint_thread_running;
+	static unsigned int checkpoint_interval;
+	static pthread_mutex_t checkpoint_write_mutex; //Serializes the writers; taken before mutex
+
+	//Shall be called without the mutex held; false if the switch does not exist
+	static bool __checkpoint_switch(uint64_t dpid);
+	static void __destroy_switch(uint64_t dpid, bool drop_checkpoint);
+	static void* checkpoint_routine(void* param);
+
 };
 
 
@@ -0,0 +1,136 @@
+#include "switch_registry.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+using namespace xdpd;
+
+switch_registry::switch_registry() : epoch(0){
+	table = alloc_table(0);
+	readers[0].count = readers[1].count = 0;
+}
+
+switch_registry::~switch_registry(){
+	free(table);
+}
+
+switch_registry::registry_table_t* switch_registry::alloc_table(unsigned int num_of_entries){
+
+	registry_table_t* t = (registry_table_t*)malloc(sizeof(registry_table_t) + num_of_entries*sizeof(registry_entry_t));
+
+	if(!t)
+		abort();
+
+	t->num_of_entries = num_of_entries;
+	return t;
+}
+
+openflow_switch* switch_registry::lookup(uint64_t dpid){
+
+	registry_table_t* t = table;
+	unsigned int lo = 0, hi, mid;
+
+	__sync_synchronize(); //Do not read the entries before the table pointer
+
+	hi = t->num_of_entries;
+
+	//Binary search
+	while(lo < hi){
+		mid = (lo+hi)/2;
+		if(t->entries[mid].dpid == dpid)
+			return t->entries[mid].sw;
+		if(t->entries[mid].dpid < dpid)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+
+	return NULL;
+}
+
+void switch_registry::get_dpids(std::list<uint64_t>& dpids){
+
+	registry_table_t* t = table;
+	unsigned int i;
+
+	__sync_synchronize();
+
+	for(i=0; i<t->num_of_entries; i++)
+		dpids.push_back(t->entries[i].dpid);
+}
+
+void switch_registry::insert(uint64_t dpid, openflow_switch* sw){
+
+	registry_table_t* old = table;
+	registry_table_t* t = alloc_table(old->num_of_entries+1);
+	unsigned int i, j = 0;
+	bool inserted = false;
+
+	//Keep the entries sorted; an existing dpid is replaced
+	for(i=0; i<old->num_of_entries; i++){
+		if(old->entries[i].dpid == dpid)
+			continue;
+
+		if(!inserted && old->entries[i].dpid > dpid){
+			t->entries[j].dpid = dpid;
+			t->entries[j++].sw = sw;
+			inserted = true;
+		}
+		t->entries[j++] = old->entries[i];
+	}
+
+	if(!inserted){
+		t->entries[j].dpid = dpid;
+		t->entries[j++].sw = sw;
+	}
+
+	t->num_of_entries = j;
+
+	publish(t);
+}
+
+void switch_registry::remove(uint64_t dpid){
+
+	registry_table_t* old = table;
+	registry_table_t* t = alloc_table(old->num_of_entries);
+	unsigned int i, j;
+
+	for(i=0, j=0; i<old->num_of_entries; i++){
+		if(old->entries[i].dpid != dpid)
+			t->entries[j++] = old->entries[i];
+	}
+	t->num_of_entries = j;
+
+	publish(t);
+}
+
+void switch_registry::publish(registry_table_t* new_table){
+
+	registry_table_t* old = table;
+
+	__sync_synchronize(); //Entries are visible before the pointer
+	table = new_table;
+
+	//Readers may still be using the old table
+	synchronize();
+	free(old);
+}
+
+//Wait until all the read sections started before the call have finished
+void switch_registry::synchronize(){
+
+	unsigned int i, idx;
+
+	//Flip the epoch twice, so that readers that sampled the epoch before a
+	//flip but incremented the counter after it are also waited for
+	for(i=0;i<2;i++){
+		idx = epoch & 0x1;
+		__sync_fetch_and_add(&epoch, 1);
+
+		while(readers[idx].count)
+			sched_yield();
+	}
+
+	__sync_synchronize();
+}
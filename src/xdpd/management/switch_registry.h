@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SWITCH_REGISTRY_H
+#define SWITCH_REGISTRY_H 
+
+#include <list>
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+* @file switch_registry.h
+*
+* @brief Epoch protected dpid -> LSI registry, used by the notification
+* paths (PACKET_IN, FLOW_REMOVED, port notifications).
+*/
+
+namespace xdpd {
+
+//Fwd declaration
+class openflow_switch;
+
+/**
+* @brief dpid indexed registry of the LSIs with wait-free lookups.
+* @ingroup cmm_mgmt
+*
+* @description The registry is an immutable array of (dpid, switch)
+* pairs, sorted by dpid, which is replaced (copy-on-write) on every
+* insertion and removal. Readers do not lock:
+*
+* @code
+*	unsigned int idx = registry.read_lock();
+*	openflow_switch* sw = registry.lookup(dpid);
+*	if(sw)
+*		sw->...;
+*	registry.read_unlock(idx);
+* @endcode
+*
+* read_lock() and read_unlock() are a single atomic increment/decrement of
+* one of two reader counters, selected by the current epoch. Writers publish
+* the new array and then wait for a grace period (the two reader counters
+* drain, flipping the epoch in between) before releasing the old array. Once
+* remove() returns, no reader can reference the removed switch anymore, so it
+* can safely be destroyed.
+*
+* Writers must be serialized by the caller. They block while readers are
+* in-flight, so they must never be called from within a read section.
+*/
+class switch_registry {
+
+public:
+	switch_registry();
+	~switch_registry();
+
+	/*
+	* Read side
+	*/
+	inline unsigned int read_lock(void){
+		unsigned int idx = *(volatile unsigned int*)&epoch & 0x1;
+		__sync_fetch_and_add(&readers[idx].count, 1);
+		return idx;
+	}
+
+	inline void read_unlock(unsigned int idx){
+		__sync_fetch_and_sub(&readers[idx].count, 1);
+	}
+
+	/**
+	* Returns the switch with dpid or NULL. Must be called within a read section
+	* and the switch must not be used after read_unlock().
+	*/
+	openflow_switch* lookup(uint64_t dpid);
+
+	/**
+	* Appends the dpids of the registered switches, in ascending order. Must
+	* be called within a read section.
+	*/
+	void get_dpids(std::list<uint64_t>& dpids);
+
+	/*
+	* Write side
+	*/
+	void insert(uint64_t dpid, openflow_switch* sw);
+
+	/**
+	* Remove dpid; returns after a grace period
+	*/
+	void remove(uint64_t dpid);
+
+private:
+	typedef struct registry_entry{
+		uint64_t dpid;
+		openflow_switch* sw;
+	}registry_entry_t;
+
+	typedef struct registry_table{
+		unsigned int num_of_entries;
+		registry_entry_t entries[0];
+	}registry_table_t;
+
+	//Current table
+	registry_table_t* volatile table;
+
+	//Reader counters; one per epoch parity, each in its own cache line
+	unsigned int epoch;
+	struct {
+		volatile unsigned int count;
+		char pad[64-sizeof(unsigned int)];
+	}readers[2] __attribute__((aligned(64)));
+
+	static registry_table_t* alloc_table(unsigned int num_of_entries);
+	void publish(registry_table_t* new_table);
+	void synchronize(void);
+
+	// this class is noncopyable
+	switch_registry(const switch_registry&);
+	switch_registry& operator=(const switch_registry&);
+};
+
+}// namespace xdpd
+
+#endif /* SWITCH_REGISTRY_H */
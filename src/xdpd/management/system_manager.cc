@@ -3,6 +3,11 @@
 #include <sstream>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <pthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
 #include <rofl/common/ciosrv.h>
 #include <rofl/common/utils/c_logger.h>
 #include <rofl/datapath/pipeline/util/logging.h>
@@ -41,6 +46,52 @@ void interrupt_handler(int dummy=0) {
 	ciosrv::stop();
 }
 
+//Reload (SIGHUP). The handler only writes to a pipe registered in the
+//main ciosrv loop; the reload is done by the loop, as the XMP reloads,
+//so that the plugins create their ciosrv objects in the main loop
+static pthread_mutex_t reload_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int reload_pipe[2] = { -1, -1 };
+
+void reload_handler(int dummy=0) {
+	char c = 0;
+	int saved_errno = errno;
+
+	//Full pipe; a reload is already pending
+	if(write(reload_pipe[1], &c, sizeof(c)) < 0){}
+
+	errno = saved_errno;
+}
+
+class reload_listener : public ciosrv {
+
+public:
+	reload_listener(){
+		register_filedesc_r(reload_pipe[0]);
+	}
+
+	virtual ~reload_listener(){
+		deregister_filedesc_r(reload_pipe[0]);
+	}
+
+protected:
+	virtual void handle_revent(int fd){
+		char buf[64];
+
+		//Coalesce the pending SIGHUPs in a single reload
+		while(read(fd, buf, sizeof(buf)) > 0);
+
+		ROFL_INFO("[xdpd][system_manager] SIGHUP received; reloading configuration\n");
+		system_manager::reload_configuration();
+	}
+};
+
+void system_manager::reload_configuration(){
+
+	pthread_mutex_lock(&reload_mutex);
+	plugin_manager::reload();
+	pthread_mutex_unlock(&reload_mutex);
+}
+
 
 std::string system_manager::__get_driver_extra_params(){
 
@@ -123,6 +174,10 @@ void system_manager::init_command_line_options(){
 	//Version
 	env_parser->add_option(coption(true, NO_ARGUMENT, 'v', "version", "Retrieve xDPd version and exit", std::string("")));
 
+	//Warm restart
+	env_parser->add_option(coption(true, REQUIRED_ARGUMENT, 'p', "checkpoint-dir", "Directory where the flow and group tables are checkpointed on shutdown, and restored from when the LSIs are created (disabled by default)", ""));
+	env_parser->add_option(coption(true, REQUIRED_ARGUMENT, 'P', "checkpoint-interval", "Additionally checkpoint the flow and group tables every N seconds (0 disables it)", "0"));
+
 
 	//Add plugin options
 	std::vector<coption> plugin_options = plugin_manager::__get_plugin_options();
@@ -225,14 +280,44 @@ void system_manager::init(int argc, char** argv){
 	//done
 	inited = true;
 	
+	//Warm restart; must be set before the LSIs are created. Test runs
+	//do not touch the checkpoints
+	if(!is_test_run() && env_parser->is_arg_set("checkpoint-dir"))
+		switch_manager::set_checkpoint_dir(env_parser->get_arg("checkpoint-dir"));
+
 	//Load plugins
 	optind=0;
 	plugin_manager::init();
 
 	//If test-config is not set, launch ciosrv loop, otherwise terminate execution
 	if(!is_test_run()){
+		//Reload on SIGHUP
+		reload_listener* reload = NULL;
+		if(pipe(reload_pipe) == 0){
+			fcntl(reload_pipe[0], F_SETFL, fcntl(reload_pipe[0], F_GETFL) | O_NONBLOCK);
+			fcntl(reload_pipe[1], F_SETFL, fcntl(reload_pipe[1], F_GETFL) | O_NONBLOCK);
+			reload = new reload_listener();
+			signal(SIGHUP, reload_handler);
+		}else{
+			ROFL_ERR("[xdpd][system_manager] Unable to create the reload pipe; SIGHUP will be ignored\n");
+			signal(SIGHUP, SIG_IGN);
+		}
+
+		if(env_parser->is_arg_set("checkpoint-dir") && env_parser->is_arg_set("checkpoint-interval"))
+			switch_manager::start_periodic_checkpoints(atoi(env_parser->get_arg("checkpoint-interval").c_str()));
+
 		//ciosrv run. Only will stop in Ctrl+C
 		ciosrv::run();
+
+		switch_manager::stop_periodic_checkpoints();
+
+		//Stop listening to SIGHUP
+		signal(SIGHUP, SIG_IGN);
+		if(reload){
+			delete reload;
+			close(reload_pipe[0]);
+			close(reload_pipe[1]);
+		}
 	}
 
 	//Printing nice trace
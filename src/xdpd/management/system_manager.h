@@ -89,6 +89,17 @@ public:
 	*/
 	static std::string get_option_value(const std::string& option_name);
 
+	//
+	// Configuration
+	//
+
+	/**
+	* Reload the configuration of the plugins (e.g. re-read the config file and
+	* apply the differences). Also triggered by SIGHUP, in the main ciosrv loop.
+	* Reloads are serialized.
+	*/
+	static void reload_configuration(void);
+
 	//
 	// xDPd logging
 	//
@@ -0,0 +1,110 @@
+#include "action_group_cache.h"
+
+#include <vector>
+
+using namespace xdpd;
+
+action_group_cache::action_group_cache(unsigned int max_entries) :
+		max_entries(max_entries),
+		hits(0),
+		misses(0)
+{
+
+}
+
+action_group_cache::~action_group_cache(){
+	clear();
+}
+
+std::string action_group_cache::get_key(rofl::openflow::cofactions& actions){
+
+	size_t len = actions.length();
+
+	if(!len)
+		return std::string();
+
+	std::vector<uint8_t> buf(len);
+	actions.pack(&buf[0], len);
+
+	return std::string((const char*)&buf[0], len);
+}
+
+bool action_group_cache::is_cacheable(of1x_action_group_t* action_group){
+
+	of1x_packet_action_t* action;
+
+	for(action=action_group->head;action;action = action->next){
+		//Groups may be modified or removed between PACKET_OUTs
+		if(action->type == OF1X_AT_GROUP)
+			return false;
+	}
+
+	return true;
+}
+
+of1x_action_group_t* action_group_cache::lookup(const std::string& key){
+
+	std::map<std::string, lru_t::iterator>::iterator it = entries.find(key);
+
+	if(it == entries.end()){
+		misses++;
+		return NULL;
+	}
+
+	//Move to the front
+	lru.splice(lru.begin(), lru, it->second);
+
+	hits++;
+	return it->second->second;
+}
+
+bool action_group_cache::insert(const std::string& key, of1x_action_group_t* action_group){
+
+	if(!max_entries || !is_cacheable(action_group) || entries.find(key) != entries.end())
+		return false;
+
+	//Evict the least recently used
+	if(entries.size() >= max_entries){
+		entries.erase(lru.back().first);
+		of1x_destroy_action_group(lru.back().second);
+		lru.pop_back();
+	}
+
+	lru.push_front(std::make_pair(key, action_group));
+	entries[key] = lru.begin();
+
+	return true;
+}
+
+of1x_action_group_t* action_group_cache::acquire(rofl::crofctl* ctl, openflow_switch* sw, rofl::openflow::cofactions& actions, map_actions_t map_actions, bool& cached){
+
+	std::string key = get_key(actions);
+	of1x_action_group_t* action_group = lookup(key);
+
+	if(action_group){
+		cached = true;
+		return action_group;
+	}
+
+	action_group = of1x_init_action_group(NULL);
+
+	try{
+		map_actions(ctl, sw, actions, action_group, NULL);
+	}catch(...){
+		of1x_destroy_action_group(action_group);
+		throw;
+	}
+
+	cached = insert(key, action_group);
+
+	return action_group;
+}
+
+void action_group_cache::clear(){
+
+	for(lru_t::iterator it = lru.begin(); it != lru.end(); ++it)
+		of1x_destroy_action_group(it->second);
+
+	lru.clear();
+	entries.clear();
+}
@@ -0,0 +1,125 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ACTION_GROUP_CACHE_H
+#define ACTION_GROUP_CACHE_H
+
+#include <map>
+#include <list>
+#include <string>
+#include <stdint.h>
+
+#include <rofl/common/openflow/cofactions.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_action.h>
+
+namespace rofl {
+	class crofctl;
+}
+
+/**
+* @file action_group_cache.h
+*
+* @brief Cache of translated PACKET_OUT action lists
+*/
+
+namespace xdpd {
+
+//Fwd declaration
+class openflow_switch;
+
+/**
+* @brief Cache of PACKET_OUT action groups keyed by the wire format of the
+* action list.
+* @ingroup cmm_of
+*
+* @description Controllers doing reactive forwarding send the same few
+* action lists over and over again (e.g. output:port). Caching the
+* translated of1x_action_group_t avoids translating and (de)allocating the
+* action group for every PACKET_OUT. Entries are evicted in LRU order.
+*
+* The cache is NOT thread-safe; it is owned by an endpoint and only used
+* from the endpoint's handlers. Action groups returned by lookup() and
+* acquire() remain valid until the next insert(), acquire() or clear().
+* Since eviction is in LRU order, a group is not evicted by the next
+* max_entries-1 acquire() calls, so the groups of the last max_entries
+* calls can be kept in use (e.g. pending in a packet_out_batch).
+*/
+class action_group_cache {
+
+public:
+	static const unsigned int DEFAULT_MAX_ENTRIES = 256;
+
+	//Translation of an action list (ofXX_translation_utils)
+	typedef void (*map_actions_t)(rofl::crofctl* ctl, openflow_switch* sw, rofl::openflow::cofactions& actions, of1x_action_group_t* apply_actions, of1x_write_actions_t* write_actions);
+
+	action_group_cache(unsigned int max_entries = DEFAULT_MAX_ENTRIES);
+	~action_group_cache();
+
+	/**
+	* Compose the key of an action list (wire format)
+	*/
+	static std::string get_key(rofl::openflow::cofactions& actions);
+
+	/**
+	* Returns the cached action group for key, or NULL
+	*/
+	of1x_action_group_t* lookup(const std::string& key);
+
+	/**
+	* Insert an action group. On success the cache takes the ownership
+	* of the group. Groups containing actions that depend on the state of the
+	* LSI (e.g. GROUP) are not cached; in this case false is returned and the
+	* caller keeps the ownership.
+	*/
+	bool insert(const std::string& key, of1x_action_group_t* action_group);
+
+	/**
+	* Returns the action group of a PACKET_OUT action list; either the cached
+	* one or translated with map_actions (and cached, if possible).
+	* cached is set to false if the caller owns the group, which must then be
+	* handed back with release(). Exceptions of map_actions are rethrown.
+	*/
+	of1x_action_group_t* acquire(rofl::crofctl* ctl, openflow_switch* sw, rofl::openflow::cofactions& actions, map_actions_t map_actions, bool& cached);
+
+	/**
+	* Release an action group returned by acquire()
+	*/
+	static void release(of1x_action_group_t* action_group, bool cached){
+		if(!cached)
+			of1x_destroy_action_group(action_group);
+	}
+
+	/**
+	* Drop all the entries
+	*/
+	void clear(void);
+
+	//Stats
+	uint64_t get_hits() const { return hits; }
+	uint64_t get_misses() const { return misses; }
+	unsigned int size() const { return entries.size(); }
+	unsigned int get_max_entries() const { return max_entries; }
+
+private:
+	typedef std::list<std::pair<std::string, of1x_action_group_t*> > lru_t;
+
+	unsigned int max_entries;
+
+	//Most recently used first
+	lru_t lru;
+	std::map<std::string, lru_t::iterator> entries;
+
+	uint64_t hits;
+	uint64_t misses;
+
+	static bool is_cacheable(of1x_action_group_t* action_group);
+
+	// this class is noncopyable
+	action_group_cache(const action_group_cache&);
+	action_group_cache& operator=(const action_group_cache&);
+};
+
+}// namespace xdpd
+
+#endif /* ACTION_GROUP_CACHE_H */
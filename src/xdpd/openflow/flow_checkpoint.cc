@@ -0,0 +1,386 @@
+#include "flow_checkpoint.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rofl/common/utils/c_logger.h>
+#include <rofl/common/openflow/cofflowmod.h>
+#include <rofl/common/openflow/messages/cofmsg_flow_mod.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+
+#include "openflow_switch.h"
+#include "flow_mod_batch.h"
+#include "openflow13/of13_translation_utils.h"
+
+using namespace xdpd;
+
+//Records are padded to 8 bytes
+#define CKPT_ALIGN(len) (((len)+7) & ~((size_t)7))
+
+static const uint8_t ckpt_padding[8] = {0,0,0,0,0,0,0,0};
+
+std::string flow_checkpoint::get_path(const std::string& dir, uint64_t dpid){
+
+	char name[64];
+
+	snprintf(name, sizeof(name), "/lsi-%016"PRIx64".ckpt", dpid);
+
+	return dir + name;
+}
+
+static void append_record(std::vector<uint8_t>& image, const void* hdr, size_t hdr_len, std::vector<uint8_t>& data){
+
+	size_t len = hdr_len + data.size();
+
+	image.insert(image.end(), (const uint8_t*)hdr, (const uint8_t*)hdr + hdr_len);
+	image.insert(image.end(), data.begin(), data.end());
+	image.insert(image.end(), ckpt_padding, ckpt_padding + (CKPT_ALIGN(len)-len));
+}
+
+static rofl_result_t serialize_groups(openflow_switch* sw, std::vector<uint8_t>& image, flow_checkpoint_hdr_t* hdr){
+
+	of1x_group_table_t group_table;
+	of1x_group_t* group_it;
+	flow_checkpoint_group_t rec;
+	std::vector<uint8_t> data;
+
+	if(hal_driver_of1x_fetch_group_table(sw->dpid, &group_table) != HAL_SUCCESS)
+		return ROFL_FAILURE;
+
+	for(group_it = group_table.head; group_it; group_it = group_it->next){
+
+		rofl::openflow::cofbuckets buckets(rofl::openflow13::OFP_VERSION);
+		of13_translation_utils::of13_map_reverse_bucket_list(buckets, group_it->bc_list);
+
+		data.resize(buckets.length());
+		if(data.size())
+			buckets.pack(&data[0], data.size());
+
+		memset(&rec, 0, sizeof(rec));
+		rec.len = sizeof(rec) + data.size();
+		rec.group_id = group_it->id;
+		rec.type = group_it->type;
+		rec.buckets_len = data.size();
+
+		append_record(image, &rec, sizeof(rec), data);
+
+		hdr->num_of_groups++;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t serialize_flows(openflow_switch* sw, std::vector<uint8_t>& image, flow_checkpoint_hdr_t* hdr){
+
+	rofl_result_t result = ROFL_SUCCESS;
+	of1x_flow_entry_t* entry;
+	of1x_stats_flow_msg_t* fp_msg;
+	of1x_stats_single_flow_msg_t* elem;
+	flow_checkpoint_flow_t rec;
+	std::vector<uint8_t> data;
+
+	//All the flows of all the tables (empty match)
+	entry = of1x_init_flow_entry(false);
+	if(!entry)
+		return ROFL_FAILURE;
+
+	fp_msg = hal_driver_of1x_get_flow_stats(sw->dpid,
+						rofl::openflow13::OFPTT_ALL,
+						0x0ULL,
+						0x0ULL,
+						rofl::openflow13::OFPP_ANY,
+						rofl::openflow13::OFPG_ANY,
+						&entry->matches);
+	of1x_destroy_flow_entry(entry);
+
+	if(!fp_msg)
+		return ROFL_FAILURE;
+
+	try{
+		for(elem = fp_msg->flows_head; elem; elem = elem->next){
+
+			rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+			of13_translation_utils::of13_map_reverse_flow_entry_matches(elem->matches, match);
+
+			rofl::openflow::cofinstructions instructions(rofl::openflow13::OFP_VERSION);
+			of13_translation_utils::of13_map_reverse_flow_entry_instructions((of1x_instruction_group_t*)(elem->inst_grp), instructions);
+
+			data.resize(match.length() + instructions.length());
+			match.pack(&data[0], match.length());
+			if(instructions.length())
+				instructions.pack(&data[match.length()], instructions.length());
+
+			memset(&rec, 0, sizeof(rec));
+			rec.len = sizeof(rec) + data.size();
+			rec.table_id = elem->table_id;
+			rec.priority = elem->priority;
+			rec.cookie = elem->cookie;
+			rec.idle_timeout = elem->idle_timeout;
+			rec.hard_timeout = elem->hard_timeout;
+			rec.match_len = match.length();
+			rec.instructions_len = instructions.length();
+
+			append_record(image, &rec, sizeof(rec), data);
+
+			hdr->num_of_flows++;
+		}
+	}catch(...){
+		ROFL_ERR("[xdpd][flow_checkpoint] Unable to serialize the flows of dpid 0x%"PRIx64"\n", sw->dpid);
+		result = ROFL_FAILURE;
+	}
+
+	of1x_destroy_stats_flow_msg(fp_msg);
+
+	return result;
+}
+
+rofl_result_t flow_checkpoint::serialize(openflow_switch* sw, uint64_t generation, std::vector<uint8_t>& image){
+
+	flow_checkpoint_hdr_t hdr;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = FLOW_CHECKPOINT_MAGIC;
+	hdr.version = FLOW_CHECKPOINT_VERSION;
+	hdr.of_version = sw->version;
+	hdr.dpid = sw->dpid;
+	hdr.generation = generation;
+	hdr.timestamp = time(NULL);
+	hdr.num_of_tables = sw->num_of_tables;
+
+	//Header is filled in once the counts are known
+	image.clear();
+	image.resize(sizeof(hdr));
+
+	//Groups first, flows may point to them
+	if(serialize_groups(sw, image, &hdr) != ROFL_SUCCESS || serialize_flows(sw, image, &hdr) != ROFL_SUCCESS){
+		ROFL_ERR("[xdpd][flow_checkpoint] Unable to serialize the tables of dpid 0x%"PRIx64"\n", sw->dpid);
+		image.clear();
+		return ROFL_FAILURE;
+	}
+
+	hdr.len = image.size();
+	memcpy(&image[0], &hdr, sizeof(hdr));
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t flow_checkpoint::write(const std::string& path, const std::vector<uint8_t>& image){
+
+	int fd;
+	ssize_t ret;
+	size_t done = 0;
+	std::string tmp_path = path + ".tmp";
+
+	fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0){
+		ROFL_ERR("[xdpd][flow_checkpoint] Unable to create %s, errno(%d): %s\n", tmp_path.c_str(), errno, strerror(errno));
+		return ROFL_FAILURE;
+	}
+
+	while(done < image.size()){
+		ret = ::write(fd, &image[done], image.size()-done);
+		if(ret < 0){
+			if(errno == EINTR)
+				continue;
+			goto WRITE_ERROR;
+		}
+		done += ret;
+	}
+
+	if(fsync(fd) != 0)
+		goto WRITE_ERROR;
+
+	close(fd);
+
+	if(rename(tmp_path.c_str(), path.c_str()) != 0){
+		ROFL_ERR("[xdpd][flow_checkpoint] Unable to rename %s to %s, errno(%d): %s\n", tmp_path.c_str(), path.c_str(), errno, strerror(errno));
+		unlink(tmp_path.c_str());
+		return ROFL_FAILURE;
+	}
+
+	ROFL_DEBUG("[xdpd][flow_checkpoint] Saved %s (%u bytes)\n", path.c_str(), (unsigned int)image.size());
+
+	return ROFL_SUCCESS;
+
+WRITE_ERROR:
+	ROFL_ERR("[xdpd][flow_checkpoint] Unable to write %s, errno(%d): %s\n", tmp_path.c_str(), errno, strerror(errno));
+	close(fd);
+	unlink(tmp_path.c_str());
+	return ROFL_FAILURE;
+}
+
+rofl_result_t flow_checkpoint::save(openflow_switch* sw, const std::string& path, uint64_t generation){
+
+	std::vector<uint8_t> image;
+
+	if(serialize(sw, generation, image) != ROFL_SUCCESS)
+		return ROFL_FAILURE;
+
+	return write(path, image);
+}
+
+static unsigned int restore_groups(openflow_switch* sw, uint8_t** it, uint8_t* end, uint32_t num_of_groups){
+
+	unsigned int failed = 0;
+	flow_checkpoint_group_t* rec;
+	of1x_bucket_list_t* bucket_list;
+	rofl_of1x_gm_result_t ret_val;
+
+	for(uint32_t i=0; i<num_of_groups; ++i){
+
+		rec = (flow_checkpoint_group_t*)*it;
+		if(*it + sizeof(*rec) > end || rec->len < sizeof(*rec) || *it + rec->len > end || sizeof(*rec) + rec->buckets_len > rec->len)
+			throw -1;
+		*it += CKPT_ALIGN(rec->len);
+
+		bucket_list = of1x_init_bucket_list();
+
+		try{
+			rofl::openflow::cofbuckets buckets(rofl::openflow13::OFP_VERSION);
+			buckets.unpack(rec->data, rec->buckets_len);
+			of13_translation_utils::of13_map_bucket_list(NULL, sw, buckets, bucket_list);
+			ret_val = hal_driver_of1x_group_mod_add(sw->dpid, (of1x_group_type_t)rec->type, rec->group_id, &bucket_list);
+		}catch(...){
+			ret_val = ROFL_OF1X_GM_INVAL;
+		}
+
+		if(ret_val != ROFL_OF1X_GM_OK){
+			ROFL_ERR("[xdpd][flow_checkpoint] Unable to restore group %u of dpid 0x%"PRIx64"\n", rec->group_id, sw->dpid);
+			of1x_destroy_bucket_list(bucket_list);
+			failed++;
+		}
+	}
+
+	return failed;
+}
+
+static unsigned int restore_flows(openflow_switch* sw, uint8_t** it, uint8_t* end, uint64_t num_of_flows){
+
+	unsigned int failed = 0;
+	flow_checkpoint_flow_t* rec;
+	of1x_flow_entry_t* entry;
+	flow_mod_batch batch;
+
+	batch.set_max_size(sw->dpid, flow_checkpoint::RESTORE_BATCH_SIZE);
+
+	for(uint64_t i=0; i<num_of_flows; ++i){
+
+		rec = (flow_checkpoint_flow_t*)*it;
+		if(*it + sizeof(*rec) > end || rec->len < sizeof(*rec) || *it + rec->len > end || sizeof(*rec) + rec->match_len + rec->instructions_len > rec->len)
+			throw -1;
+		*it += CKPT_ALIGN(rec->len);
+
+		if(rec->table_id >= sw->num_of_tables){
+			failed++;
+			continue;
+		}
+
+		try{
+			rofl::openflow::cofflowmod fm(rofl::openflow13::OFP_VERSION);
+			fm.set_command(rofl::openflow13::OFPFC_ADD);
+			fm.set_table_id(rec->table_id);
+			fm.set_priority(rec->priority);
+			fm.set_cookie(rec->cookie);
+			fm.set_idle_timeout(rec->idle_timeout);
+			fm.set_hard_timeout(rec->hard_timeout);
+			fm.set_buffer_id(rofl::openflow13::OFP_NO_BUFFER);
+			fm.set_out_port(rofl::openflow13::OFPP_ANY);
+			fm.set_out_group(rofl::openflow13::OFPG_ANY);
+			fm.set_match().unpack(rec->data, rec->match_len);
+			if(rec->instructions_len)
+				fm.set_instructions().unpack(rec->data + rec->match_len, rec->instructions_len);
+
+			rofl::openflow::cofmsg_flow_mod msg(rofl::openflow13::OFP_VERSION, 0, fm);
+			entry = of13_translation_utils::of13_map_flow_entry(NULL, &msg, sw);
+		}catch(...){
+			entry = NULL;
+		}
+
+		if(!entry){
+			failed++;
+			continue;
+		}
+
+		batch.add(rec->table_id, entry, false, false);
+	}
+
+	batch.flush();
+
+	return failed + batch.get_num_of_failures();
+}
+
+rofl_result_t flow_checkpoint::restore(openflow_switch* sw, const std::string& path, uint64_t* generation){
+
+	int fd;
+	struct stat st;
+	uint8_t *base, *it, *end;
+	flow_checkpoint_hdr_t* hdr;
+	unsigned int failed = 0;
+
+	fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0){
+		if(errno != ENOENT)
+			ROFL_ERR("[xdpd][flow_checkpoint] Unable to open %s, errno(%d): %s\n", path.c_str(), errno, strerror(errno));
+		return ROFL_FAILURE;
+	}
+
+	if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(flow_checkpoint_hdr_t)){
+		ROFL_ERR("[xdpd][flow_checkpoint] Invalid checkpoint %s\n", path.c_str());
+		close(fd);
+		return ROFL_FAILURE;
+	}
+
+	base = (uint8_t*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(base == MAP_FAILED){
+		ROFL_ERR("[xdpd][flow_checkpoint] Unable to map %s, errno(%d): %s\n", path.c_str(), errno, strerror(errno));
+		return ROFL_FAILURE;
+	}
+	madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+	hdr = (flow_checkpoint_hdr_t*)base;
+
+	if(hdr->magic != FLOW_CHECKPOINT_MAGIC || hdr->version != FLOW_CHECKPOINT_VERSION || hdr->len != (uint64_t)st.st_size){
+		ROFL_ERR("[xdpd][flow_checkpoint] Invalid or truncated checkpoint %s\n", path.c_str());
+		munmap(base, st.st_size);
+		return ROFL_FAILURE;
+	}
+
+	if(hdr->dpid != sw->dpid || hdr->of_version != (uint32_t)sw->version){
+		ROFL_ERR("[xdpd][flow_checkpoint] Checkpoint %s is for dpid 0x%"PRIx64" (OF version %u); not restoring it into dpid 0x%"PRIx64" (OF version %u)\n", path.c_str(), hdr->dpid, hdr->of_version, sw->dpid, sw->version);
+		munmap(base, st.st_size);
+		return ROFL_FAILURE;
+	}
+
+	it = base + sizeof(flow_checkpoint_hdr_t);
+	end = base + st.st_size;
+
+	try{
+		failed += restore_groups(sw, &it, end, hdr->num_of_groups);
+		failed += restore_flows(sw, &it, end, hdr->num_of_flows);
+	}catch(...){
+		ROFL_ERR("[xdpd][flow_checkpoint] Corrupted checkpoint %s; the tables of dpid 0x%"PRIx64" have been partially restored\n", path.c_str(), sw->dpid);
+		failed++;
+	}
+
+	if(failed)
+		ROFL_ERR("[xdpd][flow_checkpoint] %u flows/groups of dpid 0x%"PRIx64" could not be restored from %s\n", failed, sw->dpid, path.c_str());
+
+	ROFL_INFO("[xdpd][flow_checkpoint] Restored %"PRIu64" flows and %u groups of dpid 0x%"PRIx64" from %s (generation %"PRIu64")\n", hdr->num_of_flows, hdr->num_of_groups, sw->dpid, path.c_str(), hdr->generation);
+
+	if(generation)
+		*generation = hdr->generation;
+
+	munmap(base, st.st_size);
+
+	return ROFL_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FLOW_CHECKPOINT_H
+#define FLOW_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <rofl.h>
+
+/**
+* @file flow_checkpoint.h
+*
+* @brief Checkpointing of the flow and group tables of an LSI (warm restart)
+*/
+
+namespace xdpd {
+
+//Fwd declaration
+class openflow_switch;
+
+#define FLOW_CHECKPOINT_MAGIC 0x58445044434b5054ULL //"XDPDCKPT"
+#define FLOW_CHECKPOINT_VERSION 1
+
+/**
+* Checkpoint file layout (host byte order). The header is followed by
+* num_of_groups group records and num_of_flows flow records. Every record
+* starts with its length and is padded to 8 bytes. Matches, instructions
+* and buckets are stored in OpenFlow 1.3 wire format, regardless of the
+* version of the LSI (they all share the of1x representation).
+*/
+typedef struct flow_checkpoint_hdr{
+	uint64_t magic;
+	uint32_t version;
+	uint32_t of_version;
+	uint64_t dpid;
+	uint64_t generation;		//Incremented on every checkpoint
+	uint64_t timestamp;		//Seconds since the Epoch
+	uint32_t num_of_tables;
+	uint32_t num_of_groups;
+	uint64_t num_of_flows;
+	uint64_t len;			//Length of the file
+}__attribute__((packed)) flow_checkpoint_hdr_t;
+
+typedef struct flow_checkpoint_group{
+	uint32_t len;
+	uint32_t group_id;
+	uint8_t type;
+	uint8_t pad[3];
+	uint32_t buckets_len;
+	uint8_t data[0];		//buckets
+}__attribute__((packed)) flow_checkpoint_group_t;
+
+typedef struct flow_checkpoint_flow{
+	uint32_t len;
+	uint8_t table_id;
+	uint8_t pad;
+	uint16_t priority;
+	uint64_t cookie;
+	uint16_t idle_timeout;
+	uint16_t hard_timeout;
+	uint16_t match_len;
+	uint16_t instructions_len;
+	uint8_t data[0];		//match, instructions
+}__attribute__((packed)) flow_checkpoint_flow_t;
+
+/**
+* @brief Saves and restores the flow and group tables of an LSI
+* @ingroup cmm_of
+*
+* @description The file is written to a temporary file and renamed, so a
+* checkpoint is either complete or not there at all. Restoring maps the
+* file and installs the groups first and then the flows, in batches.
+*
+* Cookies are kept as they were, so that a reconnecting controller can
+* reconcile its state using them; the generation of the checkpoint the
+* tables were restored from is logged and kept in
+* openflow_switch::checkpoint_generation. Timers restart from zero and
+* counters are not preserved.
+*/
+class flow_checkpoint {
+
+public:
+	//Size of the FLOW_MOD batches used to restore the flows
+	static const unsigned int RESTORE_BATCH_SIZE = 1024;
+
+	/**
+	* Path of the checkpoint of the LSI dpid in the directory dir
+	*/
+	static std::string get_path(const std::string& dir, uint64_t dpid);
+
+	/**
+	* Serialize the flow and group tables of the LSI (the whole checkpoint
+	* file) into image
+	*/
+	static rofl_result_t serialize(openflow_switch* sw, uint64_t generation, std::vector<uint8_t>& image);
+
+	/**
+	* Write a serialized checkpoint to path. It does not access the LSI, so
+	* it can be called without holding the switch_manager locks.
+	*/
+	static rofl_result_t write(const std::string& path, const std::vector<uint8_t>& image);
+
+	/**
+	* Write the flow and group tables of the LSI to path (serialize() and
+	* write())
+	*/
+	static rofl_result_t save(openflow_switch* sw, const std::string& path, uint64_t generation);
+
+	/**
+	* Install the flows and groups of the checkpoint at path into the LSI.
+	* Fails, without touching the LSI, if the checkpoint does not exist or
+	* is not for this LSI (dpid, version).
+	*/
+	static rofl_result_t restore(openflow_switch* sw, const std::string& path, uint64_t* generation);
+};
+
+}// namespace xdpd
+
+#endif /* FLOW_CHECKPOINT_H */
@@ -0,0 +1,99 @@
+#include "flow_mod_batch.h"
+
+#include <rofl/common/logging.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+
+using namespace xdpd;
+
+flow_mod_batch::flow_mod_batch(flow_mod_batch_listener* listener) :
+		listener(listener),
+		dpid(0),
+		max_size(0),
+		table_id(0),
+		check_overlap(false),
+		reset_counts(false),
+		num_of_batches(0),
+		num_of_entries(0),
+		num_of_failures(0)
+{
+
+}
+
+flow_mod_batch::~flow_mod_batch(){
+	//Install whatever is left
+	flush();
+}
+
+void flow_mod_batch::set_max_size(uint64_t dpid, unsigned int max_size){
+
+	flush();
+	this->dpid = dpid;
+	this->max_size = max_size;
+	entries.reserve(max_size);
+	opaques.reserve(max_size);
+	results.resize(max_size);
+}
+
+bool flow_mod_batch::add(uint8_t table_id, of1x_flow_entry_t* entry, bool check_overlap, bool reset_counts, void* opaque){
+
+	if(!max_size)
+		return false;
+
+	//A batch is applied to a single table with the same flags
+	if(!entries.empty() && (table_id != this->table_id || check_overlap != this->check_overlap || reset_counts != this->reset_counts))
+		flush();
+
+	if(entries.empty()){
+		this->table_id = table_id;
+		this->check_overlap = check_overlap;
+		this->reset_counts = reset_counts;
+	}
+
+	entries.push_back(entry);
+	opaques.push_back(opaque);
+
+	if(entries.size() >= max_size)
+		flush();
+
+	return true;
+}
+
+void flow_mod_batch::flush(){
+
+	unsigned int i, num = entries.size();
+
+	if(!num)
+		return;
+
+	if(results.size() < num)
+		results.resize(num);
+
+	if(hal_driver_of1x_process_flow_mod_add_batch){
+		hal_driver_of1x_process_flow_mod_add_batch(dpid, table_id, &entries[0], num, check_overlap, reset_counts, &results[0]);
+	}else{
+		//Driver does not support batches
+		for(i=0;i<num;i++)
+			results[i] = hal_driver_of1x_process_flow_mod_add(dpid, table_id, &entries[i], NO_BUFFER, check_overlap, reset_counts);
+	}
+
+	for(i=0;i<num;i++){
+		if(results[i] == HAL_SUCCESS)
+			continue;
+
+		rofl::logging::error << "[xdpd][flow-mod-batch] error inserting flow-mod on dpid:0x" << std::hex << dpid << std::dec << " table:" << (int)table_id << (results[i] == HAL_FM_OVERLAP_FAILURE ? " (overlap)" : "") << std::endl;
+		num_of_failures++;
+		if(entries[i])
+			of1x_destroy_flow_entry(entries[i]);
+	}
+
+	num_of_batches++;
+	num_of_entries += num;
+	entries.clear();
+
+	//Notify the failures once all the entries have been processed
+	for(i=0;i<num;i++){
+		if(results[i] != HAL_SUCCESS && listener)
+			listener->handle_flow_mod_batch_error(opaques[i], results[i]);
+	}
+	opaques.clear();
+}
@@ -0,0 +1,114 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FLOW_MOD_BATCH_H
+#define FLOW_MOD_BATCH_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <rofl/datapath/hal/hal.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
+#include "../management/hal_ext.h"
+
+/**
+* @file flow_mod_batch.h
+*
+* @brief Batching of FLOW_MOD ADDs towards the driver
+*/
+
+namespace xdpd {
+
+/**
+* @brief Receives the insertion errors of a flow_mod_batch
+* @ingroup cmm_of
+*/
+class flow_mod_batch_listener {
+
+public:
+	virtual ~flow_mod_batch_listener(){};
+
+	/**
+	* Called by flush() for every entry that could not be installed, in
+	* the order they were queued. The entry has already been released. It
+	* must not call add() nor flush() on the batch.
+	*/
+	virtual void handle_flow_mod_batch_error(void* opaque, hal_result_t result)=0;
+};
+
+/**
+* @brief Queue of FLOW_MOD ADDs to be installed in bulk.
+* @ingroup cmm_of
+*
+* @description Entries are queued and pushed to the driver in a single call
+* per table. The queue is flushed when:
+*
+* - max_size entries are queued
+* - an ADD for a different table (or with different flags) is queued
+* - flush() is called, or the batch is destroyed
+*
+* Entries are installed after add() returns. Insertion errors are logged,
+* counted and, if a listener is set, reported to it along with the opaque
+* pointer passed to add() (e.g. to send the OpenFlow error of the original
+* FLOW_MOD).
+*
+* The batch is NOT thread-safe.
+*/
+class flow_mod_batch {
+
+public:
+	static const uint32_t NO_BUFFER = 0xffffffff;
+
+	flow_mod_batch(flow_mod_batch_listener* listener=NULL);
+	~flow_mod_batch();
+
+	/**
+	* Set the LSI and the maximum number of entries of a batch. 0 disables
+	* batching (pending entries are flushed).
+	*/
+	void set_max_size(uint64_t dpid, unsigned int max_size);
+
+	/**
+	* Queue an ADD. Returns false if batching is disabled; in this case the
+	* caller keeps the ownership of the entry and must install it.
+	*/
+	bool add(uint8_t table_id, of1x_flow_entry_t* entry, bool check_overlap, bool reset_counts, void* opaque=NULL);
+
+	/**
+	* Install all the pending entries
+	*/
+	void flush(void);
+
+	//Stats
+	uint64_t get_num_of_batches() const { return num_of_batches; }
+	uint64_t get_num_of_entries() const { return num_of_entries; }
+	uint64_t get_num_of_failures() const { return num_of_failures; }
+	unsigned int get_num_of_pending() const { return entries.size(); }
+	unsigned int get_max_size() const { return max_size; }
+
+private:
+	flow_mod_batch_listener* listener;
+	uint64_t dpid;
+	unsigned int max_size;
+
+	//Pending batch
+	uint8_t table_id;
+	bool check_overlap;
+	bool reset_counts;
+	std::vector<of1x_flow_entry_t*> entries;
+	std::vector<void*> opaques;
+	std::vector<hal_result_t> results;
+
+	uint64_t num_of_batches;
+	uint64_t num_of_entries;
+	uint64_t num_of_failures;
+
+	// this class is noncopyable
+	flow_mod_batch(const flow_mod_batch&);
+	flow_mod_batch& operator=(const flow_mod_batch&);
+};
+
+}// namespace xdpd
+
+#endif /* FLOW_MOD_BATCH_H */
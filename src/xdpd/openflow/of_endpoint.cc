@@ -0,0 +1,162 @@
+#include "of_endpoint.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include "openflow_switch.h"
+
+using namespace xdpd;
+
+of_endpoint::of_endpoint(rofl::openflow::cofhello_elem_versionbitmap const& versionbitmap) :
+		crofbase(versionbitmap),
+		sw(NULL),
+		fm_batch(this),
+		fm_pending_next(0),
+		flush_scheduled(false)
+{
+	//Without it, messages are never queued
+	if(pipe(flush_pipe) < 0){
+		rofl::logging::error << "[xdpd][of-endpoint] unable to create the flush pipe; FLOW_MOD batching disabled" << std::endl;
+		flush_pipe[0] = flush_pipe[1] = -1;
+		return;
+	}
+	fcntl(flush_pipe[0], F_SETFL, fcntl(flush_pipe[0], F_GETFL) | O_NONBLOCK);
+	fcntl(flush_pipe[1], F_SETFL, fcntl(flush_pipe[1], F_GETFL) | O_NONBLOCK);
+
+	register_filedesc_r(flush_pipe[0]);
+}
+
+of_endpoint::~of_endpoint(){
+
+	//Process the pending messages; the controllers are going away
+	drop_pending_errors(NULL);
+	fm_batch.flush();
+	pktout_batch.flush();
+
+	if(flush_pipe[0] >= 0){
+		deregister_filedesc_r(flush_pipe[0]);
+		close(flush_pipe[0]);
+		close(flush_pipe[1]);
+	}
+}
+
+void of_endpoint::set_flow_mod_batch_size(unsigned int size){
+
+	//Flushes the pending ADDs (and reports their errors) first
+	fm_batch.set_max_size(sw->dpid, size);
+	fm_pending.resize(size);
+	fm_pending_next = 0;
+}
+
+void of_endpoint::set_packet_out_batch_size(unsigned int size){
+
+	//Cached action groups must not be evicted while pending
+	if(size > pktout_cache.get_max_entries())
+		size = pktout_cache.get_max_entries();
+
+	pktout_batch.set_max_size(sw->dpid, size);
+}
+
+bool of_endpoint::queue_flow_mod_add(crofctl& ctl, rofl::openflow::cofmsg_flow_mod& msg, uint8_t table_id, of1x_flow_entry_t* entry, bool check_overlap, bool reset_counts){
+
+	fm_pending_t* pending;
+	size_t len;
+
+	if(!fm_batch.get_max_size() || flush_pipe[0] < 0 || msg.get_buffer_id() != flow_mod_batch::NO_BUFFER)
+		return false;
+
+	//PACKET_OUTs read before
+	pktout_batch.flush();
+
+	//Keep the beginning of the FLOW_MOD for the error message. A slot is
+	//never reused while its entry is queued (at most max_size are)
+	len = msg.length();
+	if(fm_pack_buf.size() < len)
+		fm_pack_buf.resize(len);
+	msg.pack(&fm_pack_buf[0], len);
+
+	pending = &fm_pending[fm_pending_next];
+	fm_pending_next = (fm_pending_next+1) % fm_pending.size();
+
+	pending->ctl = &ctl;
+	pending->xid = msg.get_xid();
+	pending->datalen = (len < FLOW_MOD_ERROR_DATA_LEN)? len : FLOW_MOD_ERROR_DATA_LEN;
+	memcpy(pending->data, &fm_pack_buf[0], pending->datalen);
+
+	fm_batch.add(table_id, entry, check_overlap, reset_counts, pending);
+
+	if(fm_batch.get_num_of_pending())
+		schedule_flush();
+
+	return true;
+}
+
+bool of_endpoint::queue_packet_out(uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, bool cached, uint8_t* buffer, uint32_t buffer_size){
+
+	//Flow entries the PACKET_OUT may rely on (OFPP_TABLE)
+	fm_batch.flush();
+
+	if(flush_pipe[0] < 0 || !pktout_batch.add(buffer_id, in_port, action_group, cached, buffer, buffer_size))
+		return false;
+
+	if(pktout_batch.get_num_of_pending())
+		schedule_flush();
+
+	return true;
+}
+
+void of_endpoint::flush_pending(){
+	//Only one of them has pending messages
+	fm_batch.flush();
+	pktout_batch.flush();
+}
+
+void of_endpoint::drop_pending_errors(crofctl* ctl){
+
+	for(std::vector<fm_pending_t>::iterator it = fm_pending.begin(); it != fm_pending.end(); ++it){
+		if(!ctl || it->ctl == ctl)
+			it->ctl = NULL;
+	}
+}
+
+void of_endpoint::handle_flow_mod_batch_error(void* opaque, hal_result_t result){
+
+	fm_pending_t* pending = (fm_pending_t*)opaque;
+
+	if(!pending || !pending->ctl)
+		return;
+
+	try{
+		send_flow_mod_error(*pending->ctl, pending->xid, result, pending->data, pending->datalen);
+	}catch(...){
+		rofl::logging::error << "[xdpd][of-endpoint] unable to send the error of FLOW_MOD xid:" << pending->xid << " on dpt:" << sw->dpname << std::endl;
+	}
+}
+
+void of_endpoint::schedule_flush(){
+
+	char c = 0;
+
+	if(flush_scheduled)
+		return;
+
+	//If the pipe is full a flush is already scheduled
+	if(write(flush_pipe[1], &c, sizeof(c)) < 0){
+		//Do nothing
+	}
+	flush_scheduled = true;
+}
+
+void of_endpoint::handle_revent(int fd){
+
+	char buf[64];
+
+	if(fd != flush_pipe[0]){
+		crofbase::handle_revent(fd);
+		return;
+	}
+
+	while(read(flush_pipe[0], buf, sizeof(buf)) > 0);
+	flush_scheduled = false;
+
+	flush_pending();
+}
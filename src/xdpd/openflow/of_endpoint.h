@@ -21,6 +21,12 @@
 
 #include <rofl/common/crofbase.h>
 #include <rofl/datapath/hal/hal.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include "action_group_cache.h"
+#include "flow_mod_batch.h"
+#include "packet_in_encoder.h"
+#include "packet_out_batch.h"
+#include "../management/hal_ext.h"
 //#include "openflow_switch.h"
 
 /**
@@ -45,13 +51,19 @@ class openflow_switch;
 * @description An OpenFlow endpoint is not a single connection endpoint, but rather the agent which
 * manages both ACTIVE and PASSIVE mode connections
 */
-class of_endpoint : public crofbase {
+class of_endpoint : public crofbase, public flow_mod_batch_listener {
 
 public:
 
-	of_endpoint(rofl::openflow::cofhello_elem_versionbitmap const& versionbitmap = rofl::openflow::cofhello_elem_versionbitmap()) : crofbase(versionbitmap), sw(NULL) {};
+	//Default maximum size of the FLOW_MOD ADD batches
+	static const unsigned int DEFAULT_FLOW_MOD_BATCH_SIZE = 64;
 
-	virtual ~of_endpoint() {};
+	//Maximum size of the PACKET_OUT batches
+	static const unsigned int PACKET_OUT_BATCH_SIZE = 64;
+
+	of_endpoint(rofl::openflow::cofhello_elem_versionbitmap const& versionbitmap = rofl::openflow::cofhello_elem_versionbitmap());
+
+	virtual ~of_endpoint();
 
 	/*
 	* Port notifications
@@ -63,11 +75,123 @@ public:
 
 	virtual rofl_result_t notify_port_status_changed(const switch_port_t* port)=0;
 
+	/**
+	* Set the maximum size of the FLOW_MOD ADD batches (0 disables batching).
+	* Pending ADDs are installed first
+	*/
+	void set_flow_mod_batch_size(unsigned int size);
+
+	/**
+	* Set the maximum size of the PACKET_OUT batches (0 disables batching),
+	* at most the capacity of pktout_cache. Pending PACKET_OUTs are processed
+	* first
+	*/
+	void set_packet_out_batch_size(unsigned int size);
+
 
 protected:
+
+	//Data of the original FLOW_MOD sent back in the errors of queued ADDs
+	static const unsigned int FLOW_MOD_ERROR_DATA_LEN = 64;
+
+	/**
+	* Queue an unbuffered FLOW_MOD ADD. Queued PACKET_OUTs are processed
+	* first. Returns false if batching is disabled; the caller keeps the
+	* entry and must install it.
+	*
+	* Queued ADDs are installed, and their errors sent with the xid of the
+	* original FLOW_MOD, when the batch is full or on flush_pending(), at the
+	* latest once the messages already read from the controllers have been
+	* handled.
+	*/
+	bool queue_flow_mod_add(crofctl& ctl, rofl::openflow::cofmsg_flow_mod& msg, uint8_t table_id, of1x_flow_entry_t* entry, bool check_overlap, bool reset_counts);
+
+	/**
+	* Queue a PACKET_OUT, whose action group comes from pktout_cache. Queued
+	* ADDs are installed first. Returns false if batching is disabled; the
+	* caller keeps the action group and must process the PACKET_OUT.
+	*
+	* Queued PACKET_OUTs are processed when the batch is full or on
+	* flush_pending(), at the latest once the messages already read from the
+	* controllers have been handled.
+	*/
+	bool queue_packet_out(uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, bool cached, uint8_t* buffer, uint32_t buffer_size);
+
+	/**
+	* Process the queued messages. Must be called before handling any
+	* message other than an unbuffered FLOW_MOD ADD or a PACKET_OUT, so that
+	* the controller observes them in order (e.g. before a BARRIER_REPLY)
+	*/
+	void flush_pending(void);
+
+	/**
+	* Do not report the errors of the queued ADDs to ctl (closed)
+	*/
+	void drop_pending_errors(crofctl* ctl);
+
+	/**
+	* Send the OFPET_FLOW_MOD_FAILED error of a queued ADD
+	*/
+	virtual void send_flow_mod_error(crofctl& ctl, uint32_t xid, hal_result_t result, uint8_t* data, size_t datalen)=0;
+
+	virtual void handle_flow_mod_batch_error(void* opaque, hal_result_t result);
+
+	virtual void handle_revent(int fd);
+
+	//Flow stats are retrieved from the driver and sent in multipart
+	//replies of (at most) this number of entries, so that large tables are
+	//never copied, translated nor serialized at once
+	static const unsigned int FLOW_STATS_CHUNK_FLOWS = 256;
+
+	/**
+	* Next chunk of the flow stats of the LSI (see
+	* hal_driver_of1x_get_flow_stats_chunk()); NULL on error
+	*/
+	static inline of1x_stats_flow_msg_t* get_flow_stats_chunk(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, uint64_t* cursor){
+
+		if(hal_driver_of1x_get_flow_stats_chunk)
+			return hal_driver_of1x_get_flow_stats_chunk(dpid, table_id, cookie, cookie_mask, out_port, out_group, matches, FLOW_STATS_CHUNK_FLOWS, cursor);
+
+		//Not supported by the driver; a single chunk
+		*cursor = 0;
+		return hal_driver_of1x_get_flow_stats(dpid, table_id, cookie, cookie_mask, out_port, out_group, matches);
+	}
 	
 	//Switch to which the endpoint belongs to
 	openflow_switch* sw;	
+
+	//Translated PACKET_OUT action lists
+	action_group_cache pktout_cache;
+
+	//PACKET_IN match encoding (PACKET_INs of an LSI are sent by a single thread)
+	packet_in_encoder pktin_encoder;
+
+private:
+	//Original FLOW_MOD of a queued ADD
+	typedef struct fm_pending{
+		crofctl* ctl;	//NULL if closed
+		uint32_t xid;
+		uint8_t data[FLOW_MOD_ERROR_DATA_LEN];
+		size_t datalen;
+	}fm_pending_t;
+
+	//Pending FLOW_MOD ADDs, and their originals (one slot per entry of the
+	//batch, used round robin)
+	flow_mod_batch fm_batch;
+	std::vector<fm_pending_t> fm_pending;
+	unsigned int fm_pending_next;
+	std::vector<uint8_t> fm_pack_buf;
+
+	//Pending PACKET_OUTs (declared after pktout_cache, which owns their
+	//cached action groups, so that it is destroyed first)
+	packet_out_batch pktout_batch;
+
+	//A byte is written when the first message is queued, so that the queue
+	//is flushed by the ioloop once the pending reads have been handled
+	int flush_pipe[2];
+	bool flush_scheduled;
+
+	void schedule_flush(void);
 };
 
 }// namespace rofl
@@ -28,6 +28,10 @@ of10_endpoint::of10_endpoint(
 	//Reference back to the sw
 	this->sw = sw;
 
+	//FLOW_MOD ADDs and PACKET_OUTs are processed in batches
+	set_flow_mod_batch_size(DEFAULT_FLOW_MOD_BATCH_SIZE);
+	set_packet_out_batch_size(PACKET_OUT_BATCH_SIZE);
+
 	//Set bitmaps
 	crofbase::get_versionbitmap().add_ofp_version(rofl::openflow10::OFP_VERSION);
 	rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
@@ -50,6 +54,8 @@ of10_endpoint::handle_features_request(
 		rofl::openflow::cofmsg_features_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	logical_switch_port_t* ls_port;
 	switch_port_snapshot_t* _port;
 	uint32_t supported_actions;
@@ -136,6 +142,8 @@ of10_endpoint::handle_get_config_request(
 		rofl::openflow::cofmsg_get_config_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	uint16_t flags = 0x0;
 	uint16_t miss_send_len = 0;
 	
@@ -161,6 +169,8 @@ of10_endpoint::handle_desc_stats_request(
 		rofl::openflow::cofmsg_desc_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	std::string mfr_desc(PACKAGE_NAME);
 	std::string hw_desc(VERSION);
 	std::string sw_desc(VERSION);
@@ -185,6 +195,8 @@ of10_endpoint::handle_table_stats_request(
 		rofl::openflow::cofmsg_table_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	unsigned int num_of_tables;
 	of1x_switch_snapshot_t* of10switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
 
@@ -229,81 +241,43 @@ of10_endpoint::handle_port_stats_request(
 		rofl::openflow::cofmsg_port_stats_request& msg,
 		uint8_t aux_id)
 {
-	switch_port_snapshot_t* port;
-	uint32_t port_no = msg.get_port_stats().get_portno();
+	flush_pending();
 
-	of1x_switch_snapshot_t* of10switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
+	port_stats_t stats;
+	struct timespec duration;
+	std::vector<uint32_t> port_nums;
+	uint32_t port_no = msg.get_port_stats().get_portno();
 
-	if(!of10switch)
-		throw eRofBase();
-	
 	rofl::openflow::cofportstatsarray portstatsarray(ctl.get_version());
 
 	/*
-	 *  send statistics for all ports
+	 * Only the counters of the requested port(s) are retrieved from the driver
 	 */
-	if (rofl::openflow10::OFPP_ALL == port_no || rofl::openflow10::OFPP_NONE == port_no){
-
-		//we check all the positions in case there are empty slots
-		for (unsigned int n = 1; n < of10switch->max_ports; n++){
-
-			port = of10switch->logical_ports[n].port;
-
-			if((port != NULL) && (of10switch->logical_ports[n].attachment_state == LOGICAL_PORT_STATE_ATTACHED)){
-
-				portstatsarray.set_port_stats(port->of_port_num).set_port_no(port->of_port_num);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_packets(port->stats.rx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_packets(port->stats.tx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_bytes(port->stats.rx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_bytes(port->stats.tx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_dropped(port->stats.rx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_dropped(port->stats.tx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_errors(port->stats.rx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_errors(port->stats.tx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_frame_err(port->stats.rx_frame_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_over_err(port->stats.rx_over_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_crc_err(port->stats.rx_crc_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_collisions(port->stats.collisions);
-			}
-	 	}
-
-	}else if(port_no < of10switch->max_ports){
-		/*
-		 * send statistics for only one port
-		 */
+	if (rofl::openflow10::OFPP_ALL == port_no || rofl::openflow10::OFPP_NONE == port_no)
+		sw->get_attached_ports(port_nums);
+	else
+		port_nums.push_back(port_no);
 
-		// search for the port with the specified port-number
-		//we check all the positions in case there are empty slots
-		port = of10switch->logical_ports[port_no].port;
-		if( 	(port != NULL) &&
-			(of10switch->logical_ports[port_no].attachment_state == LOGICAL_PORT_STATE_ATTACHED) &&
-			(port->of_port_num == port_no)
-		){
-
-			//Mapping of port state
-			portstatsarray.set_port_stats(port->of_port_num).set_port_no(port->of_port_num);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_packets(port->stats.rx_packets);
-			portstatsarray.set_port_stats(port->of_port_num).set_tx_packets(port->stats.tx_packets);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_bytes(port->stats.rx_bytes);
-			portstatsarray.set_port_stats(port->of_port_num).set_tx_bytes(port->stats.tx_bytes);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_dropped(port->stats.rx_dropped);
-			portstatsarray.set_port_stats(port->of_port_num).set_tx_dropped(port->stats.tx_dropped);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_errors(port->stats.rx_errors);
-			portstatsarray.set_port_stats(port->of_port_num).set_tx_errors(port->stats.tx_errors);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_frame_err(port->stats.rx_frame_err);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_over_err(port->stats.rx_over_err);
-			portstatsarray.set_port_stats(port->of_port_num).set_rx_crc_err(port->stats.rx_crc_err);
-			portstatsarray.set_port_stats(port->of_port_num).set_collisions(port->stats.collisions);
-		}
+	for (unsigned int i = 0; i < port_nums.size(); i++){
 
 		// if port_no was not found, body.memlen() is 0
-	}else{
-		//Unknown port
-		ROFL_ERR("Got a port stats request for an unknown port: %u. Ignoring...\n",port_no);
-	}
+		if(sw->get_port_stats(port_nums[i], &stats, &duration) != ROFL_SUCCESS)
+			continue;
 
-	//Destroy the snapshot
-	of_switch_destroy_snapshot((of_switch_snapshot_t*)of10switch);
+		portstatsarray.set_port_stats(port_nums[i]).set_port_no(port_nums[i]);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_packets(stats.rx_packets);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_packets(stats.tx_packets);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_bytes(stats.rx_bytes);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_bytes(stats.tx_bytes);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_dropped(stats.rx_dropped);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_dropped(stats.tx_dropped);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_errors(stats.rx_errors);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_errors(stats.tx_errors);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_frame_err(stats.rx_frame_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_over_err(stats.rx_over_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_crc_err(stats.rx_crc_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_collisions(stats.collisions);
+	}
 
 	ctl.send_port_stats_reply(msg.get_xid(), portstatsarray, false);
 }
@@ -316,8 +290,11 @@ of10_endpoint::handle_flow_stats_request(
 		rofl::openflow::cofmsg_flow_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	of1x_stats_flow_msg_t* fp_msg = NULL;
 	of1x_flow_entry_t* entry = NULL;
+	uint64_t cursor = 0;
 
 	of1x_switch_snapshot_t* of10switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
 
@@ -340,62 +317,67 @@ of10_endpoint::handle_flow_stats_request(
 
 	}
 
-	//Ask the Forwarding Plane to process stats
-	fp_msg = hal_driver_of1x_get_flow_stats(sw->dpid,
-			msg.get_flow_stats().get_table_id(),
-			0,
-			0,
-			of10_translation_utils::get_out_port(msg.get_flow_stats().get_out_port()),
-			OF1X_GROUP_ANY,
-			&entry->matches);
+	rofl::openflow::cofflowstatsarray flowstatsarray(ctl.get_version());
 
-	if(!fp_msg){
-		of1x_destroy_flow_entry(entry);
+	try{
+		//One reply per chunk of entries; more replies follow until the
+		//driver is done
+		do{
+			fp_msg = get_flow_stats_chunk(sw->dpid,
+					msg.get_flow_stats().get_table_id(),
+					0,
+					0,
+					of10_translation_utils::get_out_port(msg.get_flow_stats().get_out_port()),
+					OF1X_GROUP_ANY,
+					&entry->matches,
+					&cursor);
 
-		//Destroy the snapshot
-		of_switch_destroy_snapshot((of_switch_snapshot_t*)of10switch);
-	
-		throw eBadRequestBadStat();
-	}
+			if(!fp_msg)
+				throw eBadRequestBadStat();
 
-	//Construct OF message
-	of1x_stats_single_flow_msg_t *elem = fp_msg->flows_head;
+			//Construct OF message
+			uint32_t flow_id = 0;
 
-	rofl::openflow::cofflowstatsarray flowstatsarray(ctl.get_version());
+			for(of1x_stats_single_flow_msg_t* elem = fp_msg->flows_head; elem; elem = elem->next){
 
-	uint32_t flow_id = 0;
+				rofl::openflow::cofmatch match(rofl::openflow10::OFP_VERSION);
+				of10_translation_utils::of1x_map_reverse_flow_entry_matches(elem->matches, match);
 
-	try{
-		for(elem = fp_msg->flows_head; elem; elem = elem->next){
-
-			rofl::openflow::cofmatch match(rofl::openflow10::OFP_VERSION);
-			of10_translation_utils::of1x_map_reverse_flow_entry_matches(elem->matches, match);
-
-			rofl::openflow::cofactions actions(rofl::openflow10::OFP_VERSION);
-			of10_translation_utils::of1x_map_reverse_flow_entry_actions((of1x_instruction_group_t*)(elem->inst_grp), actions, of10switch->pipeline.miss_send_len);
-
-			flowstatsarray.set_flow_stats(flow_id).set_table_id(elem->table_id);
-			flowstatsarray.set_flow_stats(flow_id).set_duration_sec(elem->duration_sec);
-			flowstatsarray.set_flow_stats(flow_id).set_duration_nsec(elem->duration_nsec);
-			flowstatsarray.set_flow_stats(flow_id).set_priority(elem->priority);
-			flowstatsarray.set_flow_stats(flow_id).set_idle_timeout(elem->idle_timeout);
-			flowstatsarray.set_flow_stats(flow_id).set_hard_timeout(elem->hard_timeout);
-			flowstatsarray.set_flow_stats(flow_id).set_cookie(elem->cookie);
-			flowstatsarray.set_flow_stats(flow_id).set_packet_count(elem->packet_count);
-			flowstatsarray.set_flow_stats(flow_id).set_byte_count(elem->byte_count);
-			flowstatsarray.set_flow_stats(flow_id).set_match() = match;
-			flowstatsarray.set_flow_stats(flow_id).set_actions() = actions;
-
-			flow_id++;
-
-			// TODO: check this implicit assumption of always using a single instruction?
-			// this should be an instruction of type OFPIT_APPLY_ACTIONS anyway
-		}
+				rofl::openflow::cofactions actions(rofl::openflow10::OFP_VERSION);
+				of10_translation_utils::of1x_map_reverse_flow_entry_actions((of1x_instruction_group_t*)(elem->inst_grp), actions, of10switch->pipeline.miss_send_len);
 
-		//Send message
-		ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray);
+				flowstatsarray.set_flow_stats(flow_id).set_table_id(elem->table_id);
+				flowstatsarray.set_flow_stats(flow_id).set_duration_sec(elem->duration_sec);
+				flowstatsarray.set_flow_stats(flow_id).set_duration_nsec(elem->duration_nsec);
+				flowstatsarray.set_flow_stats(flow_id).set_priority(elem->priority);
+				flowstatsarray.set_flow_stats(flow_id).set_idle_timeout(elem->idle_timeout);
+				flowstatsarray.set_flow_stats(flow_id).set_hard_timeout(elem->hard_timeout);
+				flowstatsarray.set_flow_stats(flow_id).set_cookie(elem->cookie);
+				flowstatsarray.set_flow_stats(flow_id).set_packet_count(elem->packet_count);
+				flowstatsarray.set_flow_stats(flow_id).set_byte_count(elem->byte_count);
+				flowstatsarray.set_flow_stats(flow_id).set_match() = match;
+				flowstatsarray.set_flow_stats(flow_id).set_actions() = actions;
+
+				flow_id++;
+
+				// TODO: check this implicit assumption of always using a single instruction?
+				// this should be an instruction of type OFPIT_APPLY_ACTIONS anyway
+			}
+
+			of1x_destroy_stats_flow_msg(fp_msg);
+			fp_msg = NULL;
+
+			//Send message
+			if(cursor)
+				ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray, openflow10::OFPSF_REPLY_MORE);
+			else
+				ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray);
+
+			flowstatsarray.clear();
+		}while(cursor);
 	}catch(...){
-		of1x_destroy_stats_flow_msg(fp_msg);
+		if(fp_msg)
+			of1x_destroy_stats_flow_msg(fp_msg);
 		of1x_destroy_flow_entry(entry);
 	
 		//Destroy the snapshot
@@ -403,8 +385,7 @@ of10_endpoint::handle_flow_stats_request(
 	
 		throw;
 	}
-	//Destroy FP stats
-	of1x_destroy_stats_flow_msg(fp_msg);
+
 	of1x_destroy_flow_entry(entry);
 	
 	//Destroy the snapshot
@@ -419,6 +400,8 @@ of10_endpoint::handle_aggregate_stats_request(
 		rofl::openflow::cofmsg_aggr_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	of1x_stats_flow_aggregate_msg_t* fp_msg;
 	of1x_flow_entry_t* entry;
 
@@ -483,6 +466,8 @@ of10_endpoint::handle_queue_stats_request(
 		rofl::openflow::cofmsg_queue_stats_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	switch_port_snapshot_t* port = NULL;
 	unsigned int portnum = pack.get_queue_stats().get_port_no();
 	unsigned int queue_id = pack.get_queue_stats().get_queue_id();
@@ -572,6 +557,8 @@ of10_endpoint::handle_experimenter_stats_request(
 		rofl::openflow::cofmsg_stats_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	//TODO: when exp are supported
 }
 
@@ -583,14 +570,12 @@ of10_endpoint::handle_packet_out(
 		rofl::openflow::cofmsg_packet_out& msg,
 		uint8_t aux_id)
 {
-	of1x_action_group_t* action_group = of1x_init_action_group(NULL);
+	bool cached;
+	of1x_action_group_t* action_group = pktout_cache.acquire(&ctl, sw, msg.set_actions(), of10_translation_utils::of1x_map_flow_entry_actions, cached);
 
-	try{
-		of10_translation_utils::of1x_map_flow_entry_actions(&ctl, sw, msg.set_actions(), action_group, NULL); //TODO: is this OK always NULL?
-	}catch(...){
-		of1x_destroy_action_group(action_group);
-		throw;
-	}
+	//Processed in a batch, along with the next ones (if enabled)
+	if(queue_packet_out(msg.get_buffer_id(), msg.get_in_port(), action_group, cached, msg.get_packet().soframe(), msg.get_packet().framelen()))
+		return;
 
 	/* assumption: driver can handle all situations properly:
 	 * - data and datalen both 0 and buffer_id != rofl::openflow10::OFP_NO_BUFFER
@@ -606,7 +591,7 @@ of10_endpoint::handle_packet_out(
 		//FIXME: send error
 	}
 
-	of1x_destroy_action_group(action_group);
+	action_group_cache::release(action_group, cached);
 }
 
 
@@ -627,10 +612,12 @@ of10_endpoint::process_packet_in(
 		packet_matches_t* matches)
 {
 	try {
-		//Transform matches
+		//Transform matches; set straight from the packet_matches_t
 		rofl::openflow::cofmatch match(rofl::openflow10::OFP_VERSION);
-		of10_translation_utils::of1x_map_reverse_packet_matches(matches, match);
+		pktin_encoder.map_match(rofl::openflow10::OFP_VERSION, matches, match);
 
+		//Truncated to the send length of the pipeline (miss_send_len or the
+		//max_len of the output action); rofl copies it into the message
 		size_t len = (total_len < buf_len) ? total_len : buf_len;
 
 		send_packet_in_message(
@@ -781,7 +768,9 @@ of10_endpoint::handle_barrier_request(
 		rofl::openflow::cofmsg_barrier_request& pack,
 		uint8_t aux_id)
 {
-	//Since we are not queuing messages currently
+	//Install the queued messages, and send their errors, first
+	flush_pending();
+
 	ctl.send_barrier_reply(pack.get_xid());
 }
 
@@ -793,6 +782,10 @@ of10_endpoint::handle_flow_mod(
 		rofl::openflow::cofmsg_flow_mod& msg,
 		uint8_t aux_id)
 {
+	//Keep the order with respect to the queued ADDs
+	if(msg.get_command() != rofl::openflow10::OFPFC_ADD)
+		flush_pending();
+
 	switch (msg.get_command()) {
 		case rofl::openflow10::OFPFC_ADD: {
 				flow_mod_add(ctl, msg);
@@ -855,6 +848,11 @@ of10_endpoint::flow_mod_add(
 		return;
 	}
 
+	//Unbuffered ADDs are queued (if enabled)
+	if(queue_flow_mod_add(ctl, msg, msg.get_table_id(), entry, msg.get_flags() & rofl::openflow10::OFPFF_CHECK_OVERLAP, false))
+		return;
+	flush_pending();
+
 	if (HAL_SUCCESS != (res = hal_driver_of1x_process_flow_mod_add(sw->dpid,
 								msg.get_table_id(),
 								&entry,
@@ -1012,6 +1010,7 @@ of10_endpoint::handle_table_mod(
 		rofl::openflow::cofmsg_table_mod& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
 
 	/*
 	 * the parameters defined in the pipeline OF1X_TABLE_...
@@ -1048,6 +1047,8 @@ of10_endpoint::handle_port_mod(
 		rofl::openflow::cofmsg_port_mod& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	uint32_t config, mask, advertise;
 	uint16_t port_num;
 
@@ -1167,6 +1168,7 @@ of10_endpoint::handle_set_config(
 		rofl::openflow::cofmsg_set_config& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
 
 	//Instruct the driver to process the set config
 	if(HAL_FAILURE == hal_driver_of1x_set_pipeline_config(sw->dpid, msg.get_flags(), msg.get_miss_send_len())){
@@ -1182,6 +1184,8 @@ of10_endpoint::handle_queue_get_config_request(
 		rofl::openflow::cofmsg_queue_get_config_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	switch_port_snapshot_t* port;
 	unsigned int portnum = pack.get_port_no();
 
@@ -1240,6 +1244,8 @@ of10_endpoint::handle_experimenter_message(
 		rofl::openflow::cofmsg_experimenter& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	// TODO
 }
 
@@ -1258,4 +1264,15 @@ of10_endpoint::handle_ctrl_close(crofctl *ctrl)
 {
 	ROFL_INFO("[sw: %s] Controller %s:%u has DISCONNECTED. \n", sw->dpname.c_str() ,ctrl->get_peer_addr().c_str()); //FIXME: add role
 
+	//The errors of its queued ADDs can no longer be sent
+	drop_pending_errors(ctrl);
+}
+
+
+
+void
+of10_endpoint::send_flow_mod_error(crofctl& ctl, uint32_t xid, hal_result_t result, uint8_t* data, size_t datalen)
+{
+	//Same codes as the exceptions thrown by flow_mod_add()
+	ctl.send_error_message(xid, rofl::openflow10::OFPET_FLOW_MOD_FAILED, (result == HAL_FM_OVERLAP_FAILURE)? rofl::openflow10::OFPFMFC_OVERLAP : rofl::openflow10::OFPFMFC_ALL_TABLES_FULL, data, datalen);
 }
@@ -1371,7 +1371,7 @@ void of12_translation_utils::of12_map_reverse_packet_matches(packet_matches_t* p
 		uint64_t mac = packet_matches_get_arp_sha_value(pm);
 		match.set_arp_sha( cmacaddr(mac) );
 	}
-	if(packet_matches_get_arp_spa_value(pm)); {
+	if(packet_matches_get_arp_spa_value(pm)){
 		caddress addr(AF_INET, "0.0.0.0");
 		addr.set_ipv4_addr(packet_matches_get_arp_spa_value(pm));
 		match.set_arp_spa(addr);
@@ -1380,7 +1380,7 @@ void of12_translation_utils::of12_map_reverse_packet_matches(packet_matches_t* p
 		uint64_t mac = packet_matches_get_arp_tha_value(pm);
 		match.set_arp_tha(cmacaddr(mac));
 	}
-	if(packet_matches_get_arp_tpa_value(pm)); {
+	if(packet_matches_get_arp_tpa_value(pm)){
 		caddress addr(AF_INET, "0.0.0.0");
 		addr.set_ipv4_addr(packet_matches_get_arp_tpa_value(pm));
 		match.set_arp_tpa(addr);
@@ -1460,6 +1460,11 @@ void of12_translation_utils::of12_map_reverse_packet_matches(packet_matches_t* p
 		match.set_mpls_tc(packet_matches_get_mpls_tc_value(pm));
 
 	//Extensions
+	of12_map_reverse_packet_matches_ext(pm, match);
+}
+
+void of12_translation_utils::of12_map_reverse_packet_matches_ext(packet_matches_t* pm, rofl::openflow::cofmatch& match){
+
 	if(packet_matches_get_pppoe_code_value(pm))
 		match.set_matches().add_match(rofl::openflow::experimental::pppoe::coxmatch_ofx_pppoe_code(packet_matches_get_pppoe_code_value(pm)));
 	if(packet_matches_get_pppoe_type_value(pm))
@@ -97,6 +97,11 @@ public:
 	*/
 	static void of12_map_reverse_packet_matches(packet_matches_t* packet_matches, rofl::openflow::cofmatch& match);
 
+	/**
+	* Experimental (non OpenFlow basic) matches of of12_map_reverse_packet_matches()
+	*/
+	static void of12_map_reverse_packet_matches_ext(packet_matches_t* packet_matches, rofl::openflow::cofmatch& match);
+
 	static uint64_t of12_map_bitmap_matches(bitmap128_t* bitmap);
 
 	static uint32_t of12_map_bitmap_actions(bitmap128_t* bitmap);
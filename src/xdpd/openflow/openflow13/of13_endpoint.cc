@@ -19,6 +19,10 @@ of13_endpoint::of13_endpoint(
 	//Reference back to the sw
 	this->sw = sw;
 
+	//FLOW_MOD ADDs and PACKET_OUTs are processed in batches
+	set_flow_mod_batch_size(DEFAULT_FLOW_MOD_BATCH_SIZE);
+	set_packet_out_batch_size(PACKET_OUT_BATCH_SIZE);
+
 	//Set bitmaps
 	crofbase::get_versionbitmap().add_ofp_version(rofl::openflow13::OFP_VERSION);
 	rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
@@ -40,6 +44,8 @@ of13_endpoint::handle_features_request(
 		rofl::openflow::cofmsg_features_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	of1x_switch_snapshot_t* of13switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
 
 	if(!of13switch)
@@ -69,6 +75,8 @@ of13_endpoint::handle_get_config_request(
 		rofl::openflow::cofmsg_get_config_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	of1x_switch_snapshot_t* of13switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
 
 	if(!of13switch)
@@ -91,6 +99,8 @@ of13_endpoint::handle_set_config(
 		rofl::openflow::cofmsg_set_config& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	//Instruct the driver to process the set config
 	if(HAL_FAILURE == hal_driver_of1x_set_pipeline_config(sw->dpid, msg.get_flags(), msg.get_miss_send_len())){
 		throw eTableModBadConfig();
@@ -105,14 +115,12 @@ of13_endpoint::handle_packet_out(
 		rofl::openflow::cofmsg_packet_out& msg,
 		uint8_t aux_id)
 {
-	of1x_action_group_t* action_group = of1x_init_action_group(NULL);
+	bool cached;
+	of1x_action_group_t* action_group = pktout_cache.acquire(&ctl, sw, msg.set_actions(), of13_translation_utils::of13_map_flow_entry_actions, cached);
 
-	try{
-		of13_translation_utils::of13_map_flow_entry_actions(&ctl, sw, msg.set_actions(), action_group, NULL); //TODO: is this OK always NULL?
-	}catch(...){
-		of1x_destroy_action_group(action_group);
-		throw;
-	}
+	//Processed in a batch, along with the next ones (if enabled)
+	if(queue_packet_out(msg.get_buffer_id(), msg.get_in_port(), action_group, cached, msg.get_packet().soframe(), msg.get_packet().framelen()))
+		return;
 
 	/* assumption: driver can handle all situations properly:
 	 * - data and datalen both 0 and buffer_id != OFP_NO_BUFFER
@@ -128,7 +136,7 @@ of13_endpoint::handle_packet_out(
 		//FIXME: send error
 	}
 
-	of1x_destroy_action_group(action_group);
+	action_group_cache::release(action_group, cached);
 }
 
 
@@ -139,6 +147,10 @@ of13_endpoint::handle_flow_mod(
 		rofl::openflow::cofmsg_flow_mod& msg,
 		uint8_t aux_id)
 {
+	//Keep the order with respect to the queued ADDs
+	if(msg.get_command() != openflow13::OFPFC_ADD)
+		flush_pending();
+
 	switch (msg.get_command()) {
 	case openflow13::OFPFC_ADD: {
 		flow_mod_add(ctl, msg);
@@ -175,6 +187,7 @@ of13_endpoint::flow_mod_add(
 	if ( (table_id > sw->num_of_tables) && (table_id != openflow13::OFPTT_ALL) ){
 		rofl::logging::error << "[xdpd][of13][flow-mod-add] unable to add flow-mod due to " <<
 				"invalid table-id:" << msg.get_table_id() << " on dpt:" << sw->dpname << std::endl;
+		flush_pending();
 		throw eFlowModBadTableId();
 	}
 
@@ -182,13 +195,20 @@ of13_endpoint::flow_mod_add(
 		entry = of13_translation_utils::of13_map_flow_entry(&ctl, &msg, sw);
 	}catch(...){
 		rofl::logging::error << "[xdpd][of13][flow-mod-add] unable to map flow-mod entry to internal representation on dpt:" << sw->dpname << std::endl;
+		flush_pending();
 		throw eFlowModUnknown();
 	}
 
 	if(!entry){
+		flush_pending();
 		throw eFlowModUnknown();//Just for safety, but shall never reach this
 	}
 
+	//Unbuffered ADDs are queued (if enabled)
+	if(queue_flow_mod_add(ctl, msg, msg.get_table_id(), entry, msg.get_flags() & openflow13::OFPFF_CHECK_OVERLAP, msg.get_flags() & openflow13::OFPFF_RESET_COUNTS))
+		return;
+	flush_pending();
+
 	if (HAL_SUCCESS != (res = hal_driver_of1x_process_flow_mod_add(sw->dpid,
 								msg.get_table_id(),
 								&entry,
@@ -300,6 +320,7 @@ of13_endpoint::handle_desc_stats_request(
 		rofl::openflow::cofmsg_desc_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
 
 	std::string mfr_desc(PACKAGE_NAME);
 	std::string hw_desc(VERSION);
@@ -325,8 +346,14 @@ of13_endpoint::handle_flow_stats_request(
 		rofl::openflow::cofmsg_flow_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
+	of1x_stats_flow_msg_t* fp_msg = NULL;
+	of1x_flow_entry_t* entry = NULL;
+	uint64_t cursor = 0;
+
 	//Map the match structure from OpenFlow to packet_matches_t
-	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+	entry = of1x_init_flow_entry(false);
 
 	try{
 		of13_translation_utils::of13_map_flow_entry_matches(&ctl, msg.get_flow_stats().get_match(), sw, entry);
@@ -335,63 +362,68 @@ of13_endpoint::handle_flow_stats_request(
 		throw eBadRequestBadStat();
 	}
 
-	//Ask the Forwarding Plane to process stats
-	of1x_stats_flow_msg_t* fp_msg = hal_driver_of1x_get_flow_stats(
-													sw->dpid,
-													msg.get_flow_stats().get_table_id(),
-													msg.get_flow_stats().get_cookie(),
-													msg.get_flow_stats().get_cookie_mask(),
-													msg.get_flow_stats().get_out_port(),
-													msg.get_flow_stats().get_out_group(),
-													&entry->matches);
-
-	if(!fp_msg){
-		of1x_destroy_flow_entry(entry);
-		throw eBadRequestBadStat();
-	}
-
-	//Construct OF message
-	of1x_stats_single_flow_msg_t *elem = fp_msg->flows_head;
-
 	rofl::openflow::cofflowstatsarray flowstatsarray(ctl.get_version());
 
-	uint32_t flow_id = 0;
-
-	for(elem = fp_msg->flows_head; elem; elem = elem->next){
-
-		rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
-		of13_translation_utils::of13_map_reverse_flow_entry_matches(elem->matches, match);
-
-		rofl::openflow::cofinstructions instructions(ctl.get_version());
-		of13_translation_utils::of13_map_reverse_flow_entry_instructions((of1x_instruction_group_t*)(elem->inst_grp), instructions);
-
-
-		flowstatsarray.set_flow_stats(flow_id).set_table_id(elem->table_id);
-		flowstatsarray.set_flow_stats(flow_id).set_duration_sec(elem->duration_sec);
-		flowstatsarray.set_flow_stats(flow_id).set_duration_nsec(elem->duration_nsec);
-		flowstatsarray.set_flow_stats(flow_id).set_priority(elem->priority);
-		flowstatsarray.set_flow_stats(flow_id).set_idle_timeout(elem->idle_timeout);
-		flowstatsarray.set_flow_stats(flow_id).set_hard_timeout(elem->hard_timeout);
-		flowstatsarray.set_flow_stats(flow_id).set_cookie(elem->cookie);
-		flowstatsarray.set_flow_stats(flow_id).set_packet_count(elem->packet_count);
-		flowstatsarray.set_flow_stats(flow_id).set_byte_count(elem->byte_count);
-		flowstatsarray.set_flow_stats(flow_id).set_match() = match;
-		flowstatsarray.set_flow_stats(flow_id).set_instructions() = instructions;
+	try{
+		//One reply per chunk of entries; more replies follow until the
+		//driver is done
+		do{
+			fp_msg = get_flow_stats_chunk(sw->dpid,
+					msg.get_flow_stats().get_table_id(),
+					msg.get_flow_stats().get_cookie(),
+					msg.get_flow_stats().get_cookie_mask(),
+					msg.get_flow_stats().get_out_port(),
+					msg.get_flow_stats().get_out_group(),
+					&entry->matches,
+					&cursor);
+
+			if(!fp_msg)
+				throw eBadRequestBadStat();
+
+			//Construct OF message
+			uint32_t flow_id = 0;
+
+			for(of1x_stats_single_flow_msg_t* elem = fp_msg->flows_head; elem; elem = elem->next){
+
+				rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+				of13_translation_utils::of13_map_reverse_flow_entry_matches(elem->matches, match);
+
+				rofl::openflow::cofinstructions instructions(ctl.get_version());
+				of13_translation_utils::of13_map_reverse_flow_entry_instructions((of1x_instruction_group_t*)(elem->inst_grp), instructions);
+
+				flowstatsarray.set_flow_stats(flow_id).set_table_id(elem->table_id);
+				flowstatsarray.set_flow_stats(flow_id).set_duration_sec(elem->duration_sec);
+				flowstatsarray.set_flow_stats(flow_id).set_duration_nsec(elem->duration_nsec);
+				flowstatsarray.set_flow_stats(flow_id).set_priority(elem->priority);
+				flowstatsarray.set_flow_stats(flow_id).set_idle_timeout(elem->idle_timeout);
+				flowstatsarray.set_flow_stats(flow_id).set_hard_timeout(elem->hard_timeout);
+				flowstatsarray.set_flow_stats(flow_id).set_cookie(elem->cookie);
+				flowstatsarray.set_flow_stats(flow_id).set_packet_count(elem->packet_count);
+				flowstatsarray.set_flow_stats(flow_id).set_byte_count(elem->byte_count);
+				flowstatsarray.set_flow_stats(flow_id).set_match() = match;
+				flowstatsarray.set_flow_stats(flow_id).set_instructions() = instructions;
+
+				flow_id++;
+			}
 
-		flow_id++;
-	}
+			of1x_destroy_stats_flow_msg(fp_msg);
+			fp_msg = NULL;
 
+			//Send message
+			if(cursor)
+				ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray, openflow13::OFPMPF_REPLY_MORE);
+			else
+				ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray);
 
-	try{
-		//Send message
-		ctl.send_flow_stats_reply(msg.get_xid(), flowstatsarray);
+			flowstatsarray.clear();
+		}while(cursor);
 	}catch(...){
-		of1x_destroy_stats_flow_msg(fp_msg);
+		if(fp_msg)
+			of1x_destroy_stats_flow_msg(fp_msg);
 		of1x_destroy_flow_entry(entry);
 		throw;
 	}
-	//Destroy FP stats
-	of1x_destroy_stats_flow_msg(fp_msg);
+
 	of1x_destroy_flow_entry(entry);
 }
 
@@ -403,6 +435,8 @@ of13_endpoint::handle_aggregate_stats_request(
 		rofl::openflow::cofmsg_aggr_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	//Map the match structure from OpenFlow to packet_matches_t
 	 of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
 
@@ -459,6 +493,8 @@ of13_endpoint::handle_table_stats_request(
 		rofl::openflow::cofmsg_table_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	of1x_switch_snapshot_t* of13switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
 
 	if(!of13switch)
@@ -492,89 +528,45 @@ of13_endpoint::handle_port_stats_request(
 		rofl::openflow::cofmsg_port_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
 
-	switch_port_snapshot_t* port;
+	port_stats_t stats;
+	struct timespec duration;
+	std::vector<uint32_t> port_nums;
 	uint32_t port_no = msg.get_port_stats().get_portno();
 
-	of1x_switch_snapshot_t* of13switch = (of1x_switch_snapshot_t*)hal_driver_get_switch_snapshot_by_dpid(sw->dpid);
-
-	if(!of13switch)
-		throw eRofBase();
-
 	rofl::openflow::cofportstatsarray portstatsarray(ctl.get_version());
 
 	/*
-	 *  send statistics for all ports
+	 * Only the counters of the requested port(s) are retrieved from the driver
 	 */
-	if (openflow13::OFPP_ANY == port_no){
-
-		//we check all the positions in case there are empty slots
-		for (unsigned int n = 1; n < of13switch->max_ports; n++){
-	
-			port = of13switch->logical_ports[n].port; 
-	
-			if((port != NULL) && (of13switch->logical_ports[n].attachment_state == LOGICAL_PORT_STATE_ATTACHED)){
-
-				portstatsarray.set_port_stats(port->of_port_num).set_port_no(port->of_port_num);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_packets(port->stats.rx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_packets(port->stats.tx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_bytes(port->stats.rx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_bytes(port->stats.tx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_dropped(port->stats.rx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_dropped(port->stats.tx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_errors(port->stats.rx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_errors(port->stats.tx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_frame_err(port->stats.rx_frame_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_over_err(port->stats.rx_over_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_crc_err(port->stats.rx_crc_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_collisions(port->stats.collisions);
-				portstatsarray.set_port_stats(port->of_port_num).set_duration_sec(0); 	// TODO
-				portstatsarray.set_port_stats(port->of_port_num).set_duration_nsec(0); 	// TODO
-			}
-	 	}
-
-	}else{
-		/*
-		 * send statistics for only one port
-		 */
-		
-		// search for the port with the specified port-number
-		//we check all the positions in case there are empty slots
-		for (unsigned int n = 1; n < of13switch->max_ports; n++){
-			
-			port = of13switch->logical_ports[n].port; 
+	if (openflow13::OFPP_ANY == port_no)
+		sw->get_attached_ports(port_nums);
+	else
+		port_nums.push_back(port_no);
 
-			if( 	(port != NULL) &&
-				(of13switch->logical_ports[n].attachment_state == LOGICAL_PORT_STATE_ATTACHED) &&
-				(port->of_port_num == port_no)
-			){
-				//Mapping of port state
-				portstatsarray.set_port_stats(port->of_port_num).set_port_no(port->of_port_num);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_packets(port->stats.rx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_packets(port->stats.tx_packets);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_bytes(port->stats.rx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_bytes(port->stats.tx_bytes);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_dropped(port->stats.rx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_dropped(port->stats.tx_dropped);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_errors(port->stats.rx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_tx_errors(port->stats.tx_errors);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_frame_err(port->stats.rx_frame_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_over_err(port->stats.rx_over_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_rx_crc_err(port->stats.rx_crc_err);
-				portstatsarray.set_port_stats(port->of_port_num).set_collisions(port->stats.collisions);
-				portstatsarray.set_port_stats(port->of_port_num).set_duration_sec(0); 	// TODO
-				portstatsarray.set_port_stats(port->of_port_num).set_duration_nsec(0); 	// TODO
-
-
-				break;
-			}
-	 	}
+	for (unsigned int i = 0; i < port_nums.size(); i++){
 
 		// if port_no was not found, body.memlen() is 0
-	}
+		if(sw->get_port_stats(port_nums[i], &stats, &duration) != ROFL_SUCCESS)
+			continue;
 
-	//Destroy the snapshot
-	of_switch_destroy_snapshot((of_switch_snapshot_t*)of13switch);
+		portstatsarray.set_port_stats(port_nums[i]).set_port_no(port_nums[i]);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_packets(stats.rx_packets);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_packets(stats.tx_packets);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_bytes(stats.rx_bytes);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_bytes(stats.tx_bytes);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_dropped(stats.rx_dropped);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_dropped(stats.tx_dropped);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_errors(stats.rx_errors);
+		portstatsarray.set_port_stats(port_nums[i]).set_tx_errors(stats.tx_errors);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_frame_err(stats.rx_frame_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_over_err(stats.rx_over_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_rx_crc_err(stats.rx_crc_err);
+		portstatsarray.set_port_stats(port_nums[i]).set_collisions(stats.collisions);
+		portstatsarray.set_port_stats(port_nums[i]).set_duration_sec(duration.tv_sec);
+		portstatsarray.set_port_stats(port_nums[i]).set_duration_nsec(duration.tv_nsec);
+	}
 
 	ctl.send_port_stats_reply(msg.get_xid(), portstatsarray, false);
 }
@@ -588,6 +580,7 @@ of13_endpoint::handle_queue_stats_request(
 		rofl::openflow::cofmsg_queue_stats_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
 
 	switch_port_snapshot_t* port = NULL;
 	unsigned int portnum = pack.get_queue_stats().get_port_no();
@@ -678,6 +671,8 @@ of13_endpoint::handle_group_stats_request(
 		rofl::openflow::cofmsg_group_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	// we need to get the statistics, build a packet and send it
 	unsigned int i;
 	cmemory body(0);
@@ -735,6 +730,8 @@ of13_endpoint::handle_group_desc_stats_request(
 		rofl::openflow::cofmsg_group_desc_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	rofl::openflow::cofgroupdescstatsarray groupdescs(ctl.get_version());
 
 	of1x_group_table_t group_table;
@@ -764,6 +761,8 @@ of13_endpoint::handle_group_features_stats_request(
 		rofl::openflow::cofmsg_group_features_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	rofl::openflow::cofgroup_features_stats_reply group_features_reply(ctl.get_version());
 
 	group_features_reply.set_types((uint32_t)0);
@@ -790,6 +789,8 @@ of13_endpoint::handle_table_features_stats_request(
 		rofl::openflow::cofmsg_table_features_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	// TODO: check for pipeline definition within request and configure pipeline accordingly
 
 	rofl::openflow::coftables tables(ctl.get_version());
@@ -851,6 +852,8 @@ of13_endpoint::handle_port_desc_stats_request(
 		rofl::openflow::cofmsg_port_desc_stats_request& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	logical_switch_port_t* ls_port;
 	switch_port_snapshot_t* _port;
 
@@ -916,6 +919,8 @@ of13_endpoint::handle_experimenter_stats_request(
 		rofl::openflow::cofmsg_experimenter_stats_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	//TODO: when exp are supported 
 }
 
@@ -937,10 +942,13 @@ of13_endpoint::process_packet_in(
 		packet_matches_t* matches)
 {
 	try {
-		//Transform matches 
+		//Transform matches; set straight from the packet_matches_t
 		rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
-		of13_translation_utils::of13_map_reverse_packet_matches(matches, match);
+		pktin_encoder.map_match(rofl::openflow13::OFP_VERSION, matches, match);
+		of13_translation_utils::of13_map_reverse_packet_matches_ext(matches, match);
 
+		//Truncated to the send length of the pipeline (miss_send_len or the
+		//max_len of the output action); rofl copies it into the message
 		size_t len = (total_len < buf_len) ? total_len : buf_len;
 
 		send_packet_in_message(
@@ -1125,7 +1133,9 @@ of13_endpoint::handle_barrier_request(
 		rofl::openflow::cofmsg_barrier_request& pack,
 		uint8_t aux_id)
 {
-	//Since we are not queuing messages currently
+	//Install the queued messages, and send their errors, first
+	flush_pending();
+
 	ctl.send_barrier_reply(pack.get_xid());
 }
 
@@ -1182,6 +1192,8 @@ of13_endpoint::handle_group_mod(
 		rofl::openflow::cofmsg_group_mod& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	//throw eNotImplemented(std::string("of13_endpoint::handle_group_mod()"));
 	//steps:
 	/* 1- map the packet
@@ -1299,6 +1311,8 @@ of13_endpoint::handle_table_mod(
 		rofl::openflow::cofmsg_table_mod& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	// table config is different in OF1.3
 	// well, in fact, it's deprecated, but kept for backwards compatibility ;)
 	// hence, we ignore incoming messages of type OFPT_TABLE_MOD
@@ -1312,6 +1326,7 @@ of13_endpoint::handle_port_mod(
 		rofl::openflow::cofmsg_port_mod& msg,
 		uint8_t aux_id)
 {
+	flush_pending();
 
 
 
@@ -1427,6 +1442,8 @@ of13_endpoint::handle_queue_get_config_request(
 		rofl::openflow::cofmsg_queue_get_config_request& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	switch_port_snapshot_t* port;
 	unsigned int portnum = pack.get_port_no();
 
@@ -1486,6 +1503,8 @@ of13_endpoint::handle_experimenter_message(
 		rofl::openflow::cofmsg_experimenter& pack,
 		uint8_t aux_id)
 {
+	flush_pending();
+
 	// TODO
 }
 
@@ -1504,5 +1523,15 @@ of13_endpoint::handle_ctrl_close(crofctl *ctrl)
 {
 	ROFL_INFO("[sw: %s] Controller %s:%u has DISCONNECTED. \n", sw->dpname.c_str() ,ctrl->get_peer_addr().c_str()); //FIXME: add role
 
+	//The errors of its queued ADDs can no longer be sent
+	drop_pending_errors(ctrl);
 }
 
+
+
+void
+of13_endpoint::send_flow_mod_error(crofctl& ctl, uint32_t xid, hal_result_t result, uint8_t* data, size_t datalen)
+{
+	//Same codes as the exceptions thrown by flow_mod_add()
+	ctl.send_error_message(xid, openflow13::OFPET_FLOW_MOD_FAILED, (result == HAL_FM_OVERLAP_FAILURE)? openflow13::OFPFMFC_OVERLAP : openflow13::OFPFMFC_TABLE_FULL, data, datalen);
+}
@@ -300,6 +300,12 @@ private:
 	virtual void
 	handle_ctrl_close(crofctl *ctrl);
 
+	/**
+	 * Send the error of a queued (batched) FLOW_MOD ADD
+	 */
+	virtual void
+	send_flow_mod_error(crofctl& ctl, uint32_t xid, hal_result_t result, uint8_t* data, size_t datalen);
+
 
 	/**
 	 * @name 	flow_mod_add
@@ -1447,7 +1447,7 @@ void of13_translation_utils::of13_map_reverse_packet_matches(packet_matches_t* p
 		uint64_t mac = packet_matches_get_arp_sha_value(pm);
 		match.set_arp_sha( cmacaddr(mac) );
 	}
-	if(packet_matches_get_arp_spa_value(pm)); {
+	if(packet_matches_get_arp_spa_value(pm)){
 		caddress addr(AF_INET, "0.0.0.0");
 		addr.set_ipv4_addr(packet_matches_get_arp_spa_value(pm));
 		match.set_arp_spa(addr);
@@ -1456,7 +1456,7 @@ void of13_translation_utils::of13_map_reverse_packet_matches(packet_matches_t* p
 		uint64_t mac = packet_matches_get_arp_tha_value(pm);
 		match.set_arp_tha(cmacaddr(mac));
 	}
-	if(packet_matches_get_arp_tpa_value(pm)); {
+	if(packet_matches_get_arp_tpa_value(pm)){
 		caddress addr(AF_INET, "0.0.0.0");
 		addr.set_ipv4_addr(packet_matches_get_arp_tpa_value(pm));
 		match.set_arp_tpa(addr);
@@ -1545,6 +1545,11 @@ void of13_translation_utils::of13_map_reverse_packet_matches(packet_matches_t* p
 		match.set_ipv6_exthdr(packet_matches_get_ipv6_exthdr_value(pm));
 
 	//Extensions
+	of13_map_reverse_packet_matches_ext(pm, match);
+}
+
+void of13_translation_utils::of13_map_reverse_packet_matches_ext(packet_matches_t* pm, rofl::openflow::cofmatch& match){
+
 	if(packet_matches_get_pppoe_code_value(pm))
 		match.set_matches().add_match(rofl::openflow::experimental::pppoe::coxmatch_ofx_pppoe_code(packet_matches_get_pppoe_code_value(pm)));
 	if(packet_matches_get_pppoe_type_value(pm))
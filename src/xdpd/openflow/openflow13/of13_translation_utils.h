@@ -97,6 +97,11 @@ public:
 	*/
 	static void of13_map_reverse_packet_matches(packet_matches_t* packet_matches, rofl::openflow::cofmatch& match);
 
+	/**
+	* Experimental (non OpenFlow basic) matches of of13_map_reverse_packet_matches()
+	*/
+	static void of13_map_reverse_packet_matches_ext(packet_matches_t* packet_matches, rofl::openflow::cofmatch& match);
+
 	/**
 	*
 	*/
@@ -1,5 +1,8 @@
 #include "openflow_switch.h"
 
+#include <string.h>
+#include <rofl/datapath/hal/driver.h>
+
 using namespace rofl;
 using namespace xdpd;
 
@@ -8,18 +11,35 @@ openflow_switch::openflow_switch(const uint64_t dpid, const std::string &dpname,
 		dpid(dpid),
 		dpname(dpname),
 		version(version),
-		num_of_tables(num_of_tables)
+		num_of_tables(num_of_tables),
+		checkpoint_generation(0)
 {
+	pthread_mutex_init(&attach_time_mutex, NULL);
+}
 
+openflow_switch::~openflow_switch(){
+	pthread_mutex_destroy(&attach_time_mutex);
 }
 
 /*
 * Port notfications. Process them directly in the endpoint
 */
 rofl_result_t openflow_switch::notify_port_attached(const switch_port_t* port){
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	pthread_mutex_lock(&attach_time_mutex);
+	attach_time[port->of_port_num] = now;
+	pthread_mutex_unlock(&attach_time_mutex);
+
 	return endpoint->notify_port_attached(port);
 }
 rofl_result_t openflow_switch::notify_port_detached(const switch_port_t* port){
+	pthread_mutex_lock(&attach_time_mutex);
+	attach_time.erase(port->of_port_num);
+	pthread_mutex_unlock(&attach_time_mutex);
+
 	return endpoint->notify_port_detached(port);
 }
 rofl_result_t openflow_switch::notify_port_status_changed(const switch_port_t* port){
@@ -40,3 +60,77 @@ void openflow_switch::rpc_disconnect_from_ctl(enum rofl::csocket::socket_type_t
 	//endpoint->rpc_disconnect_from_ctl(socket_type, socket_params);
 }
 
+void openflow_switch::set_flow_mod_batch_size(unsigned int size){
+	endpoint->set_flow_mod_batch_size(size);
+}
+
+/*
+* Port statistics
+*/
+rofl_result_t openflow_switch::get_port_stats(uint32_t port_num, port_stats_t* stats, struct timespec* duration){
+
+	struct timespec now;
+	std::map<uint32_t, struct timespec>::iterator it;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if(hal_driver_get_port_stats){
+		if(hal_driver_get_port_stats(dpid, port_num, stats) != HAL_SUCCESS)
+			return ROFL_FAILURE;
+	}else{
+		//Driver does not support it; use a port snapshot
+		switch_port_snapshot_t* port = hal_driver_get_port_snapshot_by_num(dpid, port_num);
+
+		if(!port)
+			return ROFL_FAILURE;
+
+		if(port->attached_sw_dpid != dpid){
+			switch_port_destroy_snapshot(port);
+			return ROFL_FAILURE;
+		}
+
+		stats->rx_packets = port->stats.rx_packets;
+		stats->tx_packets = port->stats.tx_packets;
+		stats->rx_bytes = port->stats.rx_bytes;
+		stats->tx_bytes = port->stats.tx_bytes;
+		stats->rx_dropped = port->stats.rx_dropped;
+		stats->tx_dropped = port->stats.tx_dropped;
+		stats->rx_errors = port->stats.rx_errors;
+		stats->tx_errors = port->stats.tx_errors;
+		stats->rx_frame_err = port->stats.rx_frame_err;
+		stats->rx_over_err = port->stats.rx_over_err;
+		stats->rx_crc_err = port->stats.rx_crc_err;
+		stats->collisions = port->stats.collisions;
+
+		switch_port_destroy_snapshot(port);
+	}
+
+	duration->tv_sec = duration->tv_nsec = 0;
+
+	pthread_mutex_lock(&attach_time_mutex);
+	it = attach_time.find(port_num);
+	if(it != attach_time.end()){
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		duration->tv_sec = now.tv_sec - it->second.tv_sec;
+		duration->tv_nsec = now.tv_nsec - it->second.tv_nsec;
+		if(duration->tv_nsec < 0){
+			duration->tv_sec--;
+			duration->tv_nsec += 1000000000;
+		}
+	}
+	pthread_mutex_unlock(&attach_time_mutex);
+
+	return ROFL_SUCCESS;
+}
+
+void openflow_switch::get_attached_ports(std::vector<uint32_t>& port_nums){
+
+	pthread_mutex_lock(&attach_time_mutex);
+
+	port_nums.clear();
+	port_nums.reserve(attach_time.size());
+	for(std::map<uint32_t, struct timespec>::iterator it = attach_time.begin(); it != attach_time.end(); ++it)
+		port_nums.push_back(it->first);
+
+	pthread_mutex_unlock(&attach_time_mutex);
+}
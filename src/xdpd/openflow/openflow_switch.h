@@ -5,11 +5,17 @@
 #ifndef OPENFLOW_SWITCH_H
 #define OPENFLOW_SWITCH_H 
 
+#include <map>
+#include <vector>
+#include <time.h>
+#include <pthread.h>
+#include <rofl/datapath/hal/hal.h>
 #include <rofl/datapath/pipeline/openflow/of_switch.h>
 #include <rofl/datapath/pipeline/platform/memory.h>
 #include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
 
 #include "of_endpoint.h"
+#include "../management/hal_ext.h"
 
 /**
 * @file openflow_switch.h
@@ -41,10 +47,13 @@ public:
 	of_version_t version;
 	unsigned int num_of_tables;
 
+	//Generation of the last checkpoint of the tables (restored or saved), 0 if none
+	uint64_t checkpoint_generation;
+
 	/**
 	 * Destructor
 	 */
-	virtual ~openflow_switch(void){};
+	virtual ~openflow_switch(void);
 
 	/*
 	* Pure virtual methods
@@ -77,6 +86,27 @@ public:
 	virtual void rpc_connect_to_ctl(enum rofl::csocket::socket_type_t socket_type, cparams const& socket_params);
 
 	virtual void rpc_disconnect_from_ctl(enum rofl::csocket::socket_type_t socket_type, cparams const& socket_params);
+
+	/**
+	 * Set the maximum size of FLOW_MOD ADD batches (0 disables batching)
+	 */
+	virtual void set_flow_mod_batch_size(unsigned int size);
+
+	/**
+	 * Get the counters of the port attached at port_num, and the time
+	 * elapsed since it was attached (0 if unknown)
+	 */
+	rofl_result_t get_port_stats(uint32_t port_num, port_stats_t* stats, struct timespec* duration);
+
+	/**
+	 * Get the numbers of the attached ports, in ascending order
+	 */
+	void get_attached_ports(std::vector<uint32_t>& port_nums);
+
+private:
+	//Attachment time (CLOCK_MONOTONIC) by OF port number
+	std::map<uint32_t, struct timespec> attach_time;
+	pthread_mutex_t attach_time_mutex;
 };
 
 }// namespace rofl
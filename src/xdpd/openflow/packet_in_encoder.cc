@@ -0,0 +1,172 @@
+#include "packet_in_encoder.h"
+
+#include <rofl/common/cmacaddr.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_match.h>
+
+using namespace xdpd;
+using namespace rofl;
+
+packet_in_encoder::packet_in_encoder() :
+		in4(AF_INET, "0.0.0.0"),
+		in6(AF_INET6, "0:0:0:0:0:0:0:0")
+{
+
+}
+
+bool packet_in_encoder::map_match(uint8_t ofp_version, packet_matches_t* pm, rofl::openflow::cofmatch& match){
+
+	switch(ofp_version){
+		case rofl::openflow10::OFP_VERSION:
+			map_of10_match(pm, match);
+			return true;
+		case rofl::openflow12::OFP_VERSION:
+		case rofl::openflow13::OFP_VERSION:
+			map_oxm_match(ofp_version, pm, match);
+			return true;
+		default:
+			return false;
+	}
+}
+
+//Same mapping as of10_translation_utils::of1x_map_reverse_packet_matches()
+void packet_in_encoder::map_of10_match(packet_matches_t* pm, rofl::openflow::cofmatch& match){
+
+	uint64_t value;
+
+	if((value = packet_matches_get_port_in_value(pm)))
+		match.set_in_port(value);
+	if((value = packet_matches_get_eth_dst_value(pm)))
+		match.set_eth_dst(cmacaddr(value));
+	if((value = packet_matches_get_eth_src_value(pm)))
+		match.set_eth_src(cmacaddr(value));
+	if((value = packet_matches_get_eth_type_value(pm)))
+		match.set_eth_type(value);
+	if(packet_matches_has_vlan(pm)){
+		if((value = packet_matches_get_vlan_vid_value(pm)))
+			match.set_vlan_vid(value);
+		if((value = packet_matches_get_vlan_pcp_value(pm)))
+			match.set_vlan_pcp(value);
+	}
+
+	//ARP opcode and addresses are mapped to nw_proto, nw_src and nw_dst
+	if((value = packet_matches_get_arp_opcode_value(pm)))
+		match.set_nw_proto(value);
+	if((value = packet_matches_get_arp_spa_value(pm)))
+		match.set_nw_src(ipv4(value));
+	if((value = packet_matches_get_arp_tpa_value(pm)))
+		match.set_nw_dst(ipv4(value));
+
+	if((value = packet_matches_get_ip_dscp_value(pm)))
+		match.set_nw_tos(OF1X_IP_DSCP_ALIGN(value)); //ToS from the DSCP
+	if((value = packet_matches_get_ip_proto_value(pm)))
+		match.set_ip_proto(value);
+	if((value = packet_matches_get_ipv4_src_value(pm)))
+		match.set_nw_src(ipv4(value));
+	if((value = packet_matches_get_ipv4_dst_value(pm)))
+		match.set_nw_dst(ipv4(value));
+
+	//TCP, UDP and ICMP type/code are mapped to tp_src and tp_dst
+	if((value = packet_matches_get_tcp_src_value(pm)))
+		match.set_tp_src(value);
+	if((value = packet_matches_get_tcp_dst_value(pm)))
+		match.set_tp_dst(value);
+	if((value = packet_matches_get_udp_src_value(pm)))
+		match.set_tp_src(value);
+	if((value = packet_matches_get_udp_dst_value(pm)))
+		match.set_tp_dst(value);
+	if((value = packet_matches_get_icmpv4_type_value(pm)))
+		match.set_tp_src(value);
+	if((value = packet_matches_get_icmpv4_code_value(pm)))
+		match.set_tp_dst(value);
+}
+
+//Same mapping as of12/of13_translation_utils::of1X_map_reverse_packet_matches()
+void packet_in_encoder::map_oxm_match(uint8_t ofp_version, packet_matches_t* pm, rofl::openflow::cofmatch& match){
+
+	uint128__t tmp;
+	uint64_t value;
+
+	if((value = packet_matches_get_port_in_value(pm)))
+		match.set_in_port(value);
+	if((value = packet_matches_get_phy_port_in_value(pm)))
+		match.set_in_phy_port(value);
+	if((value = packet_matches_get_metadata_value(pm)))
+		match.set_metadata(value);
+	if((value = packet_matches_get_eth_dst_value(pm)))
+		match.set_eth_dst(cmacaddr(value));
+	if((value = packet_matches_get_eth_src_value(pm)))
+		match.set_eth_src(cmacaddr(value));
+	if((value = packet_matches_get_eth_type_value(pm)))
+		match.set_eth_type(value);
+	if((value = packet_matches_get_vlan_vid_value(pm)))
+		match.set_vlan_vid(value);
+	if((value = packet_matches_get_vlan_pcp_value(pm)))
+		match.set_vlan_pcp(value);
+	if((value = packet_matches_get_arp_opcode_value(pm)))
+		match.set_arp_opcode(value);
+	if((value = packet_matches_get_arp_sha_value(pm)))
+		match.set_arp_sha(cmacaddr(value));
+	if((value = packet_matches_get_arp_spa_value(pm)))
+		match.set_arp_spa(ipv4(value));
+	if((value = packet_matches_get_arp_tha_value(pm)))
+		match.set_arp_tha(cmacaddr(value));
+	if((value = packet_matches_get_arp_tpa_value(pm)))
+		match.set_arp_tpa(ipv4(value));
+	if((value = packet_matches_get_ip_dscp_value(pm)))
+		match.set_ip_dscp(value);
+	if((value = packet_matches_get_ip_ecn_value(pm)))
+		match.set_ip_ecn(value);
+	if((value = packet_matches_get_ip_proto_value(pm)))
+		match.set_ip_proto(value);
+	if((value = packet_matches_get_ipv4_src_value(pm)))
+		match.set_ipv4_src(ipv4(value));
+	if((value = packet_matches_get_ipv4_dst_value(pm)))
+		match.set_ipv4_dst(ipv4(value));
+	if((value = packet_matches_get_tcp_src_value(pm)))
+		match.set_tcp_src(value);
+	if((value = packet_matches_get_tcp_dst_value(pm)))
+		match.set_tcp_dst(value);
+	if((value = packet_matches_get_udp_src_value(pm)))
+		match.set_udp_src(value);
+	if((value = packet_matches_get_udp_dst_value(pm)))
+		match.set_udp_dst(value);
+	if((value = packet_matches_get_icmpv4_type_value(pm)))
+		match.set_icmpv4_type(value);
+	if((value = packet_matches_get_icmpv4_code_value(pm)))
+		match.set_icmpv4_code(value);
+
+	tmp = packet_matches_get_ipv6_src_value(pm);
+	if(UINT128__T_IS_NOT_ZERO(tmp))
+		match.set_ipv6_src(ipv6(tmp));
+	tmp = packet_matches_get_ipv6_dst_value(pm);
+	if(UINT128__T_IS_NOT_ZERO(tmp))
+		match.set_ipv6_dst(ipv6(tmp));
+	if((value = packet_matches_get_ipv6_flabel_value(pm)))
+		match.set_ipv6_flabel(value);
+	tmp = packet_matches_get_ipv6_nd_target_value(pm);
+	if(UINT128__T_IS_NOT_ZERO(tmp))
+		match.set_ipv6_nd_target(ipv6(tmp));
+	if((value = packet_matches_get_ipv6_nd_sll_value(pm)))
+		match.set_ipv6_nd_sll(cmacaddr(value));
+	if((value = packet_matches_get_ipv6_nd_tll_value(pm)))
+		match.set_ipv6_nd_tll(cmacaddr(value));
+	if((value = packet_matches_get_icmpv6_type_value(pm)))
+		match.set_icmpv6_type(value);
+	if((value = packet_matches_get_icmpv6_code_value(pm)))
+		match.set_icmpv6_code(value);
+	if((value = packet_matches_get_mpls_label_value(pm)))
+		match.set_mpls_label(value);
+	if((value = packet_matches_get_mpls_tc_value(pm)))
+		match.set_mpls_tc(value);
+
+	if(ofp_version == rofl::openflow13::OFP_VERSION){
+		if((value = packet_matches_get_mpls_bos_value(pm)))
+			match.set_mpls_bos(value);
+		if((value = packet_matches_get_tunnel_id_value(pm)))
+			match.set_tunnel_id(value);
+		if((value = packet_matches_get_pbb_isid_value(pm)))
+			match.set_pbb_isid(value);
+		if((value = packet_matches_get_ipv6_exthdr_value(pm)))
+			match.set_ipv6_exthdr(value);
+	}
+}
@@ -0,0 +1,82 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PACKET_IN_ENCODER_H
+#define PACKET_IN_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <rofl/common/caddress.h>
+#include <rofl/common/openflow/cofmatch.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+
+/**
+* @file packet_in_encoder.h
+*
+* @brief Mapping of the match of PACKET_INs straight from packet_matches_t
+*/
+
+namespace xdpd {
+
+/**
+* @brief Fills the match of a PACKET_IN (OF1.0, OF1.2 or OF1.3) from the
+* packet_matches_t of the packet.
+* @ingroup cmm_of
+*
+* @description The fields are set directly in the cofmatch of the message,
+* with the same result as the of1x/of12/of13_map_reverse_packet_matches()
+* translations, but the IPv4/IPv6 address objects are owned by the encoder
+* and reused, instead of being built (and their string representation
+* parsed) for every field of every PACKET_IN. Only the OpenFlow basic class
+* fields are set; experimental fields (PPPoE, GTP) must be added by the
+* caller.
+*
+* The match is NOT serialized into a wire buffer sent as is: rofl (0.4)
+* only sends PACKET_INs through crofbase::send_packet_in_message(), which
+* takes a cofmatch and builds (and packs) a cofmsg_packet_in per controller,
+* copying the payload; crofctl has no call to send an already serialized
+* message. A wire-format match would have to be parsed back into the
+* cofmatch, so the fields are set on it directly. The allocations of the
+* cofmatch fields and of the message are therefore left to rofl.
+*
+* An encoder must not be shared between threads.
+*/
+class packet_in_encoder {
+
+public:
+	packet_in_encoder();
+
+	/**
+	* Set the fields of pm in match, according to ofp_version (OF1.0,
+	* OF1.2 or OF1.3). Returns false if the version is not supported.
+	*/
+	bool map_match(uint8_t ofp_version, packet_matches_t* pm, rofl::openflow::cofmatch& match);
+
+private:
+	//Reused address objects
+	rofl::caddress in4;
+	rofl::caddress in6;
+
+	void map_of10_match(packet_matches_t* pm, rofl::openflow::cofmatch& match);
+	void map_oxm_match(uint8_t ofp_version, packet_matches_t* pm, rofl::openflow::cofmatch& match);
+
+	inline rofl::caddress& ipv4(uint32_t value){
+		in4.set_ipv4_addr(value);
+		return in4;
+	}
+
+	inline rofl::caddress& ipv6(uint128__t value){
+		in6.set_ipv6_addr(value);
+		return in6;
+	}
+
+	// this class is noncopyable
+	packet_in_encoder(const packet_in_encoder&);
+	packet_in_encoder& operator=(const packet_in_encoder&);
+};
+
+}// namespace xdpd
+
+#endif /* PACKET_IN_ENCODER_H */
@@ -0,0 +1,100 @@
+#include "packet_out_batch.h"
+
+#include <string.h>
+#include <rofl/common/logging.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include "action_group_cache.h"
+
+using namespace xdpd;
+
+packet_out_batch::packet_out_batch() :
+		dpid(0),
+		max_size(0),
+		num_of_batches(0),
+		num_of_packets(0),
+		num_of_failures(0)
+{
+
+}
+
+packet_out_batch::~packet_out_batch(){
+	//Process whatever is left
+	flush();
+}
+
+void packet_out_batch::set_max_size(uint64_t dpid, unsigned int max_size){
+
+	flush();
+	this->dpid = dpid;
+	this->max_size = max_size;
+	pkt_outs.reserve(max_size);
+	offsets.reserve(max_size);
+	cached.reserve(max_size);
+}
+
+bool packet_out_batch::add(uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, bool cached, uint8_t* buffer, uint32_t buffer_size){
+
+	of1x_packet_out_t pkt_out;
+
+	if(!max_size)
+		return false;
+
+	pkt_out.buffer_id = buffer_id;
+	pkt_out.in_port = in_port;
+	pkt_out.action_group = action_group;
+	pkt_out.buffer = NULL;
+	pkt_out.buffer_size = buffer_size;
+	pkt_out.result = HAL_SUCCESS;
+
+	//The message (and its payload) is released once handled
+	offsets.push_back(data.size());
+	if(buffer && buffer_size){
+		data.resize(data.size() + buffer_size);
+		memcpy(&data[offsets.back()], buffer, buffer_size);
+	}
+
+	pkt_outs.push_back(pkt_out);
+	this->cached.push_back(cached);
+
+	if(pkt_outs.size() >= max_size)
+		flush();
+
+	return true;
+}
+
+void packet_out_batch::flush(){
+
+	unsigned int i, num = pkt_outs.size();
+
+	if(!num)
+		return;
+
+	//data is not reallocated past this point
+	for(i=0;i<num;i++){
+		if(pkt_outs[i].buffer_size)
+			pkt_outs[i].buffer = &data[offsets[i]];
+	}
+
+	if(hal_driver_of1x_process_packet_out_batch){
+		hal_driver_of1x_process_packet_out_batch(dpid, &pkt_outs[0], num);
+	}else{
+		//Driver does not support batches
+		for(i=0;i<num;i++)
+			pkt_outs[i].result = hal_driver_of1x_process_packet_out(dpid, pkt_outs[i].buffer_id, pkt_outs[i].in_port, pkt_outs[i].action_group, pkt_outs[i].buffer, pkt_outs[i].buffer_size);
+	}
+
+	for(i=0;i<num;i++){
+		if(pkt_outs[i].result != HAL_SUCCESS){
+			rofl::logging::error << "[xdpd][packet-out-batch] error processing packet-out on dpid:0x" << std::hex << dpid << std::dec << " buffer-id:0x" << std::hex << pkt_outs[i].buffer_id << std::dec << std::endl;
+			num_of_failures++;
+		}
+		action_group_cache::release(pkt_outs[i].action_group, cached[i]);
+	}
+
+	num_of_batches++;
+	num_of_packets += num;
+	pkt_outs.clear();
+	offsets.clear();
+	cached.clear();
+	data.clear();
+}
@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PACKET_OUT_BATCH_H
+#define PACKET_OUT_BATCH_H
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <rofl/datapath/hal/hal.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_action.h>
+#include "../management/hal_ext.h"
+
+/**
+* @file packet_out_batch.h
+*
+* @brief Batching of PACKET_OUTs towards the driver
+*/
+
+namespace xdpd {
+
+/**
+* @brief Queue of PACKET_OUTs to be processed in bulk.
+* @ingroup cmm_of
+*
+* @description PACKET_OUTs are queued, with a copy of their payload, and
+* pushed to the driver in a single call. The queue is flushed when:
+*
+* - max_size PACKET_OUTs are queued
+* - flush() is called, or the batch is destroyed
+*
+* Action groups are released (action_group_cache::release()) once the
+* batch has been processed; cached groups must remain valid until then (see
+* action_group_cache). Failures are logged and counted.
+*
+* The batch is NOT thread-safe.
+*/
+class packet_out_batch {
+
+public:
+	packet_out_batch();
+	~packet_out_batch();
+
+	/**
+	* Set the LSI and the maximum number of PACKET_OUTs of a batch. 0
+	* disables batching (pending PACKET_OUTs are flushed).
+	*/
+	void set_max_size(uint64_t dpid, unsigned int max_size);
+
+	/**
+	* Queue a PACKET_OUT. Returns false if batching is disabled; in this case
+	* the caller keeps the ownership of the action group and must process it.
+	*/
+	bool add(uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, bool cached, uint8_t* buffer, uint32_t buffer_size);
+
+	/**
+	* Process all the pending PACKET_OUTs
+	*/
+	void flush(void);
+
+	//Stats
+	uint64_t get_num_of_batches() const { return num_of_batches; }
+	uint64_t get_num_of_packets() const { return num_of_packets; }
+	uint64_t get_num_of_failures() const { return num_of_failures; }
+	unsigned int get_num_of_pending() const { return pkt_outs.size(); }
+	unsigned int get_max_size() const { return max_size; }
+
+private:
+	uint64_t dpid;
+	unsigned int max_size;
+
+	//Pending batch; payloads are copied to data (buffer is set on flush)
+	std::vector<of1x_packet_out_t> pkt_outs;
+	std::vector<size_t> offsets;
+	std::vector<bool> cached;
+	std::vector<uint8_t> data;
+
+	uint64_t num_of_batches;
+	uint64_t num_of_packets;
+	uint64_t num_of_failures;
+
+	// this class is noncopyable
+	packet_out_batch(const packet_out_batch&);
+	packet_out_batch& operator=(const packet_out_batch&);
+};
+
+}// namespace xdpd
+
+#endif /* PACKET_OUT_BATCH_H */
@@ -0,0 +1,182 @@
+/*
+* Warm restart benchmark
+*
+* Measures how long it takes to checkpoint the flow table of an LSI and to
+* restore it when the LSI is created again (switch_manager::create_switch),
+* which is the time the datapath of the LSI is empty after a restart.
+*
+* An OF1.2 LSI with a single table is filled with N flows (distinct
+* eth_dst, output to port 1), checkpointed to a temporary directory,
+* destroyed as on shutdown and created again.
+*
+* Usage: bench_checkpoint [num_flows]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sstream>
+
+#include <rofl/common/logging.h>
+#include <rofl/datapath/hal/driver.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+
+#include "xdpd/management/switch_manager.h"
+#include "xdpd/management/system_manager.h"
+#include "xdpd/openflow/flow_checkpoint.h"
+#include "xdpd/openflow/flow_mod_batch.h"
+
+using namespace rofl;
+using namespace xdpd;
+
+#define BENCH_DEFAULT_FLOWS 1000000
+#define BENCH_DEFAULT_CTL_PORT "6699"
+#define BENCH_NUM_OF_TABLES 1
+#define BENCH_BATCH_SIZE 1024
+#define BENCH_DPID 0x100ULL
+
+static inline uint64_t bench_now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_print(const char* name, uint64_t flows, uint64_t ns){
+	double rate = (ns)? (double)flows*1000000000.0/ns : 0.0;
+	fprintf(stdout, "%-16s %10llu %12.2f %12.0f\n", name, (unsigned long long)flows, ns/1000000.0, rate);
+}
+
+static of1x_flow_entry_t* bench_flow(unsigned int i){
+
+	wrap_uint_t field;
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+	of1x_action_group_t* ac_group = of1x_init_action_group(NULL);
+
+	entry->priority = 0x8000;
+	entry->cookie = i;
+
+	//Locally administered MAC 02:00:xx:xx:xx:xx
+	of1x_add_match_to_entry(entry, of1x_init_eth_dst_match(0x020000000000ULL | i, 0xffffffffffffULL));
+
+	field.u64 = 1;
+	of1x_push_packet_action_to_group(ac_group, of1x_init_packet_action(OF1X_AT_OUTPUT, field, 0x0));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, ac_group, NULL, NULL, 0);
+
+	return entry;
+}
+
+static uint64_t bench_count_flows(uint64_t dpid){
+
+	uint64_t num = 0;
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+	of1x_stats_flow_msg_t* fp_msg;
+
+	fp_msg = hal_driver_of1x_get_flow_stats(dpid, rofl::openflow12::OFPTT_ALL, 0x0ULL, 0x0ULL, rofl::openflow12::OFPP_ANY, rofl::openflow12::OFPG_ANY, &entry->matches);
+	of1x_destroy_flow_entry(entry);
+
+	if(!fp_msg)
+		return 0;
+
+	for(of1x_stats_single_flow_msg_t* elem = fp_msg->flows_head; elem; elem = elem->next)
+		num++;
+
+	of1x_destroy_stats_flow_msg(fp_msg);
+
+	return num;
+}
+
+static openflow_switch* bench_create_switch(void){
+
+	int ma_list[BENCH_NUM_OF_TABLES] = { 0 };
+
+	cparams params = csocket::get_default_params(csocket::SOCKET_TYPE_PLAIN);
+	params.set_param(csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string("127.0.0.1");
+	params.set_param(csocket::PARAM_KEY_REMOTE_PORT).set_string(BENCH_DEFAULT_CTL_PORT);
+
+	return switch_manager::create_switch(OF_VERSION_12, BENCH_DPID, "bench-ckpt", BENCH_NUM_OF_TABLES, ma_list, 1, csocket::SOCKET_TYPE_PLAIN, params);
+}
+
+int main(int argc, char** argv){
+
+	unsigned int num_flows = (argc > 1 && atoi(argv[1]) > 0)? atoi(argv[1]) : BENCH_DEFAULT_FLOWS;
+	char dir[] = "/tmp/bench_checkpoint.XXXXXX";
+	uint64_t start, num;
+	struct stat st;
+	openflow_switch* sw;
+	int rc = EXIT_SUCCESS;
+
+	system_manager::set_logging_debug_level(rofl::logging::ERROR);
+
+	if(!mkdtemp(dir)){
+		fprintf(stderr, "Unable to create a temporary directory\n");
+		return EXIT_FAILURE;
+	}
+
+	if(hal_driver_init("") != HAL_SUCCESS){
+		fprintf(stderr, "Unable to initialize the platform driver\n");
+		rmdir(dir);
+		return EXIT_FAILURE;
+	}
+
+	switch_manager::set_checkpoint_dir(dir);
+
+	fprintf(stdout, "Warm restart benchmark: %u flows\n\n", num_flows);
+	fprintf(stdout, "%-16s %10s %12s %12s\n", "phase", "flows", "time(ms)", "flows/s");
+
+	try{
+		bench_create_switch();
+	}catch(...){
+		fprintf(stderr, "Unable to create the LSI\n");
+		hal_driver_destroy();
+		rmdir(dir);
+		return EXIT_FAILURE;
+	}
+
+	//Fill the table
+	{
+		flow_mod_batch batch;
+		batch.set_max_size(BENCH_DPID, BENCH_BATCH_SIZE);
+
+		start = bench_now_ns();
+		for(unsigned int i=0; i<num_flows; ++i)
+			batch.add(0, bench_flow(i), false, false);
+		batch.flush();
+		bench_print("install", num_flows, bench_now_ns()-start);
+	}
+
+	//Checkpoint
+	start = bench_now_ns();
+	switch_manager::checkpoint_switch(BENCH_DPID);
+	bench_print("checkpoint", num_flows, bench_now_ns()-start);
+
+	//Shutdown (checkpoints again) and restart
+	start = bench_now_ns();
+	switch_manager::destroy_all_switches();
+	bench_print("shutdown", num_flows, bench_now_ns()-start);
+
+	start = bench_now_ns();
+	sw = bench_create_switch();
+	bench_print("create+restore", num_flows, bench_now_ns()-start);
+
+	num = bench_count_flows(BENCH_DPID);
+
+	if(stat(flow_checkpoint::get_path(dir, BENCH_DPID).c_str(), &st) == 0)
+		fprintf(stdout, "\ncheckpoint: %llu bytes (%.1f bytes/flow), generation %llu\n", (unsigned long long)st.st_size, (num_flows)? (double)st.st_size/num_flows : 0.0, (unsigned long long)sw->checkpoint_generation);
+
+	if(num != num_flows){
+		fprintf(stderr, "Restored %llu flows out of %u\n", (unsigned long long)num, num_flows);
+		rc = EXIT_FAILURE;
+	}
+
+	//Explicit destroy; drops the checkpoint
+	switch_manager::destroy_switch(BENCH_DPID);
+	rmdir(dir);
+
+	hal_driver_destroy();
+	rofl::cioloop::shutdown();
+
+	return rc;
+}
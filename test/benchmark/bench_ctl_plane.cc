@@ -0,0 +1,504 @@
+/*
+* Control-plane benchmark
+*
+* Measures the FLOW_MOD, PACKET_IN and PACKET_OUT rates (and latency
+* percentiles) of xdpd for OF1.0, OF1.2 and OF1.3, with an in-process
+* controller. For every version two LSIs (A and B) are created, connected
+* back-to-back with a virtual link and attached to the controller over the
+* loopback. A table-miss entry (priority 0, output to CONTROLLER) is
+* installed in both LSIs, since the default table-miss behaviour is not the
+* same for all the versions (OF1.3 drops).
+*
+* Phases:
+*	- flow-mod-add: N FLOW_MOD ADDs to LSI A, followed by a BARRIER; the rate
+*	  is computed over the time until the BARRIER reply.
+*	- flow-mod-rtt: FLOW_MOD ADD + BARRIER round trips (latency percentiles).
+*	- flow-mod-del: N FLOW_MOD DELETE_STRICTs + BARRIER.
+*	- pkt-in/pkt-out: W frames are injected in LSI B with PACKET_OUTs. They
+*	  hit the table-miss entry of the peer LSI and are sent to the controller, which
+*	  bounces them back (PACKET_OUT to IN_PORT, using the buffer_id) during D
+*	  seconds. The latency is measured from the PACKET_OUT to the PACKET_IN
+*	  of the same frame.
+*
+* Usage: bench_ctl_plane [num_flowmods] [duration_s] [window] [ctl_port]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include <rofl/common/crofbase.h>
+#include <rofl/common/crofdpt.h>
+#include <rofl/common/logging.h>
+#include <rofl/common/openflow/cofflowmod.h>
+#include <rofl/common/openflow/cofactions.h>
+#include <rofl/datapath/hal/driver.h>
+
+#include "xdpd/management/switch_manager.h"
+#include "xdpd/management/port_manager.h"
+#include "xdpd/management/system_manager.h"
+
+using namespace rofl;
+using namespace xdpd;
+
+#define BENCH_DEFAULT_FLOWMODS 10000
+#define BENCH_DEFAULT_DURATION 5
+#define BENCH_DEFAULT_WINDOW 64
+#define BENCH_DEFAULT_CTL_PORT "6699"
+#define BENCH_RTT_SAMPLES 1000
+#define BENCH_NUM_OF_TABLES 1
+
+//Frames injected by the controller
+#define BENCH_ETHER_TYPE 0x88b5
+#define BENCH_FRAME_LEN 64
+#define BENCH_ID_OFFSET 14
+
+//The only port of each LSI (the vlink)
+#define BENCH_PORT_NUM 1
+
+//Bytes of the table-miss PACKET_INs (the frame is buffered)
+#define BENCH_MISS_SEND_LEN 128
+
+static inline uint64_t bench_now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_print_header(const char* title){
+	fprintf(stdout, "\n%s\n", title);
+	fprintf(stdout, "%-16s %10s %12s %10s %10s %10s %10s\n", "workload", "ops", "ops/s", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+}
+
+static double percentile(std::vector<uint64_t>& samples, double p){
+	if(samples.empty())
+		return 0.0;
+	size_t i = (size_t)(p*(samples.size()-1));
+	return samples[i]/1000.0;
+}
+
+static void bench_print(const char* name, uint64_t ops, uint64_t ns, std::vector<uint64_t>& samples){
+	double rate = (ns)? (double)ops*1000000000.0/ns : 0.0;
+
+	std::sort(samples.begin(), samples.end());
+
+	fprintf(stdout, "%-16s %10llu %12.0f %10.1f %10.1f %10.1f %10.1f\n", name, (unsigned long long)ops, rate,
+			percentile(samples, 0.50), percentile(samples, 0.90), percentile(samples, 0.99), percentile(samples, 1.0));
+}
+
+/**
+* In-process controller driving the benchmark of a single OpenFlow version
+*/
+class bench_controller : public crofbase {
+
+	enum bench_phase_t {
+		PHASE_CONNECTING,
+		PHASE_FLOWMOD_ADD,
+		PHASE_FLOWMOD_RTT,
+		PHASE_FLOWMOD_DEL,
+		PHASE_PKT_LOOP,
+		PHASE_DONE,
+	};
+
+	enum bench_timer_t {
+		TIMER_PKT_LOOP_END = 1,
+		TIMER_CONNECT_TIMEOUT = 2,
+	};
+
+	uint8_t ofp_version;
+	uint64_t dpid_a;
+	uint64_t dpid_b;
+	crofdpt* dpt_a;
+	crofdpt* dpt_b;
+
+	unsigned int num_flowmods;
+	unsigned int duration;
+	unsigned int window;
+
+	bench_phase_t phase;
+	uint32_t barrier_xid;
+	uint64_t phase_start;
+	uint64_t last_sent;
+	unsigned int samples_left;
+
+	//Per frame PACKET_OUT timestamps (indexed by frame id)
+	std::vector<uint64_t> pkt_sent;
+	uint64_t num_pkt_ins;
+	uint64_t num_pkt_outs;
+
+public:
+	//Results
+	uint64_t add_ns, del_ns, loop_ns;
+	std::vector<uint64_t> flowmod_rtt;
+	std::vector<uint64_t> pkt_rtt;
+	bool failed;
+
+	bench_controller(uint8_t ofp_version, uint64_t dpid_a, uint64_t dpid_b, unsigned int num_flowmods, unsigned int duration, unsigned int window) :
+			ofp_version(ofp_version),
+			dpid_a(dpid_a),
+			dpid_b(dpid_b),
+			dpt_a(NULL),
+			dpt_b(NULL),
+			num_flowmods(num_flowmods),
+			duration(duration),
+			window(window),
+			phase(PHASE_CONNECTING),
+			barrier_xid(0),
+			phase_start(0),
+			last_sent(0),
+			samples_left(0),
+			pkt_sent(window, 0),
+			num_pkt_ins(0),
+			num_pkt_outs(0),
+			add_ns(0),
+			del_ns(0),
+			loop_ns(0),
+			failed(false)
+	{
+		crofbase::get_versionbitmap().add_ofp_version(ofp_version);
+		flowmod_rtt.reserve(BENCH_RTT_SAMPLES);
+		pkt_rtt.reserve(1024*1024);
+		register_timer(TIMER_CONNECT_TIMEOUT, 10);
+	}
+
+	void listen(std::string const& port){
+		cparams params = csocket::get_default_params(csocket::SOCKET_TYPE_PLAIN);
+		params.set_param(csocket::PARAM_KEY_LOCAL_HOSTNAME).set_string("127.0.0.1");
+		params.set_param(csocket::PARAM_KEY_LOCAL_PORT).set_string(port);
+
+		rofl::openflow::cofhello_elem_versionbitmap versionbitmap;
+		versionbitmap.add_ofp_version(ofp_version);
+
+		crofbase::rpc_listen_for_dpts(versionbitmap, csocket::SOCKET_TYPE_PLAIN, params);
+	}
+
+	uint64_t get_num_pkt_ins(){ return num_pkt_ins; }
+	uint64_t get_num_pkt_outs(){ return num_pkt_outs; }
+
+protected:
+
+	virtual void handle_dpath_open(crofdpt& dpt){
+		if(dpt.get_dpid() == dpid_a)
+			dpt_a = &dpt;
+		else if(dpt.get_dpid() == dpid_b)
+			dpt_b = &dpt;
+
+		if(phase == PHASE_CONNECTING && dpt_a && dpt_b){
+			cancel_timer(TIMER_CONNECT_TIMEOUT);
+
+			//Before any other FLOW_MOD; they are processed in order
+			send_table_miss_flowmod(*dpt_a);
+			send_table_miss_flowmod(*dpt_b);
+
+			start_flowmods(OFPFC_ADD_CMD);
+		}
+	}
+
+	virtual void handle_dpath_close(crofdpt& dpt){
+		if(phase != PHASE_DONE){
+			fprintf(stderr, "LSI 0x%llx disconnected during the benchmark\n", (unsigned long long)dpt.get_dpid());
+			finish(true);
+		}
+	}
+
+	virtual void handle_barrier_reply(crofdpt& dpt, rofl::openflow::cofmsg_barrier_reply& msg, uint8_t aux_id = 0){
+
+		uint64_t now = bench_now_ns();
+
+		if(msg.get_xid() != barrier_xid)
+			return;
+
+		switch(phase){
+			case PHASE_FLOWMOD_ADD:
+				add_ns = now - phase_start;
+				phase = PHASE_FLOWMOD_RTT;
+				samples_left = BENCH_RTT_SAMPLES;
+				send_rtt_probe();
+				break;
+			case PHASE_FLOWMOD_RTT:
+				flowmod_rtt.push_back(now - last_sent);
+				if(--samples_left)
+					send_rtt_probe();
+				else
+					start_flowmods(OFPFC_DEL_CMD);
+				break;
+			case PHASE_FLOWMOD_DEL:
+				del_ns = now - phase_start;
+				start_pkt_loop();
+				break;
+			default:
+				break;
+		}
+	}
+
+	virtual void handle_packet_in(crofdpt& dpt, rofl::openflow::cofmsg_packet_in& msg, uint8_t aux_id = 0){
+
+		uint64_t now = bench_now_ns();
+		uint32_t id, in_port;
+		uint8_t* frame = msg.get_packet().soframe();
+
+		if(phase != PHASE_PKT_LOOP)
+			return;
+
+		if(msg.get_packet().framelen() < BENCH_ID_OFFSET + sizeof(uint32_t))
+			return;
+
+		num_pkt_ins++;
+
+		memcpy(&id, frame + BENCH_ID_OFFSET, sizeof(id));
+		if(id < window && pkt_sent[id])
+			pkt_rtt.push_back(now - pkt_sent[id]);
+
+		//Bounce it back through the vlink
+		if(ofp_version == rofl::openflow10::OFP_VERSION)
+			in_port = msg.get_in_port();
+		else
+			in_port = msg.get_match().get_in_port();
+
+		if(id < window)
+			pkt_sent[id] = bench_now_ns();
+
+		if(msg.get_buffer_id() == no_buffer())
+			send_frame(dpt, no_buffer(), in_port, in_port_port(), frame, msg.get_packet().framelen());
+		else
+			send_frame(dpt, msg.get_buffer_id(), in_port, in_port_port(), NULL, 0);
+	}
+
+	virtual void handle_timeout(int opaque, void* data = (void*)0){
+		switch(opaque){
+			case TIMER_PKT_LOOP_END:
+				loop_ns = bench_now_ns() - phase_start;
+				finish(false);
+				break;
+			case TIMER_CONNECT_TIMEOUT:
+				fprintf(stderr, "LSIs did not connect to the controller\n");
+				finish(true);
+				break;
+			default:
+				break;
+		}
+	}
+
+private:
+
+	enum { OFPFC_ADD_CMD, OFPFC_DEL_CMD };
+
+	uint32_t no_buffer(){
+		return (ofp_version == rofl::openflow10::OFP_VERSION)? 0xffffffff : rofl::openflow12::OFP_NO_BUFFER;
+	}
+
+	uint32_t in_port_port(){
+		return (ofp_version == rofl::openflow10::OFP_VERSION)? (uint32_t)rofl::openflow10::OFPP_IN_PORT : (uint32_t)rofl::openflow12::OFPP_IN_PORT;
+	}
+
+	uint32_t controller_port(){
+		return (ofp_version == rofl::openflow10::OFP_VERSION)? (uint32_t)rofl::openflow10::OFPP_CONTROLLER : (uint32_t)rofl::openflow12::OFPP_CONTROLLER;
+	}
+
+	//Flow-mod i matches on a distinct destination MAC
+	void send_flowmod(unsigned int i, bool add){
+
+		rofl::openflow::cofflowmod fm(ofp_version);
+		uint8_t mac[6] = { 0x02, 0xbe, (uint8_t)(i>>24), (uint8_t)(i>>16), (uint8_t)(i>>8), (uint8_t)i };
+
+		switch(ofp_version){
+			case rofl::openflow10::OFP_VERSION:
+				fm.set_command(add? rofl::openflow10::OFPFC_ADD : rofl::openflow10::OFPFC_DELETE_STRICT);
+				fm.set_buffer_id(0xffffffff);
+				fm.set_out_port(rofl::openflow10::OFPP_NONE);
+				break;
+			case rofl::openflow12::OFP_VERSION:
+				fm.set_command(add? rofl::openflow12::OFPFC_ADD : rofl::openflow12::OFPFC_DELETE_STRICT);
+				fm.set_buffer_id(rofl::openflow12::OFP_NO_BUFFER);
+				fm.set_out_port(rofl::openflow12::OFPP_ANY);
+				fm.set_out_group(rofl::openflow12::OFPG_ANY);
+				break;
+			default:
+				fm.set_command(add? rofl::openflow13::OFPFC_ADD : rofl::openflow13::OFPFC_DELETE_STRICT);
+				fm.set_buffer_id(rofl::openflow13::OFP_NO_BUFFER);
+				fm.set_out_port(rofl::openflow13::OFPP_ANY);
+				fm.set_out_group(rofl::openflow13::OFPG_ANY);
+				break;
+		}
+
+		//No actions/instructions; the entries drop
+		fm.set_table_id(0);
+		fm.set_priority(0x8000);
+		fm.set_match().set_eth_dst(cmacaddr(mac, sizeof(mac)));
+
+		dpt_a->send_flow_mod_message(fm);
+	}
+
+	//Table-miss entry; priority 0, all wildcarded, output to CONTROLLER
+	void send_table_miss_flowmod(crofdpt& dpt){
+
+		rofl::openflow::cofflowmod fm(ofp_version);
+		rofl::openflow::cofaction_output output(ofp_version, controller_port(), BENCH_MISS_SEND_LEN);
+
+		switch(ofp_version){
+			case rofl::openflow10::OFP_VERSION:
+				fm.set_command(rofl::openflow10::OFPFC_ADD);
+				fm.set_buffer_id(0xffffffff);
+				fm.set_out_port(rofl::openflow10::OFPP_NONE);
+				fm.set_actions().append_action(output);
+				break;
+			default:{
+				rofl::openflow::cofinst instruction = rofl::openflow::cofinst_apply_actions(ofp_version);
+				instruction.get_actions().append_action(output);
+
+				fm.set_command(rofl::openflow12::OFPFC_ADD);
+				fm.set_buffer_id(rofl::openflow12::OFP_NO_BUFFER);
+				fm.set_out_port(rofl::openflow12::OFPP_ANY);
+				fm.set_out_group(rofl::openflow12::OFPG_ANY);
+				fm.set_instructions().add_inst(instruction);
+				}break;
+		}
+
+		fm.set_table_id(0);
+		fm.set_priority(0);
+
+		dpt.send_flow_mod_message(fm);
+	}
+
+	void start_flowmods(int cmd){
+
+		phase = (cmd == OFPFC_ADD_CMD)? PHASE_FLOWMOD_ADD : PHASE_FLOWMOD_DEL;
+		phase_start = bench_now_ns();
+
+		for(unsigned int i=0;i<num_flowmods;i++)
+			send_flowmod(i, cmd == OFPFC_ADD_CMD);
+
+		barrier_xid = dpt_a->send_barrier_request();
+	}
+
+	void send_rtt_probe(){
+		//Use ids beyond the bulk ones; these entries are left in the table
+		last_sent = bench_now_ns();
+		send_flowmod(num_flowmods + samples_left, true);
+		barrier_xid = dpt_a->send_barrier_request();
+	}
+
+	void send_frame(crofdpt& dpt, uint32_t buffer_id, uint32_t in_port, uint32_t out_port, uint8_t* data, size_t len){
+
+		rofl::openflow::cofactions actions(ofp_version);
+		actions.append_action(rofl::openflow::cofaction_output(ofp_version, out_port, 0xffff));
+
+		dpt.send_packet_out_message(buffer_id, in_port, actions, data, len);
+		num_pkt_outs++;
+	}
+
+	void start_pkt_loop(){
+
+		uint8_t frame[BENCH_FRAME_LEN];
+
+		phase = PHASE_PKT_LOOP;
+		phase_start = bench_now_ns();
+
+		memset(frame, 0, sizeof(frame));
+		memset(frame, 0xff, 6);				//Broadcast dst
+		frame[6] = 0x02; frame[11] = 0x01;		//Locally administered src
+		frame[12] = BENCH_ETHER_TYPE >> 8;
+		frame[13] = BENCH_ETHER_TYPE & 0xff;
+
+		//Inject the window through LSI B
+		for(uint32_t id=0;id<window;id++){
+			memcpy(frame + BENCH_ID_OFFSET, &id, sizeof(id));
+			pkt_sent[id] = bench_now_ns();
+			send_frame(*dpt_b, no_buffer(), controller_port(), BENCH_PORT_NUM, frame, sizeof(frame));
+		}
+
+		register_timer(TIMER_PKT_LOOP_END, duration);
+	}
+
+	void finish(bool error){
+		failed = error;
+		phase = PHASE_DONE;
+		rofl::cioloop::get_loop().stop();
+	}
+};
+
+static int bench_version(of_version_t version, uint8_t ofp_version, const char* title, std::string const& ctl_port, unsigned int num_flowmods, unsigned int duration, unsigned int window){
+
+	uint64_t dpid_a = 0x100 + ofp_version, dpid_b = 0x200 + ofp_version;
+	std::stringstream name_a, name_b;
+	std::string port_a, port_b;
+	int ma_list[BENCH_NUM_OF_TABLES] = { 0 };
+	int rc = EXIT_SUCCESS;
+
+	name_a << "bench-a-" << (int)ofp_version;
+	name_b << "bench-b-" << (int)ofp_version;
+
+	bench_controller ctl(ofp_version, dpid_a, dpid_b, num_flowmods, duration, window);
+	ctl.listen(ctl_port);
+
+	cparams params = csocket::get_default_params(csocket::SOCKET_TYPE_PLAIN);
+	params.set_param(csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string("127.0.0.1");
+	params.set_param(csocket::PARAM_KEY_REMOTE_PORT).set_string(ctl_port);
+
+	try{
+		switch_manager::create_switch(version, dpid_a, name_a.str(), BENCH_NUM_OF_TABLES, ma_list, 1, csocket::SOCKET_TYPE_PLAIN, params);
+		switch_manager::create_switch(version, dpid_b, name_b.str(), BENCH_NUM_OF_TABLES, ma_list, 1, csocket::SOCKET_TYPE_PLAIN, params);
+		port_manager::connect_switches(dpid_a, port_a, dpid_b, port_b);
+	}catch(...){
+		fprintf(stderr, "%s: unable to create the LSIs\n", title);
+		switch_manager::destroy_all_switches();
+		return EXIT_FAILURE;
+	}
+
+	//Until the controller is done (or fails)
+	rofl::cioloop::get_loop().run();
+
+	if(ctl.failed){
+		fprintf(stderr, "%s: benchmark aborted\n", title);
+		rc = EXIT_FAILURE;
+	}else{
+		std::vector<uint64_t> none;
+
+		bench_print_header(title);
+		bench_print("flow-mod-add", num_flowmods, ctl.add_ns, none);
+		bench_print("flow-mod-rtt", ctl.flowmod_rtt.size(), 0, ctl.flowmod_rtt);
+		bench_print("flow-mod-del", num_flowmods, ctl.del_ns, none);
+		bench_print("pkt-in", ctl.get_num_pkt_ins(), ctl.loop_ns, ctl.pkt_rtt);
+		bench_print("pkt-out", ctl.get_num_pkt_outs(), ctl.loop_ns, none);
+
+		if(!ctl.get_num_pkt_ins())
+			fprintf(stderr, "%s: no PACKET_INs received\n", title);
+	}
+
+	switch_manager::destroy_all_switches();
+
+	return rc;
+}
+
+int main(int argc, char** argv){
+
+	unsigned int num_flowmods = (argc > 1 && atoi(argv[1]) > 0)? atoi(argv[1]) : BENCH_DEFAULT_FLOWMODS;
+	unsigned int duration = (argc > 2 && atoi(argv[2]) > 0)? atoi(argv[2]) : BENCH_DEFAULT_DURATION;
+	unsigned int window = (argc > 3 && atoi(argv[3]) > 0)? atoi(argv[3]) : BENCH_DEFAULT_WINDOW;
+	std::string ctl_port = (argc > 4)? argv[4] : BENCH_DEFAULT_CTL_PORT;
+	int rc = EXIT_SUCCESS;
+
+	system_manager::set_logging_debug_level(rofl::logging::ERROR);
+
+	if(hal_driver_init("") != HAL_SUCCESS){
+		fprintf(stderr, "Unable to initialize the platform driver\n");
+		return EXIT_FAILURE;
+	}
+
+	fprintf(stdout, "Control-plane benchmark: %u flow-mods, %us PKT_IN/PKT_OUT loop, window %u\n", num_flowmods, duration, window);
+
+	rc |= bench_version(OF_VERSION_10, rofl::openflow10::OFP_VERSION, "OpenFlow 1.0", ctl_port, num_flowmods, duration, window);
+	rc |= bench_version(OF_VERSION_12, rofl::openflow12::OFP_VERSION, "OpenFlow 1.2", ctl_port, num_flowmods, duration, window);
+	rc |= bench_version(OF_VERSION_13, rofl::openflow13::OFP_VERSION, "OpenFlow 1.3", ctl_port, num_flowmods, duration, window);
+
+	hal_driver_destroy();
+
+	//Release the loop resources; nothing runs on it from here on
+	rofl::cioloop::shutdown();
+
+	return rc;
+}
@@ -0,0 +1,246 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the cache of PACKET_OUT action
+* groups (action_group_cache)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdexcept>
+#include "xdpd/openflow/action_group_cache.h"
+
+using namespace std;
+using namespace xdpd;
+
+//Translation mockup; OUTPUT (or GROUP) action to port/group 1
+static unsigned int num_of_translations = 0;
+static bool translate_to_group = false;
+static bool translation_fails = false;
+
+static void map_actions(rofl::crofctl* ctl, openflow_switch* sw, rofl::openflow::cofactions& actions, of1x_action_group_t* apply_actions, of1x_write_actions_t* write_actions){
+	wrap_uint_t field;
+
+	num_of_translations++;
+
+	if(translation_fails)
+		throw std::runtime_error("bad action");
+
+	memset(&field, 0, sizeof(wrap_uint_t));
+	field.u32 = 1;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(translate_to_group? OF1X_AT_GROUP : OF1X_AT_OUTPUT, field, 0x0));
+}
+
+class ActionGroupCacheTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(ActionGroupCacheTestCase);
+	CPPUNIT_TEST(test_lookup);
+	CPPUNIT_TEST(test_eviction);
+	CPPUNIT_TEST(test_not_cacheable);
+	CPPUNIT_TEST(test_acquire);
+	CPPUNIT_TEST(test_acquire_uncached);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_lookup(void);
+	void test_eviction(void);
+	void test_not_cacheable(void);
+	void test_acquire(void);
+	void test_acquire_uncached(void);
+
+	//Action group with a single OUTPUT (or GROUP) action
+	of1x_action_group_t* init_group(of1x_packet_action_type_t type);
+
+	//Output action list to port
+	void output_actions(uint32_t port, rofl::openflow::cofactions& actions);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void ActionGroupCacheTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+
+	num_of_translations = 0;
+	translate_to_group = translation_fails = false;
+}
+
+void ActionGroupCacheTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+of1x_action_group_t* ActionGroupCacheTestCase::init_group(of1x_packet_action_type_t type){
+	of1x_action_group_t* group = of1x_init_action_group(NULL);
+	wrap_uint_t field;
+
+	memset(&field, 0, sizeof(wrap_uint_t));
+	field.u32 = 1;
+	of1x_push_packet_action_to_group(group, of1x_init_packet_action(type, field, 0x0));
+
+	return group;
+}
+
+void ActionGroupCacheTestCase::output_actions(uint32_t port, rofl::openflow::cofactions& actions){
+	actions.append_action(rofl::openflow::cofaction_output(rofl::openflow13::OFP_VERSION, port, 128));
+}
+
+void ActionGroupCacheTestCase::test_lookup(void)
+{
+	action_group_cache cache;
+	rofl::openflow::cofactions actions1(rofl::openflow13::OFP_VERSION);
+	rofl::openflow::cofactions actions2(rofl::openflow13::OFP_VERSION);
+	of1x_action_group_t* group = init_group(OF1X_AT_OUTPUT);
+
+	fprintf(stderr,"<%s:%d> ************** Test lookup ************\n",__func__,__LINE__);
+
+	output_actions(1, actions1);
+	output_actions(2, actions2);
+
+	//Keys are the wire format
+	CPPUNIT_ASSERT(action_group_cache::get_key(actions1) == action_group_cache::get_key(actions1));
+	CPPUNIT_ASSERT(action_group_cache::get_key(actions1) != action_group_cache::get_key(actions2));
+
+	CPPUNIT_ASSERT(cache.lookup(action_group_cache::get_key(actions1)) == NULL);
+	CPPUNIT_ASSERT(cache.insert(action_group_cache::get_key(actions1), group) == true);
+	CPPUNIT_ASSERT(cache.size() == 1);
+
+	CPPUNIT_ASSERT(cache.lookup(action_group_cache::get_key(actions1)) == group);
+	CPPUNIT_ASSERT(cache.lookup(action_group_cache::get_key(actions2)) == NULL);
+
+	CPPUNIT_ASSERT(cache.get_hits() == 1);
+	CPPUNIT_ASSERT(cache.get_misses() == 2);
+
+	//Already there; the caller keeps the group
+	of1x_action_group_t* dup = init_group(OF1X_AT_OUTPUT);
+	CPPUNIT_ASSERT(cache.insert(action_group_cache::get_key(actions1), dup) == false);
+	of1x_destroy_action_group(dup);
+
+	cache.clear();
+	CPPUNIT_ASSERT(cache.size() == 0);
+	CPPUNIT_ASSERT(cache.lookup(action_group_cache::get_key(actions1)) == NULL);
+}
+
+void ActionGroupCacheTestCase::test_eviction(void)
+{
+	action_group_cache cache(2);
+
+	fprintf(stderr,"<%s:%d> ************** Test eviction ************\n",__func__,__LINE__);
+
+	CPPUNIT_ASSERT(cache.insert("a", init_group(OF1X_AT_OUTPUT)));
+	CPPUNIT_ASSERT(cache.insert("b", init_group(OF1X_AT_OUTPUT)));
+
+	//"a" becomes the most recently used; "b" is evicted
+	CPPUNIT_ASSERT(cache.lookup("a") != NULL);
+	CPPUNIT_ASSERT(cache.insert("c", init_group(OF1X_AT_OUTPUT)));
+
+	CPPUNIT_ASSERT(cache.size() == 2);
+	CPPUNIT_ASSERT(cache.lookup("a") != NULL);
+	CPPUNIT_ASSERT(cache.lookup("b") == NULL);
+	CPPUNIT_ASSERT(cache.lookup("c") != NULL);
+}
+
+void ActionGroupCacheTestCase::test_not_cacheable(void)
+{
+	action_group_cache cache;
+	action_group_cache disabled(0);
+	of1x_action_group_t* group = init_group(OF1X_AT_GROUP);
+	of1x_action_group_t* output = init_group(OF1X_AT_OUTPUT);
+
+	fprintf(stderr,"<%s:%d> ************** Test not cacheable ************\n",__func__,__LINE__);
+
+	//Groups may change between PACKET_OUTs
+	CPPUNIT_ASSERT(cache.insert("group", group) == false);
+	CPPUNIT_ASSERT(cache.lookup("group") == NULL);
+
+	//Cache disabled
+	CPPUNIT_ASSERT(disabled.insert("output", output) == false);
+	CPPUNIT_ASSERT(disabled.size() == 0);
+
+	of1x_destroy_action_group(group);
+	of1x_destroy_action_group(output);
+}
+
+void ActionGroupCacheTestCase::test_acquire(void)
+{
+	action_group_cache cache;
+	rofl::openflow::cofactions actions(rofl::openflow13::OFP_VERSION);
+	of1x_action_group_t *group1, *group2;
+	bool cached;
+
+	fprintf(stderr,"<%s:%d> ************** Test acquire ************\n",__func__,__LINE__);
+
+	output_actions(1, actions);
+
+	//Translated once
+	group1 = cache.acquire(NULL, NULL, actions, map_actions, cached);
+	CPPUNIT_ASSERT(group1 != NULL && cached);
+	CPPUNIT_ASSERT(group1->head->type == OF1X_AT_OUTPUT);
+	action_group_cache::release(group1, cached);
+
+	group2 = cache.acquire(NULL, NULL, actions, map_actions, cached);
+	CPPUNIT_ASSERT(group2 == group1 && cached);
+	action_group_cache::release(group2, cached);
+
+	CPPUNIT_ASSERT(num_of_translations == 1);
+	CPPUNIT_ASSERT(cache.get_hits() == 1);
+
+	//Translation errors are rethrown, and nothing is cached
+	rofl::openflow::cofactions bad(rofl::openflow13::OFP_VERSION);
+	output_actions(2, bad);
+	translation_fails = true;
+
+	bool thrown = false;
+	try{
+		cache.acquire(NULL, NULL, bad, map_actions, cached);
+	}catch(std::runtime_error& e){
+		thrown = true;
+	}
+	CPPUNIT_ASSERT(thrown);
+	CPPUNIT_ASSERT(cache.size() == 1);
+}
+
+void ActionGroupCacheTestCase::test_acquire_uncached(void)
+{
+	action_group_cache cache;
+	rofl::openflow::cofactions actions(rofl::openflow13::OFP_VERSION);
+	of1x_action_group_t* group;
+	bool cached;
+
+	fprintf(stderr,"<%s:%d> ************** Test acquire (not cacheable) ************\n",__func__,__LINE__);
+
+	output_actions(1, actions);
+	translate_to_group = true;
+
+	//The caller owns the group; translated every time
+	for(unsigned int i=0;i<3;i++){
+		group = cache.acquire(NULL, NULL, actions, map_actions, cached);
+		CPPUNIT_ASSERT(group != NULL && !cached);
+		action_group_cache::release(group, cached);
+	}
+
+	CPPUNIT_ASSERT(num_of_translations == 3);
+	CPPUNIT_ASSERT(cache.size() == 0);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(ActionGroupCacheTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
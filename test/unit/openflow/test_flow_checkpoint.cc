@@ -0,0 +1,348 @@
+/**
+* This is a unit test that must check that the flow and group
+* tables of an LSI are restored from its checkpoint (flow_checkpoint),
+* and that truncated or corrupted checkpoints are detected
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include "xdpd/openflow/openflow_switch.h"
+#include "xdpd/openflow/flow_checkpoint.h"
+
+#define TEST_DPID 0x100ULL
+#define TEST_NUM_OF_TABLES 2
+#define TEST_NUM_OF_FLOWS 8
+
+using namespace std;
+using namespace xdpd;
+
+/*
+* Driver mockup; the calls are served by a pipeline LSI (lsw)
+*/
+static of1x_switch_t* lsw = NULL;
+
+rofl_of1x_gm_result_t hal_driver_of1x_group_mod_add(uint64_t dpid, of1x_group_type_t type, uint32_t id, of1x_bucket_list_t **buckets){
+	CPPUNIT_ASSERT(dpid == TEST_DPID);
+	return of1x_group_add(lsw->pipeline.groups, type, id, buckets);
+}
+
+hal_result_t hal_driver_of1x_fetch_group_table(uint64_t dpid, of1x_group_table_t *group_table){
+	CPPUNIT_ASSERT(dpid == TEST_DPID);
+	return (of1x_fetch_group_table(&lsw->pipeline, group_table) == ROFL_SUCCESS)? HAL_SUCCESS : HAL_FAILURE;
+}
+
+of1x_stats_flow_msg_t* hal_driver_of1x_get_flow_stats(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches){
+	CPPUNIT_ASSERT(dpid == TEST_DPID);
+	return of1x_get_flow_stats(&lsw->pipeline, table_id, cookie, cookie_mask, out_port, out_group, matches);
+}
+
+hal_result_t hal_driver_of1x_process_flow_mod_add(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** flow_entry, uint32_t buffer_id, bool check_overlap, bool reset_counts){
+	CPPUNIT_ASSERT(dpid == TEST_DPID);
+	return (of1x_add_flow_entry_table(&lsw->pipeline, table_id, flow_entry, check_overlap, reset_counts) == ROFL_OF1X_FM_SUCCESS)? HAL_SUCCESS : HAL_FAILURE;
+}
+
+hal_result_t hal_driver_of1x_process_flow_mod_add_batch(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** entries, unsigned int num, bool check_overlap, bool reset_counts, hal_result_t* results){
+	for(unsigned int i=0;i<num;i++)
+		results[i] = hal_driver_of1x_process_flow_mod_add(dpid, table_id, &entries[i], 0, check_overlap, reset_counts);
+	return HAL_SUCCESS;
+}
+
+switch_port_snapshot_t* hal_driver_get_port_snapshot_by_num(uint64_t dpid, unsigned int port_num){
+	return NULL;
+}
+
+/*
+* LSI of the CMM; only the version agnostic part is used
+*/
+class test_switch : public openflow_switch{
+
+public:
+	test_switch(uint64_t dpid) : openflow_switch(dpid, "test", OF_VERSION_13, TEST_NUM_OF_TABLES){}
+
+	virtual rofl_result_t process_packet_in(uint8_t table_id, uint8_t reason, uint32_t in_port, uint32_t buffer_id, uint8_t* pkt_buffer, uint32_t buf_len, uint16_t total_len, packet_matches_t* matches){
+		return ROFL_FAILURE;
+	}
+	virtual rofl_result_t process_flow_removed(uint8_t reason, of1x_flow_entry_t* removed_flow_entry){
+		return ROFL_FAILURE;
+	}
+};
+
+class FlowCheckpointTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(FlowCheckpointTestCase);
+	CPPUNIT_TEST(test_round_trip);
+	CPPUNIT_TEST(test_truncated);
+	CPPUNIT_TEST(test_corrupted);
+	CPPUNIT_TEST(test_other_lsi);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_round_trip(void);
+	void test_truncated(void);
+	void test_corrupted(void);
+	void test_other_lsi(void);
+
+	char dir[64];
+	std::string path;
+	test_switch* sw;
+
+	//(Re)create the pipeline LSI, with empty tables
+	void reset_lsi(void);
+
+	//Fill the tables of the LSI; a group and TEST_NUM_OF_FLOWS flows
+	void fill_lsi(void);
+
+	void write_file(std::vector<uint8_t>& image);
+	flow_checkpoint_hdr_t* get_hdr(std::vector<uint8_t>& image);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void FlowCheckpointTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+
+	strcpy(dir, "/tmp/xdpd-ckpt-XXXXXX");
+	CPPUNIT_ASSERT(mkdtemp(dir) != NULL);
+	path = flow_checkpoint::get_path(dir, TEST_DPID);
+
+	sw = new test_switch(TEST_DPID);
+	reset_lsi();
+}
+
+void FlowCheckpointTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+
+	of1x_destroy_switch(lsw);
+	lsw = NULL;
+	delete sw;
+
+	unlink(path.c_str());
+	rmdir(dir);
+}
+
+void FlowCheckpointTestCase::reset_lsi(void){
+
+	enum of1x_matching_algorithm_available ma_list[TEST_NUM_OF_TABLES] = { of1x_loop_matching_algorithm, of1x_loop_matching_algorithm };
+
+	if(lsw)
+		of1x_destroy_switch(lsw);
+
+	lsw = of1x_init_switch("test", OF_VERSION_13, TEST_DPID, TEST_NUM_OF_TABLES, ma_list);
+	CPPUNIT_ASSERT(lsw != NULL);
+}
+
+void FlowCheckpointTestCase::fill_lsi(void){
+
+	wrap_uint_t field;
+	of1x_action_group_t* ac_group;
+	of1x_bucket_list_t* bucket_list;
+	of1x_flow_entry_t* entry;
+
+	//Group 1; outputs to port 1
+	ac_group = of1x_init_action_group(NULL);
+	field.u64 = 1;
+	of1x_push_packet_action_to_group(ac_group, of1x_init_packet_action(OF1X_AT_OUTPUT, field, 0x0));
+	bucket_list = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(bucket_list, of1x_init_bucket(0, OF1X_PORT_ANY, OF1X_GROUP_ANY, ac_group));
+	CPPUNIT_ASSERT(hal_driver_of1x_group_mod_add(TEST_DPID, OF1X_GROUP_TYPE_ALL, 1, &bucket_list) == ROFL_OF1X_GM_OK);
+
+	//Flows in both tables; half of them to the group
+	for(unsigned int i=0;i<TEST_NUM_OF_FLOWS;i++){
+		entry = of1x_init_flow_entry(false);
+		entry->priority = 0x100 + i;
+		entry->cookie = 0xc0ffee00 + i;
+
+		of1x_add_match_to_entry(entry, of1x_init_eth_type_match(0x0800));
+		of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(0x0a000000 | i, 0xffffffff));
+
+		ac_group = of1x_init_action_group(NULL);
+		field.u64 = (i%2)? 1 : 2;
+		of1x_push_packet_action_to_group(ac_group, of1x_init_packet_action((i%2)? OF1X_AT_GROUP : OF1X_AT_OUTPUT, field, 0x0));
+		of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, ac_group, NULL, NULL, 0);
+
+		CPPUNIT_ASSERT(hal_driver_of1x_process_flow_mod_add(TEST_DPID, i%TEST_NUM_OF_TABLES, &entry, 0, false, false) == HAL_SUCCESS);
+	}
+}
+
+void FlowCheckpointTestCase::write_file(std::vector<uint8_t>& image){
+
+	FILE* f = fopen(path.c_str(), "w");
+
+	CPPUNIT_ASSERT(f != NULL);
+	if(image.size())
+		CPPUNIT_ASSERT(fwrite(&image[0], image.size(), 1, f) == 1);
+	fclose(f);
+}
+
+flow_checkpoint_hdr_t* FlowCheckpointTestCase::get_hdr(std::vector<uint8_t>& image){
+	CPPUNIT_ASSERT(image.size() >= sizeof(flow_checkpoint_hdr_t));
+	return (flow_checkpoint_hdr_t*)&image[0];
+}
+
+void FlowCheckpointTestCase::test_round_trip(void)
+{
+	std::vector<uint8_t> image, restored;
+	uint64_t generation = 0;
+
+	fprintf(stderr,"<%s:%d> ************** Test round trip ************\n",__func__,__LINE__);
+
+	fill_lsi();
+
+	CPPUNIT_ASSERT(flow_checkpoint::save(sw, path, 7) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(access((path + ".tmp").c_str(), F_OK) != 0);
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 7, image) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(get_hdr(image)->num_of_groups == 1);
+	CPPUNIT_ASSERT(get_hdr(image)->num_of_flows == TEST_NUM_OF_FLOWS);
+	CPPUNIT_ASSERT(get_hdr(image)->len == image.size());
+
+	//Restart
+	reset_lsi();
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, &generation) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(generation == 7);
+
+	//Same tables; the records must be the same
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 7, restored) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(restored.size() == image.size());
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_groups == 1);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_flows == TEST_NUM_OF_FLOWS);
+	CPPUNIT_ASSERT(memcmp(&image[sizeof(flow_checkpoint_hdr_t)], &restored[sizeof(flow_checkpoint_hdr_t)], image.size()-sizeof(flow_checkpoint_hdr_t)) == 0);
+}
+
+void FlowCheckpointTestCase::test_truncated(void)
+{
+	std::vector<uint8_t> image, restored;
+
+	fprintf(stderr,"<%s:%d> ************** Test truncated checkpoint ************\n",__func__,__LINE__);
+
+	fill_lsi();
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, image) == ROFL_SUCCESS);
+	reset_lsi();
+
+	//Missing the end of the last record
+	image.resize(image.size()-8);
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+
+	//Shorter than the header
+	image.resize(sizeof(flow_checkpoint_hdr_t)/2);
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+
+	//Empty
+	image.clear();
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+
+	//Missing
+	unlink(path.c_str());
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+
+	//Nothing was installed
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, restored) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_groups == 0);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_flows == 0);
+}
+
+void FlowCheckpointTestCase::test_corrupted(void)
+{
+	std::vector<uint8_t> image, restored;
+	flow_checkpoint_group_t* group;
+	flow_checkpoint_flow_t* flow;
+	uint8_t* it;
+
+	fprintf(stderr,"<%s:%d> ************** Test corrupted checkpoint ************\n",__func__,__LINE__);
+
+	fill_lsi();
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, image) == ROFL_SUCCESS);
+	reset_lsi();
+
+	//Bad magic
+	get_hdr(image)->magic ^= 0xff;
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+	get_hdr(image)->magic ^= 0xff;
+
+	//Bad version
+	get_hdr(image)->version++;
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+	get_hdr(image)->version--;
+
+	//Length of the third flow record beyond the end of the file
+	it = &image[sizeof(flow_checkpoint_hdr_t)];
+	group = (flow_checkpoint_group_t*)it;
+	it += (group->len + 7) & ~7;
+	for(unsigned int i=0;i<2;i++){
+		flow = (flow_checkpoint_flow_t*)it;
+		it += (flow->len + 7) & ~7;
+	}
+	flow = (flow_checkpoint_flow_t*)it;
+	flow->len = 0xffffffff;
+	write_file(image);
+
+	//The records before the corrupted one are restored
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, restored) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_groups == 1);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_flows == 2);
+
+	//Match length beyond the record
+	reset_lsi();
+	flow->len = sizeof(flow_checkpoint_flow_t);
+	flow->match_len = 0xffff;
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, restored) == ROFL_SUCCESS);
+	CPPUNIT_ASSERT(get_hdr(restored)->num_of_flows == 2);
+}
+
+void FlowCheckpointTestCase::test_other_lsi(void)
+{
+	std::vector<uint8_t> image;
+
+	fprintf(stderr,"<%s:%d> ************** Test checkpoint of another LSI ************\n",__func__,__LINE__);
+
+	fill_lsi();
+	CPPUNIT_ASSERT(flow_checkpoint::serialize(sw, 1, image) == ROFL_SUCCESS);
+	reset_lsi();
+
+	get_hdr(image)->dpid = TEST_DPID+1;
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+
+	get_hdr(image)->dpid = TEST_DPID;
+	get_hdr(image)->of_version = OF_VERSION_12;
+	write_file(image);
+	CPPUNIT_ASSERT(flow_checkpoint::restore(sw, path, NULL) == ROFL_FAILURE);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(FlowCheckpointTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the FLOW_MOD ADD batches (flow_mod_batch);
+* when they are flushed and how failures are accounted and reported
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <vector>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include "xdpd/openflow/flow_mod_batch.h"
+
+#define TEST_DPID 0x100ULL
+
+using namespace std;
+using namespace xdpd;
+
+/*
+* Driver mockup. Entries with an odd priority fail; the rest are taken
+* (and released) by the "driver"
+*/
+typedef struct driver_call{
+	uint64_t dpid;
+	uint8_t table_id;
+	unsigned int num;
+	bool check_overlap;
+	bool reset_counts;
+}driver_call_t;
+
+static std::vector<driver_call_t> calls;
+
+hal_result_t hal_driver_of1x_process_flow_mod_add_batch(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** entries, unsigned int num, bool check_overlap, bool reset_counts, hal_result_t* results){
+	driver_call_t call = {dpid, table_id, num, check_overlap, reset_counts};
+
+	calls.push_back(call);
+
+	for(unsigned int i=0;i<num;i++){
+		if(entries[i]->priority % 2){
+			results[i] = HAL_FAILURE;
+		}else{
+			results[i] = HAL_SUCCESS;
+			of1x_destroy_flow_entry(entries[i]);
+		}
+	}
+
+	return HAL_SUCCESS;
+}
+
+hal_result_t hal_driver_of1x_process_flow_mod_add(uint64_t dpid, uint8_t table_id, of1x_flow_entry_t** flow_entry, uint32_t buffer_id, bool check_overlap, bool reset_counts){
+	//Batched call must always be used
+	CPPUNIT_ASSERT(0);
+	return HAL_FAILURE;
+}
+
+/*
+* Listener; records the errors reported
+*/
+class error_recorder : public flow_mod_batch_listener{
+
+public:
+	std::vector<void*> opaques;
+	std::vector<hal_result_t> results;
+
+	virtual void handle_flow_mod_batch_error(void* opaque, hal_result_t result){
+		opaques.push_back(opaque);
+		results.push_back(result);
+	}
+};
+
+class FlowModBatchTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(FlowModBatchTestCase);
+	CPPUNIT_TEST(test_disabled);
+	CPPUNIT_TEST(test_flush_on_size);
+	CPPUNIT_TEST(test_flush_on_table_and_flags);
+	CPPUNIT_TEST(test_flush_explicit);
+	CPPUNIT_TEST(test_failures);
+	CPPUNIT_TEST(test_listener);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_disabled(void);
+	void test_flush_on_size(void);
+	void test_flush_on_table_and_flags(void);
+	void test_flush_explicit(void);
+	void test_failures(void);
+	void test_listener(void);
+
+	of1x_flow_entry_t* init_entry(uint16_t priority);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void FlowModBatchTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+	calls.clear();
+}
+
+void FlowModBatchTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+of1x_flow_entry_t* FlowModBatchTestCase::init_entry(uint16_t priority){
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(false);
+
+	CPPUNIT_ASSERT(entry != NULL);
+	entry->priority = priority;
+
+	return entry;
+}
+
+void FlowModBatchTestCase::test_disabled(void)
+{
+	flow_mod_batch batch;
+	of1x_flow_entry_t* entry = init_entry(0);
+
+	fprintf(stderr,"<%s:%d> ************** Test disabled ************\n",__func__,__LINE__);
+
+	//Disabled by default; the caller keeps the entry
+	CPPUNIT_ASSERT(batch.add(0, entry, false, false) == false);
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 0);
+
+	batch.set_max_size(TEST_DPID, 0);
+	CPPUNIT_ASSERT(batch.add(0, entry, false, false) == false);
+	CPPUNIT_ASSERT(calls.empty());
+
+	of1x_destroy_flow_entry(entry);
+}
+
+void FlowModBatchTestCase::test_flush_on_size(void)
+{
+	flow_mod_batch batch;
+
+	fprintf(stderr,"<%s:%d> ************** Test flush on size ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 4);
+
+	for(unsigned int i=0;i<3;i++)
+		CPPUNIT_ASSERT(batch.add(1, init_entry(0), false, false));
+
+	CPPUNIT_ASSERT(calls.empty());
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 3);
+
+	//Full
+	CPPUNIT_ASSERT(batch.add(1, init_entry(0), false, false));
+	CPPUNIT_ASSERT(calls.size() == 1);
+	CPPUNIT_ASSERT(calls[0].dpid == TEST_DPID);
+	CPPUNIT_ASSERT(calls[0].table_id == 1);
+	CPPUNIT_ASSERT(calls[0].num == 4);
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 0);
+
+	CPPUNIT_ASSERT(batch.get_num_of_batches() == 1);
+	CPPUNIT_ASSERT(batch.get_num_of_entries() == 4);
+	CPPUNIT_ASSERT(batch.get_num_of_failures() == 0);
+}
+
+void FlowModBatchTestCase::test_flush_on_table_and_flags(void)
+{
+	flow_mod_batch batch;
+
+	fprintf(stderr,"<%s:%d> ************** Test flush on table/flags change ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 16);
+
+	batch.add(0, init_entry(0), false, false);
+	batch.add(0, init_entry(0), false, false);
+
+	//Other table
+	batch.add(1, init_entry(0), false, false);
+	CPPUNIT_ASSERT(calls.size() == 1);
+	CPPUNIT_ASSERT(calls[0].table_id == 0 && calls[0].num == 2);
+
+	//Other flags
+	batch.add(1, init_entry(0), true, false);
+	CPPUNIT_ASSERT(calls.size() == 2);
+	CPPUNIT_ASSERT(calls[1].table_id == 1 && calls[1].num == 1);
+	CPPUNIT_ASSERT(!calls[1].check_overlap);
+
+	batch.add(1, init_entry(0), true, true);
+	CPPUNIT_ASSERT(calls.size() == 3);
+	CPPUNIT_ASSERT(calls[2].check_overlap && !calls[2].reset_counts);
+
+	batch.flush();
+	CPPUNIT_ASSERT(calls.size() == 4);
+	CPPUNIT_ASSERT(calls[3].check_overlap && calls[3].reset_counts);
+}
+
+void FlowModBatchTestCase::test_flush_explicit(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test explicit flush ************\n",__func__,__LINE__);
+
+	{
+		flow_mod_batch batch;
+		batch.set_max_size(TEST_DPID, 16);
+
+		//Nothing pending; no driver call
+		batch.flush();
+		CPPUNIT_ASSERT(calls.empty());
+
+		batch.add(0, init_entry(0), false, false);
+		batch.flush();
+		CPPUNIT_ASSERT(calls.size() == 1);
+
+		//Resizing flushes
+		batch.add(0, init_entry(0), false, false);
+		batch.set_max_size(TEST_DPID, 8);
+		CPPUNIT_ASSERT(calls.size() == 2);
+
+		//And so does the destruction
+		batch.add(0, init_entry(0), false, false);
+		CPPUNIT_ASSERT(calls.size() == 2);
+	}
+
+	CPPUNIT_ASSERT(calls.size() == 3);
+	CPPUNIT_ASSERT(calls[2].num == 1);
+}
+
+void FlowModBatchTestCase::test_failures(void)
+{
+	flow_mod_batch batch;
+
+	fprintf(stderr,"<%s:%d> ************** Test failures ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 10);
+
+	//Odd priorities fail (entries are released by the batch)
+	for(unsigned int i=0;i<25;i++)
+		batch.add(0, init_entry(i), false, false);
+	batch.flush();
+
+	CPPUNIT_ASSERT(calls.size() == 3);
+	CPPUNIT_ASSERT(batch.get_num_of_batches() == 3);
+	CPPUNIT_ASSERT(batch.get_num_of_entries() == 25);
+	CPPUNIT_ASSERT(batch.get_num_of_failures() == 12);
+}
+
+void FlowModBatchTestCase::test_listener(void)
+{
+	error_recorder recorder;
+	flow_mod_batch batch(&recorder);
+	uintptr_t i;
+
+	fprintf(stderr,"<%s:%d> ************** Test listener ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 4);
+
+	//Not reported until the batch is flushed
+	for(i=0;i<3;i++)
+		batch.add(0, init_entry(i), false, false, (void*)(i+1));
+	CPPUNIT_ASSERT(recorder.opaques.empty());
+
+	//Full; only the failures (odd priorities) are reported
+	batch.add(0, init_entry(3), false, false, (void*)4);
+	CPPUNIT_ASSERT(recorder.opaques.size() == 2);
+	CPPUNIT_ASSERT(recorder.opaques[0] == (void*)2 && recorder.opaques[1] == (void*)4);
+	CPPUNIT_ASSERT(recorder.results[0] == HAL_FAILURE && recorder.results[1] == HAL_FAILURE);
+
+	//In order, also on table changes
+	batch.add(0, init_entry(5), false, false, (void*)5);
+	batch.add(1, init_entry(7), false, false, (void*)6);
+	CPPUNIT_ASSERT(recorder.opaques.size() == 3);
+	batch.flush();
+	CPPUNIT_ASSERT(recorder.opaques.size() == 4);
+	CPPUNIT_ASSERT(recorder.opaques[2] == (void*)5 && recorder.opaques[3] == (void*)6);
+	CPPUNIT_ASSERT(batch.get_num_of_failures() == 4);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(FlowModBatchTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
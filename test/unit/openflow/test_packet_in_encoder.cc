@@ -0,0 +1,190 @@
+/**
+* This is a unit test that must check that the match
+* of the PACKET_INs built by the packet_in_encoder is
+* the same as the one of the reverse translations
+* (of1x/of12/of13_map_reverse_packet_matches)
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "xdpd/openflow/packet_in_encoder.h"
+#include "xdpd/openflow/openflow10/of10_translation_utils.h"
+#include "xdpd/openflow/openflow12/of12_translation_utils.h"
+#include "xdpd/openflow/openflow13/of13_translation_utils.h"
+
+//Random packet_matches_t per version
+#define NUM_OF_ITERATIONS 1000
+
+using namespace std;
+using namespace xdpd;
+
+class PacketInEncoderTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(PacketInEncoderTestCase);
+	CPPUNIT_TEST(test_empty);
+	CPPUNIT_TEST(test_of10);
+	CPPUNIT_TEST(test_of12);
+	CPPUNIT_TEST(test_of13);
+	CPPUNIT_TEST(test_unsupported);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_empty(void);
+	void test_of10(void);
+	void test_of12(void);
+	void test_of13(void);
+	void test_unsupported(void);
+
+	packet_in_encoder encoder;
+
+	//Fill pm with random values; every 8 byte block is zeroed with a 50%
+	//probability, so that fields are both set and unset
+	void fill(packet_matches_t* pm);
+
+	//Check that both matches have the same wire representation
+	void check_equal(rofl::openflow::cofmatch& match, rofl::openflow::cofmatch& expected);
+
+	void check_version(uint8_t ofp_version);
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void PacketInEncoderTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+	srand(0xbeef);
+}
+
+void PacketInEncoderTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+}
+
+void PacketInEncoderTestCase::fill(packet_matches_t* pm){
+	uint8_t* p = (uint8_t*)pm;
+
+	for(unsigned int i=0;i<sizeof(packet_matches_t);i++)
+		p[i] = rand();
+
+	for(unsigned int i=0;i<sizeof(packet_matches_t);i+=8){
+		if(rand()%2)
+			memset(p+i, 0, (sizeof(packet_matches_t)-i < 8)? sizeof(packet_matches_t)-i : 8);
+	}
+}
+
+void PacketInEncoderTestCase::check_equal(rofl::openflow::cofmatch& match, rofl::openflow::cofmatch& expected){
+
+	CPPUNIT_ASSERT(match.length() == expected.length());
+
+	std::vector<uint8_t> buf(match.length()), expected_buf(expected.length());
+
+	match.pack(&buf[0], buf.size());
+	expected.pack(&expected_buf[0], expected_buf.size());
+
+	CPPUNIT_ASSERT(buf == expected_buf);
+}
+
+void PacketInEncoderTestCase::check_version(uint8_t ofp_version){
+	packet_matches_t pm;
+
+	for(unsigned int i=0;i<NUM_OF_ITERATIONS;i++){
+		rofl::openflow::cofmatch match(ofp_version), expected(ofp_version);
+
+		fill(&pm);
+
+		CPPUNIT_ASSERT(encoder.map_match(ofp_version, &pm, match));
+
+		switch(ofp_version){
+			case rofl::openflow10::OFP_VERSION:
+				of10_translation_utils::of1x_map_reverse_packet_matches(&pm, expected);
+				break;
+			case rofl::openflow12::OFP_VERSION:
+				//Extensions are added by the endpoint
+				of12_translation_utils::of12_map_reverse_packet_matches_ext(&pm, match);
+				of12_translation_utils::of12_map_reverse_packet_matches(&pm, expected);
+				break;
+			default:
+				of13_translation_utils::of13_map_reverse_packet_matches_ext(&pm, match);
+				of13_translation_utils::of13_map_reverse_packet_matches(&pm, expected);
+				break;
+		}
+
+		check_equal(match, expected);
+	}
+}
+
+void PacketInEncoderTestCase::test_empty(void)
+{
+	packet_matches_t pm;
+
+	fprintf(stderr,"<%s:%d> ************** Test empty match ************\n",__func__,__LINE__);
+
+	memset(&pm, 0, sizeof(packet_matches_t));
+
+	uint8_t versions[] = { rofl::openflow10::OFP_VERSION, rofl::openflow12::OFP_VERSION, rofl::openflow13::OFP_VERSION };
+
+	for(unsigned int i=0;i<sizeof(versions);i++){
+		rofl::openflow::cofmatch match(versions[i]), expected(versions[i]);
+
+		CPPUNIT_ASSERT(encoder.map_match(versions[i], &pm, match));
+		check_equal(match, expected);
+	}
+}
+
+void PacketInEncoderTestCase::test_of10(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test OF1.0 ************\n",__func__,__LINE__);
+	check_version(rofl::openflow10::OFP_VERSION);
+}
+
+void PacketInEncoderTestCase::test_of12(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test OF1.2 ************\n",__func__,__LINE__);
+	check_version(rofl::openflow12::OFP_VERSION);
+}
+
+void PacketInEncoderTestCase::test_of13(void)
+{
+	fprintf(stderr,"<%s:%d> ************** Test OF1.3 ************\n",__func__,__LINE__);
+	check_version(rofl::openflow13::OFP_VERSION);
+}
+
+void PacketInEncoderTestCase::test_unsupported(void)
+{
+	packet_matches_t pm;
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION), empty(rofl::openflow13::OFP_VERSION);
+
+	fprintf(stderr,"<%s:%d> ************** Test unsupported version ************\n",__func__,__LINE__);
+
+	fill(&pm);
+
+	//OF1.1; nothing is set
+	CPPUNIT_ASSERT(encoder.map_match(0x02, &pm, match) == false);
+	check_equal(match, empty);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(PacketInEncoderTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/**
+* This is a unit test that must check the proper
+* funcionality of the PACKET_OUT batches (packet_out_batch);
+* when they are flushed, that payloads are kept and how failures
+* are accounted
+*
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <rofl/datapath/hal/openflow/openflow1x/of1x_driver.h>
+#include "xdpd/openflow/packet_out_batch.h"
+
+#define TEST_DPID 0x100ULL
+
+using namespace std;
+using namespace xdpd;
+
+/*
+* Driver mockup. PACKET_OUTs with an odd in_port fail
+*/
+typedef struct driver_pkt_out{
+	uint32_t buffer_id;
+	uint32_t in_port;
+	bool has_buffer;
+	std::string payload;
+}driver_pkt_out_t;
+
+static std::vector<unsigned int> calls;
+static std::vector<driver_pkt_out_t> processed;
+
+hal_result_t hal_driver_of1x_process_packet_out_batch(uint64_t dpid, of1x_packet_out_t* pkt_outs, unsigned int num){
+
+	hal_result_t res = HAL_SUCCESS;
+
+	CPPUNIT_ASSERT(dpid == TEST_DPID);
+	calls.push_back(num);
+
+	for(unsigned int i=0;i<num;i++){
+		driver_pkt_out_t pkt_out;
+
+		pkt_out.buffer_id = pkt_outs[i].buffer_id;
+		pkt_out.in_port = pkt_outs[i].in_port;
+		pkt_out.has_buffer = (pkt_outs[i].buffer != NULL);
+		if(pkt_outs[i].buffer)
+			pkt_out.payload = std::string((const char*)pkt_outs[i].buffer, pkt_outs[i].buffer_size);
+		processed.push_back(pkt_out);
+
+		pkt_outs[i].result = (pkt_outs[i].in_port % 2)? HAL_FAILURE : HAL_SUCCESS;
+		if(pkt_outs[i].result != HAL_SUCCESS)
+			res = HAL_FAILURE;
+	}
+
+	return res;
+}
+
+hal_result_t hal_driver_of1x_process_packet_out(uint64_t dpid, uint32_t buffer_id, uint32_t in_port, of1x_action_group_t* action_group, uint8_t* buffer, uint32_t buffer_size){
+	//Batched call must always be used
+	CPPUNIT_ASSERT(0);
+	return HAL_FAILURE;
+}
+
+class PacketOutBatchTestCase : public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(PacketOutBatchTestCase);
+	CPPUNIT_TEST(test_disabled);
+	CPPUNIT_TEST(test_flush_on_size);
+	CPPUNIT_TEST(test_flush_explicit);
+	CPPUNIT_TEST(test_payloads);
+	CPPUNIT_TEST(test_failures);
+	CPPUNIT_TEST_SUITE_END();
+
+	void test_disabled(void);
+	void test_flush_on_size(void);
+	void test_flush_explicit(void);
+	void test_payloads(void);
+	void test_failures(void);
+
+	//Owned by the "cache"
+	of1x_action_group_t* cached_group;
+
+public:
+	void setUp(void);
+	void tearDown(void);
+};
+
+void PacketOutBatchTestCase::setUp(){
+	fprintf(stderr,"<%s:%d> ************** Set up ************\n",__func__,__LINE__);
+	calls.clear();
+	processed.clear();
+	cached_group = of1x_init_action_group(NULL);
+}
+
+void PacketOutBatchTestCase::tearDown(){
+	fprintf(stderr,"<%s:%d> ************** Tear Down ************\n",__func__,__LINE__);
+	of1x_destroy_action_group(cached_group);
+}
+
+void PacketOutBatchTestCase::test_disabled(void)
+{
+	packet_out_batch batch;
+	uint8_t payload[64] = {0};
+
+	fprintf(stderr,"<%s:%d> ************** Test disabled ************\n",__func__,__LINE__);
+
+	//Disabled by default; the caller keeps the action group
+	CPPUNIT_ASSERT(batch.add(1, 2, cached_group, true, payload, sizeof(payload)) == false);
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 0);
+
+	batch.set_max_size(TEST_DPID, 0);
+	CPPUNIT_ASSERT(batch.add(1, 2, cached_group, true, payload, sizeof(payload)) == false);
+	CPPUNIT_ASSERT(calls.empty());
+}
+
+void PacketOutBatchTestCase::test_flush_on_size(void)
+{
+	packet_out_batch batch;
+	uint8_t payload[64] = {0};
+
+	fprintf(stderr,"<%s:%d> ************** Test flush on size ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 4);
+
+	//Cached and owned (released by the batch) groups
+	for(unsigned int i=0;i<3;i++)
+		CPPUNIT_ASSERT(batch.add(i, 0, (i%2)? cached_group : of1x_init_action_group(NULL), i%2, payload, sizeof(payload)));
+
+	CPPUNIT_ASSERT(calls.empty());
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 3);
+
+	//Full
+	CPPUNIT_ASSERT(batch.add(3, 0, cached_group, true, payload, sizeof(payload)));
+	CPPUNIT_ASSERT(calls.size() == 1);
+	CPPUNIT_ASSERT(calls[0] == 4);
+	CPPUNIT_ASSERT(batch.get_num_of_pending() == 0);
+
+	//In order
+	for(unsigned int i=0;i<4;i++)
+		CPPUNIT_ASSERT(processed[i].buffer_id == i);
+
+	CPPUNIT_ASSERT(batch.get_num_of_batches() == 1);
+	CPPUNIT_ASSERT(batch.get_num_of_packets() == 4);
+	CPPUNIT_ASSERT(batch.get_num_of_failures() == 0);
+}
+
+void PacketOutBatchTestCase::test_flush_explicit(void)
+{
+	uint8_t payload[64] = {0};
+
+	fprintf(stderr,"<%s:%d> ************** Test explicit flush ************\n",__func__,__LINE__);
+
+	{
+		packet_out_batch batch;
+		batch.set_max_size(TEST_DPID, 16);
+
+		//Nothing pending; no driver call
+		batch.flush();
+		CPPUNIT_ASSERT(calls.empty());
+
+		batch.add(1, 0, cached_group, true, payload, sizeof(payload));
+		batch.flush();
+		CPPUNIT_ASSERT(calls.size() == 1);
+
+		//Resizing flushes
+		batch.add(2, 0, cached_group, true, payload, sizeof(payload));
+		batch.set_max_size(TEST_DPID, 8);
+		CPPUNIT_ASSERT(calls.size() == 2);
+
+		//And so does the destruction
+		batch.add(3, 0, cached_group, true, payload, sizeof(payload));
+		CPPUNIT_ASSERT(calls.size() == 2);
+	}
+
+	CPPUNIT_ASSERT(calls.size() == 3);
+	CPPUNIT_ASSERT(calls[2] == 1);
+}
+
+void PacketOutBatchTestCase::test_payloads(void)
+{
+	packet_out_batch batch;
+	uint8_t payload[64];
+
+	fprintf(stderr,"<%s:%d> ************** Test payloads ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 16);
+
+	//The payload of the message is released (here overwritten) once queued
+	memset(payload, 'a', sizeof(payload));
+	batch.add(1, 0, cached_group, true, payload, sizeof(payload));
+	memset(payload, 'b', sizeof(payload));
+	batch.add(2, 0, cached_group, true, payload, 10);
+
+	//Buffered PACKET_OUT, without payload
+	batch.add(3, 0, cached_group, true, NULL, 0);
+
+	memset(payload, 'c', sizeof(payload));
+	batch.flush();
+
+	CPPUNIT_ASSERT(processed.size() == 3);
+	CPPUNIT_ASSERT(processed[0].payload == std::string(64, 'a'));
+	CPPUNIT_ASSERT(processed[1].payload == std::string(10, 'b'));
+	CPPUNIT_ASSERT(!processed[2].has_buffer);
+}
+
+void PacketOutBatchTestCase::test_failures(void)
+{
+	packet_out_batch batch;
+	uint8_t payload[64] = {0};
+
+	fprintf(stderr,"<%s:%d> ************** Test failures ************\n",__func__,__LINE__);
+
+	batch.set_max_size(TEST_DPID, 10);
+
+	//Odd in_ports fail
+	for(unsigned int i=0;i<25;i++)
+		batch.add(i, i, of1x_init_action_group(NULL), false, payload, sizeof(payload));
+	batch.flush();
+
+	CPPUNIT_ASSERT(calls.size() == 3);
+	CPPUNIT_ASSERT(batch.get_num_of_batches() == 3);
+	CPPUNIT_ASSERT(batch.get_num_of_packets() == 25);
+	CPPUNIT_ASSERT(batch.get_num_of_failures() == 12);
+}
+
+/*
+* Test MAIN
+*/
+int main( int argc, char* argv[] )
+{
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(PacketOutBatchTestCase::suite()); // Add the top suite to the test runner
+	runner.setOutputter(
+			new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+
+	// Run the test and don't wait a key if post build check.
+	bool wasSuccessful = runner.run( "" );
+
+	std::cerr<<"************** Test finished ************"<<std::endl;
+
+	// Return error code 1 if the one of test failed.
+	return wasSuccessful ? 0 : 1;
+}